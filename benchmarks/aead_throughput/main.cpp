@@ -0,0 +1,152 @@
+#include <boost/program_options.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include <openssl/crypto.h>
+
+#include "../shared/allocation-counter.hpp"
+#include "crypto/aes-gcm.hpp"
+#include "mal-packet-weaver/crypto.hpp"
+#include "network/buffer-pool.hpp"
+
+using namespace mal_packet_weaver;
+namespace po = boost::program_options;
+
+// OpenSSL's allocator, hooked in main() so its allocations are counted along with C++ code's.
+void *counting_malloc(size_t size, const char *, int)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size);
+}
+void *counting_realloc(void *ptr, size_t size, const char *, int)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::realloc(ptr, size);
+}
+void counting_free(void *ptr, const char *, int) { std::free(ptr); }
+
+struct BenchmarkConfig
+{
+    std::vector<size_t> payload_sizes{ 64, 1024, 16 * 1024 };
+    double seconds = 1.0;
+};
+
+struct BenchmarkResult
+{
+    uint64_t packets = 0;
+    double seconds = 0;
+    uint64_t allocations = 0;
+};
+
+// Each iteration encrypts and decrypts one packet, as one core of a relay would for a packet
+// passing through it.
+template <typename RoundTrip>
+BenchmarkResult measure(BenchmarkConfig const &config, RoundTrip &&round_trip)
+{
+    // Warm-up fills pools and lets OpenSSL finish its lazy initialization.
+    for (int i = 0; i < 1000; ++i)
+    {
+        round_trip();
+    }
+
+    BenchmarkResult result;
+    const uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    const auto duration = std::chrono::duration<double>(config.seconds);
+    while (std::chrono::steady_clock::now() - start < duration)
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            round_trip();
+        }
+        result.packets += 256;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+    return result;
+}
+
+void print(std::string_view name, size_t payload_size, BenchmarkResult const &result)
+{
+    // Both directions process the payload once, hence the factor of two.
+    const double bytes = 2.0 * static_cast<double>(payload_size) * static_cast<double>(result.packets);
+    std::cout << std::format("{:<14} {:>8} {:>10.3f} {:>12.2f} {:>12.2f}\n", name, payload_size,
+                             bytes / result.seconds / 1e9, result.packets / result.seconds / 1e6,
+                             static_cast<double>(result.allocations) / static_cast<double>(result.packets));
+}
+
+int main(int argc, char **argv)
+{
+    // Has to run before OpenSSL allocates anything.
+    CRYPTO_set_mem_functions(counting_malloc, counting_realloc, counting_free);
+
+    BenchmarkConfig config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("payload-sizes", po::value<std::vector<size_t>>(&config.payload_sizes)->multitoken(), "Packet sizes to measure")
+        ("seconds", po::value<double>(&config.seconds), "Duration of every measurement")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+
+    ByteArray key;
+    key.resize(pds::crypto::AesGcm::kKeySize);
+    for (size_t i = 0; i < key.size(); ++i)
+    {
+        key[i] = static_cast<std::byte>(i * 7 + 1);
+    }
+    ByteArray salt;
+    salt.resize(8);
+
+    std::cout << std::format("{:<14} {:>8} {:>10} {:>12} {:>12}\n", "mode", "payload", "GB/s",
+                             "Mpackets/s", "allocs/pkt");
+    for (const size_t payload_size : config.payload_sizes)
+    {
+        ByteArray payload;
+        payload.resize(payload_size);
+
+        {
+            crypto::AES::AES256 sender{ key, salt, 5 };
+            crypto::AES::AES256 receiver{ key, salt, 5 };
+            print("aes256", payload_size,
+                  measure(config, [&]() { (void)receiver.decrypt(sender.encrypt(payload)); }));
+        }
+        {
+            pds::crypto::AesGcm sender{ key, pds::crypto::Role::Server };
+            pds::crypto::AesGcm receiver{ key, pds::crypto::Role::Client };
+            print("gcm interface", payload_size,
+                  measure(config, [&]() { (void)receiver.decrypt(sender.encrypt(payload)); }));
+        }
+        {
+            pds::crypto::AesGcm sender{ key, pds::crypto::Role::Server };
+            pds::crypto::AesGcm receiver{ key, pds::crypto::Role::Client };
+            pds::network::BufferPool pool;
+            print("gcm in place", payload_size,
+                  measure(config,
+                          [&]()
+                          {
+                              ByteArray frame =
+                                  pool.acquire(payload_size + pds::crypto::AesGcm::kOverhead);
+                              std::memcpy(frame.data() + pds::crypto::AesGcm::kNonceSize,
+                                          payload.data(), payload_size);
+                              sender.seal_in_place(frame);
+                              if (!receiver.open_in_place(frame))
+                              {
+                                  std::abort();
+                              }
+                              pool.release(std::move(frame));
+                          }));
+        }
+    }
+    return 0;
+}
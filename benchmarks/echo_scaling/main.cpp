@@ -0,0 +1,316 @@
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <thread>
+
+#include <pthread.h>
+#include <sys/resource.h>
+#include <time.h>
+
+namespace po = boost::program_options;
+namespace asio = boost::asio;
+using asio::ip::tcp;
+
+#if defined(BOOST_ASIO_HAS_IO_URING) && defined(BOOST_ASIO_DISABLE_EPOLL)
+constexpr std::string_view kBackend = "io_uring";
+#else
+constexpr std::string_view kBackend = "epoll";
+#endif
+
+struct BenchmarkConfig
+{
+    std::vector<size_t> sessions{ 10'000, 50'000 };
+    uint64_t round_trips = 20;
+    size_t message_size = 64;
+    int server_threads = 1;
+    size_t connect_window = 256;
+};
+
+// Server side: echoes whatever it reads, the cheapest possible session.
+class EchoSession : public std::enable_shared_from_this<EchoSession>
+{
+public:
+    EchoSession(tcp::socket &&socket, size_t message_size)
+        : socket_{ std::move(socket) }, buffer_(message_size)
+    {
+    }
+
+    void start() { read(); }
+
+private:
+    void read()
+    {
+        socket_.async_read_some(asio::buffer(buffer_),
+                                [self = shared_from_this()](boost::system::error_code ec, size_t size)
+                                {
+                                    if (!ec)
+                                    {
+                                        self->write(size);
+                                    }
+                                });
+    }
+    void write(size_t size)
+    {
+        asio::async_write(socket_, asio::buffer(buffer_.data(), size),
+                          [self = shared_from_this()](boost::system::error_code ec, size_t)
+                          {
+                              if (!ec)
+                              {
+                                  self->read();
+                              }
+                          });
+    }
+
+    tcp::socket socket_;
+    std::vector<char> buffer_;
+};
+
+void accept(tcp::acceptor &acceptor, size_t message_size)
+{
+    acceptor.async_accept(
+        [&acceptor, message_size](boost::system::error_code ec, tcp::socket socket)
+        {
+            if (!ec)
+            {
+                socket.set_option(tcp::no_delay(true));
+                std::make_shared<EchoSession>(std::move(socket), message_size)->start();
+            }
+            if (ec != asio::error::operation_aborted)
+            {
+                accept(acceptor, message_size);
+            }
+        });
+}
+
+// Client side: a closed loop of round trips per connection.
+struct ClientSession
+{
+    explicit ClientSession(asio::io_context &io, size_t message_size)
+        : socket{ io }, message(message_size)
+    {
+    }
+
+    tcp::socket socket;
+    std::vector<char> message;
+    uint64_t remaining = 0;
+};
+
+class LoadGenerator
+{
+public:
+    LoadGenerator(asio::io_context &io, BenchmarkConfig const &config, size_t sessions,
+                  tcp::endpoint server)
+        : io_{ io }, config_{ config }, server_{ server }
+    {
+        clients_.reserve(sessions);
+        for (size_t i = 0; i < sessions; ++i)
+        {
+            clients_.emplace_back(std::make_unique<ClientSession>(io, config.message_size));
+        }
+    }
+
+    /** @brief Resolves once every client is connected. */
+    std::future<void> connect_all()
+    {
+        for (size_t i = 0; i < std::min(config_.connect_window, clients_.size()); ++i)
+        {
+            asio::post(io_, [this]() { connect_next(); });
+        }
+        return connected_.get_future();
+    }
+
+    /** @brief Resolves once every client finished its round trips. */
+    std::future<void> run()
+    {
+        for (auto &client : clients_)
+        {
+            asio::post(io_,
+                       [this, client = client.get()]()
+                       {
+                           client->remaining = config_.round_trips;
+                           round_trip(*client);
+                       });
+        }
+        return finished_.get_future();
+    }
+
+private:
+    void connect_next()
+    {
+        if (next_client_ == clients_.size())
+        {
+            return;
+        }
+        const size_t index = next_client_++;
+        ClientSession &client = *clients_[index];
+        // Spread over 127.0.0.0/8 sources, one address has too few ephemeral ports for 50k.
+        client.socket.open(tcp::v4());
+        client.socket.bind(tcp::endpoint(
+            asio::ip::address_v4(asio::ip::address_v4::loopback().to_uint() + index % 250), 0));
+        client.socket.async_connect(server_,
+                                    [this, &client](boost::system::error_code ec)
+                                    {
+                                        if (ec)
+                                        {
+                                            throw boost::system::system_error(ec, "connect");
+                                        }
+                                        client.socket.set_option(tcp::no_delay(true));
+                                        if (++connected_count_ == clients_.size())
+                                        {
+                                            connected_.set_value();
+                                        }
+                                        connect_next();
+                                    });
+    }
+
+    void round_trip(ClientSession &client)
+    {
+        asio::async_write(
+            client.socket, asio::buffer(client.message),
+            [this, &client](boost::system::error_code ec, size_t)
+            {
+                if (ec)
+                {
+                    throw boost::system::system_error(ec, "write");
+                }
+                asio::async_read(client.socket, asio::buffer(client.message),
+                                 [this, &client](boost::system::error_code ec, size_t)
+                                 {
+                                     if (ec)
+                                     {
+                                         throw boost::system::system_error(ec, "read");
+                                     }
+                                     if (--client.remaining != 0)
+                                     {
+                                         round_trip(client);
+                                     }
+                                     else if (++finished_count_ == clients_.size())
+                                     {
+                                         finished_.set_value();
+                                     }
+                                 });
+            });
+    }
+
+    asio::io_context &io_;
+    BenchmarkConfig const &config_;
+    tcp::endpoint server_;
+    std::vector<std::unique_ptr<ClientSession>> clients_;
+    size_t next_client_ = 0;
+    size_t connected_count_ = 0;
+    size_t finished_count_ = 0;
+    std::promise<void> connected_;
+    std::promise<void> finished_;
+};
+
+double thread_cpu_seconds(std::vector<std::thread> &threads)
+{
+    double seconds = 0;
+    for (auto &thread : threads)
+    {
+        clockid_t clock;
+        timespec time{};
+        pthread_getcpuclockid(thread.native_handle(), &clock);
+        clock_gettime(clock, &time);
+        seconds += static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) / 1e9;
+    }
+    return seconds;
+}
+
+void run(BenchmarkConfig const &config, size_t sessions)
+{
+    asio::io_context server_io;
+    tcp::acceptor acceptor(server_io);
+    const tcp::endpoint listen_endpoint(asio::ip::address_v4::any(), 0);
+    acceptor.open(listen_endpoint.protocol());
+    acceptor.set_option(tcp::acceptor::reuse_address(true));
+    acceptor.bind(listen_endpoint);
+    acceptor.listen(asio::socket_base::max_listen_connections);
+    accept(acceptor, config.message_size);
+
+    auto server_guard = asio::make_work_guard(server_io);
+    std::vector<std::thread> server_threads;
+    for (int i = 0; i < config.server_threads; ++i)
+    {
+        server_threads.emplace_back([&server_io]() { server_io.run(); });
+    }
+
+    asio::io_context client_io;
+    auto client_guard = asio::make_work_guard(client_io);
+    LoadGenerator load{ client_io, config, sessions,
+                        tcp::endpoint(asio::ip::address_v4::loopback(),
+                                      acceptor.local_endpoint().port()) };
+    std::thread client_thread([&client_io]() { client_io.run(); });
+
+    load.connect_all().get();
+    // Let the server finish accepting before its CPU time is sampled.
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 200 });
+
+    const double cpu_before = thread_cpu_seconds(server_threads);
+    const auto start = std::chrono::steady_clock::now();
+    load.run().get();
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double cpu = thread_cpu_seconds(server_threads) - cpu_before;
+
+    const double messages = static_cast<double>(sessions * config.round_trips);
+    std::cout << std::format("{:<9} {:>9} {:>12.0f} {:>14.3f} {:>12.2f} {:>10.0f}\n", kBackend,
+                             sessions, messages / wall, cpu / messages * 1e6,
+                             cpu / wall * 100.0, wall * 1e3);
+
+    client_guard.reset();
+    client_io.stop();
+    client_thread.join();
+    server_guard.reset();
+    server_io.stop();
+    for (auto &thread : server_threads)
+    {
+        thread.join();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("sessions", po::value<std::vector<size_t>>(&config.sessions)->multitoken(), "Concurrent sessions, one run per value")
+        ("round-trips", po::value<uint64_t>(&config.round_trips), "Echo round trips per session")
+        ("message-size", po::value<size_t>(&config.message_size), "Size of one echo message in bytes")
+        ("server-threads", po::value<int>(&config.server_threads), "Threads running the server io_context")
+        ("connect-window", po::value<size_t>(&config.connect_window), "Connects in flight while ramping up")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+
+    // Both ends of every connection live in this process.
+    rlimit files{};
+    getrlimit(RLIMIT_NOFILE, &files);
+    files.rlim_cur = files.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &files);
+
+    std::cout << std::format("echo round trips of {} bytes, {} per session, {} server thread(s)\n",
+                             config.message_size, config.round_trips, config.server_threads);
+    std::cout << std::format("{:<9} {:>9} {:>12} {:>14} {:>12} {:>10}\n", "backend", "sessions",
+                             "messages/s", "cpu us/msg", "server cpu%", "wall ms");
+    for (const size_t sessions : config.sessions)
+    {
+        if (2 * sessions + 64 > files.rlim_cur)
+        {
+            std::cout << std::format("{:<9} {:>9} skipped: needs {} file descriptors, limit is {}\n",
+                                     kBackend, sessions, 2 * sessions + 64, files.rlim_cur);
+            continue;
+        }
+        run(config, sessions);
+    }
+    return 0;
+}
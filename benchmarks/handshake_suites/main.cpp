@@ -0,0 +1,100 @@
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "crypto/curve25519.hpp"
+#include "crypto/handshake.hpp"
+#include "mal-packet-weaver/crypto.hpp"
+
+using namespace mal_packet_weaver;
+using namespace mal_packet_weaver::crypto;
+namespace po = boost::program_options;
+
+struct BenchmarkConfig
+{
+    std::vector<std::string> curves{ "secp256k1", "secp384r1", "secp521r1", "ed25519" };
+    double seconds = 2.0;
+};
+
+struct BenchmarkResult
+{
+    uint64_t handshakes = 0;
+    double client_seconds = 0;
+    double server_seconds = 0;
+};
+
+// Runs both halves of the handshake on one thread, timing each side separately, and checks
+// that the two ends agree on the session key by pushing a packet through it.
+BenchmarkResult measure(BenchmarkConfig const &config, KeyPair const &pair)
+{
+    const pds::crypto::ServerIdentity identity{ pair.private_key };
+    const pds::crypto::ServerTrust trust{ pair.public_key };
+    ByteArray probe;
+    probe.resize(64);
+
+    BenchmarkResult result;
+    const auto duration = std::chrono::duration<double>(config.seconds);
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < duration)
+    {
+        const auto client_start = std::chrono::steady_clock::now();
+        const pds::crypto::ClientHandshake client{ trust };
+        const DHKeyExchangeRequestPacket request = client.request();
+
+        const auto server_start = std::chrono::steady_clock::now();
+        const auto server = pds::crypto::accept_key_exchange(identity, request);
+        const auto server_end = std::chrono::steady_clock::now();
+
+        const auto encryption = server ? client.finish(server->response) : nullptr;
+        const auto client_end = std::chrono::steady_clock::now();
+        if (!encryption || encryption->decrypt(server->encryption->encrypt(probe)) != probe)
+        {
+            std::cerr << "Handshake failed\n";
+            std::abort();
+        }
+
+        result.handshakes++;
+        result.server_seconds += std::chrono::duration<double>(server_end - server_start).count();
+        result.client_seconds += std::chrono::duration<double>((server_start - client_start) +
+                                                               (client_end - server_end))
+                                     .count();
+    }
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("curves", po::value<std::vector<std::string>>(&config.curves)->multitoken(), "Server key types, as keygen --curve takes them")
+        ("seconds", po::value<double>(&config.seconds), "Duration of every measurement")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+
+    std::cout << std::format("{:<16} {:<16} {:>14} {:>12} {:>12}\n", "key", "suite", "handshakes/s",
+                             "server us", "client us");
+    for (auto const &curve : config.curves)
+    {
+        const KeyPair pair = curve == "ed25519" ? pds::crypto::generate_ed25519_key_pair()
+                                                : ECDSA::KeyPairGenerator(curve).generate();
+        const BenchmarkResult result = measure(config, pair);
+        const double handshakes = static_cast<double>(result.handshakes);
+        // A server only pays its own half, so that is the rate one core can accept.
+        std::cout << std::format("{:<16} {:<16} {:>14.0f} {:>12.1f} {:>12.1f}\n", curve,
+                                 pds::crypto::to_string(pds::crypto::ServerIdentity{ pair.private_key }.suite()),
+                                 handshakes / result.server_seconds, 1e6 * result.server_seconds / handshakes,
+                                 1e6 * result.client_seconds / handshakes);
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <boost/program_options.hpp>
+#include <spdlog/sinks/null_sink.h>
+#include <chrono>
+#include <iostream>
+
+#include "logging/hot-log.hpp"
+
+namespace po = boost::program_options;
+
+struct BenchmarkConfig
+{
+    uint64_t calls = 2'000'000;
+    uint64_t sample_every = 1000;
+};
+
+template <typename Statement>
+double ns_per_call(BenchmarkConfig const &config, Statement &&statement)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < config.calls; i++)
+    {
+        statement(i);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           static_cast<double>(config.calls);
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("calls", po::value<uint64_t>(&config.calls), "Log calls per measurement")
+        ("sample-every", po::value<uint64_t>(&config.sample_every), "N of the sampled statement")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+
+    // Both paths end in the same sink, which discards the text after formatting.
+    auto logger = std::make_shared<spdlog::logger>("bench", std::make_shared<spdlog::sinks::null_sink_mt>());
+    logger->set_level(spdlog::level::info);
+    pds::logging::set_level(spdlog::level::info);
+    const std::string message = "1234567";
+
+    std::vector<std::pair<std::string_view, double>> results;
+    {
+        pds::logging::HotLogBackend backend{ logger, std::chrono::milliseconds{ 1 } };
+        results.emplace_back("hot log, level disabled", ns_per_call(config, [&](uint64_t i)
+            { PDS_HOT_LOG(spdlog::level::debug, "Received message: {} #{}", message, i); }));
+        results.emplace_back("hot log, sampled", ns_per_call(config, [&](uint64_t i)
+            { PDS_HOT_LOG_EVERY_N(spdlog::level::info, config.sample_every, "Received message: {} #{}", message, i); }));
+        results.emplace_back("hot log, rate limited 1/s", ns_per_call(config, [&](uint64_t i)
+            { PDS_HOT_LOG_RATE_LIMITED(spdlog::level::info, std::chrono::seconds{ 1 }, "Received message: {} #{}", message, i); }));
+        // Records beyond what the backend keeps up with are dropped, which is counted as a
+        // write: that is what the logging thread pays either way.
+        results.emplace_back("hot log, every call", ns_per_call(config, [&](uint64_t i)
+            { PDS_HOT_LOG(spdlog::level::info, "Received message: {} #{}", message, i); }));
+    }
+    results.emplace_back("spdlog, level disabled", ns_per_call(config, [&](uint64_t i)
+        { logger->debug("Received message: {} #{}", message, i); }));
+    results.emplace_back("spdlog, every call", ns_per_call(config, [&](uint64_t i)
+        { logger->info("Received message: {} #{}", message, i); }));
+
+    std::cout << std::format("{:<28} {:>10}\n", "statement", "ns/call");
+    for (auto const &[name, ns] : results)
+    {
+        std::cout << std::format("{:<28} {:>10.1f}\n", name, ns);
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/program_options.hpp>
+#include <boost/serialization/string.hpp>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+#include "../shared/allocation-counter.hpp"
+#include "mql-cpp/c-interop.hpp"
+
+namespace po = boost::program_options;
+
+struct BenchmarkConfig
+{
+    double seconds = 0.2;
+    size_t records = 1000;
+    std::string symbol = "EURUSD.pro";
+    std::string comment = "grid level 12, signal #4471";
+    std::string external_id = "EXT-000001234567";
+};
+
+// PositionInfo as it was before its strings became inline, to compare against. Serialized the
+// same way, so both have to produce the same bytes.
+struct LegacyPositionInfoString
+{
+    std::string symbol;
+    std::string comment;
+    std::string external_id;
+
+private:
+    friend class boost::serialization::access;
+    template <class Archive>
+    void serialize(Archive &ar, const unsigned int)
+    {
+        ar &symbol;
+        ar &comment;
+        ar &external_id;
+    }
+};
+
+struct LegacyPositionInfo : mql::mql5::PositionInfoInteger, mql::mql5::PositionInfoDouble, LegacyPositionInfoString
+{
+private:
+    friend class boost::serialization::access;
+    template <class Archive>
+    void serialize(Archive &ar, const unsigned int)
+    {
+        ar &boost::serialization::base_object<mql::mql5::PositionInfoInteger>(*this);
+        ar &boost::serialization::base_object<mql::mql5::PositionInfoDouble>(*this);
+        ar &boost::serialization::base_object<LegacyPositionInfoString>(*this);
+    }
+};
+
+template <typename Record>
+std::vector<Record> make_records(BenchmarkConfig const &config)
+{
+    std::vector<Record> records(config.records);
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        Record &record = records[i];
+        record.ticket = static_cast<mql::MQL_long>(i + 1);
+        record.open_time = mql::MQL_DateTime{ std::chrono::milliseconds{ 1'700'000'000'000 } };
+        record.type = mql::mql5::EnumPositionType::PositionTypeBuy;
+        record.volume = 0.1 * static_cast<double>(i % 10 + 1);
+        record.price_open = 1.0850;
+        record.symbol = config.symbol;
+        record.comment = config.comment;
+        record.external_id = config.external_id;
+    }
+    return records;
+}
+
+constexpr auto kArchiveFlags = boost::archive::no_header;
+
+template <typename Record>
+std::string encode(std::vector<Record> const &records)
+{
+    std::ostringstream stream;
+    boost::archive::binary_oarchive archive{ stream, kArchiveFlags };
+    for (Record const &record : records)
+    {
+        archive << record;
+    }
+    return std::move(stream).str();
+}
+
+struct BenchmarkResult
+{
+    double ns_per_record = 0;
+    double allocations_per_record = 0;
+};
+
+// Runs operation, which handles config.records records, for config.seconds.
+template <typename Operation>
+BenchmarkResult measure(BenchmarkConfig const &config, Operation &&operation)
+{
+    operation();
+    uint64_t records = 0;
+    const uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    const auto duration = std::chrono::duration<double>(config.seconds);
+    while (std::chrono::steady_clock::now() - start < duration)
+    {
+        operation();
+        records += config.records;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return BenchmarkResult{ .ns_per_record = seconds * 1e9 / static_cast<double>(records),
+                            .allocations_per_record =
+                                static_cast<double>(g_allocations.load(std::memory_order_relaxed) -
+                                                    allocations_before) /
+                                static_cast<double>(records) };
+}
+
+void print(std::string_view name, std::string_view operation, BenchmarkResult const &result)
+{
+    std::cout << std::format("{:<10} {:<22} {:>10.1f} {:>14.2f}\n", name, operation, result.ns_per_record,
+                             result.allocations_per_record);
+}
+
+template <typename Record>
+void run(std::string_view name, BenchmarkConfig const &config)
+{
+    const std::vector<Record> records = make_records<Record>(config);
+    const std::string bytes = encode(records);
+
+    // Copy into existing records, as a cache update does.
+    std::vector<Record> copies = make_records<Record>(config);
+    print(name, "copy", measure(config, [&]() { std::copy(records.begin(), records.end(), copies.begin()); }));
+    // Copy into fresh records, as a queue or a snapshot does.
+    print(name, "copy-construct", measure(config, [&]() { std::vector<Record> snapshot{ records }; }));
+
+    // The strings part of mql::to_c, which only takes the inline structure.
+    MQL5_PositionInfo c_record{};
+    print(name, "to C", measure(config, [&]() {
+              for (Record const &record : records)
+              {
+                  c_record.integer_info.ticket = record.ticket;
+                  mql::to_utf16(record.symbol, c_record.symbol);
+                  mql::to_utf16(record.comment, c_record.comment);
+                  mql::to_utf16(record.external_id, c_record.external_id);
+              }
+          }));
+
+    print(name, "encode", measure(config, [&]() { (void)encode(records); }));
+    print(name, "decode", measure(config, [&]() {
+              std::istringstream stream{ bytes };
+              boost::archive::binary_iarchive archive{ stream, kArchiveFlags };
+              std::vector<Record> decoded(config.records);
+              for (Record &record : decoded)
+              {
+                  archive >> record;
+              }
+          }));
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("seconds", po::value<double>(&config.seconds), "Duration of every measurement")
+        ("records", po::value<size_t>(&config.records), "Positions handled per pass")
+        ("symbol", po::value<std::string>(&config.symbol), "Symbol of every position")
+        ("comment", po::value<std::string>(&config.comment), "Comment of every position")
+        ("external-id", po::value<std::string>(&config.external_id), "External id of every position")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+    config.records = std::max<size_t>(config.records, 1);
+
+    // Inline strings are written like std::string; anything else would break older peers.
+    if (encode(make_records<LegacyPositionInfo>(config)) != encode(make_records<mql::mql5::PositionInfo>(config)))
+    {
+        std::cerr << "PositionInfo is not encoded like LegacyPositionInfo; are the strings longer than "
+                     "their capacity?\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << std::format("sizeof: std::string {} bytes, inline {} bytes\n", sizeof(LegacyPositionInfo),
+                             sizeof(mql::mql5::PositionInfo));
+    std::cout << std::format("{:<10} {:<22} {:>10} {:>14}\n", "strings", "operation", "ns/record", "allocs/record");
+    run<LegacyPositionInfo>("std", config);
+    run<mql::mql5::PositionInfo>("inline", config);
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <variant>
+
+#include "metrics/latency-histogram.hpp"
+#include "network/transport.hpp"
+
+namespace po = boost::program_options;
+namespace asio = boost::asio;
+using pds::network::Endpoint;
+using pds::network::Socket;
+
+struct BenchmarkConfig
+{
+    uint64_t round_trips = 100'000;
+    size_t message_size = 64;
+    uint64_t stream_bytes = 1ull << 30;
+    size_t stream_chunk = 64 * 1024;
+};
+
+uint64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Both sides go through Listener/connect, so each transport is measured with the socket type it
+// is handed out as.
+std::pair<Socket, Socket> make_pair(asio::io_context &io, Endpoint const &endpoint)
+{
+    pds::network::Listener listener{ io, endpoint };
+    std::optional<Socket> accepted;
+    listener.async_accept([&accepted](boost::system::error_code ec, Socket socket)
+                          {
+                              if (!ec)
+                              {
+                                  accepted.emplace(std::move(socket));
+                              }
+                          });
+    Endpoint target = listener.endpoint();
+    if (target.address == "0.0.0.0")
+    {
+        target.address = "127.0.0.1";
+    }
+    Socket client = pds::network::connect(io, target);
+    pds::network::set_no_delay(client);
+    io.run();
+    io.restart();
+    pds::network::set_no_delay(*accepted);
+    return { std::move(client), std::move(*accepted) };
+}
+
+template <typename Stream>
+pds::metrics::LatencyHistogram ping_pong(BenchmarkConfig const &config, Stream &client, Stream &server)
+{
+    std::thread echo(
+        [&]()
+        {
+            std::vector<char> message(config.message_size);
+            for (uint64_t i = 0; i < config.round_trips; ++i)
+            {
+                asio::read(server, asio::buffer(message));
+                asio::write(server, asio::buffer(message));
+            }
+        });
+
+    pds::metrics::LatencyHistogram latency;
+    std::vector<char> message(config.message_size);
+    for (uint64_t i = 0; i < config.round_trips; ++i)
+    {
+        const uint64_t start = now_ns();
+        asio::write(client, asio::buffer(message));
+        asio::read(client, asio::buffer(message));
+        latency.record(now_ns() - start);
+    }
+    echo.join();
+    return latency;
+}
+
+template <typename Stream>
+double stream(BenchmarkConfig const &config, Stream &client, Stream &server)
+{
+    std::thread sink(
+        [&]()
+        {
+            std::vector<char> buffer(config.stream_chunk);
+            uint64_t received = 0;
+            while (received < config.stream_bytes)
+            {
+                received += server.read_some(asio::buffer(buffer));
+            }
+        });
+
+    std::vector<char> chunk(config.stream_chunk);
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t sent = 0; sent < config.stream_bytes; sent += chunk.size())
+    {
+        asio::write(client, asio::buffer(chunk));
+    }
+    sink.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void run(BenchmarkConfig const &config, Endpoint const &endpoint)
+{
+    asio::io_context io;
+    auto [client, server] = make_pair(io, endpoint);
+
+    // Both ends of a pair share a transport, so only matching alternatives are visited.
+    pds::metrics::LatencyHistogram latency;
+    double seconds = 0;
+    std::visit(
+        [&](auto &client_socket, auto &server_socket)
+        {
+            if constexpr (std::is_same_v<decltype(client_socket), decltype(server_socket)>)
+            {
+                latency = ping_pong(config, client_socket, server_socket);
+                seconds = stream(config, client_socket, server_socket);
+            }
+        },
+        client, server);
+    std::cout << std::format("{:<6} {:>10.2f} {:>10.2f} {:>10.2f} {:>12.0f} {:>10.1f}\n",
+                             endpoint.is_local() ? "unix" : "tcp", latency.percentile(50) / 1e3,
+                             latency.percentile(99) / 1e3, latency.percentile(99.9) / 1e3,
+                             1e9 / latency.mean(),
+                             config.stream_bytes / seconds / (1024.0 * 1024.0));
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+    std::string tcp_uri = "tcp://127.0.0.1:0";
+    std::string local_uri =
+        "unix://" + (std::filesystem::temp_directory_path() / "pds-local-transport.sock").string();
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("round-trips", po::value<uint64_t>(&config.round_trips), "Ping-pong exchanges per transport")
+        ("message-size", po::value<size_t>(&config.message_size), "Size of a ping-pong message in bytes")
+        ("stream-bytes", po::value<uint64_t>(&config.stream_bytes), "Bytes streamed in the throughput run")
+        ("stream-chunk", po::value<size_t>(&config.stream_chunk), "Size of a single write when streaming")
+        ("tcp", po::value<std::string>(&tcp_uri), "TCP endpoint to compare")
+        ("local", po::value<std::string>(&local_uri), "Unix domain socket endpoint to compare")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+
+    std::cout << std::format("{} round trips of {} bytes, {} MiB streamed in {} KiB writes\n",
+                             config.round_trips, config.message_size, config.stream_bytes >> 20,
+                             config.stream_chunk / 1024);
+    std::cout << std::format("{:<6} {:>10} {:>10} {:>10} {:>12} {:>10}\n", "link", "p50 us",
+                             "p99 us", "p99.9 us", "round trip/s", "MiB/s");
+    run(config, pds::network::parse_endpoint(tcp_uri));
+    run(config, pds::network::parse_endpoint(local_uri));
+    return 0;
+}
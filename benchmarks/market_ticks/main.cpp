@@ -0,0 +1,252 @@
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/program_options.hpp>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../shared/allocation-counter.hpp"
+#include "../shared/output-buffer.hpp"
+#include "market-data-router.hpp"
+#include "market/tick-codec.hpp"
+#include "packets/market-data.hpp"
+
+namespace po = boost::program_options;
+
+struct BenchmarkConfig
+{
+    double seconds = 1.0;
+    uint32_t symbols = 200;
+    size_t subscribers = 8;
+    uint32_t symbols_per_subscriber = 20;
+    size_t batch_ticks = 256;
+    int32_t digits = 5;
+    // Whether every subscriber also gets the partial M1 bars of its symbols.
+    bool bars = false;
+    // Ticks per second the pipeline has to sustain.
+    double target = 1'000'000;
+};
+
+// Stands in for DispatcherSession: serializes what it is sent, as the real one does before
+// queuing it, and decodes the ticks as the client would.
+class BenchmarkSession
+{
+public:
+    template <typename Packet>
+    void send_packet(Packet const &packet)
+    {
+        buffer_.clear();
+        {
+            boost::archive::binary_oarchive archive{ buffer_, boost::archive::no_header };
+            archive << packet;
+        }
+        frame_bytes += buffer_.size();
+        ++frames;
+        if constexpr (std::is_same_v<Packet, BarUpdate>)
+        {
+            ++bars;
+        }
+        else if constexpr (std::is_same_v<Packet, TickBatch>)
+        {
+            payload_bytes += packet.ticks.size();
+            reader_.begin(packet.ticks, packet.base_time_msc);
+            pds::market::Tick tick;
+            while (reader_.next(tick))
+            {
+                ++ticks;
+            }
+            malformed |= reader_.malformed();
+        }
+    }
+
+    [[nodiscard]] bool is_closed() const noexcept { return false; }
+
+    uint64_t frames = 0;
+    uint64_t frame_bytes = 0;
+    uint64_t payload_bytes = 0;
+    uint64_t ticks = 0;
+    uint64_t bars = 0;
+    bool malformed = false;
+
+private:
+    OutputBuffer buffer_;
+    pds::market::TickReader reader_;
+};
+
+using Router = MarketDataRouter<BenchmarkSession>;
+
+// A random walk of every symbol's prices, a few points per tick as on a liquid market.
+class TickSource
+{
+public:
+    explicit TickSource(BenchmarkConfig const &config)
+        : prices_(config.symbols, 108'500), symbol_(0, config.symbols - 1)
+    {
+    }
+
+    pds::market::Tick next()
+    {
+        pds::market::Tick tick;
+        tick.symbol = symbol_(random_);
+        time_msc_ += step_(random_) % 3;
+        tick.time_msc = time_msc_;
+        prices_[tick.symbol] += step_(random_) - 3;
+        tick.bid = prices_[tick.symbol];
+        tick.ask = tick.bid + 12;
+        tick.flags = 6;
+        return tick;
+    }
+
+    [[nodiscard]] int64_t time_msc() const noexcept { return time_msc_; }
+
+private:
+    std::mt19937 random_{ 42 };
+    std::vector<int64_t> prices_;
+    std::uniform_int_distribution<uint32_t> symbol_;
+    std::uniform_int_distribution<int64_t> step_{ 0, 6 };
+    int64_t time_msc_ = 1'700'000'000'000;
+};
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("seconds", po::value<double>(&config.seconds), "Duration of the measurement")
+        ("symbols", po::value<uint32_t>(&config.symbols), "Symbols the publisher quotes")
+        ("subscribers", po::value<size_t>(&config.subscribers), "Clients receiving ticks")
+        ("symbols-per-subscriber", po::value<uint32_t>(&config.symbols_per_subscriber),
+         "Symbols every client subscribes to")
+        ("batch-ticks", po::value<size_t>(&config.batch_ticks), "Ticks the publisher sends per TickBatch")
+        ("bars", po::bool_switch(&config.bars), "Also subscribe to partial M1 bars")
+        ("target", po::value<double>(&config.target), "Ticks per second to sustain")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+    config.symbols = std::clamp<uint32_t>(config.symbols, 1, pds::market::kMaxSymbols);
+    config.symbols_per_subscriber = std::clamp<uint32_t>(config.symbols_per_subscriber, 1, config.symbols);
+    config.batch_ticks = std::max<size_t>(config.batch_ticks, 1);
+
+    const auto symbol_name = [](uint32_t symbol) { return mql::SymbolString{ std::format("SYM{:05}", symbol) }; };
+
+    Router router;
+    const auto publisher = std::make_shared<BenchmarkSession>();
+    std::vector<std::shared_ptr<BenchmarkSession>> subscribers;
+    for (size_t i = 0; i < config.subscribers; ++i)
+    {
+        const auto &subscriber = subscribers.emplace_back(std::make_shared<BenchmarkSession>());
+        for (uint32_t j = 0; j < config.symbols_per_subscriber; ++j)
+        {
+            auto subscribe = std::make_unique<MarketDataSubscribe>();
+            subscribe->symbol = symbol_name(static_cast<uint32_t>((i * 7 + j) % config.symbols));
+            if (config.bars)
+            {
+                auto subscribe_bars = std::make_unique<BarSubscribe>();
+                subscribe_bars->symbol = subscribe->symbol;
+                subscribe_bars->timeframe = static_cast<uint8_t>(pds::market::Timeframe::M1);
+                subscribe_bars->partial = true;
+                router.on_packet(subscriber, std::move(subscribe_bars));
+            }
+            router.on_packet(subscriber, std::move(subscribe));
+        }
+    }
+    for (uint32_t symbol = 0; symbol < config.symbols; ++symbol)
+    {
+        auto definition = std::make_unique<SymbolDefinition>();
+        definition->symbol = symbol;
+        definition->name = symbol_name(symbol);
+        definition->digits = config.digits;
+        router.on_packet(publisher, std::move(definition));
+    }
+
+    // Publisher side: encode a batch as server_dll does, then hand it to the router as the
+    // dispatcher would, which decodes it and writes one batch per subscriber.
+    TickSource source{ config };
+    pds::market::TickWriter writer;
+    std::vector<uint8_t> buffer;
+    uint64_t ticks = 0;
+    uint64_t batches = 0;
+    uint64_t publisher_bytes = 0;
+    const auto publish_batch = [&]()
+    {
+        writer.begin(buffer, source.time_msc());
+        auto batch = std::make_unique<TickBatch>();
+        batch->base_time_msc = source.time_msc();
+        for (size_t i = 0; i < config.batch_ticks; ++i)
+        {
+            writer.add(source.next());
+        }
+        batch->tick_count = writer.count();
+        batch->ticks = buffer;
+        publisher_bytes += buffer.size();
+        ticks += batch->tick_count;
+        ++batches;
+        router.on_packet(publisher, std::move(batch));
+    };
+
+    publish_batch();
+    ticks = 0;
+    batches = 0;
+    publisher_bytes = 0;
+    for (auto const &subscriber : subscribers)
+    {
+        subscriber->frames = 0;
+        subscriber->ticks = 0;
+        subscriber->bars = 0;
+    }
+    const uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    const auto duration = std::chrono::duration<double>(config.seconds);
+    while (std::chrono::steady_clock::now() - start < duration)
+    {
+        publish_batch();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+
+    uint64_t delivered = 0;
+    uint64_t frames = 0;
+    uint64_t bars = 0;
+    for (auto const &subscriber : subscribers)
+    {
+        if (subscriber->malformed)
+        {
+            std::cerr << "A subscriber received a malformed batch\n";
+            return EXIT_FAILURE;
+        }
+        delivered += subscriber->ticks;
+        frames += subscriber->frames;
+        bars += subscriber->bars;
+    }
+    const double ticks_per_second = static_cast<double>(ticks) / seconds;
+
+    std::cout << std::format("{} symbols, {} subscribers of {} symbols each, {} ticks per batch\n", config.symbols,
+                             config.subscribers, config.symbols_per_subscriber, config.batch_ticks);
+    std::cout << std::format("{:<28} {:>14.0f}\n", "published ticks/s", ticks_per_second);
+    std::cout << std::format("{:<28} {:>14.0f}\n", "delivered ticks/s", static_cast<double>(delivered) / seconds);
+    std::cout << std::format("{:<28} {:>14.2f}\n", "bytes/tick (encoded)",
+                             static_cast<double>(publisher_bytes) / static_cast<double>(ticks));
+    std::cout << std::format("{:<28} {:>14}\n", "bytes/tick (fields)", sizeof(pds::market::Tick));
+    std::cout << std::format("{:<28} {:>14.3f}\n", "allocs/tick",
+                             static_cast<double>(allocations) / static_cast<double>(ticks));
+    std::cout << std::format("{:<28} {:>14.2f}\n", "frames per published batch",
+                             static_cast<double>(frames) / static_cast<double>(batches));
+    std::cout << std::format("{:<28} {:>14.2f}\n", "bar updates per batch",
+                             static_cast<double>(bars) / static_cast<double>(batches));
+    std::cout << std::format("{:<28} {:>14}\n", "dropped ticks", router.stats().ticks_dropped);
+    std::cout << std::format("target {:.0f} ticks/s: {}\n", config.target,
+                             ticks_per_second >= config.target ? "met" : "missed");
+    return 0;
+}
@@ -0,0 +1,319 @@
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/program_options.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <streambuf>
+
+#include "../shared/allocation-counter.hpp"
+#include "../shared/output-buffer.hpp"
+#include "capture/captured-packets.hpp"
+#include "packets/packet-crypto.hpp"
+
+namespace po = boost::program_options;
+
+struct BenchmarkConfig
+{
+    double seconds = 0.2;
+    size_t instances = 64;
+    // Length ranges of generated strings, byte arrays and collections such as disks_load.
+    size_t min_string = 4;
+    size_t max_string = 32;
+    size_t min_bytes = 32;
+    size_t max_bytes = 256;
+    size_t min_elements = 1;
+    size_t max_elements = 16;
+    uint64_t seed = 1;
+    std::string json_path;
+    std::string label;
+};
+
+/**
+ * @brief Loading "archive" that walks a type's serialize() like boost's archives do and fills
+ * every field with random data, so every packet gets realistic instances without a
+ * hand-written generator that would drift from the packet definitions.
+ */
+class RandomFiller
+{
+public:
+    using is_saving = boost::mpl::false_;
+    using is_loading = boost::mpl::true_;
+
+    RandomFiller(std::mt19937_64 &rng, BenchmarkConfig const &config) : rng_{ rng }, config_{ config } {}
+
+    template <typename T>
+    RandomFiller &operator&(T &value)
+    {
+        fill(value);
+        return *this;
+    }
+    template <typename T>
+    RandomFiller &operator>>(T &value)
+    {
+        fill(value);
+        return *this;
+    }
+    template <typename T>
+    RandomFiller &operator&(boost::serialization::nvp<T> const &value)
+    {
+        fill(value.value());
+        return *this;
+    }
+
+private:
+    template <typename T>
+    struct is_vector : std::false_type
+    {
+    };
+    template <typename T, typename Allocator>
+    struct is_vector<std::vector<T, Allocator>> : std::true_type
+    {
+    };
+    template <typename T>
+    struct is_fixed_string : std::false_type
+    {
+    };
+    template <size_t N>
+    struct is_fixed_string<mql::FixedString<N>> : std::true_type
+    {
+    };
+
+    size_t length(size_t min, size_t max) { return std::uniform_int_distribution<size_t>(min, max)(rng_); }
+
+    template <typename T>
+    void fill(T &value)
+    {
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            value = (rng_() & 1) != 0;
+        }
+        else if constexpr (std::is_enum_v<T>)
+        {
+            value = static_cast<T>(rng_() % 4);
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            value = std::uniform_real_distribution<T>(0, 1e6)(rng_);
+        }
+        else if constexpr (std::is_arithmetic_v<T>)
+        {
+            value = static_cast<T>(rng_());
+        }
+        else if constexpr (std::is_same_v<T, std::string>)
+        {
+            value.resize(length(config_.min_string, config_.max_string));
+            for (char &c : value)
+            {
+                c = static_cast<char>('a' + rng_() % 26);
+            }
+        }
+        else if constexpr (is_fixed_string<T>::value)
+        {
+            std::string text;
+            fill(text);
+            value = text;
+        }
+        else if constexpr (std::is_base_of_v<std::vector<std::byte>, T>)
+        {
+            value.resize(length(config_.min_bytes, config_.max_bytes));
+            for (std::byte &b : value)
+            {
+                b = static_cast<std::byte>(rng_());
+            }
+        }
+        else if constexpr (is_vector<T>::value)
+        {
+            value.resize(length(config_.min_elements, config_.max_elements));
+            for (auto &element : value)
+            {
+                fill(element);
+            }
+        }
+        else
+        {
+            boost::serialization::serialize_adl(*this, value, 0);
+        }
+    }
+
+    std::mt19937_64 &rng_;
+    BenchmarkConfig const &config_;
+};
+
+class InputBuffer : public std::streambuf
+{
+public:
+    InputBuffer(std::vector<char> const &data)
+    {
+        char *begin = const_cast<char *>(data.data());
+        setg(begin, begin, begin + data.size());
+    }
+};
+
+constexpr auto kArchiveFlags = boost::archive::no_header;
+
+template <typename PacketType>
+void encode(PacketType const &packet, OutputBuffer &buffer)
+{
+    buffer.clear();
+    boost::archive::binary_oarchive archive{ buffer, kArchiveFlags };
+    archive << packet;
+}
+
+// Decodes into an existing packet. The library's factory also heap-allocates and
+// default-constructs the packet first; that is left out because NodeInformationResponse's
+// constructor samples the host, which would swamp everything else.
+template <typename PacketType>
+void decode(std::vector<char> const &bytes, PacketType &packet)
+{
+    InputBuffer buffer{ bytes };
+    boost::archive::binary_iarchive archive{ buffer, kArchiveFlags };
+    archive >> packet;
+}
+
+struct BenchmarkResult
+{
+    std::string_view name;
+    double bytes = 0;
+    double encode_ns = 0;
+    double decode_ns = 0;
+    double encode_allocations = 0;
+    double decode_allocations = 0;
+};
+
+template <typename Operation>
+void measure(BenchmarkConfig const &config, size_t instances, double &ns_per_op, double &allocations_per_op,
+             Operation &&operation)
+{
+    uint64_t ops = 0;
+    const uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    const auto duration = std::chrono::duration<double>(config.seconds);
+    while (std::chrono::steady_clock::now() - start < duration)
+    {
+        for (size_t i = 0; i < instances; i++)
+        {
+            operation(i);
+        }
+        ops += instances;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ns_per_op = seconds * 1e9 / static_cast<double>(ops);
+    allocations_per_op = static_cast<double>(g_allocations.load(std::memory_order_relaxed) - allocations_before) /
+                         static_cast<double>(ops);
+}
+
+template <typename PacketType>
+BenchmarkResult run(std::string_view name, BenchmarkConfig const &config)
+{
+    std::mt19937_64 rng{ config.seed ^ PacketType::static_unique_id };
+    RandomFiller filler{ rng, config };
+    const PacketType prototype{};
+    std::vector<PacketType> packets(config.instances, prototype);
+    PacketType decoded{ prototype };
+    std::vector<std::vector<char>> encoded(config.instances);
+    OutputBuffer buffer;
+    double total_bytes = 0;
+    for (size_t i = 0; i < config.instances; i++)
+    {
+        filler & packets[i];
+        encode(packets[i], buffer);
+        encoded[i] = buffer.data();
+        total_bytes += static_cast<double>(encoded[i].size());
+
+        // A decoded packet has to encode to the same bytes, or the numbers measure a bug.
+        decode(encoded[i], decoded);
+        encode(decoded, buffer);
+        if (buffer.data() != encoded[i])
+        {
+            std::cerr << name << " does not survive a round trip\n";
+            std::abort();
+        }
+    }
+
+    BenchmarkResult result{ .name = name, .bytes = total_bytes / static_cast<double>(config.instances) };
+    measure(config, config.instances, result.encode_ns, result.encode_allocations,
+            [&](size_t i) { encode(packets[i], buffer); });
+    measure(config, config.instances, result.decode_ns, result.decode_allocations,
+            [&](size_t i) { decode(encoded[i], decoded); });
+    return result;
+}
+
+void write_json(BenchmarkConfig const &config, std::vector<BenchmarkResult> const &results)
+{
+    std::ofstream file(config.json_path);
+    file << std::format("{{\n  \"label\": \"{}\",\n  \"archive\": \"boost binary, no header\",\n  \"results\": [\n",
+                        config.label);
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        auto const &r = results[i];
+        file << std::format("    {{\"packet\": \"{}\", \"bytes\": {:.1f}, \"encode_ns\": {:.1f}, "
+                            "\"decode_ns\": {:.1f}, \"encode_allocs\": {:.2f}, \"decode_allocs\": {:.2f}}}{}\n",
+                            r.name, r.bytes, r.encode_ns, r.decode_ns, r.encode_allocations,
+                            r.decode_allocations, i + 1 == results.size() ? "" : ",");
+    }
+    file << "  ]\n}\n";
+}
+
+#define PACKET_BENCHMARK(PacketType) run<PacketType>(#PacketType, config),
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("seconds", po::value<double>(&config.seconds), "Duration of every measurement")
+        ("instances", po::value<size_t>(&config.instances), "Random instances generated per packet type")
+        ("max-string", po::value<size_t>(&config.max_string), "Longest generated string")
+        ("max-bytes", po::value<size_t>(&config.max_bytes), "Longest generated byte array")
+        ("max-elements", po::value<size_t>(&config.max_elements), "Largest generated collection, e.g. disks")
+        ("seed", po::value<uint64_t>(&config.seed), "Seed of the instance generator")
+        ("json", po::value<std::string>(&config.json_path), "Also write the results to this JSON file")
+        ("label", po::value<std::string>(&config.label), "Label stored in the JSON, e.g. the commit")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+    config.instances = std::max<size_t>(config.instances, 1);
+    config.min_string = std::min(config.min_string, config.max_string);
+    config.min_bytes = std::min(config.min_bytes, config.max_bytes);
+    config.min_elements = std::min(config.min_elements, config.max_elements);
+
+    // The transport's own packets, which captures leave out, then every packet a capture
+    // records, so a packet added to PDS_CAPTURED_PACKETS is benchmarked without touching this.
+    const std::vector<BenchmarkResult> results{
+        PACKET_BENCHMARK(DHKeyExchangeRequestPacket)
+        PACKET_BENCHMARK(DHKeyExchangeResponsePacket)
+        PACKET_BENCHMARK(PingPacket)
+        PACKET_BENCHMARK(PongPacket)
+        PACKET_BENCHMARK(FragmentPacket)
+        PACKET_BENCHMARK(PacketBatch)
+        PDS_CAPTURED_PACKETS(PACKET_BENCHMARK)
+    };
+
+    std::cout << std::format("{:<34} {:>9} {:>11} {:>11} {:>12} {:>12}\n", "packet", "bytes", "encode ns",
+                             "decode ns", "enc allocs", "dec allocs");
+    for (auto const &r : results)
+    {
+        std::cout << std::format("{:<34} {:>9.1f} {:>11.1f} {:>11.1f} {:>12.2f} {:>12.2f}\n", r.name, r.bytes,
+                                 r.encode_ns, r.decode_ns, r.encode_allocations, r.decode_allocations);
+    }
+    if (!config.json_path.empty())
+    {
+        write_json(config, results);
+    }
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "metrics/latency-histogram.hpp"
+#include "network/outbound-queue.hpp"
+
+using namespace mal_packet_weaver;
+namespace po = boost::program_options;
+namespace asio = boost::asio;
+using pds::network::OutboundFrame;
+using pds::network::OutboundQueue;
+
+// Frame layout: [u32 body size][u8 kind][u64 enqueue time, ns][padding]
+constexpr size_t kHeaderSize = 4;
+constexpr size_t kBodyHeaderSize = 1 + 8;
+
+enum FrameKind : uint8_t
+{
+    kUrgent = 0,
+    kBulk = 1,
+    kEnd = 2
+};
+
+constexpr UniquePacketID kUrgentType = 1;
+constexpr UniquePacketID kBulkType = 2;
+
+struct BenchmarkConfig
+{
+    double seconds = 3.0;
+    std::chrono::microseconds urgent_interval{ 200 };
+    size_t urgent_size = 64;
+    size_t bulk_payload = 1024 * 1024;
+    size_t bulk_backlog = 8 * 1024 * 1024;
+    size_t chunk_size = 16 * 1024;
+    // Data already handed to the kernel cannot be reordered, so a large socket buffer hides
+    // the lanes behind it. Both modes run with the same buffers.
+    int socket_buffer = 128 * 1024;
+};
+
+uint64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+ByteArray make_frame(FrameKind kind, size_t size)
+{
+    ByteArray frame;
+    frame.resize(std::max(size, kHeaderSize + kBodyHeaderSize));
+    const uint32_t body_size = static_cast<uint32_t>(frame.size() - kHeaderSize);
+    const uint64_t timestamp = now_ns();
+    std::memcpy(frame.data(), &body_size, sizeof(body_size));
+    frame[kHeaderSize] = static_cast<std::byte>(kind);
+    std::memcpy(frame.data() + kHeaderSize + 1, &timestamp, sizeof(timestamp));
+    return frame;
+}
+
+// Reads frames until the end marker and records the latency of urgent ones.
+pds::metrics::LatencyHistogram receive(asio::ip::tcp::socket &socket, uint64_t &bulk_bytes)
+{
+    pds::metrics::LatencyHistogram latency;
+    std::vector<std::byte> body;
+    while (true)
+    {
+        uint32_t body_size = 0;
+        asio::read(socket, asio::buffer(&body_size, sizeof(body_size)));
+        body.resize(body_size);
+        asio::read(socket, asio::buffer(body));
+
+        uint64_t timestamp = 0;
+        std::memcpy(&timestamp, body.data() + 1, sizeof(timestamp));
+        switch (static_cast<FrameKind>(body[0]))
+        {
+            case kUrgent:
+                latency.record(now_ns() - timestamp);
+                break;
+            case kBulk:
+                bulk_bytes += body_size + kHeaderSize;
+                break;
+            case kEnd:
+                return latency;
+        }
+    }
+}
+
+void run(std::string_view name, BenchmarkConfig const &config, bool lanes)
+{
+    asio::io_context io;
+    asio::ip::tcp::acceptor acceptor(io,
+                                     asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    asio::ip::tcp::socket sender(io);
+    sender.connect(acceptor.local_endpoint());
+    sender.set_option(asio::ip::tcp::no_delay(true));
+    sender.set_option(asio::socket_base::send_buffer_size(config.socket_buffer));
+    asio::ip::tcp::socket receiver = acceptor.accept();
+    receiver.set_option(asio::socket_base::receive_buffer_size(config.socket_buffer));
+
+    pds::network::OutboundQueueConfig queue_config;
+    queue_config.limits.max_bytes = 4 * config.bulk_backlog;
+    if (lanes)
+    {
+        auto priorities = std::make_shared<pds::network::PriorityMap>();
+        priorities->set(kUrgentType, pds::network::Priority::High)
+            .set(kBulkType, pds::network::Priority::Bulk);
+        queue_config.priorities = std::move(priorities);
+    }
+    else
+    {
+        // A single FIFO with unbounded writes, which is what sessions do without lanes.
+        queue_config.max_bytes_per_write = std::numeric_limits<size_t>::max();
+    }
+    OutboundQueue<asio::ip::tcp::socket> queue{ sender, queue_config };
+
+    pds::metrics::LatencyHistogram latency;
+    uint64_t bulk_bytes = 0;
+    std::thread sink(
+        [&]()
+        {
+            latency = receive(receiver, bulk_bytes);
+            asio::post(io, [&io]() { io.stop(); });
+        });
+
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                              std::chrono::duration<double>(config.seconds));
+    asio::steady_timer timer(io);
+    std::function<void(boost::system::error_code)> tick = [&](boost::system::error_code ec)
+    {
+        if (ec)
+        {
+            return;
+        }
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            queue.enqueue(OutboundFrame{ .type = kUrgentType, .bytes = make_frame(kEnd, 0) });
+            return;
+        }
+        queue.enqueue(
+            OutboundFrame{ .type = kUrgentType, .bytes = make_frame(kUrgent, config.urgent_size) });
+
+        // Keep the bulk backlog topped up so urgent frames always compete with it.
+        while (queue.pending_bytes() < config.bulk_backlog)
+        {
+            const size_t frame_size = lanes ? config.chunk_size : config.bulk_payload;
+            for (size_t sent = 0; sent < config.bulk_payload; sent += frame_size)
+            {
+                queue.enqueue(OutboundFrame{ .type = kBulkType,
+                                             .bytes = make_frame(kBulk, frame_size) });
+            }
+        }
+        timer.expires_at(timer.expiry() + config.urgent_interval);
+        timer.async_wait(tick);
+    };
+    timer.expires_after(config.urgent_interval);
+    timer.async_wait(tick);
+
+    io.run();
+    sink.join();
+
+    std::cout << std::format("{:<8} {:>9} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n",
+                             name, latency.count(), latency.percentile(50) / 1e3,
+                             latency.percentile(99) / 1e3, latency.percentile(99.9) / 1e3,
+                             latency.max() / 1e3,
+                             bulk_bytes / config.seconds / (1024.0 * 1024.0));
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+    uint64_t urgent_interval_us = config.urgent_interval.count();
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("seconds", po::value<double>(&config.seconds), "Duration of every run")
+        ("urgent-interval-us", po::value<uint64_t>(&urgent_interval_us), "Interval between high-priority frames")
+        ("bulk-payload", po::value<size_t>(&config.bulk_payload), "Size of one bulk payload in bytes")
+        ("bulk-backlog", po::value<size_t>(&config.bulk_backlog), "Bulk bytes kept pending in the session")
+        ("chunk-size", po::value<size_t>(&config.chunk_size), "Fragment size of bulk payloads with lanes")
+        ("socket-buffer", po::value<int>(&config.socket_buffer), "SO_SNDBUF/SO_RCVBUF of the connection")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+    config.urgent_interval = std::chrono::microseconds{ urgent_interval_us };
+
+    std::cout << std::format("high-priority latency under {} KiB bulk payloads, {} KiB backlog\n",
+                             config.bulk_payload / 1024, config.bulk_backlog / 1024);
+    std::cout << std::format("{:<8} {:>9} {:>10} {:>10} {:>10} {:>10} {:>10}\n", "mode", "samples",
+                             "p50 us", "p99 us", "p99.9 us", "max us", "bulk MiB/s");
+    run("fifo", config, false);
+    run("lanes", config, true);
+    return 0;
+}
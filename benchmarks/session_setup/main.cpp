@@ -0,0 +1,276 @@
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <latch>
+#include <random>
+#include <thread>
+
+#include "crypto/curve25519.hpp"
+#include "crypto/handshake.hpp"
+#include "metrics/latency-histogram.hpp"
+#include "tcp-server.hpp"
+
+namespace po = boost::program_options;
+using Clock = std::chrono::steady_clock;
+
+struct BenchmarkConfig
+{
+    std::string curve = "ed25519";
+    std::vector<size_t> concurrency{ 1, 4, 16, 64 };
+    double seconds = 3.0;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+enum Phase : size_t
+{
+    Connect,
+    ClientKeyGeneration,
+    ServerKeyGeneration,
+    ServerKeyAgreement,
+    Signature,
+    ServerKeyDerivation,
+    Verification,
+    ClientKeyAgreement,
+    ClientKeyDerivation,
+    Handshake,
+    FirstRoundTrip,
+    PhaseCount
+};
+
+constexpr std::array<std::string_view, PhaseCount> kPhaseNames{
+    "tcp connect",       "client keygen",    "server keygen",       "server agreement",
+    "server signature",  "server derivation", "client verification", "client agreement",
+    "client derivation", "handshake total",   "first round trip",
+};
+
+// Histograms of one concurrency level; clients and the server's handshake handler record into
+// it from every io thread, at most a few thousand times a second, so one mutex is enough.
+class PhaseStats
+{
+public:
+    void record_server(pds::crypto::HandshakeTimings const &timings)
+    {
+        std::lock_guard lock{ mutex_ };
+        add(ServerKeyGeneration, timings.key_generation);
+        add(ServerKeyAgreement, timings.key_agreement);
+        add(Signature, timings.signature);
+        add(ServerKeyDerivation, timings.key_derivation);
+    }
+
+    void record_client(pds::crypto::HandshakeTimings const &timings, Clock::duration connect,
+                       Clock::duration handshake, Clock::duration round_trip)
+    {
+        std::lock_guard lock{ mutex_ };
+        add(Connect, connect);
+        add(ClientKeyGeneration, timings.key_generation);
+        add(Verification, timings.verification);
+        add(ClientKeyAgreement, timings.key_agreement);
+        add(ClientKeyDerivation, timings.key_derivation);
+        add(Handshake, handshake);
+        add(FirstRoundTrip, round_trip);
+        completed_++;
+    }
+
+    void record_failure()
+    {
+        std::lock_guard lock{ mutex_ };
+        failed_++;
+    }
+
+    void reset()
+    {
+        std::lock_guard lock{ mutex_ };
+        for (auto &histogram : histograms_)
+        {
+            histogram.reset();
+        }
+        completed_ = 0;
+        failed_ = 0;
+    }
+
+    // Only read once the level's clients are done.
+    [[nodiscard]] pds::metrics::LatencyHistogram const &histogram(Phase phase) const { return histograms_[phase]; }
+    [[nodiscard]] uint64_t completed() const noexcept { return completed_; }
+    [[nodiscard]] uint64_t failed() const noexcept { return failed_; }
+
+private:
+    void add(Phase phase, Clock::duration duration)
+    {
+        histograms_[phase].record(
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+    }
+
+    std::mutex mutex_;
+    std::array<pds::metrics::LatencyHistogram, PhaseCount> histograms_;
+    uint64_t completed_ = 0;
+    uint64_t failed_ = 0;
+};
+
+// A server that rejects the handshake never answers; the client counts that as a failure
+// rather than waiting for the response forever.
+constexpr float kResponseTimeout = 5.0f;
+
+// One client: connects, runs setup_encryption_for_session's steps with timings, sends one
+// encrypted echo and disconnects, until the deadline.
+boost::asio::awaitable<void> run_client(boost::asio::io_context &io_context, boost::asio::ip::tcp::endpoint endpoint,
+                                        pds::crypto::ServerTrust const &trust, Clock::time_point deadline,
+                                        PhaseStats &stats)
+{
+    while (Clock::now() < deadline)
+    {
+        try
+        {
+            const auto start = Clock::now();
+            boost::asio::ip::tcp::socket socket(io_context);
+            co_await socket.async_connect(endpoint, boost::asio::use_awaitable);
+            const auto connected = Clock::now();
+
+            auto session = std::make_shared<DispatcherSession>(io_context, std::move(socket));
+            pds::crypto::HandshakeTimings timings;
+            const pds::crypto::ClientHandshake handshake{ trust, 0, &timings };
+            session->send_packet(handshake.request());
+            auto response = co_await session->await_packet<DHKeyExchangeResponsePacket>(kResponseTimeout);
+            auto encryption = response ? handshake.finish(*response) : nullptr;
+            if (!encryption)
+            {
+                session->Destroy();
+                stats.record_failure();
+                continue;
+            }
+            session->setup_encryption(encryption);
+            const auto established = Clock::now();
+
+            EchoPacket echo;
+            echo.echo_message = "0";
+            session->send_packet(echo);
+            // The server answers through its outbound queue, in a batch of its own.
+            const auto echoed_batch = co_await session->await_packet<PacketBatch>(kResponseTimeout);
+            const auto echoed = Clock::now();
+            session->Destroy();
+            if (!echoed_batch || std::ranges::find(echoed_batch->types, EchoPacket::static_unique_id) ==
+                                     echoed_batch->types.end())
+            {
+                stats.record_failure();
+                continue;
+            }
+
+            stats.record_client(timings, connected - start, established - start, echoed - established);
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::warn("Handshake failed: {}", e.what());
+            stats.record_failure();
+        }
+    }
+}
+
+void print_level(size_t concurrency, double seconds, PhaseStats const &stats)
+{
+    std::cout << std::format("\n{} clients: {:.0f} handshakes/s, {} failed\n", concurrency,
+                             static_cast<double>(stats.completed()) / seconds, stats.failed());
+    std::cout << std::format("{:<20} {:>9} {:>10} {:>10} {:>10} {:>10}\n", "phase", "count", "p50 us", "p90 us",
+                             "p99 us", "max us");
+    for (size_t i = 0; i < PhaseCount; i++)
+    {
+        auto const &histogram = stats.histogram(static_cast<Phase>(i));
+        const auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1e3; };
+        std::cout << std::format("{:<20} {:>9} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n", kPhaseNames[i],
+                                 histogram.count(), us(histogram.percentile(50)), us(histogram.percentile(90)),
+                                 us(histogram.percentile(99)), us(histogram.max()));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("curve", po::value<std::string>(&config.curve), "Server key type, as keygen --curve takes it")
+        ("concurrency", po::value<std::vector<size_t>>(&config.concurrency)->multitoken(), "Numbers of concurrent clients to measure")
+        ("seconds", po::value<double>(&config.seconds), "Duration of every concurrency level")
+        ("threads", po::value<size_t>(&config.threads), "Threads running the shared io_context")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+    config.threads = std::max<size_t>(config.threads, 1);
+
+    // Every connection logs on the server; only problems are of interest here.
+    spdlog::set_level(spdlog::level::warn);
+
+    const KeyPair pair = config.curve == "ed25519" ? pds::crypto::generate_ed25519_key_pair()
+                                                   : ECDSA::KeyPairGenerator(config.curve).generate();
+    // Unique, so concurrent runs don't load each other's keys.
+    std::random_device random;
+    const auto keyring_path =
+        std::filesystem::temp_directory_path() /
+        std::format("session-setup-benchmark-{:016x}.pem", std::uniform_int_distribution<uint64_t>{}(random));
+    {
+        std::ofstream file(keyring_path, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(pair.private_key.data()),
+                   static_cast<std::streamsize>(pair.private_key.size()));
+    }
+    const pds::crypto::ServerTrust trust{ pair.public_key };
+
+    boost::asio::io_context io_context;
+    auto work = boost::asio::make_work_guard(io_context);
+    PhaseStats stats;
+    TcpServer server(io_context, { pds::network::parse_endpoint("tcp://127.0.0.1:0") },
+                     std::make_unique<ServerKeyring>(keyring_path), 1);
+    server.observe_handshakes([&stats](pds::crypto::HandshakeTimings const &timings)
+                              { stats.record_server(timings); });
+    const boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::make_address("127.0.0.1"),
+                                                  server.endpoints().front().port);
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < config.threads; i++)
+    {
+        threads.emplace_back([&io_context]() { io_context.run(); });
+    }
+
+    std::vector<std::pair<size_t, double>> rates;
+    for (const size_t concurrency : config.concurrency)
+    {
+        stats.reset();
+        const auto start = Clock::now();
+        const auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                          std::chrono::duration<double>(config.seconds));
+        std::latch done{ static_cast<ptrdiff_t>(concurrency) };
+        for (size_t i = 0; i < concurrency; i++)
+        {
+            co_spawn(io_context, run_client(io_context, endpoint, trust, deadline, stats),
+                     [&done](std::exception_ptr) { done.count_down(); });
+        }
+        done.wait();
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        print_level(concurrency, seconds, stats);
+        rates.emplace_back(concurrency, static_cast<double>(stats.completed()) / seconds);
+    }
+
+    std::cout << std::format("\n{:<12} {:>14}\n", "clients", "handshakes/s");
+    for (auto const &[concurrency, rate] : rates)
+    {
+        std::cout << std::format("{:<12} {:>14.0f}\n", concurrency, rate);
+    }
+
+    work.reset();
+    io_context.stop();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    std::filesystem::remove(keyring_path);
+    return 0;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new and delete so a benchmark can count its heap allocations.
+// Replacements can't be inline: include this in the one translation unit of a benchmark only.
+
+/** @brief Heap allocations made through operator new since the start of the program. */
+std::atomic<uint64_t> g_allocations = 0;
+
+void *operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,33 @@
+#pragma once
+#include <streambuf>
+#include <vector>
+
+/**
+ * @brief Append-only streambuf that collects what an archive writes and keeps its capacity
+ * between packets, so the measured allocations are the archive's and not the buffer growing.
+ */
+class OutputBuffer : public std::streambuf
+{
+public:
+    void clear() noexcept { data_.clear(); }
+    [[nodiscard]] std::vector<char> const &data() const noexcept { return data_; }
+    [[nodiscard]] size_t size() const noexcept { return data_.size(); }
+
+protected:
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        data_.insert(data_.end(), s, s + n);
+        return n;
+    }
+    int_type overflow(int_type c) override
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            data_.push_back(traits_type::to_char_type(c));
+        }
+        return c;
+    }
+
+private:
+    std::vector<char> data_;
+};
@@ -0,0 +1,142 @@
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "ipc/shm-channel.hpp"
+#include "metrics/latency-histogram.hpp"
+
+namespace po = boost::program_options;
+namespace asio = boost::asio;
+
+struct BenchmarkConfig
+{
+    uint64_t ticks = 100'000;
+    size_t tick_size = 64;
+    std::chrono::microseconds interval{ 100 };
+};
+
+uint64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Emits timestamped ticks at a steady rate. The sender sleeps between ticks, like a terminal
+// waiting for the market, so it does not steal the CPU from a spinning receiver.
+template <typename Send>
+void produce(BenchmarkConfig const &config, Send &&send)
+{
+    std::vector<std::byte> tick(std::max(config.tick_size, sizeof(uint64_t)));
+    auto next = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < config.ticks; ++i)
+    {
+        std::this_thread::sleep_until(next);
+        next += config.interval;
+        const uint64_t timestamp = now_ns();
+        std::memcpy(tick.data(), &timestamp, sizeof(timestamp));
+        send(std::span<const std::byte>{ tick });
+    }
+}
+
+void record(pds::metrics::LatencyHistogram &latency, std::span<const std::byte> tick)
+{
+    uint64_t timestamp;
+    std::memcpy(&timestamp, tick.data(), sizeof(timestamp));
+    latency.record(now_ns() - timestamp);
+}
+
+pds::metrics::LatencyHistogram run_tcp(BenchmarkConfig const &config)
+{
+    asio::io_context io;
+    asio::ip::tcp::acceptor acceptor(io,
+                                     asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    asio::ip::tcp::socket sender(io);
+    sender.connect(acceptor.local_endpoint());
+    sender.set_option(asio::ip::tcp::no_delay(true));
+    asio::ip::tcp::socket receiver = acceptor.accept();
+
+    pds::metrics::LatencyHistogram latency;
+    std::thread consumer(
+        [&]()
+        {
+            std::vector<std::byte> tick(std::max(config.tick_size, sizeof(uint64_t)));
+            for (uint64_t i = 0; i < config.ticks; ++i)
+            {
+                asio::read(receiver, asio::buffer(tick));
+                record(latency, tick);
+            }
+        });
+    produce(config, [&](std::span<const std::byte> tick)
+            { asio::write(sender, asio::buffer(tick.data(), tick.size())); });
+    consumer.join();
+    return latency;
+}
+
+pds::metrics::LatencyHistogram run_shm(BenchmarkConfig const &config,
+                                       pds::ipc::WaitPolicy wait_policy)
+{
+    const std::string name = "pds-shm-benchmark-" + std::to_string(now_ns());
+    auto relay = pds::ipc::ShmChannel::create(name, pds::ipc::ShmChannel::kDefaultRingCapacity,
+                                              wait_policy);
+    auto terminal = pds::ipc::ShmChannel::open(name, wait_policy);
+
+    pds::metrics::LatencyHistogram latency;
+    std::thread consumer(
+        [&]()
+        {
+            while (latency.count() < config.ticks)
+            {
+                terminal.receive([&](std::span<const std::byte> tick) { record(latency, tick); },
+                                 std::chrono::seconds{ 1 });
+            }
+        });
+    produce(config, [&](std::span<const std::byte> tick) { relay.send(tick); });
+    consumer.join();
+    return latency;
+}
+
+void print(std::string_view name, pds::metrics::LatencyHistogram const &latency)
+{
+    std::cout << std::format("{:<14} {:>10.2f} {:>10.2f} {:>10.2f} {:>10.2f}\n", name,
+                             latency.percentile(50) / 1e3, latency.percentile(99) / 1e3,
+                             latency.percentile(99.9) / 1e3, latency.max() / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+    uint64_t interval_us = config.interval.count();
+    pds::ipc::WaitPolicy adaptive;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("ticks", po::value<uint64_t>(&config.ticks), "Amount of ticks per run")
+        ("tick-size", po::value<size_t>(&config.tick_size), "Size of one tick frame in bytes")
+        ("interval-us", po::value<uint64_t>(&interval_us), "Time between two ticks")
+        ("spin", po::value<uint32_t>(&adaptive.spin_iterations), "Ring polls before the adaptive receiver sleeps")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+    config.interval = std::chrono::microseconds{ interval_us };
+
+    std::cout << std::format("tick-to-delivery latency, {} ticks of {} bytes every {} us\n",
+                             config.ticks, config.tick_size, interval_us);
+    std::cout << std::format("{:<14} {:>10} {:>10} {:>10} {:>10}\n", "transport", "p50 us",
+                             "p99 us", "p99.9 us", "max us");
+    print("tcp loopback", run_tcp(config));
+    print("shm adaptive", run_shm(config, adaptive));
+    print("shm sleep", run_shm(config, pds::ipc::WaitPolicy{ .spin_iterations = 0 }));
+    print("shm spin", run_shm(config, pds::ipc::WaitPolicy{ .spin_iterations = UINT32_MAX }));
+    return 0;
+}
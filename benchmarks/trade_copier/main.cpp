@@ -0,0 +1,214 @@
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/program_options.hpp>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../shared/allocation-counter.hpp"
+#include "../shared/output-buffer.hpp"
+#include "metrics/latency-histogram.hpp"
+#include "packets/account-trade-info.hpp"
+#include "trade-copier.hpp"
+
+namespace po = boost::program_options;
+
+struct BenchmarkConfig
+{
+    double seconds = 1.0;
+    size_t followers = 100;
+    // Every how many followers one only copies the master's deals with magic 7.
+    size_t magic_filter_every = 4;
+    // Every how many followers one trades the master's symbols under a broker suffix.
+    size_t mapping_every = 3;
+    // Master deals per second; 0 sends them back to back.
+    double deal_rate = 0;
+};
+
+// Stands in for DispatcherSession: serializes what it is sent, as the real one does before
+// queuing it, and checks the command was mapped for its follower.
+class BenchmarkSession
+{
+public:
+    explicit BenchmarkSession(int64_t login) : login_{ login } {}
+
+    void send_packet(CopyTradeCommand const &command)
+    {
+        buffer_.clear();
+        {
+            boost::archive::binary_oarchive archive{ buffer_, boost::archive::no_header };
+            archive << command;
+        }
+        frame_bytes += buffer_.size();
+        ++commands;
+        wrong |= command.follower_login != login_ || command.owner_login() != login_ || command.volume <= 0;
+    }
+
+    [[nodiscard]] bool is_closed() const noexcept { return false; }
+
+    uint64_t commands = 0;
+    uint64_t frame_bytes = 0;
+    bool wrong = false;
+
+private:
+    const int64_t login_;
+    OutputBuffer buffer_;
+};
+
+using Copier = TradeCopier<BenchmarkSession>;
+
+constexpr int64_t kMasterLogin = 1'000;
+
+// Master deals on a few symbols, a quarter of them with magic 7 and half of them closing.
+class DealSource
+{
+public:
+    MQL5DealInfoResponse const &next()
+    {
+        mql::mql5::DealInfo &info = deal_;
+        ++info.ticket;
+        info.position_id = info.ticket / 2;
+        info.time_msc += 250;
+        info.type = random_() % 2 == 0 ? mql::mql5::EnumDealType::DealTypeBuy : mql::mql5::EnumDealType::DealTypeSell;
+        info.entry =
+            info.ticket % 2 == 0 ? mql::mql5::EnumDealEntry::DealEntryIn : mql::mql5::EnumDealEntry::DealEntryOut;
+        info.magic = random_() % 4 == 0 ? 7 : 3;
+        info.volume = static_cast<double>(random_() % 100 + 1) / 100;
+        info.price = 1.085 + static_cast<double>(random_() % 100) / 1e5;
+        info.symbol = symbols_[random_() % symbols_.size()];
+        deal_.set_owner_login(kMasterLogin);
+        deal_.stamp_send_time();
+        return deal_;
+    }
+
+private:
+    std::mt19937 random_{ 42 };
+    std::vector<mql::SymbolString> symbols_{ mql::SymbolString{ "EURUSD" }, mql::SymbolString{ "GBPUSD" },
+                                             mql::SymbolString{ "XAUUSD" }, mql::SymbolString{ "US500" } };
+    MQL5DealInfoResponse deal_;
+};
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("seconds", po::value<double>(&config.seconds), "Duration of the measurement")
+        ("followers", po::value<size_t>(&config.followers), "Follower accounts copying the master")
+        ("magic-filter-every", po::value<size_t>(&config.magic_filter_every),
+         "Every how many followers one filters by magic; 0 for none")
+        ("mapping-every", po::value<size_t>(&config.mapping_every),
+         "Every how many followers one maps symbols; 0 for none")
+        ("deal-rate", po::value<double>(&config.deal_rate), "Master deals per second, 0 for back to back")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+    config.followers = std::max<size_t>(config.followers, 1);
+
+    Copier copier;
+    std::vector<std::shared_ptr<BenchmarkSession>> followers;
+    for (size_t i = 0; i < config.followers; ++i)
+    {
+        const int64_t login = kMasterLogin + 1 + static_cast<int64_t>(i);
+        const auto &session = followers.emplace_back(std::make_shared<BenchmarkSession>(login));
+        auto follow = std::make_unique<CopierFollow>();
+        follow->master_login = kMasterLogin;
+        follow->follower_login = login;
+        follow->rules.lot_multiplier = 0.5 + static_cast<double>(i % 4) * 0.5;
+        if (config.magic_filter_every != 0 && i % config.magic_filter_every == 0)
+        {
+            follow->rules.magics = { 7 };
+        }
+        if (config.mapping_every != 0 && i % config.mapping_every == 0)
+        {
+            follow->rules.symbols = { { mql::SymbolString{ "EURUSD" }, mql::SymbolString{ "EURUSD.m" } },
+                                      { mql::SymbolString{ "XAUUSD" }, mql::SymbolString{ "GOLD" } } };
+        }
+        copier.on_packet(session, std::move(follow));
+    }
+
+    DealSource source;
+    // The first deal, sent before the measurement, lets the buffers grow.
+    copier.on_deal(source.next());
+    static_cast<void>(copier.take_latencies());
+    const TradeCopierStats before = copier.stats();
+
+    // The whole fan-out of a deal, i.e. the latency of its last follower.
+    pds::metrics::LatencyHistogram fan_out;
+    const auto interval = config.deal_rate > 0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                     std::chrono::duration<double>(1.0 / config.deal_rate))
+                                               : std::chrono::steady_clock::duration::zero();
+    const uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    const auto duration = std::chrono::duration<double>(config.seconds);
+    auto next_deal = start;
+    uint64_t deals = 0;
+    while (std::chrono::steady_clock::now() - start < duration)
+    {
+        while (std::chrono::steady_clock::now() < next_deal)
+        {
+        }
+        next_deal += interval;
+        MQL5DealInfoResponse const &deal = source.next();
+        const auto deal_start = std::chrono::steady_clock::now();
+        copier.on_deal(deal);
+        fan_out.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - deal_start)
+                .count()));
+        ++deals;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+
+    const TradeCopierStats stats = copier.stats();
+    TradeCopierLatencies latencies = copier.take_latencies();
+    uint64_t frame_bytes = 0;
+    uint64_t delivered = 0;
+    for (auto const &follower : followers)
+    {
+        if (follower->wrong)
+        {
+            std::cerr << "A follower received a command that wasn't mapped for it\n";
+            return EXIT_FAILURE;
+        }
+        frame_bytes += follower->frame_bytes;
+        delivered += follower->commands;
+    }
+    const uint64_t commands = stats.commands_sent - before.commands_sent;
+
+    std::cout << std::format("1 master, {} followers, {} deals in {:.1f} s\n", config.followers, deals, seconds);
+    std::cout << std::format("{:<28} {:>14.0f}\n", "deals/s", static_cast<double>(deals) / seconds);
+    std::cout << std::format("{:<28} {:>14.0f}\n", "commands/s", static_cast<double>(commands) / seconds);
+    std::cout << std::format("{:<28} {:>14.2f}\n", "commands per deal",
+                             static_cast<double>(commands) / static_cast<double>(deals));
+    std::cout << std::format("{:<28} {:>14}\n", "filtered copies", stats.filtered - before.filtered);
+    std::cout << std::format("{:<28} {:>14.1f}\n", "bytes/command (serialized)",
+                             static_cast<double>(frame_bytes) / static_cast<double>(delivered));
+    std::cout << std::format("{:<28} {:>14.3f}\n", "allocs/command",
+                             static_cast<double>(allocations) / static_cast<double>(commands));
+
+    const auto us = [](pds::metrics::LatencyHistogram const &histogram, double percentile)
+    { return static_cast<double>(histogram.percentile(percentile)) / 1e3; };
+    std::cout << std::format("{:<20} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}\n", "", "count", "p50 us", "p90 us",
+                             "p99 us", "p99.9 us", "max us");
+    for (auto const &[name, histogram] :
+         { std::pair{ "deal to send", &latencies.from_receipt }, std::pair{ "deal fan-out", &fan_out } })
+    {
+        std::cout << std::format("{:<20} {:>10} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n", name,
+                                 histogram->count(), us(*histogram, 50), us(*histogram, 90), us(*histogram, 99),
+                                 us(*histogram, 99.9), static_cast<double>(histogram->max()) / 1e3);
+    }
+    return 0;
+}
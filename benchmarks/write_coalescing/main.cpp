@@ -0,0 +1,189 @@
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <thread>
+
+#include "network/outbound-queue.hpp"
+
+using namespace mal_packet_weaver;
+namespace po = boost::program_options;
+namespace asio = boost::asio;
+
+// Forwards to the wrapped socket and counts async_write_some calls. Every call is one
+// send/sendmsg (writev) attempt by the reactor, so this approximates syscalls spent on writes.
+class CountingStream
+{
+public:
+    using executor_type = asio::ip::tcp::socket::executor_type;
+
+    explicit CountingStream(asio::ip::tcp::socket &socket) : socket_{ socket } {}
+
+    executor_type get_executor() { return socket_.get_executor(); }
+
+    template <typename ConstBufferSequence, typename WriteToken>
+    auto async_write_some(ConstBufferSequence const &buffers, WriteToken &&token)
+    {
+        ++write_calls;
+        return socket_.async_write_some(buffers, std::forward<WriteToken>(token));
+    }
+
+    uint64_t write_calls = 0;
+
+private:
+    asio::ip::tcp::socket &socket_;
+};
+
+// Mirrors what a session does without coalescing: every frame becomes its own async_write.
+class PerFrameWriter
+{
+public:
+    explicit PerFrameWriter(CountingStream &stream) : stream_{ stream } {}
+
+    void enqueue(pds::network::OutboundFrame &&frame)
+    {
+        pending_.emplace_back(std::move(frame.bytes));
+        if (pending_.size() == 1)
+        {
+            write_front();
+        }
+    }
+
+    uint64_t frames_written = 0;
+
+private:
+    void write_front()
+    {
+        asio::async_write(stream_, asio::buffer(pending_.front()),
+                          [this](boost::system::error_code ec, size_t)
+                          {
+                              if (ec)
+                              {
+                                  return;
+                              }
+                              ++frames_written;
+                              pending_.pop_front();
+                              if (!pending_.empty())
+                              {
+                                  write_front();
+                              }
+                          });
+    }
+
+    CountingStream &stream_;
+    std::deque<ByteArray> pending_;
+};
+
+struct BenchmarkConfig
+{
+    uint64_t frames = 1'000'000;
+    size_t frame_size = 64;
+    size_t burst = 32;
+    uint64_t max_outstanding = 16'384;
+};
+
+struct BenchmarkResult
+{
+    uint64_t write_calls;
+    double seconds;
+};
+
+template <typename Writer, typename FramesWritten>
+BenchmarkResult run(BenchmarkConfig const &config, FramesWritten frames_written)
+{
+    asio::io_context io;
+    asio::ip::tcp::acceptor acceptor(io, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    asio::ip::tcp::socket sender(io);
+    sender.connect(acceptor.local_endpoint());
+    sender.set_option(asio::ip::tcp::no_delay(true));
+    asio::ip::tcp::socket receiver = acceptor.accept();
+
+    const uint64_t total_bytes = config.frames * config.frame_size;
+    std::thread sink(
+        [&receiver, total_bytes]()
+        {
+            std::vector<char> buffer(1 << 20);
+            uint64_t received = 0;
+            boost::system::error_code ec;
+            while (received < total_bytes && !ec)
+            {
+                received += receiver.read_some(asio::buffer(buffer), ec);
+            }
+        });
+
+    CountingStream stream{ sender };
+    Writer writer{ stream };
+
+    ByteArray prototype;
+    prototype.resize(config.frame_size);
+    uint64_t produced = 0;
+
+    std::function<void()> produce = [&]()
+    {
+        // Keep a bounded amount of data in user space so both writers are compared on the
+        // same socket-buffer pressure rather than on who can allocate faster.
+        if (produced - frames_written(writer) < config.max_outstanding)
+        {
+            for (size_t i = 0; i < config.burst && produced < config.frames; ++i, ++produced)
+            {
+                writer.enqueue(pds::network::OutboundFrame{ .bytes = prototype });
+            }
+        }
+        if (produced < config.frames)
+        {
+            asio::post(io, produce);
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    asio::post(io, produce);
+    io.run();
+    sink.join();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return { stream.write_calls, std::chrono::duration<double>(elapsed).count() };
+}
+
+void print(std::string_view name, BenchmarkConfig const &config, BenchmarkResult const &result)
+{
+    const double frames = static_cast<double>(config.frames);
+    std::cout << std::format("{:<12} {:>12} {:>14.4f} {:>14.3f} {:>10.1f}\n", name,
+                             result.write_calls, result.write_calls / frames,
+                             frames / result.seconds / 1e6,
+                             frames * config.frame_size / result.seconds / (1 << 20));
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkConfig config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("frames", po::value<uint64_t>(&config.frames), "Amount of frames to send per run")
+        ("frame-size", po::value<size_t>(&config.frame_size), "Size of every frame in bytes")
+        ("burst", po::value<size_t>(&config.burst), "Frames enqueued per event-loop turn")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+
+    std::cout << std::format("{} frames of {} bytes, {} frames per turn\n", config.frames,
+                             config.frame_size, config.burst);
+    std::cout << std::format("{:<12} {:>12} {:>14} {:>14} {:>10}\n", "writer", "send calls",
+                             "calls/packet", "Mpackets/s", "MiB/s");
+
+    print("per-frame", config,
+          run<PerFrameWriter>(config, [](PerFrameWriter &w) { return w.frames_written; }));
+    print("coalesced", config,
+          run<pds::network::OutboundQueue<CountingStream>>(
+              config, [](pds::network::OutboundQueue<CountingStream> &q)
+              { return q.stats().frames_written.load(std::memory_order_relaxed); }));
+    return 0;
+}
@@ -2,144 +2,79 @@
 #include <SDKDDKVer.h>
 
 #include <boost/asio.hpp>
+#include <boost/program_options.hpp>
 #include <iostream>
 
-#include "mal-packet-weaver/dispatcher-session.hpp"
-#include "mal-packet-weaver/packet-dispatcher.hpp"
-#include "mal-packet-weaver/packet.hpp"
-#include "mal-packet-weaver/session.hpp"
-#include "common.hpp"
-#include "packets/account-trade-info.hpp"
-
-using namespace mal_packet_weaver;
-using namespace mal_packet_weaver::crypto;
+#include "tcp-server.hpp"
 
 constexpr int kAdditionalThreads = 7;
 
-void process_echo(mal_packet_weaver::Session& connection, std::unique_ptr<EchoPacket>&& echo)
-{
-    EchoPacket response;
-    response.echo_message = std::to_string(std::stoi(echo->echo_message) + 1);
-    connection.send_packet(response);
-    spdlog::info("Received message: {}", echo->echo_message);
-}
-
-class TcpServer
+int main(int argc, char** argv)
 {
-public:
-    TcpServer(boost::asio::io_context& io_context, unsigned short port, std::unique_ptr<ECDSA::Signer> signer)
-        : acceptor_(io_context.get_executor(), boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port)),
-          io_context_(io_context),
-          signer_(std::move(signer))
-    {
-        do_accept();
-        co_spawn(io_context, boost::bind(&TcpServer::cleanup_task, this), boost::asio::detached);
-        connections_.reserve(100);
-    }
-    ~TcpServer() { alive = false; }
-
-private:
-    void do_accept()
-    {
-        acceptor_.async_accept(
-            [this](boost::system::error_code ec, boost::asio::ip::tcp::socket socket)
-            {
-                if (ec)
-                {
-                    spdlog::info("Error accepting connection: {}", ec.message());
-                }
-                else
-                {
-                    setup_new_connection(std::move(socket));
-                }
-
-                do_accept();
-            });
-    }
-    void setup_new_connection(boost::asio::ip::tcp::socket&& socket)
+    namespace po = boost::program_options;
+
+    std::vector<std::string> listen_uris;
+    std::string keyring_path = "private-key.pem";
+    ServerKeyring::KeyId default_key_id = 1;
+    std::string log_level = "info";
+    std::string capture_path;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("listen", po::value<std::vector<std::string>>(&listen_uris)->composing(),
+         "Endpoint to accept connections on, tcp://host:port or unix:///path; repeatable")
+        ("keyring", po::value<std::string>(&keyring_path),
+         "PEM file with one or more private keys, e.g. keygen's merged output (default: private-key.pem)")
+        ("default-key-id", po::value<ServerKeyring::KeyId>(&default_key_id),
+         "1-based key used for clients that don't name one (default: 1)")
+        ("log-level", po::value<std::string>(&log_level),
+         "trace, debug, info, warn, err, critical or off (default: info)")
+        ("capture", po::value<std::string>(&capture_path),
+         "Record every session's decrypted inbound packets to this file, for traffic_replay")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
     {
-        spdlog::info("New connection established.");
-        auto dispatcher_session = std::make_unique < DispatcherSession>( io_context_, std::move(socket) );
-
-        using namespace std::placeholders;
-
-        dispatcher_session->register_default_handler<Session&, DHKeyExchangeRequestPacket>(
-            std::bind(&TcpServer::encryption_handler_server, this, _1, _2));
-        dispatcher_session->register_default_handler<Session&, EchoPacket>(process_echo);
-
-        connections_.emplace_back(std::move(dispatcher_session));
-    }
-
-    void encryption_handler_server(Session& connection, std::unique_ptr<DHKeyExchangeRequestPacket>&& exchange_request)
-    {
-        spdlog::info("Received encryption request packet");
-
-        DiffieHellmanHelper dh{};
-        DHKeyExchangeResponsePacket response_packet;
-        response_packet.public_key = dh.get_public_key();
-
-        std::mt19937_64 rng(std::random_device{}());
-
-        response_packet.salt = ByteArray{ 8 };
-
-        std::generate(response_packet.salt.begin(), response_packet.salt.end(),
-                      [&rng]() -> std::byte {
-                          return static_cast<std::byte>(
-                              static_cast<std::uint8_t>(std::uniform_int_distribution<uint16_t>(0, 255)(rng)));
-                      });
-
-        response_packet.n_rounds = 5 + static_cast<int>(std::chi_squared_distribution<float>(2)(rng));
-        response_packet.n_rounds = std::min(response_packet.n_rounds, 5);
-        response_packet.n_rounds = std::max(response_packet.n_rounds, 20);
-
-        response_packet.signature = signer_->sign_hash(response_packet.get_hash());
-
-        ByteArray shared_secret = dh.get_shared_secret(exchange_request->public_key);
-        shared_secret.append(response_packet.salt);
-        spdlog::info("Computed shared secret: {}", bytes_to_hex_str(shared_secret));
-
-        const Hash shared_key = SHA::ComputeHash(shared_secret, Hash::HashType::SHA256);
-        spdlog::info("Computed shared key: {}", bytes_to_hex_str(shared_key.hash_value));
-
-        connection.send_packet(response_packet);
-        auto encryption = std::make_shared<crypto::AES::AES256>(shared_key.hash_value, response_packet.salt,
-                                                                static_cast<uint16_t>(response_packet.n_rounds));
-
-        connection.setup_encryption(encryption);
+        std::cout << desc << "\n";
+        return 0;
     }
-
-    boost::asio::awaitable<void> cleanup_task()
+    if (listen_uris.empty())
     {
-        while(true)
-        {
-            std::erase_if(connections_, [](auto &session){ return session->is_closed(); });
-            boost::asio::steady_timer timer(io_context_, std::chrono::seconds(1));
-            co_await timer.async_wait(boost::asio::use_awaitable);
-        }
+        listen_uris.emplace_back("tcp://0.0.0.0:1234");
     }
 
-    std::mutex connection_access;
-    bool alive = true;
-    boost::asio::ip::tcp::acceptor acceptor_;
-    std::vector<std::shared_ptr<mal_packet_weaver::DispatcherSession>> connections_;
-    boost::asio::io_context& io_context_;
-    std::unique_ptr<crypto::ECDSA::Signer> signer_;
-};
-
-int main()
-{
-    spdlog::set_level(spdlog::level::trace);
+    // Per-connection and per-packet messages go through the hot log, which formats them on its
+    // own thread; it is declared first so it outlives the io threads and writes their last records.
+    const auto level = spdlog::level::from_str(log_level);
+    spdlog::set_level(level);
+    pds::logging::set_level(level);
+    pds::logging::HotLogBackend hot_log;
 
     boost::asio::io_context io_context;
 
-    auto private_key = read_key("private-key.pem");
-
-    std::unique_ptr<ECDSA::Signer> signer = std::make_unique<ECDSA::Signer>(private_key, Hash::HashType::SHA256);
-
     std::unique_ptr<TcpServer> server;
     try
     {
-        server = std::make_unique<TcpServer>(io_context, (uint16_t)(1234), std::move(signer));
+        auto keyring = std::make_unique<ServerKeyring>(keyring_path);
+        // Parsing the default key up front fails fast on a bad file; the key type picks the
+        // handshake suite, see keygen --curve.
+        spdlog::info("Loaded {} keys from {}, default key {} uses {}, fingerprint {}", keyring->size(), keyring_path,
+                     default_key_id, pds::crypto::to_string(keyring->get(default_key_id).suite()),
+                     keyring->fingerprint(default_key_id));
+
+        std::vector<pds::network::Endpoint> endpoints;
+        for (auto const& uri : listen_uris)
+        {
+            endpoints.emplace_back(pds::network::parse_endpoint(uri));
+        }
+        server = std::make_unique<TcpServer>(io_context, endpoints, std::move(keyring), default_key_id);
+        if (!capture_path.empty())
+        {
+            server->capture_to(std::make_shared<pds::capture::CaptureWriter>(capture_path));
+            spdlog::info("Capturing inbound packets to {}", capture_path);
+        }
     }
     catch(const std::exception& e)
     {
@@ -0,0 +1,523 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "logging/hot-log.hpp"
+#include "market/bars.hpp"
+#include "market/symbol-table.hpp"
+#include "market/tick-codec.hpp"
+#include "packets/market-data.hpp"
+#include "packet-routes.hpp"
+
+struct MarketDataStats
+{
+    uint64_t ticks_received = 0;
+    /** @brief Ticks written to subscribers, once per subscriber. */
+    uint64_t ticks_forwarded = 0;
+    /** @brief Ticks of symbols their publisher never defined, and malformed batches. */
+    uint64_t ticks_dropped = 0;
+    uint64_t batches_sent = 0;
+    uint64_t bars_closed = 0;
+};
+
+/**
+ * @brief Forwards the ticks publishers send to the clients that subscribed to their symbols.
+ *
+ * @details Symbols are interned once for the whole server: the ids of every publisher are
+ * mapped to the server's on arrival, and its prices rescaled if it quotes a symbol with other
+ * digits than the first publisher did. Every incoming TickBatch is decoded once and its ticks
+ * are written to one batch per interested subscriber, sent at the end; a subscriber gets a
+ * frame per incoming batch however many of its symbols the batch carries.
+ *
+ * Every routed tick also updates the M1, M5, H1 and D1 bars of its symbol, whether anyone
+ * subscribed or not, so that history can be fetched at any time. Subscribers of a timeframe
+ * get every bar as it closes, and with partial updates the forming bar once per incoming batch
+ * that changed it.
+ *
+ * Session is central_server's OutboundSession except in benchmarks. Thread-safe; packets are
+ * only queued on the sessions while the lock is held.
+ */
+template <typename Session>
+class MarketDataRouter
+{
+public:
+    using Routes = PacketRoutes<SymbolDefinition, TickBatch, MarketDataSubscribe, MarketDataUnsubscribe,
+                                BarSubscribe, BarUnsubscribe, BarHistoryRequest>;
+
+    template <typename Packet>
+    static constexpr bool kRoutes = Routes::template kRoutes<Packet>;
+
+    /** @brief Registers the handlers of every routed packet; any session may publish and subscribe. */
+    void attach(std::shared_ptr<Session> const &session) { Routes::attach(*this, session); }
+
+    /** @brief Routed packets dropped for arriving past their lifetime, by type. Thread-safe. */
+    [[nodiscard]] pds::network::PacketCounters const &late_arrivals() const noexcept
+    {
+        return packet_routes_.late_arrivals();
+    }
+
+    /** @brief For handlers registered elsewhere, e.g. the capturing ones. */
+    template <typename Packet>
+    void on_packet(std::weak_ptr<Session> const &from, std::unique_ptr<Packet> &&packet)
+    {
+        const auto session = packet_routes_.admit(from, *packet);
+        if (!session)
+        {
+            return;
+        }
+        std::lock_guard lock{ mutex_ };
+        if constexpr (std::is_same_v<Packet, SymbolDefinition>)
+        {
+            define(session.get(), *packet);
+        }
+        else if constexpr (std::is_same_v<Packet, TickBatch>)
+        {
+            route(session.get(), *packet);
+        }
+        else if constexpr (std::is_same_v<Packet, MarketDataSubscribe>)
+        {
+            subscribe(session, packet->symbol);
+        }
+        else if constexpr (std::is_same_v<Packet, MarketDataUnsubscribe>)
+        {
+            unsubscribe(session.get(), packet->symbol);
+        }
+        else if constexpr (std::is_same_v<Packet, BarSubscribe>)
+        {
+            subscribe_bars(session, packet->symbol, packet->timeframe, packet->partial);
+        }
+        else if constexpr (std::is_same_v<Packet, BarUnsubscribe>)
+        {
+            unsubscribe_bars(session.get(), packet->symbol, packet->timeframe);
+        }
+        else
+        {
+            send_history(*session, *packet);
+        }
+    }
+
+    /** @brief Call once a session is closed, before it is released. */
+    void session_closed(Session const *session)
+    {
+        std::lock_guard lock{ mutex_ };
+        publishers_.erase(session);
+        if (const auto subscriber = subscribers_.find(session); subscriber != subscribers_.end())
+        {
+            for (const uint32_t symbol : subscriber->second->symbols)
+            {
+                std::erase(routes_[symbol].subscribers, subscriber->second.get());
+            }
+            for (const BarKey key : subscriber->second->bars)
+            {
+                erase_bar_subscriber(key, subscriber->second.get());
+            }
+            subscribers_.erase(subscriber);
+        }
+    }
+
+    [[nodiscard]] MarketDataStats stats() const
+    {
+        std::lock_guard lock{ mutex_ };
+        return stats_;
+    }
+
+private:
+    static constexpr uint32_t kUnmapped = UINT32_MAX;
+
+    struct BarKey
+    {
+        uint32_t symbol;
+        uint8_t timeframe;
+
+        friend bool operator==(BarKey const &, BarKey const &) = default;
+    };
+
+    struct Subscriber
+    {
+        std::weak_ptr<Session> session;
+        // Symbols of the ticks subscribed to.
+        std::vector<uint32_t> symbols;
+        std::vector<BarKey> bars;
+        pds::market::TickWriter writer;
+        // Reused for every frame, so the writer's buffer keeps its capacity; send_packet still
+        // copies it into the queued frame.
+        TickBatch batch;
+        // Has ticks of the batch being routed.
+        bool pending = false;
+    };
+
+    struct BarSubscriber
+    {
+        Subscriber *subscriber;
+        bool partial;
+    };
+
+    struct Route
+    {
+        std::vector<Subscriber *> subscribers;
+        pds::market::SymbolBars bars;
+        std::array<std::vector<BarSubscriber>, pds::market::kTimeframeCount> bar_subscribers;
+        // Whether the forming bars changed in the batch being routed; the symbol is in dirty_.
+        bool dirty = false;
+    };
+
+    // What a publisher's symbol id stands for on the server.
+    struct Mapping
+    {
+        uint32_t symbol = kUnmapped;
+        int32_t digits = 0;
+    };
+
+    void define(Session const *session, SymbolDefinition const &definition)
+    {
+        if (definition.symbol >= pds::market::kMaxSymbols ||
+            !pds::market::SymbolTable::valid_digits(definition.digits))
+        {
+            PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                     "Rejected definition of symbol {} with {} digits", definition.symbol,
+                                     definition.digits);
+            return;
+        }
+        const auto symbol = intern(definition.name);
+        if (!symbol)
+        {
+            return;
+        }
+        std::vector<Mapping> &mappings = publishers_[session];
+        if (definition.symbol >= mappings.size())
+        {
+            mappings.resize(static_cast<size_t>(definition.symbol) + 1);
+        }
+        mappings[definition.symbol] = Mapping{ *symbol, definition.digits };
+
+        pds::market::SymbolTable::Symbol &known = symbols_[*symbol];
+        if (known.digits == pds::market::SymbolTable::kUnknownDigits)
+        {
+            // The first publisher decides how the server quotes it; subscribers waited for that.
+            known.digits = definition.digits;
+            // Once to every subscriber, whether of the ticks or of bars of any timeframe.
+            Route const &route = routes_[*symbol];
+            std::vector<Subscriber *> waiting = route.subscribers;
+            for (auto const &bar_subscribers : route.bar_subscribers)
+            {
+                for (BarSubscriber const &bar_subscriber : bar_subscribers)
+                {
+                    waiting.emplace_back(bar_subscriber.subscriber);
+                }
+            }
+            std::ranges::sort(waiting);
+            const auto duplicates = std::ranges::unique(waiting);
+            waiting.erase(duplicates.begin(), duplicates.end());
+            for (Subscriber *subscriber : waiting)
+            {
+                send_definition(*subscriber, *symbol);
+            }
+        }
+    }
+
+    void route(Session const *session, TickBatch const &batch)
+    {
+        const auto publisher = publishers_.find(session);
+        reader_.begin(batch.ticks, batch.base_time_msc);
+        pds::market::Tick tick;
+        while (reader_.next(tick))
+        {
+            ++stats_.ticks_received;
+            if (publisher == publishers_.end() || tick.symbol >= publisher->second.size() ||
+                publisher->second[tick.symbol].symbol == kUnmapped)
+            {
+                ++stats_.ticks_dropped;
+                continue;
+            }
+            const Mapping mapping = publisher->second[tick.symbol];
+            tick.symbol = mapping.symbol;
+            if (const int32_t digits = symbols_[mapping.symbol].digits; digits != mapping.digits)
+            {
+                tick.bid = pds::market::rescale(tick.bid, mapping.digits, digits);
+                tick.ask = pds::market::rescale(tick.ask, mapping.digits, digits);
+                tick.last = pds::market::rescale(tick.last, mapping.digits, digits);
+            }
+            Route &route = routes_[mapping.symbol];
+            add_to_bars(route, tick);
+            for (Subscriber *subscriber : route.subscribers)
+            {
+                if (!subscriber->pending)
+                {
+                    subscriber->pending = true;
+                    subscriber->writer.begin(subscriber->batch.ticks, batch.base_time_msc);
+                    pending_.emplace_back(subscriber);
+                }
+                subscriber->writer.add(tick);
+            }
+        }
+        if (reader_.malformed())
+        {
+            ++stats_.ticks_dropped;
+            PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                     "Dropped the rest of a malformed tick batch");
+        }
+
+        for (Subscriber *subscriber : pending_)
+        {
+            subscriber->pending = false;
+            subscriber->batch.base_time_msc = batch.base_time_msc;
+            subscriber->batch.tick_count = subscriber->writer.count();
+            stats_.ticks_forwarded += subscriber->batch.tick_count;
+            if (const auto session = subscriber->session.lock(); session && !session->is_closed())
+            {
+                session->send_packet(subscriber->batch);
+                ++stats_.batches_sent;
+            }
+        }
+        pending_.clear();
+        send_forming_bars();
+    }
+
+    void add_to_bars(Route &route, pds::market::Tick const &tick)
+    {
+        const int64_t price = tick.bid != 0 ? tick.bid : tick.last;
+        if (price == 0)
+        {
+            return;
+        }
+        for (size_t timeframe = 0; timeframe < pds::market::kTimeframeCount; ++timeframe)
+        {
+            pds::market::BarSeries &series = route.bars.series[timeframe];
+            const bool closed = series.add(tick.time_msc, price, tick.volume);
+            if (closed)
+            {
+                ++stats_.bars_closed;
+            }
+            if (route.bar_subscribers[timeframe].empty())
+            {
+                continue;
+            }
+            if (closed)
+            {
+                for (BarSubscriber const &bar_subscriber : route.bar_subscribers[timeframe])
+                {
+                    send_bar(*bar_subscriber.subscriber, tick.symbol, timeframe, true, series.last_closed());
+                }
+            }
+            if (!route.dirty)
+            {
+                route.dirty = true;
+                dirty_.emplace_back(tick.symbol);
+            }
+        }
+    }
+
+    // The forming bars the batch changed, to the subscribers that want partial updates.
+    void send_forming_bars()
+    {
+        for (const uint32_t symbol : dirty_)
+        {
+            Route &route = routes_[symbol];
+            route.dirty = false;
+            for (size_t timeframe = 0; timeframe < pds::market::kTimeframeCount; ++timeframe)
+            {
+                for (BarSubscriber const &bar_subscriber : route.bar_subscribers[timeframe])
+                {
+                    if (bar_subscriber.partial)
+                    {
+                        send_bar(*bar_subscriber.subscriber, symbol, timeframe, false,
+                                 route.bars.series[timeframe].forming());
+                    }
+                }
+            }
+        }
+        dirty_.clear();
+    }
+
+    void send_bar(Subscriber const &subscriber, uint32_t symbol, size_t timeframe, bool closed,
+                  pds::market::Bar const &bar)
+    {
+        if (const auto session = subscriber.session.lock(); session && !session->is_closed())
+        {
+            BarUpdate update;
+            update.symbol = symbol;
+            update.timeframe = static_cast<uint8_t>(timeframe);
+            update.closed = closed;
+            update.bar = bar;
+            session->send_packet(update);
+        }
+    }
+
+    void subscribe(std::shared_ptr<Session> const &session, mql::SymbolString const &name)
+    {
+        const auto symbol = intern(name);
+        if (!symbol)
+        {
+            return;
+        }
+        Subscriber &subscriber = subscriber_of(session);
+        if (std::ranges::find(subscriber.symbols, *symbol) != subscriber.symbols.end())
+        {
+            return;
+        }
+        subscriber.symbols.emplace_back(*symbol);
+        routes_[*symbol].subscribers.emplace_back(&subscriber);
+        if (symbols_[*symbol].digits != pds::market::SymbolTable::kUnknownDigits)
+        {
+            send_definition(subscriber, *symbol);
+        }
+    }
+
+    void unsubscribe(Session const *session, mql::SymbolString const &name)
+    {
+        const auto symbol = symbols_.find(name);
+        const auto subscriber = subscribers_.find(session);
+        if (!symbol || subscriber == subscribers_.end())
+        {
+            return;
+        }
+        std::erase(subscriber->second->symbols, *symbol);
+        std::erase(routes_[*symbol].subscribers, subscriber->second.get());
+        erase_if_unused(subscriber);
+    }
+
+    // Subscribing again changes whether partial updates are sent.
+    void subscribe_bars(std::shared_ptr<Session> const &session, mql::SymbolString const &name, uint8_t timeframe,
+                        bool partial)
+    {
+        if (!pds::market::valid_timeframe(timeframe))
+        {
+            return;
+        }
+        const auto symbol = intern(name);
+        if (!symbol)
+        {
+            return;
+        }
+        Subscriber &subscriber = subscriber_of(session);
+        std::vector<BarSubscriber> &bar_subscribers = routes_[*symbol].bar_subscribers[timeframe];
+        if (const auto existing = std::ranges::find(bar_subscribers, &subscriber, &BarSubscriber::subscriber);
+            existing != bar_subscribers.end())
+        {
+            existing->partial = partial;
+            return;
+        }
+        bar_subscribers.emplace_back(BarSubscriber{ &subscriber, partial });
+        subscriber.bars.emplace_back(BarKey{ *symbol, timeframe });
+        if (symbols_[*symbol].digits != pds::market::SymbolTable::kUnknownDigits)
+        {
+            send_definition(subscriber, *symbol);
+        }
+    }
+
+    void unsubscribe_bars(Session const *session, mql::SymbolString const &name, uint8_t timeframe)
+    {
+        const auto symbol = symbols_.find(name);
+        const auto subscriber = subscribers_.find(session);
+        if (!symbol || !pds::market::valid_timeframe(timeframe) || subscriber == subscribers_.end())
+        {
+            return;
+        }
+        const BarKey key{ *symbol, timeframe };
+        std::erase(subscriber->second->bars, key);
+        erase_bar_subscriber(key, subscriber->second.get());
+        erase_if_unused(subscriber);
+    }
+
+    void erase_bar_subscriber(BarKey key, Subscriber const *subscriber)
+    {
+        std::erase_if(routes_[key.symbol].bar_subscribers[key.timeframe],
+                      [subscriber](BarSubscriber const &bar_subscriber)
+                      { return bar_subscriber.subscriber == subscriber; });
+    }
+
+    // Answered on the spot with what the server has, the forming bar last.
+    void send_history(Session &session, BarHistoryRequest const &request)
+    {
+        BarHistoryResponse response;
+        response.symbol = request.symbol;
+        response.timeframe = request.timeframe;
+        response.digits = pds::market::SymbolTable::kUnknownDigits;
+        response.partial = false;
+        const auto symbol = symbols_.find(request.symbol);
+        if (symbol && pds::market::valid_timeframe(request.timeframe) && request.count != 0)
+        {
+            response.digits = symbols_[*symbol].digits;
+            pds::market::BarSeries const &series = routes_[*symbol].bars.series[request.timeframe];
+            const size_t count = std::min<size_t>(request.count, series.closed_count() + 1);
+            response.bars.reserve(count);
+            series.copy_closed(series.has_forming() ? count - 1 : count, response.bars);
+            if (series.has_forming())
+            {
+                response.bars.emplace_back(series.forming());
+                response.partial = true;
+            }
+        }
+        session.send_packet(response);
+    }
+
+    Subscriber &subscriber_of(std::shared_ptr<Session> const &session)
+    {
+        std::unique_ptr<Subscriber> &subscriber = subscribers_[session.get()];
+        if (!subscriber)
+        {
+            subscriber = std::make_unique<Subscriber>();
+            subscriber->session = session;
+        }
+        return *subscriber;
+    }
+
+    void erase_if_unused(typename std::unordered_map<Session const *, std::unique_ptr<Subscriber>>::iterator subscriber)
+    {
+        if (subscriber->second->symbols.empty() && subscriber->second->bars.empty())
+        {
+            subscribers_.erase(subscriber);
+        }
+    }
+
+    std::optional<uint32_t> intern(mql::SymbolString const &name)
+    {
+        const auto symbol = symbols_.intern(name);
+        if (!symbol)
+        {
+            PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                     "Ignored symbol {}: the server knows too many", name.view());
+            return std::nullopt;
+        }
+        if (*symbol >= routes_.size())
+        {
+            routes_.resize(static_cast<size_t>(*symbol) + 1);
+        }
+        return symbol;
+    }
+
+    void send_definition(Subscriber const &subscriber, uint32_t symbol)
+    {
+        if (const auto session = subscriber.session.lock(); session && !session->is_closed())
+        {
+            SymbolDefinition definition;
+            definition.symbol = symbol;
+            definition.name = symbols_[symbol].name;
+            definition.digits = symbols_[symbol].digits;
+            session->send_packet(definition);
+        }
+    }
+
+    Routes packet_routes_;
+    mutable std::mutex mutex_;
+    pds::market::SymbolTable symbols_;
+    // By server symbol id.
+    std::vector<Route> routes_;
+    // Mapping of every id the publisher defined, by its own id.
+    std::unordered_map<Session const *, std::vector<Mapping>> publishers_;
+    std::unordered_map<Session const *, std::unique_ptr<Subscriber>> subscribers_;
+    // Only used while routing a batch.
+    pds::market::TickReader reader_;
+    std::vector<Subscriber *> pending_;
+    // Symbols whose Route::dirty is set.
+    std::vector<uint32_t> dirty_;
+    MarketDataStats stats_;
+};
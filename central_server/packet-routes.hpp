@@ -0,0 +1,67 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "logging/hot-log.hpp"
+#include "network/deadline.hpp"
+#include "network/packet-counters.hpp"
+
+/**
+ * @brief What the routers of central_server share about the packets they handle: which types
+ * they are, the handlers registered for them on a session and the check every one of them
+ * passes before it is routed.
+ *
+ * @details A router keeps one as a member and has an on_packet(std::weak_ptr<Session> const &,
+ * std::unique_ptr<Packet> &&) for every routed type, which starts with admit().
+ */
+template <typename... Routed>
+class PacketRoutes
+{
+public:
+    template <typename Packet>
+    static constexpr bool kRoutes = (std::is_same_v<Packet, Routed> || ...);
+
+    /** @brief Registers router's on_packet for every routed packet of session. */
+    template <typename Router, typename Session>
+    static void attach(Router &router, std::shared_ptr<Session> const &session)
+    {
+        const std::weak_ptr<Session> weak = session;
+        (session->template register_default_handler<Routed>(
+             [&router, weak](std::unique_ptr<Routed> &&packet) { router.on_packet(weak, std::move(packet)); }),
+         ...);
+    }
+
+    /**
+     * @brief The session packet came from, or null if it is gone or the packet outlived its
+     * lifetime in transit. Thread-safe.
+     */
+    template <typename Session, typename Packet>
+    [[nodiscard]] std::shared_ptr<Session> admit(std::weak_ptr<Session> const &from, Packet const &packet)
+    {
+        static_assert(kRoutes<Packet>);
+        auto session = from.lock();
+        if (!session)
+        {
+            return nullptr;
+        }
+        if (!late_arrivals_.accept(packet))
+        {
+            PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                     "Dropped packet {:#x}, which arrived past its lifetime", Packet::static_unique_id);
+            return nullptr;
+        }
+        return session;
+    }
+
+    /** @brief The packets admit() dropped for arriving past their lifetime, by type. */
+    [[nodiscard]] pds::network::PacketCounters const &late_arrivals() const noexcept
+    {
+        return late_arrivals_.rejected();
+    }
+
+private:
+    // Has a lock of its own.
+    pds::network::LateArrivalFilter late_arrivals_;
+};
@@ -0,0 +1,472 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <format>
+#include <map>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mal-packet-weaver/dispatcher-session.hpp"
+#include "mal-packet-weaver/packet-dispatcher.hpp"
+#include "mal-packet-weaver/packet.hpp"
+#include "mal-packet-weaver/session.hpp"
+#include "capture/capture-file.hpp"
+#include "capture/captured-packets.hpp"
+#include "common.hpp"
+#include "crypto/handshake.hpp"
+#include "crypto/keyring.hpp"
+#include "logging/hot-log.hpp"
+#include "network/heartbeat.hpp"
+#include "network/outbound-session.hpp"
+#include "network/transport.hpp"
+#include "packets/account-trade-info.hpp"
+#include "packets/outbound-policies.hpp"
+#include "market-data-router.hpp"
+#include "trade-copier.hpp"
+#include "trade-router.hpp"
+
+using namespace mal_packet_weaver;
+using namespace mal_packet_weaver::crypto;
+
+constexpr std::chrono::milliseconds kHeartbeatInterval{ 1000 };
+constexpr uint32_t kHeartbeatMissLimit = 3;
+constexpr std::chrono::seconds kCopierReportInterval{ 60 };
+constexpr std::chrono::seconds kSessionReportInterval{ 60 };
+// Cap on the output all sessions together may have pending, on top of each session's limits.
+constexpr size_t kOutboundMemoryBudget = 256 * 1024 * 1024;
+
+using ServerKeyring = pds::crypto::Keyring<pds::crypto::ServerIdentity>;
+/** @brief What the routers send through: every session's packets go through its outbound queue. */
+using ServerSession = pds::network::OutboundSession<mal_packet_weaver::DispatcherSession>;
+
+inline void process_echo(std::weak_ptr<ServerSession> const& from, std::unique_ptr<EchoPacket>&& echo)
+{
+    const auto session = from.lock();
+    if (!session)
+    {
+        return;
+    }
+    EchoPacket response;
+    response.echo_message = std::to_string(std::stoi(echo->echo_message) + 1);
+    session->send_packet(response);
+    PDS_HOT_LOG(spdlog::level::debug, "Received message: {}", echo->echo_message);
+}
+
+/** @brief Liveness and output of one session, see TcpServer::session_stats(). */
+struct SessionStats
+{
+    pds::capture::SessionId id;
+    /** @brief Empty until the peer answered its first heartbeat. */
+    std::optional<pds::network::RttEstimate> rtt;
+    uint64_t frames_written;
+    uint64_t frames_dropped;
+    uint64_t frames_expired;
+    /** @brief frames_expired by packet type, sorted by type. */
+    std::vector<std::pair<mal_packet_weaver::UniquePacketID, uint64_t>> expired_by_type;
+};
+
+class TcpServer
+{
+public:
+    /** @brief Called with the server half's step timings after every accepted handshake. */
+    using HandshakeObserver = std::function<void(pds::crypto::HandshakeTimings const&)>;
+
+    TcpServer(boost::asio::io_context& io_context, std::vector<pds::network::Endpoint> const& endpoints,
+              std::unique_ptr<ServerKeyring> keyring, ServerKeyring::KeyId default_key_id)
+        : io_context_(io_context),
+          keyring_(std::move(keyring)),
+          default_key_id_(default_key_id),
+          outbound_config_{ .policies = make_default_overflow_policies(),
+                            .budget = std::make_shared<pds::network::OutboundMemoryBudget>(kOutboundMemoryBudget),
+                            .priorities = make_default_priorities(),
+                            .buffer_pool = std::make_shared<pds::network::BufferPool>(),
+                            .fragmentation = make_default_fragmentation() },
+          heartbeat_(io_context, pds::network::HeartbeatConfig{ .interval = kHeartbeatInterval,
+                                                                .miss_limit = kHeartbeatMissLimit })
+    {
+        trade_router_.observe_deals([this](MQL5DealInfoResponse const& deal) { trade_copier_.on_deal(deal); });
+        for (auto const& endpoint : endpoints)
+        {
+            listeners_.emplace_back(std::make_unique<pds::network::Listener>(io_context, endpoint));
+            do_accept(*listeners_.back());
+            spdlog::info("Listening on {}", endpoint.to_string());
+        }
+        co_spawn(io_context, boost::bind(&TcpServer::cleanup_task, this), boost::asio::detached);
+        co_spawn(io_context, boost::bind(&TcpServer::copier_report_task, this), boost::asio::detached);
+        co_spawn(io_context, boost::bind(&TcpServer::session_report_task, this), boost::asio::detached);
+        connections_.reserve(100);
+    }
+    ~TcpServer() { alive = false; }
+
+    /** @brief The bound endpoints, with the actual port for TCP ones listening on port 0. */
+    [[nodiscard]] std::vector<pds::network::Endpoint> endpoints() const
+    {
+        std::vector<pds::network::Endpoint> result;
+        for (auto const& listener : listeners_)
+        {
+            result.emplace_back(listener->endpoint());
+        }
+        return result;
+    }
+
+    /** @brief One entry per open session. Thread-safe. */
+    [[nodiscard]] std::vector<SessionStats> session_stats()
+    {
+        std::lock_guard lock{ connection_access };
+        std::vector<SessionStats> result;
+        result.reserve(connections_.size());
+        for (Connection const& connection : connections_)
+        {
+            pds::network::OutboundStats const& outbound = connection.session->stats();
+            result.emplace_back(SessionStats{
+                .id = connection.id,
+                .rtt = heartbeat_.rtt(connection.peer),
+                .frames_written = outbound.frames_written.load(std::memory_order_relaxed),
+                .frames_dropped = outbound.frames_dropped.load(std::memory_order_relaxed),
+                .frames_expired = outbound.frames_expired.load(std::memory_order_relaxed),
+                .expired_by_type = connection.session->expired_by_type().snapshot() });
+        }
+        return result;
+    }
+    /** @brief Routed packets dropped for arriving past their lifetime, by packet type, sorted by type. */
+    [[nodiscard]] std::vector<std::pair<mal_packet_weaver::UniquePacketID, uint64_t>> late_arrivals() const
+    {
+        auto result = trade_router_.late_arrivals().snapshot();
+        // The routers route disjoint types, so their counts need no merging.
+        for (auto const& counters : { &market_data_router_.late_arrivals(), &trade_copier_.late_arrivals() })
+        {
+            std::ranges::copy(counters->snapshot(), std::back_inserter(result));
+        }
+        std::ranges::sort(result);
+        return result;
+    }
+    /** @brief Sessions closed for missing too many heartbeats. */
+    [[nodiscard]] uint64_t dead_peers() const { return heartbeat_.dead_peers(); }
+
+    /** @brief Times every handshake from now on; set it before the io_context runs. */
+    void observe_handshakes(HandshakeObserver observer) { handshake_observer_ = std::move(observer); }
+
+    /**
+     * @brief Records the decrypted packets of every session opened from now on, for
+     * traffic_replay; set it before the io_context runs.
+     */
+    void capture_to(std::shared_ptr<pds::capture::CaptureWriter> capture) { capture_ = std::move(capture); }
+
+private:
+    void do_accept(pds::network::Listener& listener)
+    {
+        listener.async_accept(
+            [this, &listener](boost::system::error_code ec, pds::network::Socket socket)
+            {
+                if (ec)
+                {
+                    PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                             "Error accepting connection: {}", ec.message());
+                }
+                else
+                {
+                    setup_new_connection(std::move(socket), listener.endpoint().is_local());
+                }
+
+                do_accept(listener);
+            });
+    }
+    // Only sessions on local endpoints may go without encryption: the others get their handlers once their
+    // handshake succeeded, and until then only answer pings.
+    void setup_new_connection(pds::network::Socket&& socket, bool plaintext_allowed)
+    {
+        PDS_HOT_LOG(spdlog::level::info, "New connection established.");
+        auto dispatcher_session =
+            std::make_shared<DispatcherSession>(io_context_, pds::network::into_session_socket(std::move(socket)));
+        auto session = ServerSession::create(io_context_, dispatcher_session, outbound_config_);
+        const pds::capture::SessionId session_id = next_session_id_++;
+
+        dispatcher_session->register_default_handler<Session&, DHKeyExchangeRequestPacket>(
+            [this, weak_session = std::weak_ptr<ServerSession>{ session }, session_id, plaintext_allowed](
+                Session& connection, std::unique_ptr<DHKeyExchangeRequestPacket>&& exchange_request)
+            {
+                const auto session = weak_session.lock();
+                if (encryption_handler_server(connection, std::move(exchange_request)) && session &&
+                    !plaintext_allowed)
+                {
+                    attach_handlers(session, session_id);
+                }
+            });
+        dispatcher_session->register_default_handler<Session&, PingPacket>(pds::network::respond_to_ping);
+        if (capture_)
+        {
+            capture_->session_opened(session_id);
+        }
+        if (plaintext_allowed)
+        {
+            attach_handlers(session, session_id);
+        }
+
+        const auto peer = heartbeat_.add(dispatcher_session);
+        dispatcher_session->register_default_handler<PongPacket>(
+            [this, peer](std::unique_ptr<PongPacket>&& pong) { heartbeat_.on_pong(peer, *pong); });
+
+        std::lock_guard lock{ connection_access };
+        connections_.emplace_back(Connection{ std::move(session), session_id, peer });
+    }
+
+    void attach_handlers(std::shared_ptr<ServerSession> const& session, pds::capture::SessionId session_id)
+    {
+        if (capture_)
+        {
+            setup_capture(session, session_id);
+            return;
+        }
+        session->register_default_handler<EchoPacket>(
+            [weak_session = std::weak_ptr<ServerSession>{ session }](std::unique_ptr<EchoPacket>&& echo)
+            { process_echo(weak_session, std::move(echo)); });
+        trade_router_.attach(session);
+        market_data_router_.attach(session);
+        trade_copier_.attach(session);
+    }
+
+    // Echo, the trade info, the copier's requests and the market data are captured on their way to their handlers; the
+    // other captured packets have no handler of their own and are only recorded. All are registered through the outbound
+    // session, so they are captured when they arrive in batches too.
+    void setup_capture(std::shared_ptr<ServerSession> const& outbound_session, pds::capture::SessionId session_id)
+    {
+        const std::weak_ptr<ServerSession> weak_session = outbound_session;
+        pds::capture::for_each_captured_packet(
+            [this, &outbound_session, weak_session, session_id, capture = capture_]<typename Packet>(std::string_view)
+            {
+                if constexpr (std::is_same_v<Packet, EchoPacket>)
+                {
+                    outbound_session->register_default_handler<EchoPacket>(
+                        [weak_session, session_id, capture](std::unique_ptr<EchoPacket>&& echo)
+                        {
+                            capture_packet(*capture, session_id, *echo);
+                            process_echo(weak_session, std::move(echo));
+                        });
+                }
+                else if constexpr (kRouted<Packet>)
+                {
+                    outbound_session->register_default_handler<Packet>(
+                        [this, weak_session, session_id, capture](std::unique_ptr<Packet>&& packet)
+                        {
+                            capture_packet(*capture, session_id, *packet);
+                            route(weak_session, std::move(packet));
+                        });
+                }
+                else
+                {
+                    outbound_session->register_default_handler<Packet>(
+                        [session_id, capture](std::unique_ptr<Packet>&& packet)
+                        { capture_packet(*capture, session_id, *packet); });
+                }
+            });
+    }
+
+    template <typename Packet>
+    static constexpr bool kRouted = TradeRouter<ServerSession>::kRoutes<Packet> ||
+                                    TradeCopier<ServerSession>::kRoutes<Packet> ||
+                                    MarketDataRouter<ServerSession>::kRoutes<Packet>;
+
+    template <typename Packet>
+    void route(std::weak_ptr<ServerSession> const& session, std::unique_ptr<Packet>&& packet)
+    {
+        if constexpr (TradeRouter<ServerSession>::kRoutes<Packet>)
+        {
+            trade_router_.on_packet(session, std::move(packet));
+        }
+        else if constexpr (TradeCopier<ServerSession>::kRoutes<Packet>)
+        {
+            trade_copier_.on_packet(session, std::move(packet));
+        }
+        else
+        {
+            market_data_router_.on_packet(session, std::move(packet));
+        }
+    }
+
+    template <typename Packet>
+    static void capture_packet(pds::capture::CaptureWriter& capture, pds::capture::SessionId session_id,
+                               Packet const& packet)
+    {
+        thread_local std::vector<std::byte> payload;
+        pds::capture::encode_packet(packet, payload);
+        capture.packet(session_id, Packet::static_unique_id, payload);
+    }
+
+    // True once the session is encrypted; a rejected one is destroyed.
+    bool encryption_handler_server(Session& connection, std::unique_ptr<DHKeyExchangeRequestPacket>&& exchange_request)
+    {
+        PDS_HOT_LOG(spdlog::level::debug, "Received encryption request packet");
+
+        const ServerKeyring::KeyId key_id = exchange_request->key_id == 0 ? default_key_id_ : exchange_request->key_id;
+        if (!keyring_->contains(key_id))
+        {
+            PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                     "Rejected encryption request for unknown key {}", key_id);
+            connection.Destroy();
+            return false;
+        }
+
+        std::optional<pds::crypto::ServerHandshake> handshake;
+        pds::crypto::HandshakeTimings timings;
+        try
+        {
+            // Parsed on the first handshake for this key, then served from the keyring's cache.
+            pds::crypto::ServerIdentity const& identity = keyring_->get(key_id);
+            handshake = pds::crypto::accept_key_exchange(identity, *exchange_request,
+                                                         handshake_observer_ ? &timings : nullptr);
+            if (!handshake)
+            {
+                PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                         "Rejected encryption request for suite {}, key {} is {}",
+                                         exchange_request->suite, key_id, pds::crypto::to_string(identity.suite()));
+                connection.Destroy();
+                return false;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                     "Rejected encryption request for key {}: {}", key_id, e.what());
+            connection.Destroy();
+            return false;
+        }
+
+        connection.send_packet(handshake->response);
+        connection.setup_encryption(handshake->encryption);
+        if (handshake_observer_)
+        {
+            handshake_observer_(timings);
+        }
+        return true;
+    }
+
+    boost::asio::awaitable<void> cleanup_task()
+    {
+        while(true)
+        {
+            {
+                std::lock_guard lock{ connection_access };
+                std::erase_if(connections_,
+                              [this](Connection const& connection)
+                              {
+                                  if (!connection.session->is_closed())
+                                  {
+                                      return false;
+                                  }
+                                  heartbeat_.remove(connection.peer);
+                                  trade_router_.session_closed(connection.session.get());
+                                  market_data_router_.session_closed(connection.session.get());
+                                  trade_copier_.session_closed(connection.session.get());
+                                  if (capture_)
+                                  {
+                                      capture_->session_closed(connection.id);
+                                  }
+                                  return true;
+                              });
+            }
+            boost::asio::steady_timer timer(io_context_, std::chrono::seconds(1));
+            co_await timer.async_wait(boost::asio::use_awaitable);
+        }
+    }
+
+    // Logs how long copied deals took to reach the followers' sessions, when any were copied.
+    boost::asio::awaitable<void> copier_report_task()
+    {
+        while (true)
+        {
+            boost::asio::steady_timer timer(io_context_, kCopierReportInterval);
+            co_await timer.async_wait(boost::asio::use_awaitable);
+            const TradeCopierLatencies latencies = trade_copier_.take_latencies();
+            if (latencies.from_receipt.count() == 0)
+            {
+                continue;
+            }
+            spdlog::info("Copied {} trade commands: p50 {:.1f} us, p99 {:.1f} us, max {:.1f} us after the deal "
+                         "arrived; p50 {} ms, p99 {} ms after the publisher sent it",
+                         latencies.from_receipt.count(), latencies.from_receipt.percentile(50) / 1e3,
+                         latencies.from_receipt.percentile(99) / 1e3, latencies.from_receipt.max() / 1e3,
+                         latencies.from_publisher.percentile(50) / 1'000'000,
+                         latencies.from_publisher.percentile(99) / 1'000'000);
+        }
+    }
+
+    // Logs the spread of the sessions' round-trip times and how many were lost to missed heartbeats, then which packet
+    // types expired in the open sessions' queues and which arrived too late to be routed.
+    boost::asio::awaitable<void> session_report_task()
+    {
+        while (true)
+        {
+            boost::asio::steady_timer timer(io_context_, kSessionReportInterval);
+            co_await timer.async_wait(boost::asio::use_awaitable);
+            std::vector<std::chrono::nanoseconds> rtts;
+            std::map<mal_packet_weaver::UniquePacketID, uint64_t> expired;
+            for (SessionStats const& session : session_stats())
+            {
+                if (session.rtt)
+                {
+                    rtts.emplace_back(session.rtt->smoothed);
+                }
+                for (auto const& [type, count] : session.expired_by_type)
+                {
+                    expired[type] += count;
+                }
+            }
+            if (!rtts.empty())
+            {
+                std::ranges::sort(rtts);
+                spdlog::info(
+                    "{} sessions answering heartbeats: RTT p50 {:.1f} us, max {:.1f} us; {} closed as dead so far",
+                    rtts.size(), rtts[rtts.size() / 2].count() / 1e3, rtts.back().count() / 1e3, dead_peers());
+            }
+            if (!expired.empty())
+            {
+                spdlog::info("Expired before they were written, by packet type: {}", format_counts(expired));
+            }
+            if (const auto late = late_arrivals(); !late.empty())
+            {
+                spdlog::info("Dropped for arriving past their lifetime so far, by packet type: {}",
+                             format_counts(late));
+            }
+        }
+    }
+
+    // "0x101: 3, 0x204: 1" for (type, count) pairs.
+    template <typename Counts>
+    static std::string format_counts(Counts const& counts)
+    {
+        std::string result;
+        for (auto const& [type, count] : counts)
+        {
+            result += std::format("{}{:#x}: {}", result.empty() ? "" : ", ", type, count);
+        }
+        return result;
+    }
+
+    struct Connection
+    {
+        std::shared_ptr<ServerSession> session;
+        pds::capture::SessionId id;
+        pds::network::HeartbeatMonitor<mal_packet_weaver::DispatcherSession>::PeerId peer;
+    };
+
+    std::mutex connection_access;
+    bool alive = true;
+    std::vector<std::unique_ptr<pds::network::Listener>> listeners_;
+    std::vector<Connection> connections_;
+    std::atomic<pds::capture::SessionId> next_session_id_ = 1;
+    boost::asio::io_context& io_context_;
+    std::unique_ptr<ServerKeyring> keyring_;
+    const ServerKeyring::KeyId default_key_id_;
+    // Shared by every session, and so are its memory budget and buffer pool.
+    const pds::network::OutboundQueueConfig outbound_config_;
+    pds::network::HeartbeatMonitor<mal_packet_weaver::DispatcherSession> heartbeat_;
+    HandshakeObserver handshake_observer_;
+    std::shared_ptr<pds::capture::CaptureWriter> capture_;
+    TradeRouter<ServerSession> trade_router_;
+    MarketDataRouter<ServerSession> market_data_router_;
+    TradeCopier<ServerSession> trade_copier_;
+};
@@ -0,0 +1,226 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "logging/hot-log.hpp"
+#include "metrics/latency-histogram.hpp"
+#include "packets/account-trade-info.hpp"
+#include "packet-routes.hpp"
+
+struct TradeCopierStats
+{
+    /** @brief Master deals that had followers. */
+    uint64_t deals = 0;
+    uint64_t commands_sent = 0;
+    /** @brief Copies left out by a follower's magic filter, or whose volume rounded to zero. */
+    uint64_t filtered = 0;
+};
+
+/** @brief Nanoseconds from a master deal to the send of every command copying it. */
+struct TradeCopierLatencies
+{
+    /** @brief From the deal's arrival at the copier. */
+    pds::metrics::LatencyHistogram from_receipt;
+    /** @brief From its send by the master's publisher; millisecond resolution, wall clocks. */
+    pds::metrics::LatencyHistogram from_publisher;
+};
+
+/**
+ * @brief Copies the deals of master accounts to the follower accounts that follow them, as
+ * trade commands ready to execute.
+ *
+ * @details Deals come from TradeRouter, from the channels of the masters' publishers, so they
+ * are copied as they are published and nobody polls for them. Every follower of a master has
+ * its own CopyRules: a magic filter, symbol mappings and a lot multiplier. A command is filled
+ * once per deal and only the follower's part is changed for each follower before it is queued
+ * on the follower's session; followers are found with one lookup by master login.
+ *
+ * Only buy and sell deals are copied. Session is central_server's OutboundSession except in
+ * benchmarks. Thread-safe; packets are only queued on the sessions while the lock is held.
+ */
+template <typename Session>
+class TradeCopier
+{
+public:
+    using Routes = PacketRoutes<CopierFollow, CopierUnfollow>;
+
+    template <typename Packet>
+    static constexpr bool kRoutes = Routes::template kRoutes<Packet>;
+
+    /** @brief Registers the handlers of every routed packet; any session may follow, but not change others' follows. */
+    void attach(std::shared_ptr<Session> const &session) { Routes::attach(*this, session); }
+
+    /** @brief Routed packets dropped for arriving past their lifetime, by type. Thread-safe. */
+    [[nodiscard]] pds::network::PacketCounters const &late_arrivals() const noexcept
+    {
+        return packet_routes_.late_arrivals();
+    }
+
+    /** @brief For handlers registered elsewhere, e.g. the capturing ones. */
+    template <typename Packet>
+    void on_packet(std::weak_ptr<Session> const &from, std::unique_ptr<Packet> &&packet)
+    {
+        const auto session = packet_routes_.admit(from, *packet);
+        if (!session)
+        {
+            return;
+        }
+        std::lock_guard lock{ mutex_ };
+        if constexpr (std::is_same_v<Packet, CopierFollow>)
+        {
+            follow(session, *packet);
+        }
+        else
+        {
+            unfollow(session.get(), packet->master_login, packet->follower_login);
+        }
+    }
+
+    /** @brief Every deal published on a channel, stamped with the master's login. */
+    void on_deal(MQL5DealInfoResponse const &deal)
+    {
+        const auto received = std::chrono::steady_clock::now();
+        // Packet has a type of its own.
+        mql::mql5::DealInfo const &info = deal;
+        std::lock_guard lock{ mutex_ };
+        const auto master = masters_.find(deal.owner_login());
+        if (master == masters_.end() || (info.type != mql::mql5::EnumDealType::DealTypeBuy &&
+                                         info.type != mql::mql5::EnumDealType::DealTypeSell))
+        {
+            return;
+        }
+        ++stats_.deals;
+        command_.master_login = deal.owner_login();
+        command_.master_deal = info.ticket;
+        command_.master_position = info.position_id;
+        command_.master_time_msc = info.time_msc;
+        command_.type = info.type;
+        command_.entry = info.entry;
+        command_.price = info.price;
+        command_.stop_loss = info.stop_loss;
+        command_.take_profit = info.take_profit;
+        command_.magic = info.magic;
+        for (Follower const &follower : master->second)
+        {
+            command_.volume = follower.rules.follower_volume(info.volume);
+            if (!follower.rules.copies_magic(info.magic) || command_.volume <= 0)
+            {
+                ++stats_.filtered;
+                continue;
+            }
+            const auto session = follower.session.lock();
+            if (!session || session->is_closed())
+            {
+                continue;
+            }
+            command_.follower_login = follower.login;
+            command_.symbol = follower.rules.follower_symbol(info.symbol);
+            command_.set_owner_login(follower.login);
+            command_.stamp_send_time();
+            session->send_packet(command_);
+            ++stats_.commands_sent;
+            latencies_.from_receipt.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - received)
+                    .count()));
+            if (deal.sent_at_ms() != 0)
+            {
+                latencies_.from_publisher.record(
+                    static_cast<uint64_t>(std::max<int64_t>(command_.sent_at_ms() - deal.sent_at_ms(), 0)) * 1'000'000);
+            }
+        }
+    }
+
+    /** @brief Call once a session is closed, before it is released. */
+    void session_closed(Session const *session)
+    {
+        std::lock_guard lock{ mutex_ };
+        for (auto master = masters_.begin(); master != masters_.end();)
+        {
+            std::erase_if(master->second, [session](Follower const &follower) { return follower.id == session; });
+            master = master->second.empty() ? masters_.erase(master) : std::next(master);
+        }
+    }
+
+    [[nodiscard]] TradeCopierStats stats() const
+    {
+        std::lock_guard lock{ mutex_ };
+        return stats_;
+    }
+
+    /** @brief The latencies recorded since the last call. */
+    [[nodiscard]] TradeCopierLatencies take_latencies()
+    {
+        TradeCopierLatencies taken;
+        std::lock_guard lock{ mutex_ };
+        std::swap(taken, latencies_);
+        return taken;
+    }
+
+private:
+    struct Follower
+    {
+        int64_t login;
+        Session const *id;
+        std::weak_ptr<Session> session;
+        pds::copier::CopyRules rules;
+    };
+
+    // Following again replaces the follower's rules, but only from the session that follows
+    // the master into that account, or once that session is closed: no session can take over,
+    // or change, the copies another one receives.
+    void follow(std::shared_ptr<Session> const &session, CopierFollow const &request)
+    {
+        if (request.master_login == 0 || request.follower_login == 0 ||
+            request.master_login == request.follower_login || !request.rules.valid())
+        {
+            PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                     "Rejected copying account {} to {}", request.master_login,
+                                     request.follower_login);
+            return;
+        }
+        std::vector<Follower> &followers = masters_[request.master_login];
+        const auto existing = std::ranges::find(followers, request.follower_login, &Follower::login);
+        if (existing != followers.end() && existing->id != session.get())
+        {
+            if (const auto owner = existing->session.lock(); owner && !owner->is_closed())
+            {
+                PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                         "Rejected copying account {} to {}, which another session follows it into",
+                                         request.master_login, request.follower_login);
+                return;
+            }
+        }
+        Follower &follower = existing == followers.end() ? followers.emplace_back() : *existing;
+        follower = Follower{ request.follower_login, session.get(), session, request.rules };
+    }
+
+    void unfollow(Session const *session, int64_t master_login, int64_t follower_login)
+    {
+        const auto master = masters_.find(master_login);
+        if (master == masters_.end())
+        {
+            return;
+        }
+        std::erase_if(master->second, [session, follower_login](Follower const &follower)
+                      { return follower.id == session && follower.login == follower_login; });
+        if (master->second.empty())
+        {
+            masters_.erase(master);
+        }
+    }
+
+    Routes packet_routes_;
+    mutable std::mutex mutex_;
+    std::unordered_map<int64_t, std::vector<Follower>> masters_;
+    // Reused for every command, so that only the follower's part changes between sends.
+    CopyTradeCommand command_;
+    TradeCopierStats stats_;
+    TradeCopierLatencies latencies_;
+};
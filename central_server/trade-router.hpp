@@ -0,0 +1,364 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "logging/hot-log.hpp"
+#include "packets/account-trade-info.hpp"
+#include "packet-routes.hpp"
+
+/**
+ * @brief Forwards the trade info terminals publish through server_dll to the clients that
+ * subscribed to its account, and keeps the current part of it for new subscribers.
+ *
+ * @details A session publishes on channels, one per account: TradeChannelOpen claims the
+ * account, and its trade info then carries the login in PacketTag::owner_login. Trade info
+ * without one comes from publishers that predate channels and belongs to the account of the
+ * session's last MQL5AccountInfoIntegerResponse. What belongs to no open channel is dropped.
+ * Channels cost an entry in the session's list and nothing else; they are closed by
+ * TradeChannelClose or with their session.
+ *
+ * Everything forwarded carries the account's login in PacketTag::owner_login. Account info,
+ * open positions and pending orders are kept, so a subscriber starts from the current state;
+ * deals are only forwarded. When a channel closes or another session takes over the account,
+ * subscribers get a TradeInvalidation and the kept state is dropped until the account is
+ * published again. Deals also go to the deal observer, e.g. the trade copier. Session is
+ * central_server's OutboundSession. Thread-safe; packets are only queued on the sessions, and
+ * the observer called, while the lock is held.
+ */
+template <typename Session>
+class TradeRouter
+{
+public:
+    /** @brief Gets every routed deal, stamped with its account's login; must not call back into the router. */
+    using DealObserver = std::function<void(MQL5DealInfoResponse const &)>;
+
+    using Routes = PacketRoutes<MQL5AccountInfoIntegerResponse, MQL5AccountInfoDoubleResponse,
+                                    AccountInfoStringResponse, MQL5PositionInfoResponse, MQL5OrderInfoResponse,
+                                    MQL5DealInfoResponse, TradeSubscribeRequest, TradeUnsubscribeRequest,
+                                    TradeChannelOpen, TradeChannelClose>;
+
+    template <typename Packet>
+    static constexpr bool kRoutes = Routes::template kRoutes<Packet>;
+
+    /** @brief Registers the handlers of every routed packet; any session may publish and subscribe. */
+    void attach(std::shared_ptr<Session> const &session) { Routes::attach(*this, session); }
+
+    /** @brief Routed packets dropped for arriving past their lifetime, by type. Thread-safe. */
+    [[nodiscard]] pds::network::PacketCounters const &late_arrivals() const noexcept
+    {
+        return packet_routes_.late_arrivals();
+    }
+
+    /** @brief For handlers registered elsewhere, e.g. the capturing ones. */
+    template <typename Packet>
+    void on_packet(std::weak_ptr<Session> const &from, std::unique_ptr<Packet> &&packet)
+    {
+        const auto session = packet_routes_.admit(from, *packet);
+        if (!session)
+        {
+            return;
+        }
+        std::lock_guard lock{ mutex_ };
+        if constexpr (std::is_same_v<Packet, TradeSubscribeRequest>)
+        {
+            subscribe(session, packet->account_login);
+        }
+        else if constexpr (std::is_same_v<Packet, TradeUnsubscribeRequest>)
+        {
+            unsubscribe(session.get(), packet->account_login);
+        }
+        else if constexpr (std::is_same_v<Packet, TradeChannelOpen>)
+        {
+            claim(session.get(), packet->account_login);
+        }
+        else if constexpr (std::is_same_v<Packet, TradeChannelClose>)
+        {
+            close_channel(session.get(), packet->account_login);
+        }
+        else
+        {
+            int64_t login = packet->owner_login();
+            if constexpr (std::is_same_v<Packet, MQL5AccountInfoIntegerResponse>)
+            {
+                if (login == 0)
+                {
+                    claim_untagged(session.get(), packet->account_login);
+                }
+            }
+            const auto publisher = publishers_.find(session.get());
+            if (publisher != publishers_.end() && login == 0)
+            {
+                login = publisher->second.untagged;
+            }
+            if (publisher == publishers_.end() || login == 0 ||
+                std::ranges::find(publisher->second.channels, login) == publisher->second.channels.end())
+            {
+                PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                         "Dropped trade info of account {}, which has no channel open", login);
+                return;
+            }
+            Account &account = accounts_[login];
+            packet->set_owner_login(login);
+            if constexpr (std::is_same_v<Packet, MQL5DealInfoResponse>)
+            {
+                if (deal_observer_)
+                {
+                    deal_observer_(*packet);
+                }
+            }
+            send_to_subscribers(account, *packet);
+            keep(account, std::move(packet));
+        }
+    }
+
+    /** @brief Set before any session is attached. */
+    void observe_deals(DealObserver observer) { deal_observer_ = std::move(observer); }
+
+    /** @brief Call once a session is closed, before it is released. */
+    void session_closed(Session const *session)
+    {
+        std::lock_guard lock{ mutex_ };
+        if (const auto publisher = publishers_.find(session); publisher != publishers_.end())
+        {
+            for (const int64_t login : publisher->second.channels)
+            {
+                release(login, session);
+            }
+            publishers_.erase(publisher);
+        }
+        for (auto account = accounts_.begin(); account != accounts_.end();)
+        {
+            std::erase_if(account->second.subscribers, [session](Subscriber const &subscriber)
+                          { return subscriber.id == session || subscriber.session.expired(); });
+            account = account->second.unused() ? accounts_.erase(account) : std::next(account);
+        }
+    }
+
+private:
+    struct Subscriber
+    {
+        Session const *id;
+        std::weak_ptr<Session> session;
+    };
+
+    struct Account
+    {
+        Session const *publisher = nullptr;
+        std::unique_ptr<MQL5AccountInfoIntegerResponse> integer_info;
+        std::unique_ptr<MQL5AccountInfoDoubleResponse> double_info;
+        std::unique_ptr<AccountInfoStringResponse> string_info;
+        std::unordered_map<int64_t, std::unique_ptr<MQL5PositionInfoResponse>> positions;
+        std::unordered_map<int64_t, std::unique_ptr<MQL5OrderInfoResponse>> orders;
+        std::vector<Subscriber> subscribers;
+
+        [[nodiscard]] bool unused() const noexcept { return publisher == nullptr && subscribers.empty(); }
+    };
+
+    struct Publisher
+    {
+        // Accounts the session has a channel open for.
+        std::vector<int64_t> channels;
+        // Account of trade info without an owner login; one of channels, or 0.
+        int64_t untagged = 0;
+    };
+
+    // Opens a channel of session for login, taking the account over from any other session.
+    void claim(Session const *session, int64_t login)
+    {
+        if (login == 0)
+        {
+            return;
+        }
+        Publisher &publisher = publishers_[session];
+        if (std::ranges::find(publisher.channels, login) == publisher.channels.end())
+        {
+            publisher.channels.emplace_back(login);
+        }
+        Account &account = accounts_[login];
+        if (account.publisher == session)
+        {
+            return;
+        }
+        if (account.publisher != nullptr)
+        {
+            invalidate(login, account);
+            forget_channel(account.publisher, login);
+        }
+        account.publisher = session;
+    }
+
+    // A publisher without channels switched to another account.
+    void claim_untagged(Session const *session, int64_t login)
+    {
+        if (const auto publisher = publishers_.find(session);
+            publisher != publishers_.end() && publisher->second.untagged != login &&
+            publisher->second.untagged != 0)
+        {
+            close_channel(session, publisher->second.untagged);
+        }
+        claim(session, login);
+        publishers_[session].untagged = login;
+    }
+
+    void close_channel(Session const *session, int64_t login)
+    {
+        release(login, session);
+        forget_channel(session, login);
+    }
+
+    // Removes login from the channels of session, without touching the account.
+    void forget_channel(Session const *session, int64_t login)
+    {
+        const auto publisher = publishers_.find(session);
+        if (publisher == publishers_.end())
+        {
+            return;
+        }
+        std::erase(publisher->second.channels, login);
+        if (publisher->second.untagged == login)
+        {
+            publisher->second.untagged = 0;
+        }
+        if (publisher->second.channels.empty())
+        {
+            publishers_.erase(publisher);
+        }
+    }
+
+    void release(int64_t login, Session const *session)
+    {
+        const auto account = accounts_.find(login);
+        if (account == accounts_.end() || account->second.publisher != session)
+        {
+            return;
+        }
+        invalidate(login, account->second);
+        account->second.publisher = nullptr;
+        if (account->second.unused())
+        {
+            accounts_.erase(account);
+        }
+    }
+
+    void invalidate(int64_t login, Account &account)
+    {
+        account.integer_info.reset();
+        account.double_info.reset();
+        account.string_info.reset();
+        account.positions.clear();
+        account.orders.clear();
+        TradeInvalidation invalidation;
+        invalidation.account_login = login;
+        invalidation.set_owner_login(login);
+        send_to_subscribers(account, invalidation);
+    }
+
+    void subscribe(std::shared_ptr<Session> const &session, int64_t login)
+    {
+        Account &account = accounts_[login];
+        if (std::ranges::none_of(account.subscribers,
+                                 [&session](Subscriber const &subscriber) { return subscriber.id == session.get(); }))
+        {
+            account.subscribers.emplace_back(Subscriber{ session.get(), session });
+        }
+        // Everything kept is already stamped with the login; it is sent again as the current
+        // state, so it leaves with a fresh send time rather than the one it was published with.
+        const auto send = [&session](auto const &packet)
+        {
+            if (packet)
+            {
+                packet->stamp_send_time();
+                session->send_packet(*packet);
+            }
+        };
+        send(account.integer_info);
+        send(account.double_info);
+        send(account.string_info);
+        for (auto const &[ticket, position] : account.positions)
+        {
+            send(position);
+        }
+        for (auto const &[ticket, order] : account.orders)
+        {
+            send(order);
+        }
+    }
+
+    void unsubscribe(Session const *session, int64_t login)
+    {
+        const auto account = accounts_.find(login);
+        if (account == accounts_.end())
+        {
+            return;
+        }
+        std::erase_if(account->second.subscribers,
+                      [session](Subscriber const &subscriber) { return subscriber.id == session; });
+        if (account->second.unused())
+        {
+            accounts_.erase(account);
+        }
+    }
+
+    template <typename Packet>
+    static void send_to_subscribers(Account &account, Packet const &packet)
+    {
+        std::erase_if(account.subscribers,
+                      [&packet](Subscriber const &subscriber)
+                      {
+                          const auto session = subscriber.session.lock();
+                          if (!session || session->is_closed())
+                          {
+                              return true;
+                          }
+                          session->send_packet(packet);
+                          return false;
+                      });
+    }
+
+    static void keep(Account &account, std::unique_ptr<MQL5AccountInfoIntegerResponse> &&packet)
+    {
+        account.integer_info = std::move(packet);
+    }
+    static void keep(Account &account, std::unique_ptr<MQL5AccountInfoDoubleResponse> &&packet)
+    {
+        account.double_info = std::move(packet);
+    }
+    static void keep(Account &account, std::unique_ptr<AccountInfoStringResponse> &&packet)
+    {
+        account.string_info = std::move(packet);
+    }
+    static void keep(Account &account, std::unique_ptr<MQL5PositionInfoResponse> &&packet)
+    {
+        if (packet->volume == 0)
+        {
+            account.positions.erase(packet->ticket);
+        }
+        else
+        {
+            account.positions[packet->ticket] = std::move(packet);
+        }
+    }
+    static void keep(Account &account, std::unique_ptr<MQL5OrderInfoResponse> &&packet)
+    {
+        if (mql::mql5::is_final(packet->state))
+        {
+            account.orders.erase(packet->ticket);
+        }
+        else
+        {
+            account.orders[packet->ticket] = std::move(packet);
+        }
+    }
+    static void keep(Account &, std::unique_ptr<MQL5DealInfoResponse> &&) {}
+
+    Routes packet_routes_;
+    std::mutex mutex_;
+    DealObserver deal_observer_;
+    std::unordered_map<int64_t, Account> accounts_;
+    std::unordered_map<Session const *, Publisher> publishers_;
+};
@@ -0,0 +1,117 @@
+#ifndef CLIENT_API_C_H
+#define CLIENT_API_C_H
+
+#include <wchar.h>
+
+#include "dll_declaration.hpp"
+#include "mql-c/account-info.h"
+#include "mql-c/status.h"
+#include "mql-c/trade-info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Reading the trade state of remote accounts from an MQL5 EA. An EA subscribes to the accounts
+ * it follows; central_server then pushes their state into a cache inside the DLL, and the query
+ * calls copy from that cache into arrays the EA allocated once. Queries never touch the network
+ * nor wait for the I/O thread, and pull a whole collection per call:
+ *
+ *     #import "client_dll.dll"
+ *     int PdsClientStart(string endpoint, string server_key_path, uint key_id);
+ *     void PdsClientStop();
+ *     int PdsSubscribe(long account_login);
+ *     int PdsGetPositions(long account_login, MQL5_PositionInfo &positions[], int capacity, ulong &version);
+ *     ...
+ *     #import
+ *
+ *     PdsSubscribe(login);
+ *     MQL5_PositionInfo positions[];
+ *     ArrayResize(positions, 256);
+ *     int count = PdsGetPositions(login, positions, ArraySize(positions), version);
+ *     if (count > ArraySize(positions)) { ArrayResize(positions, count); ...call again... }
+ *
+ * The collection calls return how many records the cache holds, of which at most capacity
+ * were copied, or a negated status.h code. Versions change whenever their collection does;
+ * PdsGetVersions lets an EA poll all of them and only copy what changed.
+ *
+ * Copying trades: the EA trading a follower account follows a master account with PdsFollow;
+ * central_server then maps every deal the master's terminal publishes through the follower's
+ * rules and pushes a ready to execute PdsCopyCommand, which the EA takes with
+ * PdsPollCopyCommands from its OnTimer or OnTick and executes.
+ */
+
+MQL_C_PACK_BEGIN
+
+    typedef struct {
+        MQL_ulong account;
+        MQL_ulong positions;
+        MQL_ulong orders;
+        MQL_ulong deals;
+        /* 0 while the account's state isn't being kept current: just subscribed, disconnected
+           from central_server, or the account's terminal went offline. */
+        MQL_int current;
+    } PdsCacheVersions;
+
+    /* A master deal to repeat on the follower account: open for DEAL_ENTRY_IN, close or reduce
+       the follower's copy of master_position for DEAL_ENTRY_OUT. */
+    typedef struct {
+        MQL_long master_login;
+        MQL_long follower_login;
+        MQL_long master_deal;
+        MQL_long master_position;
+        /* Of the master deal, in trade server time; lets the EA skip commands that are too late. */
+        MQL_long master_time_msc;
+        MQL_long magic;
+        EnumDealType type;
+        EnumDealEntry entry;
+        /* Already multiplied and rounded to the follower's volume step. */
+        double volume;
+        /* The master's; the EA trades at market. */
+        double price;
+        double stop_loss;
+        double take_profit;
+        /* The follower's symbol, after the symbol mappings. */
+        MQL_ushort symbol[MQL_SYMBOL_LENGTH];
+    } PdsCopyCommand;
+
+MQL_C_PACK_END
+
+    /* Same sharing between EAs and arguments as server_dll's PdsStart. */
+    CLIENT_DLL_API MQL_int PdsClientStart(const wchar_t *endpoint, const wchar_t *server_key_path, MQL_uint key_id);
+    CLIENT_DLL_API void PdsClientStop(void);
+
+    /* Counted per account: every EA unsubscribes from what it subscribed to. */
+    CLIENT_DLL_API MQL_int PdsSubscribe(MQL_long account_login);
+    CLIENT_DLL_API MQL_int PdsUnsubscribe(MQL_long account_login);
+
+    /* 1 with the account filled in, 0 if no account has arrived yet. */
+    CLIENT_DLL_API MQL_int PdsGetAccount(MQL_long account_login, MQL5_AccountInfo *account, MQL_ulong *version);
+    CLIENT_DLL_API MQL_int PdsGetPositions(MQL_long account_login, MQL5_PositionInfo *positions, MQL_int capacity,
+                                           MQL_ulong *version);
+    /* Pending orders only; orders leave the cache in a final state. */
+    CLIENT_DLL_API MQL_int PdsGetOrders(MQL_long account_login, MQL5_OrderInfo *orders, MQL_int capacity,
+                                        MQL_ulong *version);
+    /* The latest deals, oldest first. */
+    CLIENT_DLL_API MQL_int PdsGetDeals(MQL_long account_login, MQL5_DealInfo *deals, MQL_int capacity,
+                                       MQL_ulong *version);
+    CLIENT_DLL_API MQL_int PdsGetVersions(MQL_long account_login, PdsCacheVersions *versions);
+
+    /* Copies the deals of master_login to follower_login, volumes multiplied by lot_multiplier and
+       rounded to volume_step. Only deals with one of the magic_count magics are copied, all of
+       them if magic_count is 0. symbol_map renames master symbols on the follower, e.g.
+       "EURUSD=EURUSD.m;XAUUSD=GOLD", and may be null. Following again replaces the rules. Fails
+       with PDS_TOO_MANY_SUBSCRIPTIONS past 32 follower accounts. */
+    CLIENT_DLL_API MQL_int PdsFollow(MQL_long master_login, MQL_long follower_login, double lot_multiplier,
+                                     double volume_step, const MQL_long *magics, MQL_int magic_count,
+                                     const wchar_t *symbol_map);
+    CLIENT_DLL_API MQL_int PdsUnfollow(MQL_long master_login, MQL_long follower_login);
+    /* Takes at most capacity of the follower's commands, oldest first, and returns how many, or a
+       negated status.h code. One EA polls each follower; commands are dropped while 1024 wait. */
+    CLIENT_DLL_API MQL_int PdsPollCopyCommands(MQL_long follower_login, PdsCopyCommand *commands, MQL_int capacity);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,131 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "client-api.h"
+#include "ipc/mpsc-queue.hpp"
+#include "mql-cpp/c-interop.hpp"
+#include "packets/account-trade-info.hpp"
+
+/**
+ * @brief The copy trade commands central_server sends for the followed accounts, queued until
+ * the EA trading each follower account takes them.
+ *
+ * @details Every follower has a fixed slot holding a queue, found by scanning the slot logins
+ * like SubscriptionCache does. The I/O thread converts a command once and pushes it without
+ * waiting; a command for a full queue is dropped, as it would be stale by the time the EA got
+ * to it. Polls of one follower take its slot's mutex, so only EAs polling the same account ever
+ * wait for each other. Following takes a mutex, only against other follows.
+ */
+class CopyCommandQueues
+{
+public:
+    static constexpr size_t kMaxFollowers = 32;
+    static constexpr size_t kQueueCapacity = 1024;
+
+    CopyCommandQueues() : slots_{ std::make_unique<Slot[]>(kMaxFollowers) } {}
+
+    /** @brief Counted, once per followed master. False if all kMaxFollowers slots are taken. */
+    bool add(int64_t follower)
+    {
+        std::lock_guard lock{ follows_mutex_ };
+        if (Slot *slot = find(follower); slot != nullptr)
+        {
+            ++slot->follows;
+            return true;
+        }
+        Slot *slot = find(0);
+        if (slot == nullptr)
+        {
+            return false;
+        }
+        {
+            // Commands left from the slot's previous follower.
+            std::lock_guard poll_lock{ slot->poll_mutex };
+            PdsCopyCommand stale;
+            while (slot->queue.try_pop(stale))
+            {
+            }
+        }
+        slot->follows = 1;
+        slot->login.store(follower, std::memory_order_release);
+        return true;
+    }
+    void remove(int64_t follower)
+    {
+        std::lock_guard lock{ follows_mutex_ };
+        if (Slot *slot = find(follower); slot != nullptr && --slot->follows == 0)
+        {
+            slot->login.store(0, std::memory_order_release);
+        }
+    }
+
+    /** @brief I/O thread only. False if the follower's queue is full or it isn't followed. */
+    bool push(CopyTradeCommand const &command)
+    {
+        Slot *slot = command.follower_login == 0 ? nullptr : find(command.follower_login);
+        if (slot == nullptr)
+        {
+            return false;
+        }
+        PdsCopyCommand record{};
+        record.master_login = command.master_login;
+        record.follower_login = command.follower_login;
+        record.master_deal = command.master_deal;
+        record.master_position = command.master_position;
+        record.master_time_msc = command.master_time_msc;
+        record.type = static_cast<EnumDealType>(command.type);
+        record.entry = static_cast<EnumDealEntry>(command.entry);
+        record.volume = command.volume;
+        record.price = command.price;
+        record.stop_loss = command.stop_loss;
+        record.take_profit = command.take_profit;
+        record.magic = command.magic;
+        mql::to_utf16(command.symbol.view(), record.symbol);
+        return slot->queue.try_push(record);
+    }
+
+    /** @brief Takes at most capacity commands, oldest first; -1 if the account isn't followed. */
+    int64_t poll(int64_t follower, PdsCopyCommand *out, size_t capacity)
+    {
+        Slot *slot = follower == 0 ? nullptr : find(follower);
+        if (slot == nullptr)
+        {
+            return -1;
+        }
+        std::lock_guard lock{ slot->poll_mutex };
+        size_t count = 0;
+        while (count < capacity && slot->queue.try_pop(out[count]))
+        {
+            ++count;
+        }
+        return static_cast<int64_t>(count);
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<int64_t> login = 0;
+        pds::ipc::MpscQueue<PdsCopyCommand> queue{ kQueueCapacity };
+        std::mutex poll_mutex;
+        // Guarded by follows_mutex_.
+        uint32_t follows = 0;
+    };
+
+    [[nodiscard]] Slot *find(int64_t login) const noexcept
+    {
+        for (size_t i = 0; i < kMaxFollowers; ++i)
+        {
+            if (slots_[i].login.load(std::memory_order_acquire) == login)
+            {
+                return &slots_[i];
+            }
+        }
+        return nullptr;
+    }
+
+    const std::unique_ptr<Slot[]> slots_;
+    std::mutex follows_mutex_;
+};
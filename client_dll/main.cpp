@@ -1,9 +1,260 @@
 #include "dll_declaration.hpp"
 #include <Windows.h>
 #include <memory>
-extern "C" CLIENT_DLL_API float ComputeSqrt(float x)
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+#include "client-api.h"
+#include "trade-client.hpp"
+
+namespace
+{
+    // Shared by every EA of the terminal; queries only take the lock shared, so they only ever
+    // wait for PdsClientStart and PdsClientStop.
+    std::shared_mutex client_access;
+    std::unique_ptr<TradeClient> client;
+    uint32_t client_users = 0;
+
+    template <typename Record>
+    MQL_int copy_collection(MQL_long account_login, Record *out, MQL_int capacity, MQL_ulong *version,
+                            size_t (AccountCache::*copy)(Record *, size_t, uint64_t &) const)
+    {
+        if ((out == nullptr && capacity > 0) || capacity < 0 || version == nullptr)
+        {
+            return -PDS_INVALID_ARGUMENT;
+        }
+        std::shared_lock lock{ client_access };
+        if (!client)
+        {
+            return -PDS_NOT_STARTED;
+        }
+        size_t count = 0;
+        uint64_t current_version = 0;
+        if (!client->cache().read(account_login, [&](AccountCache const &cache)
+                                  { count = (cache.*copy)(out, static_cast<size_t>(capacity), current_version); }))
+        {
+            return -PDS_NOT_SUBSCRIBED;
+        }
+        *version = current_version;
+        return static_cast<MQL_int>(count);
+    }
+
+    // "MASTER=FOLLOWER;..." into mappings; nullopt if an entry lacks either symbol.
+    std::optional<std::vector<pds::copier::SymbolMapping>> parse_symbol_map(std::wstring_view map)
+    {
+        std::vector<pds::copier::SymbolMapping> mappings;
+        while (!map.empty())
+        {
+            const std::wstring_view entry = map.substr(0, map.find(L';'));
+            map.remove_prefix(std::min(entry.size() + 1, map.size()));
+            if (entry.empty())
+            {
+                continue;
+            }
+            const size_t separator = entry.find(L'=');
+            if (separator == 0 || separator == std::wstring_view::npos || separator + 1 == entry.size())
+            {
+                return std::nullopt;
+            }
+            pds::copier::SymbolMapping &mapping = mappings.emplace_back();
+            mql::to_utf8(entry.substr(0, separator), mapping.master);
+            mql::to_utf8(entry.substr(separator + 1), mapping.follower);
+        }
+        return mappings;
+    }
+}  // namespace
+
+extern "C" CLIENT_DLL_API MQL_int PdsClientStart(const wchar_t *endpoint, const wchar_t *server_key_path,
+                                                 MQL_uint key_id)
+{
+    if (endpoint == nullptr)
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    std::unique_lock lock{ client_access };
+    if (client)
+    {
+        ++client_users;
+        return PDS_OK;
+    }
+    try
+    {
+        pds::network::Endpoint parsed = pds::network::parse_endpoint(mql::to_utf8(endpoint));
+        std::unique_ptr<pds::crypto::Keyring<pds::crypto::ServerTrust>> server_keys;
+        if (server_key_path != nullptr && *server_key_path != L'\0')
+        {
+            server_keys = std::make_unique<pds::crypto::Keyring<pds::crypto::ServerTrust>>(
+                std::filesystem::path{ server_key_path });
+        }
+        else if (!parsed.is_local())
+        {
+            spdlog::error("A server key is required on non-local endpoints.");
+            return PDS_INVALID_ARGUMENT;
+        }
+        client = std::make_unique<TradeClient>(std::move(parsed), std::move(server_keys), key_id);
+        client_users = 1;
+        return PDS_OK;
+    }
+    catch (const std::invalid_argument &e)
+    {
+        spdlog::error("Couldn't start the trade client: {}", e.what());
+        return PDS_INVALID_ARGUMENT;
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::error("Couldn't start the trade client: {}", e.what());
+        return PDS_ERROR;
+    }
+}
+
+extern "C" CLIENT_DLL_API void PdsClientStop(void)
+{
+    std::unique_lock lock{ client_access };
+    if (client_users != 0 && --client_users == 0)
+    {
+        client.reset();
+    }
+}
+
+extern "C" CLIENT_DLL_API MQL_int PdsSubscribe(MQL_long account_login)
+{
+    if (account_login <= 0)
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    std::shared_lock lock{ client_access };
+    if (!client)
+    {
+        return PDS_NOT_STARTED;
+    }
+    return client->subscribe(account_login) ? PDS_OK : PDS_TOO_MANY_SUBSCRIPTIONS;
+}
+
+extern "C" CLIENT_DLL_API MQL_int PdsUnsubscribe(MQL_long account_login)
+{
+    std::shared_lock lock{ client_access };
+    if (!client)
+    {
+        return PDS_NOT_STARTED;
+    }
+    return client->unsubscribe(account_login) ? PDS_OK : PDS_NOT_SUBSCRIBED;
+}
+
+extern "C" CLIENT_DLL_API MQL_int PdsGetAccount(MQL_long account_login, MQL5_AccountInfo *account, MQL_ulong *version)
+{
+    if (account == nullptr || version == nullptr)
+    {
+        return -PDS_INVALID_ARGUMENT;
+    }
+    std::shared_lock lock{ client_access };
+    if (!client)
+    {
+        return -PDS_NOT_STARTED;
+    }
+    bool present = false;
+    uint64_t current_version = 0;
+    if (!client->cache().read(account_login, [&](AccountCache const &cache)
+                              { present = cache.copy_account(*account, current_version); }))
+    {
+        return -PDS_NOT_SUBSCRIBED;
+    }
+    *version = current_version;
+    return present ? 1 : 0;
+}
+
+extern "C" CLIENT_DLL_API MQL_int PdsGetPositions(MQL_long account_login, MQL5_PositionInfo *positions,
+                                                  MQL_int capacity, MQL_ulong *version)
+{
+    return copy_collection(account_login, positions, capacity, version, &AccountCache::copy_positions);
+}
+
+extern "C" CLIENT_DLL_API MQL_int PdsGetOrders(MQL_long account_login, MQL5_OrderInfo *orders, MQL_int capacity,
+                                               MQL_ulong *version)
+{
+    return copy_collection(account_login, orders, capacity, version, &AccountCache::copy_orders);
+}
+
+extern "C" CLIENT_DLL_API MQL_int PdsGetDeals(MQL_long account_login, MQL5_DealInfo *deals, MQL_int capacity,
+                                              MQL_ulong *version)
 {
-    return sqrtf(x);
+    return copy_collection(account_login, deals, capacity, version, &AccountCache::copy_deals);
+}
+
+extern "C" CLIENT_DLL_API MQL_int PdsGetVersions(MQL_long account_login, PdsCacheVersions *versions)
+{
+    if (versions == nullptr)
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    std::shared_lock lock{ client_access };
+    if (!client)
+    {
+        return PDS_NOT_STARTED;
+    }
+    CacheVersions current{};
+    if (!client->cache().read(account_login, [&current](AccountCache const &cache) { current = cache.versions(); }))
+    {
+        return PDS_NOT_SUBSCRIBED;
+    }
+    *versions = PdsCacheVersions{ current.account, current.positions, current.orders, current.deals,
+                                  current.current && client->connected() ? 1 : 0 };
+    return PDS_OK;
+}
+
+extern "C" CLIENT_DLL_API MQL_int PdsFollow(MQL_long master_login, MQL_long follower_login, double lot_multiplier,
+                                            double volume_step, const MQL_long *magics, MQL_int magic_count,
+                                            const wchar_t *symbol_map)
+{
+    if (master_login <= 0 || follower_login <= 0 || master_login == follower_login || magic_count < 0 ||
+        (magics == nullptr && magic_count > 0))
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    pds::copier::CopyRules rules;
+    rules.lot_multiplier = lot_multiplier;
+    rules.volume_step = volume_step;
+    rules.magics.assign(magics, magics + magic_count);
+    std::optional<std::vector<pds::copier::SymbolMapping>> symbols =
+        parse_symbol_map(symbol_map == nullptr ? std::wstring_view{} : std::wstring_view{ symbol_map });
+    if (!rules.valid() || !symbols)
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    rules.symbols = std::move(*symbols);
+    std::shared_lock lock{ client_access };
+    if (!client)
+    {
+        return PDS_NOT_STARTED;
+    }
+    return client->follow(master_login, follower_login, std::move(rules)) ? PDS_OK : PDS_TOO_MANY_SUBSCRIPTIONS;
+}
+
+extern "C" CLIENT_DLL_API MQL_int PdsUnfollow(MQL_long master_login, MQL_long follower_login)
+{
+    std::shared_lock lock{ client_access };
+    if (!client)
+    {
+        return PDS_NOT_STARTED;
+    }
+    return client->unfollow(master_login, follower_login) ? PDS_OK : PDS_NOT_SUBSCRIBED;
+}
+
+extern "C" CLIENT_DLL_API MQL_int PdsPollCopyCommands(MQL_long follower_login, PdsCopyCommand *commands,
+                                                      MQL_int capacity)
+{
+    if ((commands == nullptr && capacity > 0) || capacity < 0)
+    {
+        return -PDS_INVALID_ARGUMENT;
+    }
+    std::shared_lock lock{ client_access };
+    if (!client)
+    {
+        return -PDS_NOT_STARTED;
+    }
+    const int64_t count = client->copy_commands().poll(follower_login, commands, static_cast<size_t>(capacity));
+    return count < 0 ? -PDS_NOT_SUBSCRIBED : static_cast<MQL_int>(count);
 }
 
 BOOL APIENTRY DllMain([[maybe_unused]] HMODULE hModule,
@@ -19,7 +270,10 @@ BOOL APIENTRY DllMain([[maybe_unused]] HMODULE hModule,
     }
     case DLL_THREAD_ATTACH:
     case DLL_THREAD_DETACH:
+        break;
     case DLL_PROCESS_DETACH:
+        // See server_dll: joining the I/O thread under the loader lock would deadlock.
+        static_cast<void>(client.release());
         break;
     }
     return TRUE;
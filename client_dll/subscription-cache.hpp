@@ -0,0 +1,380 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "ipc/left-right.hpp"
+#include "mql-cpp/c-interop.hpp"
+
+/**
+ * @brief Records of one kind keyed by ticket, stored contiguously so that one call copies all
+ * of them to the caller.
+ */
+template <typename Record>
+class RecordTable
+{
+public:
+    void upsert(int64_t ticket, Record const &record)
+    {
+        const auto [it, inserted] = index_.try_emplace(ticket, records_.size());
+        if (inserted)
+        {
+            records_.emplace_back(record);
+        }
+        else
+        {
+            records_[it->second] = record;
+        }
+        ++version_;
+    }
+
+    void erase(int64_t ticket)
+    {
+        const auto it = index_.find(ticket);
+        if (it == index_.end())
+        {
+            return;
+        }
+        // Move the last record into the hole so the table stays contiguous.
+        const size_t position = it->second;
+        index_.erase(it);
+        if (position != records_.size() - 1)
+        {
+            records_[position] = records_.back();
+            index_[records_[position].integer_info.ticket] = position;
+        }
+        records_.pop_back();
+        ++version_;
+    }
+
+    void clear()
+    {
+        records_.clear();
+        index_.clear();
+        ++version_;
+    }
+
+    /** @brief Copies up to `capacity` records; returns how many there are. */
+    size_t copy_to(Record *out, size_t capacity) const
+    {
+        std::copy_n(records_.data(), std::min(capacity, records_.size()), out);
+        return records_.size();
+    }
+
+    [[nodiscard]] uint64_t version() const noexcept { return version_; }
+
+private:
+    std::vector<Record> records_;
+    std::unordered_map<int64_t, size_t> index_;
+    uint64_t version_ = 0;
+};
+
+struct CacheVersions
+{
+    uint64_t account;
+    uint64_t positions;
+    uint64_t orders;
+    uint64_t deals;
+    bool current;
+};
+
+/**
+ * @brief What client_dll holds of one subscribed account, already in the C layout EAs read.
+ *
+ * @details Every collection has a version that changes with each update, so an EA polling at
+ * tick frequency only copies what changed. Positions that reach zero volume and orders in a
+ * final state are dropped; the latest kMaxDeals deals are kept. Not synchronized, see
+ * SubscriptionCache.
+ */
+class AccountCache
+{
+public:
+    static constexpr size_t kMaxDeals = 1024;
+
+    /** @brief Empties the cache for another account, keeping the versions counting up. */
+    void reset(int64_t login)
+    {
+        login_ = login;
+        invalidate();
+        deals_.clear();
+        deals_start_ = 0;
+        ++deals_version_;
+    }
+
+    /** @brief Drops what may be outdated until the account's state is received again; deals stay. */
+    void invalidate()
+    {
+        current_ = false;
+        has_account_ = false;
+        account_ = MQL5_AccountInfo{};
+        ++account_version_;
+        positions_.clear();
+        orders_.clear();
+    }
+
+    void update(MQL5_AccountInfoInteger const &record)
+    {
+        account_.integer_info = record;
+        account_updated();
+    }
+    void update(MQL5_AccountInfoDouble const &record)
+    {
+        account_.double_info = record;
+        account_updated();
+    }
+    void update(AccountInfoString const &record)
+    {
+        account_.string_info = record;
+        account_updated();
+    }
+    void update(MQL5_PositionInfo const &record)
+    {
+        current_ = true;
+        if (record.double_info.volume == 0)
+        {
+            positions_.erase(record.integer_info.ticket);
+        }
+        else
+        {
+            positions_.upsert(record.integer_info.ticket, record);
+        }
+    }
+    void update(MQL5_OrderInfo const &record)
+    {
+        current_ = true;
+        if (mql::mql5::is_final(static_cast<mql::mql5::EnumOrderState>(record.integer_info.state)))
+        {
+            orders_.erase(record.integer_info.ticket);
+        }
+        else
+        {
+            orders_.upsert(record.integer_info.ticket, record);
+        }
+    }
+    void update(MQL5_DealInfo const &record)
+    {
+        current_ = true;
+        if (deals_.size() < kMaxDeals)
+        {
+            deals_.emplace_back(record);
+        }
+        else
+        {
+            deals_[deals_start_] = record;
+            deals_start_ = (deals_start_ + 1) % kMaxDeals;
+        }
+        ++deals_version_;
+    }
+
+    [[nodiscard]] int64_t login() const noexcept { return login_; }
+
+    /** @brief False until the first account update arrived. */
+    bool copy_account(MQL5_AccountInfo &out, uint64_t &version) const
+    {
+        out = account_;
+        version = account_version_;
+        return has_account_;
+    }
+    size_t copy_positions(MQL5_PositionInfo *out, size_t capacity, uint64_t &version) const
+    {
+        version = positions_.version();
+        return positions_.copy_to(out, capacity);
+    }
+    size_t copy_orders(MQL5_OrderInfo *out, size_t capacity, uint64_t &version) const
+    {
+        version = orders_.version();
+        return orders_.copy_to(out, capacity);
+    }
+    /** @brief Copies the latest `capacity` deals, oldest first; returns how many are kept. */
+    size_t copy_deals(MQL5_DealInfo *out, size_t capacity, uint64_t &version) const
+    {
+        version = deals_version_;
+        const size_t count = std::min(capacity, deals_.size());
+        // Index in deals_ of the oldest deal to copy.
+        const size_t first = (deals_start_ + deals_.size() - count) % std::max<size_t>(deals_.size(), 1);
+        const size_t until_end = std::min(count, deals_.size() - first);
+        std::copy_n(deals_.data() + first, until_end, out);
+        std::copy_n(deals_.data(), count - until_end, out + until_end);
+        return deals_.size();
+    }
+
+    [[nodiscard]] CacheVersions versions() const
+    {
+        return CacheVersions{ account_version_, positions_.version(), orders_.version(), deals_version_, current_ };
+    }
+
+private:
+    void account_updated()
+    {
+        current_ = true;
+        has_account_ = true;
+        ++account_version_;
+    }
+
+    int64_t login_ = 0;
+    // False from subscribing or an invalidation until the server sends the account again.
+    bool current_ = false;
+    MQL5_AccountInfo account_{};
+    bool has_account_ = false;
+    uint64_t account_version_ = 0;
+    RecordTable<MQL5_PositionInfo> positions_;
+    RecordTable<MQL5_OrderInfo> orders_;
+    // Ring of the latest deals; deals_start_ is the oldest once it is full.
+    std::vector<MQL5_DealInfo> deals_;
+    size_t deals_start_ = 0;
+    uint64_t deals_version_ = 0;
+};
+
+/**
+ * @brief The accounts EAs subscribed to, read from EA threads without ever waiting.
+ *
+ * @details Every account lives in a fixed slot holding two copies of its AccountCache
+ * (pds::ipc::LeftRight): reads find the slot by scanning the slot logins and copy from the
+ * current copy with no lock, so an EA can poll at tick frequency while the I/O thread applies
+ * updates. Updates are converted to the C structures before they are applied, so the I/O
+ * thread only ever waits for one copy by a reader. Subscribing takes a mutex, only against
+ * other subscriptions.
+ */
+class SubscriptionCache
+{
+public:
+    static constexpr size_t kMaxSubscriptions = 32;
+
+    SubscriptionCache() : slots_{ std::make_unique<Slot[]>(kMaxSubscriptions) } {}
+
+    /**
+     * @brief Counted, as several EAs may subscribe to the same account. False if all
+     * kMaxSubscriptions slots are taken.
+     */
+    bool add(int64_t login)
+    {
+        std::lock_guard lock{ subscriptions_mutex_ };
+        if (Slot *slot = find(login); slot != nullptr)
+        {
+            ++slot->subscribers;
+            return true;
+        }
+        Slot *slot = find(0);
+        if (slot == nullptr)
+        {
+            return false;
+        }
+        slot->cache.modify([login](AccountCache &cache) { cache.reset(login); });
+        slot->subscribers = 1;
+        slot->login.store(login, std::memory_order_release);
+        return true;
+    }
+    /** @brief Subscriptions left on the account, nullopt if it wasn't subscribed. */
+    std::optional<uint32_t> remove(int64_t login)
+    {
+        std::lock_guard lock{ subscriptions_mutex_ };
+        Slot *slot = find(login);
+        if (slot == nullptr)
+        {
+            return std::nullopt;
+        }
+        if (--slot->subscribers == 0)
+        {
+            slot->login.store(0, std::memory_order_release);
+            slot->cache.modify([](AccountCache &cache) { cache.reset(0); });
+        }
+        return slot->subscribers;
+    }
+
+    [[nodiscard]] std::vector<int64_t> logins() const
+    {
+        std::vector<int64_t> result;
+        for (size_t i = 0; i < kMaxSubscriptions; ++i)
+        {
+            if (const int64_t login = slots_[i].login.load(std::memory_order_acquire); login != 0)
+            {
+                result.emplace_back(login);
+            }
+        }
+        return result;
+    }
+
+    /** @brief Writer side; does nothing for accounts that aren't subscribed. */
+    template <typename Record>
+    void update(int64_t login, Record const &record)
+    {
+        modify(login, [&record](AccountCache &cache) { cache.update(record); });
+    }
+    void invalidate(int64_t login)
+    {
+        modify(login, [](AccountCache &cache) { cache.invalidate(); });
+    }
+    void invalidate_all()
+    {
+        for (const int64_t login : logins())
+        {
+            invalidate(login);
+        }
+    }
+
+    /**
+     * @brief Calls read with the cache of the account, from any thread and without waiting.
+     * False if the account isn't subscribed.
+     */
+    template <typename Read>
+    bool read(int64_t login, Read &&read) const
+    {
+        const Slot *slot = login == 0 ? nullptr : find(login);
+        return slot != nullptr && slot->cache.read(
+                                      [login, &read](AccountCache const &cache)
+                                      {
+                                          // The slot may have been handed to another account meanwhile.
+                                          if (cache.login() != login)
+                                          {
+                                              return false;
+                                          }
+                                          read(cache);
+                                          return true;
+                                      });
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<int64_t> login = 0;
+        pds::ipc::LeftRight<AccountCache> cache;
+        // Guarded by subscriptions_mutex_.
+        uint32_t subscribers = 0;
+    };
+
+    template <typename Modify>
+    void modify(int64_t login, Modify &&modify)
+    {
+        if (Slot *slot = login == 0 ? nullptr : find(login); slot != nullptr)
+        {
+            slot->cache.modify(
+                [login, &modify](AccountCache &cache)
+                {
+                    if (cache.login() == login)
+                    {
+                        modify(cache);
+                    }
+                });
+        }
+    }
+
+    [[nodiscard]] Slot *find(int64_t login) const noexcept
+    {
+        for (size_t i = 0; i < kMaxSubscriptions; ++i)
+        {
+            if (slots_[i].login.load(std::memory_order_acquire) == login)
+            {
+                return &slots_[i];
+            }
+        }
+        return nullptr;
+    }
+
+    const std::unique_ptr<Slot[]> slots_;
+    std::mutex subscriptions_mutex_;
+};
@@ -0,0 +1,243 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "copy-commands.hpp"
+#include "crypto/keyring.hpp"
+#include "logging/hot-log.hpp"
+#include "network/client-connection.hpp"
+#include "network/deadline.hpp"
+#include "packets/account-trade-info.hpp"
+#include "subscription-cache.hpp"
+
+/**
+ * @brief client_dll's connection to central_server: subscribes to the accounts EAs ask for and
+ * applies the trade info pushed for them to the cache on the DLL's own I/O thread; EAs only
+ * ever read the cache.
+ *
+ * @details Losing the connection or a TradeInvalidation from the server marks the affected
+ * accounts as not current and drops their positions and orders; every new connection
+ * subscribes again and the server answers with the current state. Follows of master accounts
+ * are kept the same way and sent again on every connection; the copy trade commands they bring
+ * are queued for the EAs of the follower accounts.
+ */
+class TradeClient
+{
+public:
+    using Session = pds::network::ClientConnection::Outbound;
+
+    /** @param server_keys Keys to trust, or nullptr for a plaintext session on a local endpoint. */
+    TradeClient(pds::network::Endpoint endpoint,
+                std::unique_ptr<pds::crypto::Keyring<pds::crypto::ServerTrust>> server_keys, uint32_t key_id)
+        : server_keys_{ std::move(server_keys) },
+          work_guard_{ boost::asio::make_work_guard(io_context_) },
+          connection_{ io_context_, std::move(endpoint),
+                       server_keys_ ? &server_keys_->get(key_id != 0 && server_keys_->size() > 1 ? key_id : 1)
+                                    : nullptr,
+                       key_id, [this](Session &session) { on_connected(session); },
+                       [this]() { cache_.invalidate_all(); },
+                       pds::network::OutboundQueueConfig{
+                           .buffer_pool = std::make_shared<pds::network::BufferPool>() } }
+    {
+        connection_.start();
+        thread_ = std::thread([this]() { io_context_.run(); });
+    }
+    ~TradeClient()
+    {
+        io_context_.stop();
+        thread_.join();
+    }
+
+    TradeClient(TradeClient const &) = delete;
+    TradeClient &operator=(TradeClient const &) = delete;
+
+    /** @brief Safe from any thread. False if SubscriptionCache::kMaxSubscriptions are taken. */
+    bool subscribe(int64_t login)
+    {
+        if (!cache_.add(login))
+        {
+            return false;
+        }
+        boost::asio::post(io_context_, [this, login]() { send_subscription<TradeSubscribeRequest>(login); });
+        return true;
+    }
+    /** @brief Safe from any thread. False if the account wasn't subscribed. */
+    bool unsubscribe(int64_t login)
+    {
+        const std::optional<uint32_t> remaining = cache_.remove(login);
+        if (remaining == 0)
+        {
+            boost::asio::post(io_context_, [this, login]() { send_subscription<TradeUnsubscribeRequest>(login); });
+        }
+        return remaining.has_value();
+    }
+
+    /**
+     * @brief Safe from any thread; following again replaces the rules. False if
+     * CopyCommandQueues::kMaxFollowers follower accounts are taken.
+     */
+    bool follow(int64_t master, int64_t follower, pds::copier::CopyRules rules)
+    {
+        CopierFollow request;
+        request.master_login = master;
+        request.follower_login = follower;
+        request.rules = std::move(rules);
+        {
+            std::lock_guard lock{ follows_mutex_ };
+            const auto existing = std::ranges::find_if(
+                follows_, [master, follower](CopierFollow const &follow)
+                { return follow.master_login == master && follow.follower_login == follower; });
+            if (existing != follows_.end())
+            {
+                existing->rules = request.rules;
+            }
+            else if (commands_.add(follower))
+            {
+                follows_.emplace_back(request);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        boost::asio::post(io_context_, [this, request = std::move(request)]() mutable { send(request); });
+        return true;
+    }
+    /** @brief Safe from any thread. False if the master wasn't followed by the account. */
+    bool unfollow(int64_t master, int64_t follower)
+    {
+        {
+            std::lock_guard lock{ follows_mutex_ };
+            const auto erased =
+                std::erase_if(follows_, [master, follower](CopierFollow const &follow)
+                              { return follow.master_login == master && follow.follower_login == follower; });
+            if (erased == 0)
+            {
+                return false;
+            }
+            commands_.remove(follower);
+        }
+        boost::asio::post(io_context_,
+                          [this, master, follower]()
+                          {
+                              CopierUnfollow request;
+                              request.master_login = master;
+                              request.follower_login = follower;
+                              send(request);
+                          });
+        return true;
+    }
+
+    [[nodiscard]] SubscriptionCache const &cache() const noexcept { return cache_; }
+    [[nodiscard]] CopyCommandQueues &copy_commands() noexcept { return commands_; }
+    [[nodiscard]] bool connected() const noexcept { return connection_.connected(); }
+
+private:
+    void on_connected(Session &session)
+    {
+        update_on<MQL5AccountInfoIntegerResponse, MQL5_AccountInfoInteger>(session);
+        update_on<MQL5AccountInfoDoubleResponse, MQL5_AccountInfoDouble>(session);
+        update_on<AccountInfoStringResponse, AccountInfoString>(session);
+        update_on<MQL5PositionInfoResponse, MQL5_PositionInfo>(session);
+        update_on<MQL5OrderInfoResponse, MQL5_OrderInfo>(session);
+        update_on<MQL5DealInfoResponse, MQL5_DealInfo>(session);
+        session.register_default_handler<TradeInvalidation>(
+            [this](std::unique_ptr<TradeInvalidation> &&invalidation)
+            { cache_.invalidate(invalidation->account_login); });
+        session.register_default_handler<CopyTradeCommand>(
+            [this](std::unique_ptr<CopyTradeCommand> &&command)
+            {
+                if (!arrived_in_time(*command))
+                {
+                    return;
+                }
+                if (!commands_.push(*command))
+                {
+                    PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                             "Dropped a copy of deal {} for account {}, which isn't polled fast enough",
+                                             command->master_deal, command->follower_login);
+                }
+            });
+        for (const int64_t login : cache_.logins())
+        {
+            send_subscription<TradeSubscribeRequest>(login);
+        }
+        std::lock_guard lock{ follows_mutex_ };
+        for (CopierFollow &follow : follows_)
+        {
+            send(follow);
+        }
+    }
+
+    template <typename Packet, typename Record>
+    void update_on(Session &session)
+    {
+        session.register_default_handler<Packet>(
+            [this](std::unique_ptr<Packet> &&packet)
+            {
+                if (!arrived_in_time(*packet))
+                {
+                    return;
+                }
+                // Converted once, before the cache applies it to both of its copies.
+                Record record{};
+                mql::to_c(record, *packet);
+                cache_.update(packet->owner_login(), record);
+            });
+    }
+
+    // A copy command or update that outlived its lifetime in transit would be acted on too late.
+    template <typename Packet>
+    bool arrived_in_time(Packet const &packet)
+    {
+        if (late_arrivals_.accept(packet))
+        {
+            return true;
+        }
+        PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                 "Dropped packet {:#x}, which arrived past its lifetime", Packet::static_unique_id);
+        return false;
+    }
+
+    // Runs on the I/O thread; while disconnected the next connection subscribes anyway.
+    template <typename Request>
+    void send_subscription(int64_t login)
+    {
+        if (auto const &session = connection_.session(); session && connection_.connected())
+        {
+            Request request;
+            request.account_login = login;
+            request.stamp_send_time();
+            session->send_packet(request);
+        }
+    }
+
+    // Runs on the I/O thread, like send_subscription.
+    template <typename Request>
+    void send(Request &request)
+    {
+        if (auto const &session = connection_.session(); session && connection_.connected())
+        {
+            request.stamp_send_time();
+            session->send_packet(request);
+        }
+    }
+
+    // The I/O thread's warnings, e.g. those of the session, go through the hot log; declared
+    // first, so it is destroyed after the thread is joined and writes the thread's last records.
+    pds::logging::HotLogBackend hot_log_;
+    const std::unique_ptr<pds::crypto::Keyring<pds::crypto::ServerTrust>> server_keys_;
+    SubscriptionCache cache_;
+    CopyCommandQueues commands_;
+    std::mutex follows_mutex_;
+    std::vector<CopierFollow> follows_;
+    pds::network::LateArrivalFilter late_arrivals_;
+    boost::asio::io_context io_context_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
+    pds::network::ClientConnection connection_;
+    std::thread thread_;
+};
@@ -0,0 +1,436 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "mal-packet-weaver/dispatcher-session.hpp"
+#include "common.hpp"
+#include "crypto/handshake.hpp"
+#include "crypto/session-encryption.hpp"
+#include "metrics/latency-histogram.hpp"
+#include "network/heartbeat.hpp"
+#include "network/packet-batch.hpp"
+#include "network/transport.hpp"
+#include "packets/account-trade-info.hpp"
+#include "packets/node-info.hpp"
+
+enum class LoadMode
+{
+    // Every session keeps `window` echoes in flight and sends the next one when a reply arrives.
+    Closed,
+    // Every session sends at `message_rate` no matter how fast the server answers. Latency is
+    // measured from the scheduled send time, so a stalled server shows up in the percentiles
+    // instead of silently lowering the offered load.
+    Open
+};
+
+enum class MessageKind : size_t
+{
+    Echo,
+    TradeInfo,
+    Count
+};
+
+/** @brief Relative weights of the messages sessions send. */
+struct MessageMix
+{
+    uint32_t echo = 1;
+    uint32_t trade_info = 0;
+};
+
+struct LoadConfig
+{
+    uint32_t sessions = 1;
+    // New sessions per second; 0 connects them all at once.
+    double connect_rate = 0;
+    LoadMode mode = LoadMode::Closed;
+    uint32_t window = 1;
+    // Messages per second per session in open-loop mode.
+    double message_rate = 10;
+    MessageMix mix;
+    std::chrono::milliseconds report_interval{ 1000 };
+    // 0 runs until the process is stopped.
+    std::chrono::seconds duration{ 0 };
+};
+
+/**
+ * @brief Counters and echo latency shared by all sessions, sharded so that io threads rarely
+ * contend; the reporter merges the shards every interval.
+ */
+class LoadStats
+{
+public:
+    struct Interval
+    {
+        pds::metrics::LatencyHistogram latency;
+        std::array<uint64_t, static_cast<size_t>(MessageKind::Count)> sent{};
+        uint64_t replies = 0;
+    };
+
+    explicit LoadStats(size_t shard_count)
+    {
+        for (size_t i = 0; i < shard_count; i++)
+        {
+            shards_.emplace_back(std::make_unique<Shard>());
+        }
+    }
+
+    void record_sent(size_t shard_index, MessageKind kind)
+    {
+        Shard &shard = *shards_[shard_index % shards_.size()];
+        std::lock_guard lock{ shard.mutex };
+        shard.interval.sent[static_cast<size_t>(kind)]++;
+    }
+
+    void record_reply(size_t shard_index, uint64_t latency_ns)
+    {
+        Shard &shard = *shards_[shard_index % shards_.size()];
+        std::lock_guard lock{ shard.mutex };
+        shard.interval.replies++;
+        shard.interval.latency.record(latency_ns);
+    }
+
+    /** @brief Everything recorded since the previous call. */
+    void take_interval(Interval &out)
+    {
+        out.latency.reset();
+        out.sent.fill(0);
+        out.replies = 0;
+        for (auto &shard : shards_)
+        {
+            std::lock_guard lock{ shard->mutex };
+            out.latency.merge(shard->interval.latency);
+            for (size_t i = 0; i < out.sent.size(); i++)
+            {
+                out.sent[i] += shard->interval.sent[i];
+            }
+            out.replies += shard->interval.replies;
+            shard->interval.latency.reset();
+            shard->interval.sent.fill(0);
+            shard->interval.replies = 0;
+        }
+    }
+
+    std::atomic<uint32_t> connected = 0;
+    std::atomic<uint32_t> established = 0;
+    std::atomic<uint32_t> failed = 0;
+
+private:
+    struct Shard
+    {
+        std::mutex mutex;
+        Interval interval;
+    };
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+/**
+ * @brief One connection of the load generator.
+ *
+ * @details Echo messages carry a per-session sequence number, which the server answers with
+ * the number plus one; that is how replies are matched to their send time. Trade-info messages
+ * subscribe to the session's own account and unsubscribe from it in turn; nothing publishes the
+ * account, so the trade router handles them without replying.
+ */
+class LoadSession
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    LoadSession(boost::asio::io_context &io_context, LoadConfig const &config, LoadStats &stats, size_t index,
+                std::shared_ptr<mal_packet_weaver::DispatcherSession> session)
+        : io_context_{ io_context },
+          config_{ config },
+          stats_{ stats },
+          index_{ index },
+          session_{ std::move(session) },
+          rng_{ static_cast<uint32_t>(index) }
+    {
+        session_->register_default_handler<mal_packet_weaver::Session &, PingPacket>(pds::network::respond_to_ping);
+        // The server answers through its outbound queue, in batches.
+        const auto batches = std::make_shared<pds::network::BatchReceiver>();
+        batches->add<EchoPacket>([this](std::unique_ptr<EchoPacket> &&echo) { on_echo(*echo); });
+        pds::network::receive_batches(*session_, batches);
+    }
+
+    [[nodiscard]] mal_packet_weaver::DispatcherSession &session() noexcept { return *session_; }
+
+    /** @brief Starts sending; called once the session is encrypted, or right away in plaintext. */
+    void start()
+    {
+        if (config_.mode == LoadMode::Open)
+        {
+            co_spawn(io_context_, open_loop(), boost::asio::detached);
+            return;
+        }
+        for (uint32_t i = 0; i < config_.window; i++)
+        {
+            send_until_echo(Clock::now());
+        }
+    }
+
+private:
+    // Keeps echo sequence numbers, and their replies, within int.
+    static constexpr int kSequenceLimit = 1'000'000'000;
+    // Sessions subscribe to accounts from here on, one each, away from real logins.
+    static constexpr int64_t kFirstAccount = 9'000'000'000;
+
+    MessageKind pick_kind()
+    {
+        const MessageMix &mix = config_.mix;
+        const uint32_t total = mix.echo + mix.trade_info;
+        const uint32_t value = std::uniform_int_distribution<uint32_t>(0, total - 1)(rng_);
+        return value < mix.echo ? MessageKind::Echo : MessageKind::TradeInfo;
+    }
+
+    MessageKind send_one(Clock::time_point scheduled)
+    {
+        std::unique_lock lock{ mutex_ };
+        const MessageKind kind = pick_kind();
+        switch (kind)
+        {
+            case MessageKind::Echo:
+            {
+                const int sequence = next_sequence_;
+                next_sequence_ = (next_sequence_ + 2) % kSequenceLimit;
+                in_flight_[sequence] = scheduled;
+                lock.unlock();
+
+                EchoPacket echo;
+                echo.echo_message = std::to_string(sequence);
+                session_->send_packet(echo);
+                break;
+            }
+            default:
+            {
+                subscribed_ = !subscribed_;
+                const bool subscribe = subscribed_;
+                lock.unlock();
+                if (subscribe)
+                {
+                    send_subscription<TradeSubscribeRequest>();
+                }
+                else
+                {
+                    send_subscription<TradeUnsubscribeRequest>();
+                }
+                break;
+            }
+        }
+        stats_.record_sent(index_, kind);
+        return kind;
+    }
+
+    template <typename Request>
+    void send_subscription()
+    {
+        Request request;
+        request.account_login = kFirstAccount + static_cast<int64_t>(index_);
+        request.stamp_send_time();
+        session_->send_packet(request);
+    }
+
+    // In closed-loop mode a reply releases exactly one echo; the one-way messages drawn before
+    // it go out with it, which keeps the configured mix.
+    void send_until_echo(Clock::time_point scheduled)
+    {
+        while (send_one(scheduled) != MessageKind::Echo)
+        {
+        }
+    }
+
+    void on_echo(EchoPacket const &echo)
+    {
+        const auto now = Clock::now();
+        int sequence;
+        try
+        {
+            sequence = std::stoi(echo.echo_message) - 1;
+        }
+        catch (const std::exception &)
+        {
+            return;
+        }
+        Clock::time_point scheduled;
+        {
+            std::lock_guard lock{ mutex_ };
+            const auto it = in_flight_.find(sequence);
+            if (it == in_flight_.end())
+            {
+                return;
+            }
+            scheduled = it->second;
+            in_flight_.erase(it);
+        }
+        stats_.record_reply(index_, static_cast<uint64_t>(
+                                        std::chrono::duration_cast<std::chrono::nanoseconds>(now - scheduled).count()));
+        if (config_.mode == LoadMode::Closed)
+        {
+            send_until_echo(Clock::now());
+        }
+    }
+
+    boost::asio::awaitable<void> open_loop()
+    {
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / config_.message_rate));
+        // Spreads the sessions' first sends over one period instead of bunching them.
+        auto next = Clock::now() + period * static_cast<int64_t>(index_ % 1024) / 1024;
+        boost::asio::steady_timer timer{ io_context_ };
+        while (!session_->is_closed())
+        {
+            timer.expires_at(next);
+            co_await timer.async_wait(boost::asio::use_awaitable);
+            // A late wake-up sends the missed messages at once; each keeps its scheduled time.
+            const auto now = Clock::now();
+            while (next <= now)
+            {
+                send_one(next);
+                next += period;
+            }
+        }
+    }
+
+    boost::asio::io_context &io_context_;
+    LoadConfig const &config_;
+    LoadStats &stats_;
+    const size_t index_;
+    std::shared_ptr<mal_packet_weaver::DispatcherSession> session_;
+    std::mutex mutex_;
+    std::mt19937 rng_;
+    int next_sequence_ = 0;
+    bool subscribed_ = false;
+    std::unordered_map<int, Clock::time_point> in_flight_;
+};
+
+/** @brief Opens the configured sessions at the connect rate and reports every interval. */
+class LoadGenerator
+{
+public:
+    /** @param trust Server key to handshake with, or nullptr for plaintext sessions, only served on local endpoints. */
+    LoadGenerator(boost::asio::io_context &io_context, LoadConfig config, pds::network::Endpoint endpoint,
+                  pds::crypto::ServerTrust const *trust, uint32_t key_id, size_t stat_shards)
+        : io_context_{ io_context },
+          config_{ std::move(config) },
+          endpoint_{ std::move(endpoint) },
+          trust_{ trust },
+          key_id_{ key_id },
+          stats_{ stat_shards }
+    {
+        sessions_.reserve(config_.sessions);
+    }
+
+    void start()
+    {
+        co_spawn(io_context_, connect_sessions(), boost::asio::detached);
+        co_spawn(io_context_, report(), boost::asio::detached);
+    }
+
+private:
+    boost::asio::awaitable<void> connect_sessions()
+    {
+        boost::asio::steady_timer timer{ io_context_ };
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < config_.sessions; i++)
+        {
+            if (config_.connect_rate > 0)
+            {
+                timer.expires_at(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                             std::chrono::duration<double>(i / config_.connect_rate)));
+                co_await timer.async_wait(boost::asio::use_awaitable);
+            }
+            boost::asio::ip::tcp::socket socket(io_context_);
+            try
+            {
+                socket = pds::network::into_session_socket(co_await pds::network::async_connect(endpoint_));
+            }
+            catch (const std::exception &e)
+            {
+                stats_.failed++;
+                spdlog::error("Couldn't establish connection: {}", e.what());
+                continue;
+            }
+            stats_.connected++;
+            auto session = std::make_unique<LoadSession>(
+                io_context_, config_, stats_, i,
+                std::make_shared<mal_packet_weaver::DispatcherSession>(io_context_, std::move(socket)));
+            LoadSession &load_session = *session;
+            sessions_.emplace_back(std::move(session));
+            co_spawn(io_context_, establish(load_session), boost::asio::detached);
+        }
+    }
+
+    boost::asio::awaitable<void> establish(LoadSession &session)
+    {
+        if (trust_ != nullptr && !co_await pds::crypto::setup_encryption_for_session(session.session(), *trust_, key_id_))
+        {
+            stats_.failed++;
+            co_return;
+        }
+        stats_.established++;
+        session.start();
+    }
+
+    boost::asio::awaitable<void> report()
+    {
+        std::cout << std::format("{:>8} {:>9} {:>12} {:>12} {:>10} {:>10} {:>10} {:>10} {:>10}\n", "time s",
+                                 "sessions", "sent/s", "replies/s", "p50 us", "p90 us", "p99 us", "p99.9 us",
+                                 "max us");
+        boost::asio::steady_timer timer{ io_context_ };
+        const auto start = std::chrono::steady_clock::now();
+        auto previous = start;
+        LoadStats::Interval interval;
+        LoadStats::Interval total;
+        while (config_.duration.count() == 0 || previous - start < config_.duration)
+        {
+            timer.expires_at(previous + config_.report_interval);
+            co_await timer.async_wait(boost::asio::use_awaitable);
+            const auto now = std::chrono::steady_clock::now();
+            stats_.take_interval(interval);
+            print_line(std::chrono::duration<double>(now - start).count(),
+                       std::chrono::duration<double>(now - previous).count(), interval);
+            total.latency.merge(interval.latency);
+            for (size_t i = 0; i < total.sent.size(); i++)
+            {
+                total.sent[i] += interval.sent[i];
+            }
+            total.replies += interval.replies;
+            previous = now;
+        }
+
+        std::cout << "total\n";
+        print_line(std::chrono::duration<double>(previous - start).count(),
+                   std::chrono::duration<double>(previous - start).count(), total);
+        std::cout << std::format("sent echo {} trade-info {}; sessions failed {}\n", total.sent[0], total.sent[1],
+                                 stats_.failed.load());
+        io_context_.stop();
+    }
+
+    void print_line(double elapsed, double seconds, LoadStats::Interval const &interval) const
+    {
+        uint64_t sent = 0;
+        for (const uint64_t count : interval.sent)
+        {
+            sent += count;
+        }
+        const auto us = [&interval](double percentile)
+        { return static_cast<double>(interval.latency.percentile(percentile)) / 1e3; };
+        std::cout << std::format("{:>8.1f} {:>9} {:>12.0f} {:>12.0f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n",
+                                 elapsed, stats_.established.load(), sent / seconds, interval.replies / seconds,
+                                 us(50), us(90), us(99), us(99.9), interval.latency.max() / 1e3);
+    }
+
+    boost::asio::io_context &io_context_;
+    const LoadConfig config_;
+    const pds::network::Endpoint endpoint_;
+    pds::crypto::ServerTrust const *trust_;
+    const uint32_t key_id_;
+    LoadStats stats_;
+    std::vector<std::unique_ptr<LoadSession>> sessions_;
+};
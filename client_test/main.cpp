@@ -1,117 +1,119 @@
+#include <boost/program_options.hpp>
 #include <iostream>
 #include <thread>
 
 #include "mal-packet-weaver/crypto.hpp"
-#include "mal-packet-weaver/dispatcher-session.hpp"
-#include "common.hpp"
+#include "crypto/keyring.hpp"
+#include "load-generator.hpp"
 
 using namespace mal_packet_weaver;
 using namespace mal_packet_weaver::crypto;
 
-constexpr int kAdditionalThreads = 7;
-constexpr int kAmountOfSessions = 1;
+constexpr uint32_t kDefaultThreads = 8;
 
-boost::asio::awaitable<void> setup_encryption_for_session(DispatcherSession &dispatcher_session,
-                                                          boost::asio::io_context &io,
-                                                          mal_packet_weaver::crypto::ECDSA::Verifier &verifier)
+int main(int argc, char **argv)
 {
-    // Initiate encryption by sending DH request to the server.
-
-    mal_packet_weaver::crypto::DiffieHellmanHelper dh{};
-
-    DHKeyExchangeRequestPacket dh_packet;
-    // Generate public key using DiffieHellmanHelper
-    dh_packet.public_key = dh.get_public_key();
-    // Send it to the server
-    dispatcher_session.send_packet(dh_packet);
-
-    // Wait for the response using dispatcher.
-    auto response = co_await dispatcher_session.await_packet<DHKeyExchangeResponsePacket>();
-
-    // Verify the hash of the response. We use the function declared in DHKeyExchangeResponsePacket to compute hash.
-    if (!verifier.verify_hash(response->get_hash(), response->signature))
+    namespace po = boost::program_options;
+
+    std::string endpoint_uri = "tcp://127.0.0.1:1234";
+    std::string server_key_path = "public-key.pem";
+    uint32_t key_id = 0;
+    std::string key_fingerprint;
+    uint32_t threads = kDefaultThreads;
+    std::string mode = "closed";
+    uint32_t report_interval_ms = 1000;
+    uint32_t duration_s = 0;
+    LoadConfig config;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("endpoint", po::value<std::string>(&endpoint_uri), "Server endpoint, tcp://host:port or unix:///path")
+        ("server-key", po::value<std::string>(&server_key_path), "Trusted server public key(s), one PEM or keygen's merged file")
+        ("key-id", po::value<uint32_t>(&key_id), "1-based tenant key in the server keyring; 0 for the server's default")
+        ("key-fingerprint", po::value<std::string>(&key_fingerprint), "Tenant key by the fingerprint central_server logs for it; overrides --key-id")
+        ("plaintext", "Skip the encryption handshake; only allowed on unix:// endpoints")
+        ("sessions", po::value<uint32_t>(&config.sessions), "Sessions to open (default: 1)")
+        ("connect-rate", po::value<double>(&config.connect_rate), "New sessions per second; 0 opens all at once (default: 0)")
+        ("mode", po::value<std::string>(&mode), "closed: next echo on reply; open: fixed --message-rate (default: closed)")
+        ("window", po::value<uint32_t>(&config.window), "Echoes in flight per session in closed mode (default: 1)")
+        ("message-rate", po::value<double>(&config.message_rate), "Messages per second per session in open mode (default: 10)")
+        ("mix-echo", po::value<uint32_t>(&config.mix.echo), "Weight of echo messages (default: 1)")
+        ("mix-trade-info", po::value<uint32_t>(&config.mix.trade_info), "Weight of trade subscription changes (default: 0)")
+        ("report-interval-ms", po::value<uint32_t>(&report_interval_ms), "Statistics interval (default: 1000)")
+        ("duration", po::value<uint32_t>(&duration_s), "Seconds to run, then print totals; 0 runs forever (default: 0)")
+        ("threads", po::value<uint32_t>(&threads), "io_context threads (default: 8)")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help"))
     {
-        spdlog::warn("encryption response packet has the wrong signature. Aborting connection.");
-        dispatcher_session.Destroy();
+        std::cout << desc << "\n";
+        return 0;
     }
+    const pds::network::Endpoint endpoint = pds::network::parse_endpoint(endpoint_uri);
+    const bool plaintext = vm.contains("plaintext");
+    if (plaintext && !endpoint.is_local())
+    {
+        spdlog::error("--plaintext is only allowed on local endpoints.");
+        return 1;
+    }
+    if (mode != "closed" && mode != "open")
+    {
+        spdlog::error("--mode must be closed or open.");
+        return 1;
+    }
+    config.mode = mode == "open" ? LoadMode::Open : LoadMode::Closed;
+    if (config.mode == LoadMode::Closed ? config.mix.echo == 0 || config.window == 0 : config.message_rate <= 0)
+    {
+        spdlog::error("Closed mode needs echo messages and a window; open mode needs a message rate.");
+        return 1;
+    }
+    if (config.mix.echo + config.mix.trade_info == 0)
+    {
+        spdlog::error("The message mix is empty.");
+        return 1;
+    }
+    config.report_interval = std::chrono::milliseconds(std::max(report_interval_ms, 1u));
+    config.duration = std::chrono::seconds(duration_s);
+    threads = std::max(threads, 1u);
 
-    mal_toolkit::ByteArray shared_secret = dh.get_shared_secret(response->public_key);
-    spdlog::info("Computed shared secret: {}", bytes_to_hex_str(shared_secret));
-    shared_secret.append(response->salt);
-    const mal_packet_weaver::crypto::Hash shared_key =
-        mal_packet_weaver::crypto::SHA::ComputeHash(shared_secret, mal_packet_weaver::crypto::Hash::HashType::SHA256);
-
-    spdlog::info("Computed shared key: {}", bytes_to_hex_str(shared_key.hash_value));
-
-    auto encryption =
-        std::make_shared<AES::AES256>(shared_key.hash_value, response->salt, static_cast<uint16_t>(response->n_rounds));
-
-    // setup the encryption for the connection using AES256.
-    dispatcher_session.setup_encryption(encryption);
-
-    EchoPacket echo;
-    echo.echo_message = "0";
-
-    // Send an echo packet.
-    dispatcher_session.send_packet(echo);
-}
-
-// Echo packet receiver.
-void process_echo(mal_packet_weaver::Session &connection, std::unique_ptr<EchoPacket> &&echo)
-{
-    EchoPacket response;
-    response.echo_message = std::to_string(std::stoi(echo->echo_message) + 1);
-    connection.send_packet(response);
-    spdlog::info("Received message: {}", echo->echo_message);
-}
-
-int main()
-{
-    spdlog::set_level(spdlog::level::debug);
+    // Per-message logging would dominate the measurement.
+    spdlog::set_level(spdlog::level::warn);
     boost::asio::io_context io_context;
-    std::vector<std::unique_ptr<DispatcherSession>> sessions;
-    auto public_key = read_key("public-key.pem");
-
-    mal_packet_weaver::crypto::ECDSA::Verifier verifier{
-        public_key, mal_packet_weaver::crypto::Hash::HashType::SHA256
-    };
 
-    for(int i = 0; i < kAmountOfSessions; i++)
+    // The trusted key sits at the same position as the tenant key when the file holds several;
+    // an Ed25519 key makes the client ask for the X25519/Ed25519 suite.
+    std::unique_ptr<pds::crypto::Keyring<pds::crypto::ServerTrust>> server_keys;
+    pds::crypto::ServerTrust const *trust = nullptr;
+    if (!plaintext)
     {
-        boost::asio::ip::tcp::socket socket(io_context);
-        try
+        server_keys = std::make_unique<pds::crypto::Keyring<pds::crypto::ServerTrust>>(server_key_path);
+        if (!key_fingerprint.empty())
         {
-            socket.connect(boost::asio::ip::tcp::endpoint(
-                boost::asio::ip::address::from_string("127.0.0.1"), 1234));
+            const auto found = server_keys->find_by_fingerprint(key_fingerprint);
+            if (!found)
+            {
+                spdlog::error("No key in {} has the fingerprint {}.", server_key_path, key_fingerprint);
+                return 1;
+            }
+            key_id = *found;
         }
-        catch (const std::exception &e)
-        {
-            spdlog::error("Couldn't establish connection: {}", e.what());
-            break;
-        }
-        std::cout << "Connected to server." << std::endl;
-        std::unique_ptr<DispatcherSession> dispatcher_session = std::make_unique<DispatcherSession>(io_context, std::move(socket));
-        // For dispatcher_session you should explicitly declare parameters.
-        // It will automatically fill
-        // io_context/Session&/std::shared_ptr<Session>/PacketDispatcher&/std::shared_ptr<PacketDispatcher> variables.
-        dispatcher_session->register_default_handler<mal_packet_weaver::Session &, EchoPacket>(process_echo);
-        co_spawn(io_context,
-                std::bind(&setup_encryption_for_session, std::ref(*dispatcher_session), std::ref(io_context),
-                        std::ref(verifier)),
-                boost::asio::detached);
-                sessions.push_back(std::move(dispatcher_session));
+        trust = &server_keys->get(key_id != 0 && server_keys->size() > 1 ? key_id : 1);
     }
 
-    std::vector<std::thread> threads;
+    LoadGenerator generator{ io_context, config, endpoint, trust, key_id, threads };
+    generator.start();
 
-    for (int i = 0; i < kAdditionalThreads; ++i)
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < threads; ++i)
     {
-        threads.emplace_back([&io_context]() { io_context.run(); });
+        workers.emplace_back([&io_context]() { io_context.run(); });
     }
     io_context.run();
-    for (auto &thread : threads)
+    for (auto &thread : workers)
     {
         thread.join();
     }
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,226 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "mal-packet-weaver/packet.hpp"
+
+namespace pds::capture
+{
+    using SessionId = uint32_t;
+
+    enum class RecordKind : uint8_t
+    {
+        SessionOpened = 1,
+        SessionClosed = 2,
+        Packet = 3
+    };
+
+    /** @brief One decoded record; the payload points into the reader's buffer. */
+    struct CaptureRecord
+    {
+        RecordKind kind;
+        SessionId session;
+        // Since the capture was started.
+        std::chrono::nanoseconds time;
+        mal_packet_weaver::UniquePacketID packet_type = 0;
+        std::span<const std::byte> payload;
+    };
+
+    /**
+     * @brief Layout of a capture file.
+     *
+     * @details An 8-byte header, "PDSCAP" and a little-endian version, followed by records:
+     * the kind byte, then LEB128 varints of the session id and of the nanoseconds since the
+     * previous record, and for packets the packet id, the payload size and the payload, which
+     * is the packet's boost binary archive without header. Typical records take a dozen bytes
+     * plus the payload.
+     */
+    inline constexpr std::array<char, 6> kMagic{ 'P', 'D', 'S', 'C', 'A', 'P' };
+    inline constexpr uint16_t kVersion = 1;
+    inline constexpr size_t kHeaderSize = kMagic.size() + sizeof(kVersion);
+
+    namespace detail
+    {
+        inline void put_varint(std::vector<std::byte> &out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<std::byte>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<std::byte>(value));
+        }
+
+        inline uint64_t get_varint(std::span<const std::byte> &in)
+        {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                if (in.empty())
+                {
+                    throw std::runtime_error("Truncated capture record");
+                }
+                const auto byte = static_cast<uint8_t>(in.front());
+                in = in.subspan(1);
+                value |= uint64_t{ byte & 0x7Fu } << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+            throw std::runtime_error("Malformed varint in capture");
+        }
+    }  // namespace detail
+
+    /**
+     * @brief Appends records from any thread to a capture file.
+     *
+     * @details Records are buffered and written in blocks; the timestamp is taken under the
+     * buffer lock so it never goes backwards in the file.
+     */
+    class CaptureWriter
+    {
+    public:
+        static constexpr size_t kFlushThreshold = 1 << 20;
+
+        /** @brief Throws std::runtime_error if the file can't be created. */
+        explicit CaptureWriter(std::filesystem::path const &path)
+            : file_{ path, std::ios::binary | std::ios::trunc }, previous_{ std::chrono::steady_clock::now() }
+        {
+            if (!file_)
+            {
+                throw std::runtime_error("Couldn't create capture file " + path.string());
+            }
+            file_.write(kMagic.data(), kMagic.size());
+            const std::array<char, 2> version{ static_cast<char>(kVersion & 0xFF), static_cast<char>(kVersion >> 8) };
+            file_.write(version.data(), version.size());
+            buffer_.reserve(kFlushThreshold + 4096);
+        }
+        ~CaptureWriter() { flush(); }
+
+        CaptureWriter(CaptureWriter const &) = delete;
+        CaptureWriter &operator=(CaptureWriter const &) = delete;
+
+        void session_opened(SessionId session) { append(RecordKind::SessionOpened, session, 0, {}); }
+        void session_closed(SessionId session) { append(RecordKind::SessionClosed, session, 0, {}); }
+        void packet(SessionId session, mal_packet_weaver::UniquePacketID type, std::span<const std::byte> payload)
+        {
+            append(RecordKind::Packet, session, type, payload);
+        }
+
+        void flush()
+        {
+            std::lock_guard lock{ mutex_ };
+            write_buffer();
+            file_.flush();
+        }
+
+    private:
+        void append(RecordKind kind, SessionId session, mal_packet_weaver::UniquePacketID type,
+                    std::span<const std::byte> payload)
+        {
+            std::lock_guard lock{ mutex_ };
+            const auto now = std::chrono::steady_clock::now();
+            buffer_.push_back(static_cast<std::byte>(kind));
+            detail::put_varint(buffer_, session);
+            detail::put_varint(buffer_, static_cast<uint64_t>(
+                                            std::chrono::duration_cast<std::chrono::nanoseconds>(now - previous_).count()));
+            previous_ = now;
+            if (kind == RecordKind::Packet)
+            {
+                detail::put_varint(buffer_, type);
+                detail::put_varint(buffer_, payload.size());
+                buffer_.insert(buffer_.end(), payload.begin(), payload.end());
+            }
+            if (buffer_.size() >= kFlushThreshold)
+            {
+                write_buffer();
+            }
+        }
+
+        void write_buffer()
+        {
+            file_.write(reinterpret_cast<const char *>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+            buffer_.clear();
+        }
+
+        std::mutex mutex_;
+        std::ofstream file_;
+        std::vector<std::byte> buffer_;
+        std::chrono::steady_clock::time_point previous_;
+    };
+
+    /** @brief Reads a whole capture file into memory and iterates its records. */
+    class CaptureReader
+    {
+    public:
+        /** @brief Throws std::runtime_error if the file is missing or isn't a capture. */
+        explicit CaptureReader(std::filesystem::path const &path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+            {
+                throw std::runtime_error("Couldn't open capture file " + path.string());
+            }
+            data_.resize(std::filesystem::file_size(path));
+            file.read(reinterpret_cast<char *>(data_.data()), static_cast<std::streamsize>(data_.size()));
+            if (data_.size() < kHeaderSize || std::memcmp(data_.data(), kMagic.data(), kMagic.size()) != 0)
+            {
+                throw std::runtime_error(path.string() + " is not a capture file");
+            }
+            const auto version =
+                static_cast<uint16_t>(static_cast<uint8_t>(data_[6]) | static_cast<uint8_t>(data_[7]) << 8);
+            if (version != kVersion)
+            {
+                throw std::runtime_error("Unsupported capture version " + std::to_string(version));
+            }
+            remaining_ = std::span<const std::byte>{ data_ }.subspan(kHeaderSize);
+        }
+
+        /** @brief The next record, or nothing at the end. Throws std::runtime_error on a truncated file. */
+        std::optional<CaptureRecord> next()
+        {
+            if (remaining_.empty())
+            {
+                return std::nullopt;
+            }
+            CaptureRecord record;
+            record.kind = static_cast<RecordKind>(remaining_.front());
+            remaining_ = remaining_.subspan(1);
+            record.session = static_cast<SessionId>(detail::get_varint(remaining_));
+            time_ += std::chrono::nanoseconds{ detail::get_varint(remaining_) };
+            record.time = time_;
+            if (record.kind == RecordKind::Packet)
+            {
+                record.packet_type = static_cast<mal_packet_weaver::UniquePacketID>(detail::get_varint(remaining_));
+                const uint64_t size = detail::get_varint(remaining_);
+                if (size > remaining_.size())
+                {
+                    throw std::runtime_error("Truncated capture record");
+                }
+                record.payload = remaining_.first(size);
+                remaining_ = remaining_.subspan(size);
+            }
+            else if (record.kind != RecordKind::SessionOpened && record.kind != RecordKind::SessionClosed)
+            {
+                throw std::runtime_error("Unknown capture record kind");
+            }
+            return record;
+        }
+
+    private:
+        std::vector<std::byte> data_;
+        std::span<const std::byte> remaining_;
+        std::chrono::nanoseconds time_{};
+    };
+}  // namespace pds::capture
@@ -0,0 +1,198 @@
+#pragma once
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include <memory>
+#include <span>
+#include <streambuf>
+#include <string_view>
+#include <vector>
+
+#include "packets/account-trade-info.hpp"
+#include "packets/market-data.hpp"
+#include "packets/node-info.hpp"
+#include "packets/packet-network.hpp"
+
+/**
+ * @brief Packets a capture records: everything clients send after the handshake except the
+ * heartbeat, which the replayer answers on its own.
+ */
+#define PDS_CAPTURED_PACKETS(X)                                                                    \
+    X(EchoPacket)                                                                                  \
+    X(MessagePacket)                                                                               \
+    X(NodeInformationRequest)                                                                      \
+    X(NodeInformationResponse)                                                                     \
+    X(MQL_VersionRequest)                                                                          \
+    X(MQL_VersionResponse)                                                                         \
+    X(AccountInfoDoubleRequest)                                                                    \
+    X(AccountInfoDoubleResponse)                                                                   \
+    X(AccountInfoStringRequest)                                                                    \
+    X(AccountInfoStringResponse)                                                                   \
+    X(AccountInfoIntegerRequest)                                                                   \
+    X(AccountInfoIntegerResponse)                                                                  \
+    X(AccountInfoDoubleMinimalRequest)                                                             \
+    X(AccountInfoDoubleMinimalResponse)                                                            \
+    X(AccountInfoIntegerMinimalRequest)                                                            \
+    X(AccountInfoIntegerMinimalResponse)                                                           \
+    X(AccountInfoMinimalRequest)                                                                   \
+    X(AccountInfoMinimalResponse)                                                                  \
+    X(MQL4FullAccountInfoRequest)                                                                  \
+    X(MQL4FullAccountInfoResponse)                                                                 \
+    X(MQL5AccountInfoIntegerRequest)                                                               \
+    X(MQL5AccountInfoIntegerResponse)                                                              \
+    X(MQL5AccountInfoDoubleRequest)                                                                \
+    X(MQL5AccountInfoDoubleResponse)                                                               \
+    X(MQL5OrderInfoIntegerRequest)                                                                 \
+    X(MQL5OrderInfoIntegerResponse)                                                                \
+    X(MQL5OrderInfoDoubleRequest)                                                                  \
+    X(MQL5OrderInfoDoubleResponse)                                                                 \
+    X(MQL5OrderInfoStringRequest)                                                                  \
+    X(MQL5OrderInfoStringResponse)                                                                 \
+    X(MQL5OrderInfoRequest)                                                                        \
+    X(MQL5OrderInfoResponse)                                                                       \
+    X(MQL5PositionInfoIntegerRequest)                                                              \
+    X(MQL5PositionInfoIntegerResponse)                                                             \
+    X(MQL5PositionInfoDoubleRequest)                                                               \
+    X(MQL5PositionInfoDoubleResponse)                                                              \
+    X(MQL5PositionInfoStringRequest)                                                               \
+    X(MQL5PositionInfoStringResponse)                                                              \
+    X(MQL5PositionInfoRequest)                                                                     \
+    X(MQL5PositionInfoResponse)                                                                    \
+    X(MQL5DealInfoIntegerRequest)                                                                  \
+    X(MQL5DealInfoIntegerResponse)                                                                 \
+    X(MQL5DealInfoDoubleRequest)                                                                   \
+    X(MQL5DealInfoDoubleResponse)                                                                  \
+    X(MQL5DealInfoStringRequest)                                                                   \
+    X(MQL5DealInfoStringResponse)                                                                  \
+    X(MQL5DealInfoRequest)                                                                         \
+    X(MQL5DealInfoResponse)                                                                        \
+    X(MQL4OrderInfoRequest)                                                                        \
+    X(MQL4OrderInfoResponse)                                                                       \
+    X(TradeSubscribeRequest)                                                                       \
+    X(TradeUnsubscribeRequest)                                                                     \
+    X(TradeChannelOpen)                                                                            \
+    X(TradeChannelClose)                                                                           \
+    X(CopierFollow)                                                                                \
+    X(CopierUnfollow)                                                                              \
+    X(CopyTradeCommand)                                                                            \
+    X(SymbolDefinition)                                                                            \
+    X(TickBatch)                                                                                   \
+    X(MarketDataSubscribe)                                                                         \
+    X(MarketDataUnsubscribe)                                                                       \
+    X(BarSubscribe)                                                                                \
+    X(BarUnsubscribe)                                                                              \
+    X(BarUpdate)                                                                                   \
+    X(BarHistoryRequest)                                                                           \
+    X(BarHistoryResponse)
+
+namespace pds::capture
+{
+    /** @brief Calls `visitor.template operator()<Packet>(name)` for every captured packet type. */
+    template <typename Visitor>
+    void for_each_captured_packet(Visitor &&visitor)
+    {
+#define PDS_VISIT_CAPTURED_PACKET(Packet) visitor.template operator()<Packet>(std::string_view{ #Packet });
+        PDS_CAPTURED_PACKETS(PDS_VISIT_CAPTURED_PACKET)
+#undef PDS_VISIT_CAPTURED_PACKET
+    }
+
+    namespace detail
+    {
+        class AppendBuffer : public std::streambuf
+        {
+        public:
+            explicit AppendBuffer(std::vector<std::byte> &out) : out_{ out } {}
+
+        protected:
+            std::streamsize xsputn(const char *s, std::streamsize n) override
+            {
+                const auto *bytes = reinterpret_cast<const std::byte *>(s);
+                out_.insert(out_.end(), bytes, bytes + n);
+                return n;
+            }
+            int_type overflow(int_type c) override
+            {
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                {
+                    out_.push_back(static_cast<std::byte>(c));
+                }
+                return c;
+            }
+
+        private:
+            std::vector<std::byte> &out_;
+        };
+
+        class CountingBuffer : public std::streambuf
+        {
+        public:
+            [[nodiscard]] size_t size() const noexcept { return size_; }
+
+        protected:
+            std::streamsize xsputn(const char *, std::streamsize n) override
+            {
+                size_ += static_cast<size_t>(n);
+                return n;
+            }
+            int_type overflow(int_type c) override
+            {
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                {
+                    ++size_;
+                }
+                return c;
+            }
+
+        private:
+            size_t size_ = 0;
+        };
+
+        class ReadBuffer : public std::streambuf
+        {
+        public:
+            explicit ReadBuffer(std::span<const std::byte> data)
+            {
+                char *begin = const_cast<char *>(reinterpret_cast<const char *>(data.data()));
+                setg(begin, begin, begin + data.size());
+            }
+        };
+    }  // namespace detail
+
+    /** @brief Replaces `out` with the payload a capture stores for `packet`. */
+    template <typename Packet>
+    void encode_packet(Packet const &packet, std::vector<std::byte> &out)
+    {
+        out.clear();
+        detail::AppendBuffer buffer{ out };
+        boost::archive::binary_oarchive archive{ buffer, boost::archive::no_header };
+        archive << packet;
+    }
+
+    /** @brief Size of the payload encode_packet() would produce, without storing it. */
+    template <typename Packet>
+    [[nodiscard]] size_t encoded_size(Packet const &packet)
+    {
+        detail::CountingBuffer buffer;
+        boost::archive::binary_oarchive archive{ buffer, boost::archive::no_header };
+        archive << packet;
+        return buffer.size();
+    }
+
+    /**
+     * @brief Rebuilds a packet from a capture payload; throws boost::archive::archive_exception
+     * if it doesn't hold one.
+     *
+     * @details The packet starts as a copy of a default-constructed one, made once per type:
+     * NodeInformationResponse's constructor samples the host.
+     */
+    template <typename Packet>
+    std::unique_ptr<Packet> decode_packet(std::span<const std::byte> payload)
+    {
+        static const Packet prototype{};
+        auto packet = std::make_unique<Packet>(prototype);
+        detail::ReadBuffer buffer{ payload };
+        boost::archive::binary_iarchive archive{ buffer, boost::archive::no_header };
+        archive >> *packet;
+        return packet;
+    }
+}  // namespace pds::capture
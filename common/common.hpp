@@ -1,20 +1,21 @@
+#pragma once
 #include "packets/packet-crypto.hpp"
 #include "packets/packet-network.hpp"
 
-std::string bytes_to_hex_str(mal_toolkit::ByteView const byte_view)
+inline std::string bytes_to_hex_str(mal_toolkit::ByteView const byte_view)
 {
-    std::string rv;
-    for (int i = 0; i < byte_view.size(); i++)
+    static constexpr std::string_view kHexDigits = "0123456789abcdef";
+    std::string rv(byte_view.size() * 2, '\0');
+    for (size_t i = 0; i < byte_view.size(); i++)
     {
         const uint8_t val = static_cast<uint8_t>(byte_view[i]);
-        const static std::string hex_values = "0123456789abcdef";
-        rv += hex_values[val >> 4];
-        rv += hex_values[val & 0xF];
+        rv[2 * i] = kHexDigits[val >> 4];
+        rv[2 * i + 1] = kHexDigits[val & 0xF];
     }
     return rv;
 }
 
-mal_packet_weaver::crypto::Key read_key(std::filesystem::path const &path)
+inline mal_packet_weaver::crypto::Key read_key(std::filesystem::path const &path)
 {
     mal_packet_weaver::crypto::Key key;
     std::ifstream key_file(path);
@@ -0,0 +1,86 @@
+#pragma once
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/level.hpp>
+#include <boost/serialization/tracking.hpp>
+#include <boost/serialization/vector.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../mql-cpp/common.hpp"
+
+namespace pds::copier
+{
+    /** @brief A master's symbol traded under another name on the follower, e.g. with a broker suffix. */
+    struct SymbolMapping
+    {
+        mql::SymbolString master;
+        mql::SymbolString follower;
+
+    private:
+        friend class boost::serialization::access;
+        template <class Archive>
+        void serialize(Archive &ar, const unsigned int)
+        {
+            ar &master;
+            ar &follower;
+        }
+    };
+
+    /**
+     * @brief How a follower copies the deals of a master: which deals, under which symbol, and
+     * with what volume.
+     */
+    struct CopyRules
+    {
+        /** @brief Follower volume per master lot. */
+        double lot_multiplier = 1.0;
+        /** @brief Volumes are rounded to it; deals that round to zero aren't copied. */
+        double volume_step = 0.01;
+        /** @brief Magic numbers of the master deals to copy; empty copies all of them. */
+        std::vector<int64_t> magics;
+        /** @brief Symbols without a mapping are copied under their own name. */
+        std::vector<SymbolMapping> symbols;
+
+        [[nodiscard]] bool valid() const noexcept
+        {
+            return std::isfinite(lot_multiplier) && lot_multiplier > 0 && std::isfinite(volume_step) &&
+                   volume_step > 0;
+        }
+
+        [[nodiscard]] bool copies_magic(int64_t magic) const noexcept
+        {
+            return magics.empty() || std::ranges::find(magics, magic) != magics.end();
+        }
+
+        [[nodiscard]] mql::SymbolString const &follower_symbol(mql::SymbolString const &master) const noexcept
+        {
+            const auto mapping = std::ranges::find_if(symbols, [&master](SymbolMapping const &mapping)
+                                                      { return mapping.master.view() == master.view(); });
+            return mapping == symbols.end() ? master : mapping->follower;
+        }
+
+        /** @brief Follower volume of a master volume, 0 if it isn't worth a step. */
+        [[nodiscard]] double follower_volume(double master_volume) const noexcept
+        {
+            return std::round(master_volume * lot_multiplier / volume_step) * volume_step;
+        }
+
+    private:
+        friend class boost::serialization::access;
+        template <class Archive>
+        void serialize(Archive &ar, const unsigned int)
+        {
+            ar &lot_multiplier;
+            ar &volume_step;
+            ar &magics;
+            ar &symbols;
+        }
+    };
+}  // namespace pds::copier
+
+BOOST_CLASS_IMPLEMENTATION(pds::copier::SymbolMapping, boost::serialization::object_serializable)
+BOOST_CLASS_TRACKING(pds::copier::SymbolMapping, boost::serialization::track_never)
+BOOST_CLASS_IMPLEMENTATION(pds::copier::CopyRules, boost::serialization::object_serializable)
+BOOST_CLASS_TRACKING(pds::copier::CopyRules, boost::serialization::track_never)
@@ -0,0 +1,196 @@
+#pragma once
+#include <openssl/evp.h>
+
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+#include "mal-packet-weaver/crypto.hpp"
+
+namespace pds::crypto
+{
+    /** @brief Which end of the connection a cipher instance belongs to. */
+    enum class Role : uint32_t
+    {
+        Server = 1,
+        Client = 2
+    };
+
+    /**
+     * @brief AES-256-GCM with one reusable OpenSSL context per direction.
+     *
+     * @details Sealed frames are laid out as [nonce 12][ciphertext][tag 16]. The nonce is the
+     * sender's role followed by a 64-bit counter, so the two directions never reuse a nonce
+     * under the shared key, and the receiver rejects anything that is not strictly newer than
+     * the last frame it accepted, which also stops replays.
+     *
+     * The in-place functions touch no heap memory: the key schedule is set up once and every
+     * packet only re-initializes the IV. The EncryptionInterface overloads allocate exactly
+     * their result, because that interface returns a new ByteArray.
+     */
+    class AesGcm final : public mal_packet_weaver::crypto::EncryptionInterface
+    {
+    public:
+        static constexpr size_t kKeySize = 32;
+        static constexpr size_t kNonceSize = 12;
+        static constexpr size_t kTagSize = 16;
+        static constexpr size_t kOverhead = kNonceSize + kTagSize;
+
+        AesGcm(mal_packet_weaver::ByteView key, Role role)
+            : role_{ role }, peer_role_{ role == Role::Server ? Role::Client : Role::Server }
+        {
+            if (key.size() != kKeySize)
+            {
+                throw std::invalid_argument("AES-256-GCM needs a 32-byte key");
+            }
+            encrypt_ctx_ = make_context(key, true);
+            try
+            {
+                decrypt_ctx_ = make_context(key, false);
+            }
+            catch (...)
+            {
+                EVP_CIPHER_CTX_free(encrypt_ctx_);
+                throw;
+            }
+        }
+        ~AesGcm() override
+        {
+            EVP_CIPHER_CTX_free(encrypt_ctx_);
+            EVP_CIPHER_CTX_free(decrypt_ctx_);
+        }
+
+        AesGcm(AesGcm const &) = delete;
+        AesGcm &operator=(AesGcm const &) = delete;
+
+        /**
+         * @brief Encrypts frame[kNonceSize, size - kTagSize) in place and fills in the nonce and
+         * tag around it.
+         */
+        void seal_in_place(std::span<std::byte> frame) const
+        {
+            if (frame.size() < kOverhead)
+            {
+                throw std::invalid_argument("Frame has no room for the AES-256-GCM overhead");
+            }
+            std::byte *const payload = frame.data() + kNonceSize;
+            const int payload_size = static_cast<int>(frame.size() - kOverhead);
+
+            std::lock_guard lock{ encrypt_mutex_ };
+            const uint64_t counter = ++sent_counter_;
+            const uint32_t role = static_cast<uint32_t>(role_);
+            std::memcpy(frame.data(), &role, sizeof(role));
+            std::memcpy(frame.data() + sizeof(role), &counter, sizeof(counter));
+
+            int written = 0;
+            int final_written = 0;
+            if (EVP_EncryptInit_ex(encrypt_ctx_, nullptr, nullptr, nullptr, as_uchar(frame.data())) != 1 ||
+                EVP_EncryptUpdate(encrypt_ctx_, as_uchar(payload), &written, as_uchar(payload),
+                                  payload_size) != 1 ||
+                EVP_EncryptFinal_ex(encrypt_ctx_, as_uchar(payload + written), &final_written) != 1 ||
+                EVP_CIPHER_CTX_ctrl(encrypt_ctx_, EVP_CTRL_GCM_GET_TAG, kTagSize,
+                                    payload + payload_size) != 1)
+            {
+                throw std::runtime_error("AES-256-GCM encryption failed");
+            }
+        }
+
+        /**
+         * @brief Authenticates and decrypts a sealed frame in place.
+         *
+         * @returns The plaintext inside `frame`, or nothing if the frame was forged, damaged,
+         * replayed or reordered.
+         */
+        [[nodiscard]] std::optional<std::span<std::byte>> open_in_place(
+            std::span<std::byte> frame) const
+        {
+            if (frame.size() < kOverhead)
+            {
+                return std::nullopt;
+            }
+            uint32_t role;
+            uint64_t counter;
+            std::memcpy(&role, frame.data(), sizeof(role));
+            std::memcpy(&counter, frame.data() + sizeof(role), sizeof(counter));
+            std::byte *const payload = frame.data() + kNonceSize;
+            const int payload_size = static_cast<int>(frame.size() - kOverhead);
+
+            std::lock_guard lock{ decrypt_mutex_ };
+            if (role != static_cast<uint32_t>(peer_role_) || counter <= received_counter_)
+            {
+                return std::nullopt;
+            }
+            int written = 0;
+            int final_written = 0;
+            if (EVP_DecryptInit_ex(decrypt_ctx_, nullptr, nullptr, nullptr, as_uchar(frame.data())) != 1 ||
+                EVP_DecryptUpdate(decrypt_ctx_, as_uchar(payload), &written, as_uchar(payload),
+                                  payload_size) != 1 ||
+                EVP_CIPHER_CTX_ctrl(decrypt_ctx_, EVP_CTRL_GCM_SET_TAG, kTagSize,
+                                    payload + payload_size) != 1 ||
+                EVP_DecryptFinal_ex(decrypt_ctx_, as_uchar(payload + written), &final_written) != 1)
+            {
+                return std::nullopt;
+            }
+            received_counter_ = counter;
+            return std::span<std::byte>{ payload, static_cast<size_t>(payload_size) };
+        }
+
+        [[nodiscard]] mal_packet_weaver::ByteArray encrypt(
+            const mal_packet_weaver::ByteView plaintext) const override
+        {
+            mal_packet_weaver::ByteArray frame;
+            frame.resize(plaintext.size() + kOverhead);
+            std::memcpy(frame.data() + kNonceSize, plaintext.data(), plaintext.size());
+            seal_in_place(frame);
+            return frame;
+        }
+
+        /** @brief Throws std::runtime_error if the ciphertext does not authenticate. */
+        [[nodiscard]] mal_packet_weaver::ByteArray decrypt(
+            const mal_packet_weaver::ByteView ciphertext) const override
+        {
+            mal_packet_weaver::ByteArray frame{ ciphertext.begin(), ciphertext.end() };
+            const auto plaintext = open_in_place(frame);
+            if (!plaintext)
+            {
+                throw std::runtime_error("AES-256-GCM frame failed authentication");
+            }
+            std::memmove(frame.data(), plaintext->data(), plaintext->size());
+            frame.resize(plaintext->size());
+            return frame;
+        }
+
+    private:
+        static unsigned char *as_uchar(std::byte *data) noexcept
+        {
+            return reinterpret_cast<unsigned char *>(data);
+        }
+
+        static EVP_CIPHER_CTX *make_context(mal_packet_weaver::ByteView key, bool encrypt)
+        {
+            EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+            const auto *raw_key = reinterpret_cast<const unsigned char *>(key.data());
+            if (ctx == nullptr ||
+                EVP_CipherInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr, encrypt) != 1 ||
+                EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, kNonceSize, nullptr) != 1 ||
+                EVP_CipherInit_ex(ctx, nullptr, nullptr, raw_key, nullptr, encrypt) != 1)
+            {
+                EVP_CIPHER_CTX_free(ctx);
+                throw std::runtime_error("Couldn't initialize AES-256-GCM");
+            }
+            return ctx;
+        }
+
+        const Role role_;
+        const Role peer_role_;
+        EVP_CIPHER_CTX *encrypt_ctx_ = nullptr;
+        EVP_CIPHER_CTX *decrypt_ctx_ = nullptr;
+        // The interface is const, yet every call advances the nonce state of its direction.
+        mutable std::mutex encrypt_mutex_;
+        mutable std::mutex decrypt_mutex_;
+        mutable uint64_t sent_counter_ = 0;
+        mutable uint64_t received_counter_ = 0;
+    };
+}  // namespace pds::crypto
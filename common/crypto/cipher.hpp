@@ -0,0 +1,63 @@
+#pragma once
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "aes-gcm.hpp"
+#include "mal-packet-weaver/crypto.hpp"
+
+namespace pds::crypto
+{
+    /** @brief Session ciphers; the client offers a bitmask of them, the server picks one. */
+    enum class Cipher : uint32_t
+    {
+        /** @brief mal-packet-weaver's AES256, used with peers that offer nothing. */
+        Aes256 = 1u << 0,
+        Aes256Gcm = 1u << 1
+    };
+
+    constexpr uint32_t kSupportedCiphers =
+        static_cast<uint32_t>(Cipher::Aes256) | static_cast<uint32_t>(Cipher::Aes256Gcm);
+
+    /** @brief Strongest cipher both sides support. */
+    [[nodiscard]] constexpr Cipher choose_cipher(uint32_t offered) noexcept
+    {
+        if ((offered & kSupportedCiphers & static_cast<uint32_t>(Cipher::Aes256Gcm)) != 0)
+        {
+            return Cipher::Aes256Gcm;
+        }
+        return Cipher::Aes256;
+    }
+
+    /** @brief The cipher a response names, if it is exactly one of kSupportedCiphers. */
+    [[nodiscard]] constexpr std::optional<Cipher> to_cipher(uint32_t wire_value) noexcept
+    {
+        switch (static_cast<Cipher>(wire_value))
+        {
+            case Cipher::Aes256:
+            case Cipher::Aes256Gcm:
+                return static_cast<Cipher>(wire_value);
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Builds the session encryption from the key derived in the handshake. Throws
+     * std::invalid_argument for a value that isn't a Cipher.
+     */
+    [[nodiscard]] inline std::shared_ptr<mal_packet_weaver::crypto::EncryptionInterface>
+    make_encryption(Cipher cipher, Role role, mal_packet_weaver::ByteArray const &key,
+                    mal_packet_weaver::ByteArray const &salt, int n_rounds)
+    {
+        switch (cipher)
+        {
+            case Cipher::Aes256Gcm:
+                return std::make_shared<AesGcm>(key, role);
+            case Cipher::Aes256:
+                return std::make_shared<mal_packet_weaver::crypto::AES::AES256>(
+                    key, salt, static_cast<uint16_t>(n_rounds));
+        }
+        throw std::invalid_argument("Unknown session cipher " + std::to_string(static_cast<uint32_t>(cipher)));
+    }
+}  // namespace pds::crypto
@@ -0,0 +1,202 @@
+#pragma once
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+
+#include <memory>
+#include <stdexcept>
+
+#include "mal-packet-weaver/crypto.hpp"
+
+namespace pds::crypto
+{
+    namespace detail
+    {
+        struct PkeyDeleter
+        {
+            void operator()(EVP_PKEY *key) const noexcept { EVP_PKEY_free(key); }
+        };
+        struct PkeyCtxDeleter
+        {
+            void operator()(EVP_PKEY_CTX *ctx) const noexcept { EVP_PKEY_CTX_free(ctx); }
+        };
+        struct MdCtxDeleter
+        {
+            void operator()(EVP_MD_CTX *ctx) const noexcept { EVP_MD_CTX_free(ctx); }
+        };
+        struct BioDeleter
+        {
+            void operator()(BIO *bio) const noexcept { BIO_free(bio); }
+        };
+        using Pkey = std::unique_ptr<EVP_PKEY, PkeyDeleter>;
+        using PkeyCtx = std::unique_ptr<EVP_PKEY_CTX, PkeyCtxDeleter>;
+        using MdCtx = std::unique_ptr<EVP_MD_CTX, MdCtxDeleter>;
+        using Bio = std::unique_ptr<BIO, BioDeleter>;
+
+        inline const unsigned char *as_uchar(std::byte const *data) noexcept
+        {
+            return reinterpret_cast<const unsigned char *>(data);
+        }
+        inline unsigned char *as_uchar(std::byte *data) noexcept
+        {
+            return reinterpret_cast<unsigned char *>(data);
+        }
+
+        inline Pkey generate_key(int type)
+        {
+            PkeyCtx ctx{ EVP_PKEY_CTX_new_id(type, nullptr) };
+            EVP_PKEY *key = nullptr;
+            if (!ctx || EVP_PKEY_keygen_init(ctx.get()) != 1 || EVP_PKEY_keygen(ctx.get(), &key) != 1)
+            {
+                throw std::runtime_error("Couldn't generate a curve25519 key");
+            }
+            return Pkey{ key };
+        }
+
+        inline Pkey read_pem(mal_packet_weaver::ByteView pem, bool private_key)
+        {
+            Bio bio{ BIO_new_mem_buf(pem.data(), static_cast<int>(pem.size())) };
+            EVP_PKEY *key = private_key ? PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr)
+                                        : PEM_read_bio_PUBKEY(bio.get(), nullptr, nullptr, nullptr);
+            return Pkey{ key };
+        }
+
+        inline mal_packet_weaver::ByteArray write_pem(EVP_PKEY *key, bool private_key)
+        {
+            Bio bio{ BIO_new(BIO_s_mem()) };
+            const int written =
+                private_key ? PEM_write_bio_PrivateKey(bio.get(), key, nullptr, nullptr, 0, nullptr, nullptr)
+                            : PEM_write_bio_PUBKEY(bio.get(), key);
+            if (written != 1)
+            {
+                throw std::runtime_error("Couldn't encode the key as PEM");
+            }
+            char *data = nullptr;
+            const long size = BIO_get_mem_data(bio.get(), &data);
+            const auto *bytes = reinterpret_cast<const std::byte *>(data);
+            return mal_packet_weaver::ByteArray{ bytes, bytes + size };
+        }
+    }  // namespace detail
+
+    /** @brief True if the PEM holds an Ed25519 key of the given kind. */
+    [[nodiscard]] inline bool is_ed25519_key(mal_packet_weaver::ByteView pem, bool private_key)
+    {
+        const detail::Pkey key = detail::read_pem(pem, private_key);
+        return key && EVP_PKEY_id(key.get()) == EVP_PKEY_ED25519;
+    }
+
+    /** @brief PEM-encoded Ed25519 key pair, in the same format keygen writes for ECDSA. */
+    [[nodiscard]] inline mal_packet_weaver::crypto::KeyPair generate_ed25519_key_pair()
+    {
+        const detail::Pkey key = detail::generate_key(EVP_PKEY_ED25519);
+        mal_packet_weaver::crypto::KeyPair pair;
+        pair.private_key = detail::write_pem(key.get(), true);
+        pair.public_key = detail::write_pem(key.get(), false);
+        return pair;
+    }
+
+    /** @brief Ephemeral X25519 key agreement; one instance per handshake. */
+    class X25519KeyExchange
+    {
+    public:
+        static constexpr size_t kKeySize = 32;
+
+        X25519KeyExchange() : key_{ detail::generate_key(EVP_PKEY_X25519) } {}
+
+        [[nodiscard]] mal_packet_weaver::ByteArray public_key() const
+        {
+            mal_packet_weaver::ByteArray raw;
+            raw.resize(kKeySize);
+            size_t size = raw.size();
+            if (EVP_PKEY_get_raw_public_key(key_.get(), detail::as_uchar(raw.data()), &size) != 1)
+            {
+                throw std::runtime_error("Couldn't export the X25519 public key");
+            }
+            return raw;
+        }
+
+        /** @brief Throws std::invalid_argument for malformed or low-order peer keys. */
+        [[nodiscard]] mal_packet_weaver::ByteArray shared_secret(
+            mal_packet_weaver::ByteView peer_public_key) const
+        {
+            const detail::Pkey peer{ EVP_PKEY_new_raw_public_key(
+                EVP_PKEY_X25519, nullptr, detail::as_uchar(peer_public_key.data()),
+                peer_public_key.size()) };
+            detail::PkeyCtx ctx{ EVP_PKEY_CTX_new(key_.get(), nullptr) };
+            mal_packet_weaver::ByteArray secret;
+            secret.resize(kKeySize);
+            size_t size = secret.size();
+            // OpenSSL rejects an all-zero result, which is what low-order points produce.
+            if (!peer || !ctx || EVP_PKEY_derive_init(ctx.get()) != 1 ||
+                EVP_PKEY_derive_set_peer(ctx.get(), peer.get()) != 1 ||
+                EVP_PKEY_derive(ctx.get(), detail::as_uchar(secret.data()), &size) != 1)
+            {
+                throw std::invalid_argument("Invalid X25519 peer key");
+            }
+            return secret;
+        }
+
+    private:
+        detail::Pkey key_;
+    };
+
+    class Ed25519Signer
+    {
+    public:
+        static constexpr size_t kSignatureSize = 64;
+
+        explicit Ed25519Signer(mal_packet_weaver::ByteView private_key_pem)
+            : key_{ detail::read_pem(private_key_pem, true) }
+        {
+            if (!key_ || EVP_PKEY_id(key_.get()) != EVP_PKEY_ED25519)
+            {
+                throw std::invalid_argument("Not an Ed25519 private key");
+            }
+        }
+
+        [[nodiscard]] mal_packet_weaver::ByteArray sign(mal_packet_weaver::ByteView message) const
+        {
+            detail::MdCtx ctx{ EVP_MD_CTX_new() };
+            mal_packet_weaver::ByteArray signature;
+            signature.resize(kSignatureSize);
+            size_t size = signature.size();
+            // Ed25519 hashes internally, so no digest is configured.
+            if (!ctx || EVP_DigestSignInit(ctx.get(), nullptr, nullptr, nullptr, key_.get()) != 1 ||
+                EVP_DigestSign(ctx.get(), detail::as_uchar(signature.data()), &size,
+                               detail::as_uchar(message.data()), message.size()) != 1)
+            {
+                throw std::runtime_error("Ed25519 signing failed");
+            }
+            return signature;
+        }
+
+    private:
+        detail::Pkey key_;
+    };
+
+    class Ed25519Verifier
+    {
+    public:
+        explicit Ed25519Verifier(mal_packet_weaver::ByteView public_key_pem)
+            : key_{ detail::read_pem(public_key_pem, false) }
+        {
+            if (!key_ || EVP_PKEY_id(key_.get()) != EVP_PKEY_ED25519)
+            {
+                throw std::invalid_argument("Not an Ed25519 public key");
+            }
+        }
+
+        [[nodiscard]] bool verify(mal_packet_weaver::ByteView message,
+                                  mal_packet_weaver::ByteView signature) const
+        {
+            detail::MdCtx ctx{ EVP_MD_CTX_new() };
+            return ctx &&
+                   EVP_DigestVerifyInit(ctx.get(), nullptr, nullptr, nullptr, key_.get()) == 1 &&
+                   EVP_DigestVerify(ctx.get(), detail::as_uchar(signature.data()), signature.size(),
+                                    detail::as_uchar(message.data()), message.size()) == 1;
+        }
+
+    private:
+        detail::Pkey key_;
+    };
+}  // namespace pds::crypto
@@ -0,0 +1,325 @@
+#pragma once
+#include <openssl/rand.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <variant>
+
+#include "../packets/packet-crypto.hpp"
+#include "cipher.hpp"
+#include "curve25519.hpp"
+#include "mal-packet-weaver/crypto.hpp"
+
+namespace pds::crypto
+{
+    /**
+     * @brief Key agreement and server signature used by the DHKeyExchange packets.
+     *
+     * @details The suite follows the server key: keygen's secp curves give DhEcdsa, an Ed25519
+     * key gives X25519Ed25519. The latter needs one fixed-base and one variable-base scalar
+     * multiplication on each side instead of full ECDH and ECDSA, which is what dominates CPU
+     * when many terminals reconnect at once.
+     */
+    enum class HandshakeSuite : uint32_t
+    {
+        DhEcdsa = 1,
+        X25519Ed25519 = 2
+    };
+
+    [[nodiscard]] constexpr std::string_view to_string(HandshakeSuite suite) noexcept
+    {
+        switch (suite)
+        {
+            case HandshakeSuite::DhEcdsa:
+                return "dh-ecdsa";
+            case HandshakeSuite::X25519Ed25519:
+                return "x25519-ed25519";
+        }
+        return "unknown";
+    }
+
+    /** @brief Suite named in a request; peers that predate the field send zero. */
+    [[nodiscard]] constexpr HandshakeSuite requested_suite(uint32_t wire_value) noexcept
+    {
+        return wire_value == 0 ? HandshakeSuite::DhEcdsa : static_cast<HandshakeSuite>(wire_value);
+    }
+
+    /** @brief SHA-256 of the shared secret followed by the salt, as both suites derive it. */
+    [[nodiscard]] inline mal_packet_weaver::ByteArray derive_session_key(
+        mal_packet_weaver::ByteArray shared_secret, mal_packet_weaver::ByteArray const &salt)
+    {
+        shared_secret.append(salt);
+        return mal_packet_weaver::crypto::SHA::ComputeHash(shared_secret,
+                                                           mal_packet_weaver::crypto::Hash::HashType::SHA256)
+            .hash_value;
+    }
+
+    /**
+     * @brief Time one side of a handshake spent in each step, filled in when a caller asks for
+     * it. Signing is the server's, verification the client's; the rest exist on both sides.
+     */
+    struct HandshakeTimings
+    {
+        std::chrono::nanoseconds key_generation{};
+        std::chrono::nanoseconds key_agreement{};
+        std::chrono::nanoseconds signature{};
+        std::chrono::nanoseconds verification{};
+        std::chrono::nanoseconds key_derivation{};
+    };
+
+    namespace detail
+    {
+        /** @brief Adds the time since the previous lap to a HandshakeTimings field; free without one. */
+        class HandshakeStopwatch
+        {
+        public:
+            using Phase = std::chrono::nanoseconds HandshakeTimings::*;
+
+            explicit HandshakeStopwatch(HandshakeTimings *timings) noexcept
+                : timings_{ timings }, last_{ timings ? Clock::now() : Clock::time_point{} }
+            {
+            }
+
+            /** @param phase Field to charge, or nullptr to skip the time since the last lap. */
+            void lap(Phase phase) noexcept
+            {
+                if (timings_ == nullptr)
+                {
+                    return;
+                }
+                const auto now = Clock::now();
+                if (phase != nullptr)
+                {
+                    timings_->*phase += now - last_;
+                }
+                last_ = now;
+            }
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            HandshakeTimings *timings_;
+            Clock::time_point last_;
+        };
+    }  // namespace detail
+
+    /** @brief The server's long-term signing key, of either suite. */
+    class ServerIdentity
+    {
+    public:
+        explicit ServerIdentity(mal_packet_weaver::crypto::Key const &private_key_pem)
+        {
+            if (is_ed25519_key(private_key_pem, true))
+            {
+                signer_.emplace<Ed25519Signer>(private_key_pem);
+            }
+            else
+            {
+                signer_.emplace<std::unique_ptr<mal_packet_weaver::crypto::ECDSA::Signer>>(
+                    std::make_unique<mal_packet_weaver::crypto::ECDSA::Signer>(
+                        private_key_pem, mal_packet_weaver::crypto::Hash::HashType::SHA256));
+            }
+        }
+
+        [[nodiscard]] HandshakeSuite suite() const noexcept
+        {
+            return std::holds_alternative<Ed25519Signer>(signer_) ? HandshakeSuite::X25519Ed25519
+                                                                  : HandshakeSuite::DhEcdsa;
+        }
+
+        [[nodiscard]] mal_packet_weaver::ByteArray sign(mal_packet_weaver::crypto::Hash const &hash) const
+        {
+            if (const auto *ed25519 = std::get_if<Ed25519Signer>(&signer_))
+            {
+                return ed25519->sign(hash.hash_value);
+            }
+            return std::get<0>(signer_)->sign_hash(hash);
+        }
+
+    private:
+        std::variant<std::unique_ptr<mal_packet_weaver::crypto::ECDSA::Signer>, Ed25519Signer> signer_;
+    };
+
+    /** @brief The server public key a client trusts, of either suite. */
+    class ServerTrust
+    {
+    public:
+        explicit ServerTrust(mal_packet_weaver::crypto::Key const &public_key_pem)
+        {
+            if (is_ed25519_key(public_key_pem, false))
+            {
+                verifier_.emplace<Ed25519Verifier>(public_key_pem);
+            }
+            else
+            {
+                verifier_.emplace<std::unique_ptr<mal_packet_weaver::crypto::ECDSA::Verifier>>(
+                    std::make_unique<mal_packet_weaver::crypto::ECDSA::Verifier>(
+                        public_key_pem, mal_packet_weaver::crypto::Hash::HashType::SHA256));
+            }
+        }
+
+        [[nodiscard]] HandshakeSuite suite() const noexcept
+        {
+            return std::holds_alternative<Ed25519Verifier>(verifier_) ? HandshakeSuite::X25519Ed25519
+                                                                      : HandshakeSuite::DhEcdsa;
+        }
+
+        [[nodiscard]] bool verify(mal_packet_weaver::crypto::Hash const &hash,
+                                  mal_packet_weaver::ByteView signature) const
+        {
+            if (const auto *ed25519 = std::get_if<Ed25519Verifier>(&verifier_))
+            {
+                return ed25519->verify(hash.hash_value, signature);
+            }
+            return std::get<0>(verifier_)->verify_hash(hash, signature);
+        }
+
+    private:
+        std::variant<std::unique_ptr<mal_packet_weaver::crypto::ECDSA::Verifier>, Ed25519Verifier> verifier_;
+    };
+
+    struct ServerHandshake
+    {
+        DHKeyExchangeResponsePacket response;
+        std::shared_ptr<mal_packet_weaver::crypto::EncryptionInterface> encryption;
+    };
+
+    /**
+     * @brief Server half of the handshake: answers a request and builds the session encryption.
+     *
+     * @param timings If set, the time of every step is added to it.
+     * @returns Nothing if the request is for a suite the server key can't sign. Throws
+     * std::invalid_argument if the client's public key is malformed.
+     */
+    [[nodiscard]] inline std::optional<ServerHandshake> accept_key_exchange(
+        ServerIdentity const &identity, DHKeyExchangeRequestPacket const &request,
+        HandshakeTimings *timings = nullptr)
+    {
+        const HandshakeSuite suite = requested_suite(request.suite);
+        if (suite != identity.suite())
+        {
+            return std::nullopt;
+        }
+
+        detail::HandshakeStopwatch stopwatch{ timings };
+        ServerHandshake handshake;
+        DHKeyExchangeResponsePacket &response = handshake.response;
+        mal_packet_weaver::ByteArray shared_secret;
+        if (suite == HandshakeSuite::X25519Ed25519)
+        {
+            const X25519KeyExchange exchange;
+            response.public_key = exchange.public_key();
+            stopwatch.lap(&HandshakeTimings::key_generation);
+            shared_secret = exchange.shared_secret(request.public_key);
+        }
+        else
+        {
+            const mal_packet_weaver::crypto::DiffieHellmanHelper dh{};
+            response.public_key = dh.get_public_key();
+            stopwatch.lap(&HandshakeTimings::key_generation);
+            shared_secret = dh.get_shared_secret(request.public_key);
+        }
+        stopwatch.lap(&HandshakeTimings::key_agreement);
+
+        response.salt.resize(8);
+        if (RAND_bytes(reinterpret_cast<unsigned char *>(response.salt.data()),
+                       static_cast<int>(response.salt.size())) != 1)
+        {
+            throw std::runtime_error("Couldn't generate the handshake salt");
+        }
+        thread_local std::mt19937_64 rng{ std::random_device{}() };
+        response.n_rounds =
+            std::clamp(5 + static_cast<int>(std::chi_squared_distribution<float>(2)(rng)), 5, 20);
+
+        const Cipher cipher = choose_cipher(request.ciphers);
+        response.cipher = static_cast<uint32_t>(cipher);
+        response.suite = static_cast<uint32_t>(suite);
+        stopwatch.lap(nullptr);
+        response.signature = identity.sign(response.get_hash(request));
+        stopwatch.lap(&HandshakeTimings::signature);
+
+        handshake.encryption = make_encryption(cipher, Role::Server,
+                                               derive_session_key(std::move(shared_secret), response.salt),
+                                               response.salt, response.n_rounds);
+        stopwatch.lap(&HandshakeTimings::key_derivation);
+        return handshake;
+    }
+
+    /** @brief Client half of the handshake; holds the ephemeral key between request and response. */
+    class ClientHandshake
+    {
+    public:
+        /**
+         * @param key_id Which key of the server's keyring `trust` belongs to; zero for its default.
+         * @param timings If set, the time of every step on this side is added to it.
+         */
+        explicit ClientHandshake(ServerTrust const &trust, uint32_t key_id = 0, HandshakeTimings *timings = nullptr)
+            : trust_{ trust }, key_id_{ key_id }, timings_{ timings }
+        {
+            detail::HandshakeStopwatch stopwatch{ timings_ };
+            if (trust_.suite() == HandshakeSuite::X25519Ed25519)
+            {
+                x25519_ = std::make_unique<X25519KeyExchange>();
+            }
+            else
+            {
+                dh_ = std::make_unique<mal_packet_weaver::crypto::DiffieHellmanHelper>();
+            }
+            stopwatch.lap(&HandshakeTimings::key_generation);
+            request_.public_key = x25519_ ? x25519_->public_key() : dh_->get_public_key();
+            request_.ciphers = kSupportedCiphers;
+            request_.suite = static_cast<uint32_t>(trust_.suite());
+            request_.key_id = key_id_;
+        }
+
+        [[nodiscard]] DHKeyExchangeRequestPacket const &request() const noexcept { return request_; }
+
+        /**
+         * @returns The session encryption, or nullptr if the response is not signed by the
+         * trusted key over this request, names another suite, or picks a cipher that wasn't
+         * offered.
+         */
+        [[nodiscard]] std::shared_ptr<mal_packet_weaver::crypto::EncryptionInterface> finish(
+            DHKeyExchangeResponsePacket const &response) const
+        {
+            detail::HandshakeStopwatch stopwatch{ timings_ };
+            const std::optional<Cipher> cipher = to_cipher(response.cipher);
+            if (response.suite != static_cast<uint32_t>(trust_.suite()) || !cipher ||
+                (response.cipher & request_.ciphers) == 0 ||
+                !trust_.verify(response.get_hash(request_), response.signature))
+            {
+                return nullptr;
+            }
+            stopwatch.lap(&HandshakeTimings::verification);
+            mal_packet_weaver::ByteArray shared_secret;
+            try
+            {
+                shared_secret = x25519_ ? x25519_->shared_secret(response.public_key)
+                                        : dh_->get_shared_secret(response.public_key);
+            }
+            catch (const std::invalid_argument &)
+            {
+                return nullptr;
+            }
+            stopwatch.lap(&HandshakeTimings::key_agreement);
+            auto encryption = make_encryption(*cipher, Role::Client,
+                                              derive_session_key(std::move(shared_secret), response.salt),
+                                              response.salt, response.n_rounds);
+            stopwatch.lap(&HandshakeTimings::key_derivation);
+            return encryption;
+        }
+
+    private:
+        ServerTrust const &trust_;
+        const uint32_t key_id_;
+        HandshakeTimings *const timings_;
+        std::unique_ptr<mal_packet_weaver::crypto::DiffieHellmanHelper> dh_;
+        std::unique_ptr<X25519KeyExchange> x25519_;
+        DHKeyExchangeRequestPacket request_;
+    };
+}  // namespace pds::crypto
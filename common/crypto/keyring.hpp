@@ -0,0 +1,197 @@
+#pragma once
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <openssl/x509.h>
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "curve25519.hpp"
+#include "mal-packet-weaver/crypto.hpp"
+
+namespace pds::crypto
+{
+    /**
+     * @brief Read-only view of a PEM file with any number of keys, such as keygen's merged
+     * output, with every key parsed on first use only.
+     *
+     * @details Opening maps the file and records where each PEM block starts and ends, which
+     * takes milliseconds for tens of thousands of keys. `Key` is built from the PEM bytes the
+     * first time its id is looked up and cached for the lifetime of the keyring, so a server
+     * parses each tenant key once instead of on every connection. Lookups after that are
+     * lock-free.
+     *
+     * Key ids are 1-based positions in the file, matching the privateN/publicN numbering of
+     * keygen's separate output. Fingerprints are the lowercase hex SHA-256 of a key's public half
+     * in DER, so a server's private key and the public key its clients trust have the same one;
+     * their index is built on the first fingerprint lookup, which parses every block.
+     *
+     * @tparam Key Constructible from a mal_packet_weaver::crypto::Key holding one PEM block,
+     * e.g. ServerIdentity or ServerTrust.
+     */
+    template <typename Key>
+    class Keyring
+    {
+    public:
+        using KeyId = uint32_t;
+
+        /** @brief Throws std::invalid_argument if the file can't be mapped or holds no keys. */
+        explicit Keyring(std::filesystem::path const &path)
+        {
+            if (!std::filesystem::exists(path) || std::filesystem::file_size(path) == 0)
+            {
+                throw std::invalid_argument("Keyring file is missing or empty: " + path.string());
+            }
+            try
+            {
+                file_ = boost::interprocess::file_mapping(path.string().c_str(),
+                                                          boost::interprocess::read_only);
+                region_ = boost::interprocess::mapped_region(file_, boost::interprocess::read_only);
+            }
+            catch (const boost::interprocess::interprocess_exception &e)
+            {
+                throw std::invalid_argument("Couldn't map keyring " + path.string() + ": " + e.what());
+            }
+
+            const std::string_view contents{ static_cast<const char *>(region_.get_address()),
+                                             region_.get_size() };
+            std::vector<std::string_view> blocks;
+            for (size_t begin = contents.find(kBeginMarker); begin != std::string_view::npos;
+                 begin = contents.find(kBeginMarker, begin))
+            {
+                const size_t end_marker = contents.find(kEndMarker, begin);
+                if (end_marker == std::string_view::npos)
+                {
+                    throw std::invalid_argument("Truncated PEM block in keyring " + path.string());
+                }
+                size_t end = contents.find('\n', end_marker);
+                end = end == std::string_view::npos ? contents.size() : end + 1;
+                blocks.emplace_back(contents.substr(begin, end - begin));
+                begin = end;
+            }
+            if (blocks.empty())
+            {
+                throw std::invalid_argument("No PEM keys in keyring " + path.string());
+            }
+
+            size_ = blocks.size();
+            entries_ = std::make_unique<Entry[]>(size_);
+            for (size_t i = 0; i < size_; i++)
+            {
+                entries_[i].pem = blocks[i];
+            }
+        }
+
+        Keyring(Keyring const &) = delete;
+        Keyring &operator=(Keyring const &) = delete;
+
+        [[nodiscard]] size_t size() const noexcept { return size_; }
+        [[nodiscard]] bool contains(KeyId id) const noexcept { return id >= 1 && id <= size_; }
+
+        /** @brief The PEM block of a key, pointing into the mapping. */
+        [[nodiscard]] std::string_view pem(KeyId id) const { return entry(id).pem; }
+
+        /**
+         * @brief The parsed key, built on the first call for this id.
+         *
+         * @details Throws std::out_of_range for unknown ids; a key that fails to parse throws
+         * whatever `Key` throws, every time it is asked for.
+         */
+        [[nodiscard]] Key const &get(KeyId id) const
+        {
+            Entry &e = entry(id);
+            std::call_once(e.parsed,
+                           [&e]()
+                           {
+                               const auto *bytes = reinterpret_cast<const std::byte *>(e.pem.data());
+                               e.key = std::make_unique<Key>(
+                                   mal_packet_weaver::crypto::Key{ bytes, bytes + e.pem.size() });
+                           });
+            return *e.key;
+        }
+
+        /** @brief Throws std::invalid_argument if a block of the keyring doesn't parse. */
+        [[nodiscard]] std::optional<KeyId> find_by_fingerprint(std::string_view value) const
+        {
+            std::call_once(fingerprints_built_,
+                           [this]()
+                           {
+                               fingerprints_.reserve(size_);
+                               for (KeyId id = 1; id <= size_; id++)
+                               {
+                                   fingerprints_.emplace(fingerprint(id), id);
+                               }
+                           });
+            const auto it = fingerprints_.find(std::string{ value });
+            if (it == fingerprints_.end())
+            {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+
+        /** @brief Throws std::invalid_argument if the block doesn't parse. */
+        [[nodiscard]] std::string fingerprint(KeyId id) const
+        {
+            const std::string_view block = pem(id);
+            const auto *bytes = reinterpret_cast<const std::byte *>(block.data());
+            const bool private_key = !block.starts_with(kPublicKeyMarker);
+            const detail::Pkey key = detail::read_pem(mal_packet_weaver::ByteView{ bytes, block.size() }, private_key);
+            const int size = key ? i2d_PUBKEY(key.get(), nullptr) : -1;
+            if (size <= 0)
+            {
+                throw std::invalid_argument("Couldn't parse key " + std::to_string(id) + " of the keyring");
+            }
+            mal_packet_weaver::ByteArray der;
+            der.resize(static_cast<size_t>(size));
+            unsigned char *out = detail::as_uchar(der.data());
+            i2d_PUBKEY(key.get(), &out);
+            const auto hash = mal_packet_weaver::crypto::SHA::ComputeHash(
+                der, mal_packet_weaver::crypto::Hash::HashType::SHA256);
+            static constexpr std::string_view kHexDigits = "0123456789abcdef";
+            std::string result;
+            result.reserve(hash.hash_value.size() * 2);
+            for (const std::byte byte : hash.hash_value)
+            {
+                result += kHexDigits[static_cast<uint8_t>(byte) >> 4];
+                result += kHexDigits[static_cast<uint8_t>(byte) & 0xF];
+            }
+            return result;
+        }
+
+    private:
+        static constexpr std::string_view kBeginMarker = "-----BEGIN ";
+        static constexpr std::string_view kEndMarker = "-----END ";
+        static constexpr std::string_view kPublicKeyMarker = "-----BEGIN PUBLIC KEY-----";
+
+        struct Entry
+        {
+            std::string_view pem;
+            std::once_flag parsed;
+            std::unique_ptr<Key> key;
+        };
+
+        Entry &entry(KeyId id) const
+        {
+            if (!contains(id))
+            {
+                throw std::out_of_range("Unknown key id " + std::to_string(id));
+            }
+            return entries_[id - 1];
+        }
+
+        boost::interprocess::file_mapping file_;
+        boost::interprocess::mapped_region region_;
+        size_t size_ = 0;
+        std::unique_ptr<Entry[]> entries_;
+        mutable std::once_flag fingerprints_built_;
+        mutable std::unordered_map<std::string, KeyId> fingerprints_;
+    };
+}  // namespace pds::crypto
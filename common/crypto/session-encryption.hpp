@@ -0,0 +1,50 @@
+#pragma once
+#include <boost/asio/awaitable.hpp>
+
+#include "handshake.hpp"
+#include "mal-packet-weaver/dispatcher-session.hpp"
+
+namespace pds::crypto
+{
+    /** @brief Seconds a client waits for the server's handshake response. */
+    constexpr float kHandshakeTimeout = 10.0f;
+
+    /**
+     * @brief Client side of the handshake over a session: sends the request, waits for the
+     * response and switches the session to the negotiated cipher.
+     *
+     * @returns false, with the session destroyed, if no response arrives within
+     * kHandshakeTimeout, e.g. because the server rejected the key or suite, or if it isn't
+     * signed by `trust` or doesn't match the request (see ClientHandshake::finish).
+     */
+    inline boost::asio::awaitable<bool> setup_encryption_for_session(
+        mal_packet_weaver::DispatcherSession &dispatcher_session, ServerTrust const &trust, uint32_t key_id)
+    {
+        // Initiate encryption by sending the ephemeral public key of the trusted key's suite.
+        const ClientHandshake handshake{ trust, key_id };
+        dispatcher_session.send_packet(handshake.request());
+
+        // Wait for the response using dispatcher.
+        auto response = co_await dispatcher_session.await_packet<DHKeyExchangeResponsePacket>(kHandshakeTimeout);
+        if (!response)
+        {
+            spdlog::error("The server didn't answer the encryption request. Aborting connection.");
+            dispatcher_session.Destroy();
+            co_return false;
+        }
+
+        // The signature covers our request and the cipher and suite the server picked.
+        auto encryption = handshake.finish(*response);
+        if (!encryption)
+        {
+            spdlog::error("encryption response packet has the wrong signature or a cipher we didn't offer. "
+                          "Aborting connection.");
+            dispatcher_session.Destroy();
+            co_return false;
+        }
+
+        // setup the encryption for the connection using the cipher the server picked.
+        dispatcher_session.setup_encryption(encryption);
+        co_return true;
+    }
+}  // namespace pds::crypto
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace pds::ipc
+{
+    /**
+     * @brief Two copies of a value: readers are wait-free, a writer changes the copy nobody
+     * reads and then swaps them (the Left-Right technique of Ramalhete and Correia).
+     *
+     * @details A reader announces itself on one of two read indicators and reads whichever copy
+     * is current, with no retry and no lock. A writer applies its change to the idle copy,
+     * points readers at it, waits until every reader that could still be in the old copy has
+     * left and applies the same change there. Changes are therefore applied twice and have to
+     * be deterministic; do the expensive part, e.g. conversions, before calling modify().
+     *
+     * Writers are serialized among themselves and wait for at most one read each; readers
+     * never wait. Suits state that is read far more often than it changes, e.g. at tick
+     * frequency, and that may be large or change size.
+     */
+    template <typename T>
+    class LeftRight
+    {
+    public:
+        LeftRight() = default;
+        LeftRight(LeftRight const &) = delete;
+        LeftRight &operator=(LeftRight const &) = delete;
+
+        /** @brief Calls read with the current copy; any thread, never blocks. */
+        template <typename Read>
+        decltype(auto) read(Read &&read) const
+        {
+            const uint32_t indicator = version_index_.load(std::memory_order_seq_cst);
+            readers_[indicator].count.fetch_add(1, std::memory_order_seq_cst);
+            struct Departure
+            {
+                std::atomic<int64_t> &count;
+                ~Departure() { count.fetch_sub(1, std::memory_order_release); }
+            } departure{ readers_[indicator].count };
+            return read(instances_[left_right_.load(std::memory_order_seq_cst)]);
+        }
+
+        /** @brief Applies modify to both copies, one after the other; see the class comment. */
+        template <typename Modify>
+        void modify(Modify &&modify)
+        {
+            std::lock_guard lock{ writer_mutex_ };
+            const uint32_t current = left_right_.load(std::memory_order_relaxed);
+            modify(instances_[1 - current]);
+            left_right_.store(1 - current, std::memory_order_seq_cst);
+
+            // Readers may have read the old left_right_ under either indicator: flip the
+            // version and drain both, the idle one first so that no new reader starves us.
+            const uint32_t previous = version_index_.load(std::memory_order_relaxed);
+            wait_for_readers(1 - previous);
+            version_index_.store(1 - previous, std::memory_order_seq_cst);
+            wait_for_readers(previous);
+
+            modify(instances_[current]);
+        }
+
+    private:
+        void wait_for_readers(uint32_t indicator) const noexcept
+        {
+            while (readers_[indicator].count.load(std::memory_order_acquire) != 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        struct alignas(64) ReadIndicator
+        {
+            std::atomic<int64_t> count = 0;
+        };
+
+        T instances_[2]{};
+        alignas(64) std::atomic<uint32_t> left_right_ = 0;
+        std::atomic<uint32_t> version_index_ = 0;
+        mutable ReadIndicator readers_[2];
+        std::mutex writer_mutex_;
+    };
+}  // namespace pds::ipc
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace pds::ipc
+{
+    /**
+     * @brief Bounded lock-free multi-producer/single-consumer queue of trivially copyable values
+     * within one process.
+     *
+     * @details Every cell carries a sequence number telling whose turn it is: a producer claims
+     * a position with one CAS on the tail and publishes the cell by bumping its sequence, the
+     * consumer reads cells in order and hands them back one lap later. A full queue fails the
+     * push instead of waiting, so producers never block on the consumer.
+     */
+    template <typename T>
+    class MpscQueue
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Values are copied into preallocated cells");
+
+    public:
+        /** @param capacity Has to be a power of two. */
+        explicit MpscQueue(size_t capacity)
+            : cells_{ std::make_unique<Cell[]>(capacity) }, mask_{ capacity - 1 }
+        {
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        /** @brief Producer side, any thread. Returns false if the queue is full. */
+        [[nodiscard]] bool try_push(T const &value) noexcept
+        {
+            uint64_t position = tail_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell &cell = cells_[position & mask_];
+                const uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto lag = static_cast<int64_t>(sequence - position);
+                if (lag == 0)
+                {
+                    if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        cell.value = value;
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (lag < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** @brief Consumer side, one thread only. Returns false if nothing is published yet. */
+        [[nodiscard]] bool try_pop(T &value) noexcept
+        {
+            Cell &cell = cells_[head_ & mask_];
+            if (cell.sequence.load(std::memory_order_acquire) != head_ + 1)
+            {
+                return false;
+            }
+            value = cell.value;
+            cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+            ++head_;
+            return true;
+        }
+
+        [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+
+    private:
+        struct Cell
+        {
+            std::atomic<uint64_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> cells_;
+        const size_t mask_;
+        alignas(64) std::atomic<uint64_t> tail_ = 0;
+        // Only touched by the consumer.
+        alignas(64) uint64_t head_ = 0;
+    };
+}  // namespace pds::ipc
@@ -0,0 +1,238 @@
+#include "shared-memory.hpp"
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <climits>
+#endif
+#else
+#error "Unsupported operating system"
+#endif
+
+namespace pds::ipc
+{
+    namespace
+    {
+        [[noreturn]] void throw_last_error(std::string const &what)
+        {
+#ifdef _WIN32
+            throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), what);
+#else
+            throw std::system_error(errno, std::generic_category(), what);
+#endif
+        }
+
+#ifdef _WIN32
+        std::wstring to_wide(std::string const &name)
+        {
+            return std::wstring(name.begin(), name.end());
+        }
+#else
+        // POSIX shm names are a single path component starting with a slash.
+        std::string posix_name(std::string const &name) { return "/" + name; }
+#endif
+    }  // namespace
+
+    SharedMemoryRegion SharedMemoryRegion::create(std::string const &name, size_t size)
+    {
+        SharedMemoryRegion region;
+        region.name_ = name;
+        region.size_ = size;
+        region.owner_ = true;
+#ifdef _WIN32
+        const auto wide_name = to_wide("Local\\" + name);
+        region.mapping_ = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                             static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                             static_cast<DWORD>(size & 0xFFFFFFFFu),
+                                             wide_name.c_str());
+        if (region.mapping_ == nullptr)
+        {
+            throw_last_error("CreateFileMapping " + name);
+        }
+        region.data_ = MapViewOfFile(region.mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (region.data_ == nullptr)
+        {
+            throw_last_error("MapViewOfFile " + name);
+        }
+#else
+        const std::string shm_name = posix_name(name);
+        // A crashed owner may have left the name behind.
+        shm_unlink(shm_name.c_str());
+        const int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+        {
+            throw_last_error("shm_open " + name);
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+        {
+            ::close(fd);
+            shm_unlink(shm_name.c_str());
+            throw_last_error("ftruncate " + name);
+        }
+        void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            shm_unlink(shm_name.c_str());
+            throw_last_error("mmap " + name);
+        }
+        region.data_ = data;
+#endif
+        return region;
+    }
+
+    SharedMemoryRegion SharedMemoryRegion::open(std::string const &name)
+    {
+        SharedMemoryRegion region;
+        region.name_ = name;
+#ifdef _WIN32
+        const auto wide_name = to_wide("Local\\" + name);
+        region.mapping_ = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, wide_name.c_str());
+        if (region.mapping_ == nullptr)
+        {
+            throw_last_error("OpenFileMapping " + name);
+        }
+        region.data_ = MapViewOfFile(region.mapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        if (region.data_ == nullptr)
+        {
+            throw_last_error("MapViewOfFile " + name);
+        }
+        MEMORY_BASIC_INFORMATION info{};
+        VirtualQuery(region.data_, &info, sizeof(info));
+        region.size_ = info.RegionSize;
+#else
+        const int fd = shm_open(posix_name(name).c_str(), O_RDWR, 0600);
+        if (fd < 0)
+        {
+            throw_last_error("shm_open " + name);
+        }
+        struct stat info{};
+        if (fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            throw_last_error("fstat " + name);
+        }
+        region.size_ = static_cast<size_t>(info.st_size);
+        void *data = mmap(nullptr, region.size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            throw_last_error("mmap " + name);
+        }
+        region.data_ = data;
+#endif
+        return region;
+    }
+
+    SharedMemoryRegion::SharedMemoryRegion(SharedMemoryRegion &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    SharedMemoryRegion &SharedMemoryRegion::operator=(SharedMemoryRegion &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            name_ = std::move(other.name_);
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            owner_ = std::exchange(other.owner_, false);
+#ifdef _WIN32
+            mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    SharedMemoryRegion::~SharedMemoryRegion() { close(); }
+
+    void SharedMemoryRegion::close() noexcept
+    {
+#ifdef _WIN32
+        if (data_ != nullptr)
+        {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_ != nullptr)
+        {
+            CloseHandle(mapping_);
+            mapping_ = nullptr;
+        }
+#else
+        if (data_ != nullptr)
+        {
+            munmap(data_, size_);
+        }
+        if (owner_)
+        {
+            shm_unlink(posix_name(name_).c_str());
+        }
+#endif
+        data_ = nullptr;
+        owner_ = false;
+    }
+
+    Doorbell::Doorbell([[maybe_unused]] std::string const &name, std::atomic<uint32_t> &word)
+        : word_{ word }
+    {
+#ifdef _WIN32
+        const auto wide_name = to_wide("Local\\" + name);
+        event_ = CreateEventW(nullptr, FALSE, FALSE, wide_name.c_str());
+        if (event_ == nullptr)
+        {
+            throw_last_error("CreateEvent " + name);
+        }
+#endif
+    }
+
+    Doorbell::~Doorbell()
+    {
+#ifdef _WIN32
+        CloseHandle(event_);
+#endif
+    }
+
+    void Doorbell::wait(uint32_t expected, std::chrono::microseconds timeout) noexcept
+    {
+        if (word_.load(std::memory_order_acquire) != expected)
+        {
+            return;
+        }
+#ifdef _WIN32
+        WaitForSingleObject(event_, static_cast<DWORD>((timeout.count() + 999) / 1000));
+#elif defined(__linux__)
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        const timespec relative{ static_cast<time_t>(seconds.count()),
+                                 static_cast<long>((timeout - seconds).count() * 1000) };
+        // Not FUTEX_PRIVATE_FLAG: the word is shared with another process.
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word_), FUTEX_WAIT, expected, &relative,
+                nullptr, 0);
+#else
+        std::this_thread::sleep_for(std::min(timeout, std::chrono::microseconds{ 50 }));
+#endif
+    }
+
+    void Doorbell::ring() noexcept
+    {
+        word_.fetch_add(1, std::memory_order_release);
+#ifdef _WIN32
+        SetEvent(event_);
+#elif defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word_), FUTEX_WAKE, INT_MAX, nullptr,
+                nullptr, 0);
+#endif
+    }
+}  // namespace pds::ipc
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pds::ipc
+{
+    /**
+     * @brief Named shared memory segment: POSIX shm on Linux and macOS, a pagefile-backed file
+     * mapping on Windows.
+     *
+     * @details The creating side owns the name and removes it on destruction; mappings held by
+     * other processes stay valid until they are closed. Throws std::system_error on failure.
+     */
+    class SharedMemoryRegion
+    {
+    public:
+        static SharedMemoryRegion create(std::string const &name, size_t size);
+        static SharedMemoryRegion open(std::string const &name);
+
+        SharedMemoryRegion(SharedMemoryRegion &&other) noexcept;
+        SharedMemoryRegion &operator=(SharedMemoryRegion &&other) noexcept;
+        ~SharedMemoryRegion();
+
+        SharedMemoryRegion(SharedMemoryRegion const &) = delete;
+        SharedMemoryRegion &operator=(SharedMemoryRegion const &) = delete;
+
+        [[nodiscard]] void *data() const noexcept { return data_; }
+        [[nodiscard]] size_t size() const noexcept { return size_; }
+        [[nodiscard]] std::string const &name() const noexcept { return name_; }
+
+    private:
+        SharedMemoryRegion() = default;
+        void close() noexcept;
+
+        std::string name_;
+        void *data_ = nullptr;
+        size_t size_ = 0;
+        bool owner_ = false;
+#ifdef _WIN32
+        void *mapping_ = nullptr;
+#endif
+    };
+
+    /**
+     * @brief Cross-process wakeup on a 32-bit word in shared memory.
+     *
+     * @details A futex on Linux, a named auto-reset event on Windows. Elsewhere wait() degrades
+     * to a short sleep, which keeps the protocol correct at the cost of latency when idle.
+     */
+    class Doorbell
+    {
+    public:
+        /** @brief `name` identifies the event on Windows and is ignored elsewhere. */
+        Doorbell(std::string const &name, std::atomic<uint32_t> &word);
+        ~Doorbell();
+
+        Doorbell(Doorbell const &) = delete;
+        Doorbell &operator=(Doorbell const &) = delete;
+
+        /** @brief Sleeps while the word equals `expected`, at most `timeout`. Spurious wakeups are possible. */
+        void wait(uint32_t expected, std::chrono::microseconds timeout) noexcept;
+        /** @brief Bumps the word and wakes the waiter. */
+        void ring() noexcept;
+
+    private:
+        std::atomic<uint32_t> &word_;
+#ifdef _WIN32
+        void *event_ = nullptr;
+#endif
+    };
+}  // namespace pds::ipc
@@ -0,0 +1,232 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "shared-memory.hpp"
+#include "spsc-ring.hpp"
+
+namespace pds::ipc
+{
+    /** @brief How a receiver waits for frames: busy-poll first, then sleep on the doorbell. */
+    struct WaitPolicy
+    {
+        /** @brief Polls of the ring before going to sleep; 0 sleeps right away. */
+        uint32_t spin_iterations = 4096;
+        /** @brief Upper bound of one sleep, protecting against a lost wakeup of a dead peer. */
+        std::chrono::microseconds max_sleep{ 100'000 };
+    };
+
+    /**
+     * @brief Bidirectional frame channel over shared memory between two processes on one host.
+     *
+     * @details Two SpscRing instances live in one named segment; the creating side sends on the
+     * first and the opening side on the second. Frames are opaque bytes. A sender issues a
+     * wakeup only if the receiver announced it is about to sleep, so a busy receiver costs no
+     * syscalls at all.
+     *
+     * One thread may send and one thread may receive on each side at a time.
+     *
+     * Only a building block so far, measured by benchmarks/shm_ipc. Sessions are
+     * mal_packet_weaver ones, which only run over a tcp::socket, so no Endpoint carries packets
+     * over a channel; the DLLs reach central_server through a socket, unix:// being the local one.
+     */
+    class ShmChannel
+    {
+    public:
+        static constexpr size_t kDefaultRingCapacity = 1 << 20;
+
+        /** @brief Relay side; ring_capacity has to be a power of two. */
+        static ShmChannel create(std::string const &name,
+                                 size_t ring_capacity = kDefaultRingCapacity,
+                                 WaitPolicy wait_policy = {})
+        {
+            if (ring_capacity == 0 || (ring_capacity & (ring_capacity - 1)) != 0)
+            {
+                throw std::invalid_argument("Ring capacity has to be a power of two");
+            }
+            const size_t ring_size = SpscRing::required_size(ring_capacity);
+            auto region =
+                SharedMemoryRegion::create(name, sizeof(ChannelHeader) + 2 * ring_size);
+            std::byte *base = static_cast<std::byte *>(region.data());
+
+            auto *header = new (base) ChannelHeader{};
+            header->ring_capacity = ring_capacity;
+            SpscRing first = SpscRing::create(base + sizeof(ChannelHeader), ring_capacity);
+            SpscRing second =
+                SpscRing::create(base + sizeof(ChannelHeader) + ring_size, ring_capacity);
+            header->magic.store(kMagic, std::memory_order_release);
+            return ShmChannel{ std::move(region), first, second, wait_policy };
+        }
+
+        /**
+         * @brief DLL side. Throws if the segment does not exist, is not a channel, or its rings
+         * don't fit into it.
+         */
+        static ShmChannel open(std::string const &name, WaitPolicy wait_policy = {})
+        {
+            auto region = SharedMemoryRegion::open(name);
+            std::byte *base = static_cast<std::byte *>(region.data());
+            auto *header = reinterpret_cast<ChannelHeader *>(base);
+            if (region.size() < sizeof(ChannelHeader) ||
+                header->magic.load(std::memory_order_acquire) != kMagic)
+            {
+                throw std::runtime_error("Shared memory segment " + name + " is not a channel");
+            }
+            // Read once: the creator's process could still change it.
+            const size_t ring_capacity = header->ring_capacity;
+            if (ring_capacity < 2 * SpscRing::kAlignment || (ring_capacity & (ring_capacity - 1)) != 0 ||
+                ring_capacity > (region.size() - sizeof(ChannelHeader)) / 2 ||
+                2 * SpscRing::required_size(ring_capacity) > region.size() - sizeof(ChannelHeader))
+            {
+                throw std::runtime_error("Shared memory segment " + name + " has an invalid ring capacity");
+            }
+            const size_t ring_size = SpscRing::required_size(ring_capacity);
+            SpscRing first = SpscRing::attach(base + sizeof(ChannelHeader), ring_capacity);
+            SpscRing second = SpscRing::attach(base + sizeof(ChannelHeader) + ring_size, ring_capacity);
+            return ShmChannel{ std::move(region), second, first, wait_policy };
+        }
+
+        /** @brief Returns false if the frame does not fit into the ring right now. */
+        [[nodiscard]] bool try_send(std::span<const std::byte> frame)
+        {
+            if (!tx_.try_write(frame))
+            {
+                return false;
+            }
+            // Pairs with the fence in receive(): either the receiver sees the frame before it
+            // sleeps or we see that it sleeps.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (tx_.header().consumer_sleeping.load(std::memory_order_relaxed) != 0)
+            {
+                tx_doorbell_->ring();
+            }
+            return true;
+        }
+
+        /** @brief Yields until there is room; false if the frame can never fit. */
+        bool send(std::span<const std::byte> frame)
+        {
+            if (frame.size() > tx_.max_frame_size())
+            {
+                return false;
+            }
+            while (!try_send(frame))
+            {
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+        /** @brief Hands every pending frame to on_frame without waiting. Returns the amount. */
+        template <typename OnFrame>
+        size_t poll(OnFrame &&on_frame)
+        {
+            size_t frames = 0;
+            while (rx_.try_read(on_frame))
+            {
+                ++frames;
+            }
+            return frames;
+        }
+
+        /**
+         * @brief Waits up to `timeout` for at least one frame, spinning first and then sleeping,
+         * and hands all pending frames to on_frame. Returns the amount.
+         */
+        template <typename OnFrame>
+        size_t receive(OnFrame &&on_frame, std::chrono::microseconds timeout)
+        {
+            for (uint32_t i = 0; i < wait_policy_.spin_iterations; ++i)
+            {
+                if (const size_t frames = poll(on_frame); frames != 0)
+                {
+                    return frames;
+                }
+                cpu_relax();
+            }
+
+            RingHeader &header = rx_.header();
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (true)
+            {
+                const uint32_t bell = header.doorbell.load(std::memory_order_acquire);
+                header.consumer_sleeping.store(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                size_t frames = poll(on_frame);
+                if (frames == 0)
+                {
+                    const auto now = std::chrono::steady_clock::now();
+                    if (now >= deadline)
+                    {
+                        header.consumer_sleeping.store(0, std::memory_order_relaxed);
+                        return 0;
+                    }
+                    rx_doorbell_->wait(
+                        bell, std::min(wait_policy_.max_sleep,
+                                       std::chrono::duration_cast<std::chrono::microseconds>(
+                                           deadline - now)));
+                    frames = poll(on_frame);
+                }
+                header.consumer_sleeping.store(0, std::memory_order_relaxed);
+                if (frames != 0)
+                {
+                    return frames;
+                }
+            }
+        }
+
+        [[nodiscard]] size_t max_frame_size() const noexcept { return tx_.max_frame_size(); }
+
+    private:
+        static constexpr uint64_t kMagic = 0x50'44'53'5F'53'48'4D'31;  // "PDS_SHM1"
+
+        struct ChannelHeader
+        {
+            alignas(64) std::atomic<uint64_t> magic;
+            uint64_t ring_capacity;
+        };
+
+        ShmChannel(SharedMemoryRegion &&region, SpscRing tx, SpscRing rx, WaitPolicy wait_policy)
+            : region_{ std::move(region) },
+              tx_{ tx },
+              rx_{ rx },
+              wait_policy_{ wait_policy },
+              tx_doorbell_{ std::make_unique<Doorbell>(doorbell_name(tx), tx_.header().doorbell) },
+              rx_doorbell_{ std::make_unique<Doorbell>(doorbell_name(rx), rx_.header().doorbell) }
+        {
+        }
+
+        // Both sides derive the same name for a ring from the segment name and ring position.
+        std::string doorbell_name(SpscRing &ring) const
+        {
+            const bool first = reinterpret_cast<std::byte *>(&ring.header()) ==
+                               static_cast<std::byte *>(region_.data()) + sizeof(ChannelHeader);
+            return region_.name() + (first ? ".bell0" : ".bell1");
+        }
+
+        static void cpu_relax() noexcept
+        {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+
+        SharedMemoryRegion region_;
+        SpscRing tx_;
+        SpscRing rx_;
+        WaitPolicy wait_policy_;
+        std::unique_ptr<Doorbell> tx_doorbell_;
+        std::unique_ptr<Doorbell> rx_doorbell_;
+    };
+}  // namespace pds::ipc
@@ -0,0 +1,224 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <stdexcept>
+
+namespace pds::ipc
+{
+    /**
+     * @brief Control block of a ring, placed at the start of its shared memory.
+     *
+     * @details Positions grow monotonically and are reduced modulo the capacity on access, so
+     * head == tail means empty and tail - head is the amount of used bytes. Producer and
+     * consumer owned fields live on separate cache lines.
+     */
+    struct RingHeader
+    {
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+        /** @brief Futex word the consumer sleeps on; bumped by the producer to wake it. */
+        alignas(64) std::atomic<uint32_t> doorbell;
+        std::atomic<uint32_t> consumer_sleeping;
+        uint64_t capacity;
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "Ring positions must be address-free to be shared between processes");
+
+    /**
+     * @brief Single-producer/single-consumer ring of length-prefixed frames in caller-provided
+     * memory, usable between processes.
+     *
+     * @details Every record is a 4-byte length followed by the frame, padded to 8 bytes. A
+     * record never wraps: when it does not fit before the end of the buffer, a wrap marker is
+     * written and the record starts over at offset 0, so readers always see frames as one
+     * contiguous span.
+     *
+     * Exactly one thread may call the producer functions and exactly one the consumer functions.
+     */
+    class SpscRing
+    {
+    public:
+        static constexpr size_t kAlignment = 8;
+        static constexpr uint32_t kWrapMarker = 0xFFFFFFFFu;
+
+        /** @brief Bytes of shared memory needed for a ring with the given data capacity. */
+        [[nodiscard]] static constexpr size_t required_size(size_t capacity) noexcept
+        {
+            return sizeof(RingHeader) + capacity;
+        }
+
+        /** @brief Initializes a fresh ring; capacity has to be a power of two. */
+        static SpscRing create(void *memory, size_t capacity)
+        {
+            auto *header = new (memory) RingHeader{};
+            header->capacity = capacity;
+            return SpscRing{ memory, capacity };
+        }
+        /**
+         * @brief Attaches to a ring created by another process, which has to have the capacity
+         * the caller validated; throws std::runtime_error otherwise.
+         */
+        static SpscRing attach(void *memory, size_t capacity)
+        {
+            if (static_cast<RingHeader *>(memory)->capacity != capacity)
+            {
+                throw std::runtime_error("Shared memory ring has an unexpected capacity");
+            }
+            return SpscRing{ memory, capacity };
+        }
+
+        /** @brief Largest frame that can ever be written. */
+        [[nodiscard]] size_t max_frame_size() const noexcept
+        {
+            return capacity_ / 2 - sizeof(uint32_t);
+        }
+
+        /** @brief Producer side. Returns false if the frame does not fit right now. */
+        [[nodiscard]] bool try_write(std::span<const std::byte> frame) noexcept
+        {
+            return try_write_gather(std::span<const std::span<const std::byte>>{ &frame, 1 });
+        }
+
+        /** @brief Producer side; writes the concatenation of `parts` as one frame. */
+        [[nodiscard]] bool try_write_gather(
+            std::span<const std::span<const std::byte>> parts) noexcept
+        {
+            size_t frame_size = 0;
+            for (auto const &part : parts)
+            {
+                frame_size += part.size();
+            }
+            if (frame_size > max_frame_size())
+            {
+                return false;
+            }
+
+            const uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+            const size_t record = record_size(frame_size);
+            const size_t offset = tail & mask_;
+            const size_t padding = offset + record > capacity_ ? capacity_ - offset : 0;
+
+            if (tail + padding + record - cached_head_ > capacity_)
+            {
+                cached_head_ = header_->head.load(std::memory_order_acquire);
+                if (tail + padding + record - cached_head_ > capacity_)
+                {
+                    return false;
+                }
+            }
+
+            uint64_t position = tail;
+            if (padding != 0)
+            {
+                store_length(offset, kWrapMarker);
+                position += padding;
+            }
+            const size_t start = position & mask_;
+            store_length(start, static_cast<uint32_t>(frame_size));
+            std::byte *out = data_ + start + sizeof(uint32_t);
+            for (auto const &part : parts)
+            {
+                std::memcpy(out, part.data(), part.size());
+                out += part.size();
+            }
+            header_->tail.store(position + record, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Consumer side. Calls on_frame(std::span<const std::byte>) for the oldest frame
+         * and releases it afterwards; the span must not be used after the call.
+         *
+         * @details The memory is shared with the producer's process, so nothing read from it is
+         * trusted: a position or record the producer couldn't have written throws
+         * std::runtime_error, and the ring is unusable from then on.
+         */
+        template <typename OnFrame>
+        bool try_read(OnFrame &&on_frame)
+        {
+            uint64_t head = header_->head.load(std::memory_order_relaxed);
+            if (head == cached_tail_)
+            {
+                cached_tail_ = header_->tail.load(std::memory_order_acquire);
+                if (head == cached_tail_)
+                {
+                    return false;
+                }
+            }
+            if (cached_tail_ - head > capacity_ || head % kAlignment != 0)
+            {
+                throw std::runtime_error("Shared memory ring positions are corrupted");
+            }
+
+            size_t offset = head & mask_;
+            uint32_t length = load_length(offset);
+            if (length == kWrapMarker)
+            {
+                // A marker is only written in front of a record.
+                if (capacity_ - offset >= cached_tail_ - head)
+                {
+                    throw std::runtime_error("Shared memory ring has a wrap marker past its tail");
+                }
+                head += capacity_ - offset;
+                offset = 0;
+                length = load_length(0);
+            }
+            if (length > max_frame_size() || record_size(length) > cached_tail_ - head ||
+                offset + record_size(length) > capacity_)
+            {
+                throw std::runtime_error("Shared memory ring has a record past its written bytes");
+            }
+            on_frame(std::span<const std::byte>{ data_ + offset + sizeof(uint32_t), length });
+            header_->head.store(head + record_size(length), std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return header_->head.load(std::memory_order_acquire) ==
+                   header_->tail.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] RingHeader &header() noexcept { return *header_; }
+        [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+
+    private:
+        // Takes the capacity from the caller, as the one in the header may change under it.
+        SpscRing(void *memory, size_t capacity)
+            : header_{ static_cast<RingHeader *>(memory) },
+              data_{ static_cast<std::byte *>(memory) + sizeof(RingHeader) },
+              capacity_{ capacity },
+              mask_{ capacity_ - 1 },
+              cached_head_{ header_->head.load(std::memory_order_acquire) },
+              cached_tail_{ header_->tail.load(std::memory_order_acquire) }
+        {
+        }
+
+        static constexpr size_t record_size(size_t frame_size) noexcept
+        {
+            return (sizeof(uint32_t) + frame_size + kAlignment - 1) & ~(kAlignment - 1);
+        }
+        void store_length(size_t offset, uint32_t length) noexcept
+        {
+            std::memcpy(data_ + offset, &length, sizeof(length));
+        }
+        [[nodiscard]] uint32_t load_length(size_t offset) const noexcept
+        {
+            uint32_t length;
+            std::memcpy(&length, data_ + offset, sizeof(length));
+            return length;
+        }
+
+        RingHeader *header_;
+        std::byte *data_;
+        size_t capacity_;
+        size_t mask_;
+        // Last positions seen of the other side; refreshed only when they look exhausted.
+        uint64_t cached_head_;
+        uint64_t cached_tail_;
+    };
+}  // namespace pds::ipc
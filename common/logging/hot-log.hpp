@@ -0,0 +1,425 @@
+#pragma once
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pds::logging
+{
+    using Level = spdlog::level::level_enum;
+
+    /** @brief Everything about a log statement that is known at compile time; records point at it. */
+    struct LogSite
+    {
+        Level level;
+        std::string_view format;
+        const char *file;
+        int line;
+    };
+
+    namespace detail
+    {
+        inline constexpr size_t kRecordSize = 128;
+        inline constexpr size_t kRingCapacity = 4096;
+        inline constexpr size_t kMaxStringArgument = 39;
+
+        inline std::atomic<int> g_level{ Level::info };
+
+        /** @brief String argument copied into a record, truncated to kMaxStringArgument bytes. */
+        struct InlineString
+        {
+            uint8_t size;
+            char data[kMaxStringArgument];
+
+            [[nodiscard]] std::string_view view() const noexcept { return { data, size }; }
+        };
+
+        template <typename T>
+        constexpr bool kUnsupportedArgument = false;
+
+        template <typename T>
+        [[nodiscard]] auto encode(T const &value) noexcept
+        {
+            if constexpr (std::is_enum_v<T>)
+            {
+                return static_cast<std::underlying_type_t<T>>(value);
+            }
+            else if constexpr (std::is_arithmetic_v<T>)
+            {
+                return value;
+            }
+            else if constexpr (std::is_convertible_v<T const &, std::string_view>)
+            {
+                const std::string_view text = value;
+                InlineString result;
+                result.size = static_cast<uint8_t>(std::min(text.size(), kMaxStringArgument));
+                std::memcpy(result.data, text.data(), result.size);
+                return result;
+            }
+            else
+            {
+                static_assert(kUnsupportedArgument<T>, "Hot log arguments are numbers, enums or strings");
+            }
+        }
+
+        template <typename T>
+        using Encoded = decltype(encode(std::declval<T const &>()));
+
+        template <typename T>
+        [[nodiscard]] auto decode(T const &value) noexcept
+        {
+            if constexpr (std::is_same_v<T, InlineString>)
+            {
+                return value.view();
+            }
+            else
+            {
+                return value;
+            }
+        }
+
+        using Formatter = std::string (*)(std::string_view format, const std::byte *payload);
+
+        /** @brief One log statement as the hot path leaves it: a pointer to its site and raw arguments. */
+        struct Record
+        {
+            std::chrono::system_clock::time_point time;
+            LogSite const *site;
+            Formatter formatter;
+            std::array<std::byte, kRecordSize - 3 * sizeof(void *)> payload;
+        };
+        static_assert(sizeof(Record) == kRecordSize);
+
+        template <typename T>
+        T read(const std::byte *&cursor) noexcept
+        {
+            T value;
+            std::memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return value;
+        }
+
+        template <typename... Stored>
+        std::string format_payload(std::string_view format, const std::byte *payload)
+        {
+            // Braced initialization reads the arguments in order.
+            const std::tuple<Stored...> stored{ read<Stored>(payload)... };
+            auto arguments =
+                std::apply([](auto const &...values) { return std::make_tuple(decode(values)...); }, stored);
+            return std::apply([format](auto &...values)
+                              { return std::vformat(format, std::make_format_args(values...)); },
+                              arguments);
+        }
+
+        /**
+         * @brief Per-thread ring of records: the owning thread produces, the backend consumes.
+         *
+         * @details The producer re-reads the consumer position only when its cached copy says the
+         * ring is full, so a write is a slot copy and one release store. A full ring drops the
+         * record rather than blocking the thread that logs.
+         */
+        class RecordRing
+        {
+        public:
+            RecordRing() : slots_{ std::make_unique<Record[]>(kRingCapacity) } {}
+
+            [[nodiscard]] Record *try_claim() noexcept
+            {
+                const uint64_t tail = tail_.load(std::memory_order_relaxed);
+                if (tail - cached_head_ >= kRingCapacity)
+                {
+                    cached_head_ = head_.load(std::memory_order_acquire);
+                    if (tail - cached_head_ >= kRingCapacity)
+                    {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        return nullptr;
+                    }
+                }
+                return &slots_[tail % kRingCapacity];
+            }
+            void publish() noexcept
+            {
+                tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+            template <typename Consumer>
+            size_t drain(Consumer &&consumer)
+            {
+                uint64_t head = head_.load(std::memory_order_relaxed);
+                const uint64_t tail = tail_.load(std::memory_order_acquire);
+                const size_t count = tail - head;
+                for (; head != tail; head++)
+                {
+                    consumer(slots_[head % kRingCapacity]);
+                }
+                head_.store(head, std::memory_order_release);
+                return count;
+            }
+            [[nodiscard]] bool empty() const noexcept
+            {
+                return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+            }
+            [[nodiscard]] uint64_t take_dropped() noexcept { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+            /** @brief Set when the owning thread exits; the backend forgets the ring once it is drained. */
+            std::atomic<bool> orphaned = false;
+
+        private:
+            alignas(64) std::atomic<uint64_t> head_ = 0;
+            alignas(64) std::atomic<uint64_t> tail_ = 0;
+            uint64_t cached_head_ = 0;
+            std::atomic<uint64_t> dropped_ = 0;
+            std::unique_ptr<Record[]> slots_;
+        };
+
+        class Registry
+        {
+        public:
+            static Registry &instance()
+            {
+                static Registry registry;
+                return registry;
+            }
+
+            std::shared_ptr<RecordRing> add_ring()
+            {
+                auto ring = std::make_shared<RecordRing>();
+                std::lock_guard lock{ mutex_ };
+                rings_.emplace_back(ring);
+                return ring;
+            }
+
+            /** @brief The live rings, forgetting those whose threads exited and that have been drained. */
+            std::vector<std::shared_ptr<RecordRing>> rings()
+            {
+                std::lock_guard lock{ mutex_ };
+                std::erase_if(rings_, [](auto const &ring) { return ring->orphaned && ring->empty(); });
+                return rings_;
+            }
+
+        private:
+            std::mutex mutex_;
+            std::vector<std::shared_ptr<RecordRing>> rings_;
+        };
+
+        inline RecordRing &local_ring()
+        {
+            struct Owner
+            {
+                std::shared_ptr<RecordRing> ring = Registry::instance().add_ring();
+                ~Owner() { ring->orphaned = true; }
+            };
+            thread_local Owner owner;
+            return *owner.ring;
+        }
+    }  // namespace detail
+
+    /** @brief Hot log statements below this level cost one relaxed load; defaults to info. */
+    inline void set_level(Level level) noexcept { detail::g_level.store(level, std::memory_order_relaxed); }
+
+    [[nodiscard]] inline bool enabled(Level level) noexcept
+    {
+        return level >= detail::g_level.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Copies the arguments of one statement into the calling thread's ring; use the
+     * PDS_HOT_LOG macros rather than calling this.
+     *
+     * @details Arguments are numbers, enums and strings; strings are truncated to
+     * detail::kMaxStringArgument bytes, and all of them together have to fit in a record.
+     */
+    template <typename... Args>
+    void write(LogSite const &site, Args const &...args)
+    {
+        static_assert((sizeof(detail::Encoded<Args>) + ... + 0) <= sizeof(detail::Record::payload),
+                      "Hot log arguments don't fit in a record");
+        detail::RecordRing &ring = detail::local_ring();
+        detail::Record *record = ring.try_claim();
+        if (record == nullptr)
+        {
+            return;
+        }
+        record->time = std::chrono::system_clock::now();
+        record->site = &site;
+        record->formatter = &detail::format_payload<detail::Encoded<Args>...>;
+        std::byte *cursor = record->payload.data();
+        (
+            [&cursor](auto const &encoded)
+            {
+                std::memcpy(cursor, &encoded, sizeof(encoded));
+                cursor += sizeof(encoded);
+            }(detail::encode(args)),
+            ...);
+        ring.publish();
+    }
+
+    /** @brief Lets one call through per interval, shared by all threads of a log statement. */
+    class RateLimiter
+    {
+    public:
+        explicit RateLimiter(std::chrono::nanoseconds interval) noexcept : interval_{ interval.count() } {}
+
+        [[nodiscard]] bool allow() noexcept
+        {
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now().time_since_epoch())
+                                    .count();
+            int64_t next = next_.load(std::memory_order_relaxed);
+            return now >= next && next_.compare_exchange_strong(next, now + interval_, std::memory_order_relaxed);
+        }
+
+    private:
+        const int64_t interval_;
+        std::atomic<int64_t> next_ = 0;
+    };
+
+    /**
+     * @brief Background thread that formats the records of every thread and hands them to an
+     * spdlog logger, so sinks and patterns stay configured the usual way.
+     *
+     * @details Records are collected from all rings and written in timestamp order. Without a
+     * running backend the rings fill up and further records are dropped; drops are reported
+     * as a warning on the next drain. Keep one alive for as long as threads may log, and
+     * destroy it after they are joined so their last records are written.
+     */
+    class HotLogBackend
+    {
+    public:
+        explicit HotLogBackend(std::shared_ptr<spdlog::logger> logger = spdlog::default_logger(),
+                               std::chrono::milliseconds poll_interval = std::chrono::milliseconds{ 5 })
+            : logger_{ std::move(logger) }, poll_interval_{ poll_interval }, thread_{ [this]() { run(); } }
+        {
+        }
+        ~HotLogBackend()
+        {
+            {
+                std::lock_guard lock{ mutex_ };
+                stopping_ = true;
+            }
+            wake_.notify_one();
+            thread_.join();
+        }
+
+        HotLogBackend(HotLogBackend const &) = delete;
+        HotLogBackend &operator=(HotLogBackend const &) = delete;
+
+    private:
+        void run()
+        {
+            std::unique_lock lock{ mutex_ };
+            while (!stopping_)
+            {
+                lock.unlock();
+                const size_t written = drain();
+                lock.lock();
+                if (written == 0)
+                {
+                    wake_.wait_for(lock, poll_interval_, [this]() { return stopping_; });
+                }
+            }
+            lock.unlock();
+            drain();
+        }
+
+        size_t drain()
+        {
+            batch_.clear();
+            uint64_t dropped = 0;
+            for (auto const &ring : detail::Registry::instance().rings())
+            {
+                ring->drain([this](detail::Record const &record) { batch_.push_back(record); });
+                dropped += ring->take_dropped();
+            }
+            std::stable_sort(batch_.begin(), batch_.end(),
+                             [](auto const &lhs, auto const &rhs) { return lhs.time < rhs.time; });
+            for (auto const &record : batch_)
+            {
+                LogSite const &site = *record.site;
+                std::string message;
+                try
+                {
+                    message = record.formatter(site.format, record.payload.data());
+                }
+                catch (const std::format_error &e)
+                {
+                    message = std::format("bad hot log format \"{}\": {}", site.format, e.what());
+                }
+                logger_->log(record.time, spdlog::source_loc{ site.file, site.line, "" }, site.level, message);
+            }
+            if (dropped != 0)
+            {
+                logger_->warn("Hot log rings were full, dropped {} records", dropped);
+            }
+            return batch_.size();
+        }
+
+        std::shared_ptr<spdlog::logger> logger_;
+        const std::chrono::milliseconds poll_interval_;
+        std::vector<detail::Record> batch_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+        std::thread thread_;
+    };
+}  // namespace pds::logging
+
+/**
+ * @brief Logs `format` with `args` through the hot log: the calling thread only copies the
+ * arguments, formatting happens on the HotLogBackend thread. Disabled levels cost one load.
+ */
+#define PDS_HOT_LOG(level, format, ...)                                                                    \
+    do                                                                                                     \
+    {                                                                                                      \
+        if (::pds::logging::enabled(level))                                                                \
+        {                                                                                                  \
+            static constexpr ::pds::logging::LogSite pds_hot_log_site{ level, format, __FILE__, __LINE__ }; \
+            ::pds::logging::write(pds_hot_log_site __VA_OPT__(, ) __VA_ARGS__);                            \
+        }                                                                                                  \
+    } while (false)
+
+/** @brief Logs the first of every `n` calls; counted per thread so sampling never contends. */
+#define PDS_HOT_LOG_EVERY_N(level, n, format, ...)                                                         \
+    do                                                                                                     \
+    {                                                                                                      \
+        if (::pds::logging::enabled(level))                                                                \
+        {                                                                                                  \
+            static thread_local uint64_t pds_hot_log_count = 0;                                            \
+            if (pds_hot_log_count++ % (n) == 0)                                                            \
+            {                                                                                              \
+                static constexpr ::pds::logging::LogSite pds_hot_log_site{ level, format, __FILE__,        \
+                                                                           __LINE__ };                     \
+                ::pds::logging::write(pds_hot_log_site __VA_OPT__(, ) __VA_ARGS__);                        \
+            }                                                                                              \
+        }                                                                                                  \
+    } while (false)
+
+/** @brief Logs at most once per `interval` (a std::chrono duration) across all threads. */
+#define PDS_HOT_LOG_RATE_LIMITED(level, interval, format, ...)                                             \
+    do                                                                                                     \
+    {                                                                                                      \
+        if (::pds::logging::enabled(level))                                                                \
+        {                                                                                                  \
+            static ::pds::logging::RateLimiter pds_hot_log_limiter{ interval };                            \
+            if (pds_hot_log_limiter.allow())                                                               \
+            {                                                                                              \
+                static constexpr ::pds::logging::LogSite pds_hot_log_site{ level, format, __FILE__,        \
+                                                                           __LINE__ };                     \
+                ::pds::logging::write(pds_hot_log_site __VA_OPT__(, ) __VA_ARGS__);                        \
+            }                                                                                              \
+        }                                                                                                  \
+    } while (false)
@@ -0,0 +1,158 @@
+#pragma once
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/level.hpp>
+#include <boost/serialization/tracking.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace pds::market
+{
+    enum class Timeframe : uint8_t
+    {
+        M1,
+        M5,
+        H1,
+        D1
+    };
+    constexpr size_t kTimeframeCount = 4;
+
+    constexpr std::array<int64_t, kTimeframeCount> kTimeframePeriodsMsc{ 60'000, 300'000, 3'600'000, 86'400'000 };
+
+    [[nodiscard]] constexpr bool valid_timeframe(uint8_t timeframe) noexcept { return timeframe < kTimeframeCount; }
+    [[nodiscard]] constexpr int64_t period_msc(Timeframe timeframe) noexcept
+    {
+        return kTimeframePeriodsMsc[static_cast<size_t>(timeframe)];
+    }
+
+    /**
+     * @brief OHLCV bar in points of its symbol, like MqlRates. Prices are bids, or last prices
+     * for symbols quoted without one.
+     */
+    struct Bar
+    {
+        /** @brief Start of the bar, in trade server time like the ticks. */
+        int64_t time_msc = 0;
+        int64_t open = 0;
+        int64_t high = 0;
+        int64_t low = 0;
+        int64_t close = 0;
+        uint64_t tick_volume = 0;
+        uint64_t volume = 0;
+
+        friend bool operator==(Bar const &, Bar const &) = default;
+
+    private:
+        friend class boost::serialization::access;
+        template <class Archive>
+        void serialize(Archive &ar, const unsigned int)
+        {
+            ar &time_msc;
+            ar &open;
+            ar &high;
+            ar &low;
+            ar &close;
+            ar &tick_volume;
+            ar &volume;
+        }
+    };
+
+    /**
+     * @brief Bars of one symbol and timeframe, built a tick at a time: the forming bar and a
+     * ring of the last kMaxBars closed ones, contiguous so that history is copied in at most
+     * two runs.
+     *
+     * @details Every tick costs a division and a few comparisons. Minutes without ticks have no
+     * bar, as in the terminal; a tick older than the forming bar is counted in it.
+     */
+    class BarSeries
+    {
+    public:
+        /** @brief A day of M1 bars, and years of D1 ones. */
+        static constexpr size_t kMaxBars = 1440;
+
+        explicit BarSeries(Timeframe timeframe = Timeframe::M1) noexcept : period_msc_{ period_msc(timeframe) } {}
+
+        /** @brief True if the tick closed the forming bar, which is then last_closed(). */
+        bool add(int64_t time_msc, int64_t price, uint64_t volume)
+        {
+            const int64_t start = time_msc - time_msc % period_msc_;
+            bool closed = false;
+            if (forming_.tick_volume == 0 || start > forming_.time_msc)
+            {
+                if (forming_.tick_volume != 0)
+                {
+                    push(forming_);
+                    closed = true;
+                }
+                forming_ = Bar{ start, price, price, price, price, 0, 0 };
+            }
+            forming_.high = std::max(forming_.high, price);
+            forming_.low = std::min(forming_.low, price);
+            forming_.close = price;
+            ++forming_.tick_volume;
+            forming_.volume += volume;
+            return closed;
+        }
+
+        /** @brief Whether a bar is forming, i.e. the series had any tick. */
+        [[nodiscard]] bool has_forming() const noexcept { return forming_.tick_volume != 0; }
+        [[nodiscard]] Bar const &forming() const noexcept { return forming_; }
+        /** @brief Only valid once a bar closed. */
+        [[nodiscard]] Bar const &last_closed() const noexcept
+        {
+            return closed_[(next_ + closed_.size() - 1) % closed_.size()];
+        }
+        [[nodiscard]] size_t closed_count() const noexcept { return closed_.size(); }
+
+        /** @brief Appends the last count closed bars to out, oldest first. */
+        void copy_closed(size_t count, std::vector<Bar> &out) const
+        {
+            count = std::min(count, closed_.size());
+            // Index of the oldest bar to copy; next_ is the oldest kept once the ring is full.
+            const size_t first = (next_ + closed_.size() - count) % std::max<size_t>(closed_.size(), 1);
+            const size_t until_end = std::min(count, closed_.size() - first);
+            out.insert(out.end(), closed_.begin() + first, closed_.begin() + first + until_end);
+            out.insert(out.end(), closed_.begin(), closed_.begin() + (count - until_end));
+        }
+
+    private:
+        void push(Bar const &bar)
+        {
+            if (closed_.size() < kMaxBars)
+            {
+                closed_.emplace_back(bar);
+                return;
+            }
+            closed_[next_] = bar;
+            next_ = (next_ + 1) % kMaxBars;
+        }
+
+        int64_t period_msc_;
+        Bar forming_;
+        std::vector<Bar> closed_;
+        // Where the next closed bar goes once the ring is full, i.e. the oldest one.
+        size_t next_ = 0;
+    };
+
+    /** @brief The series of every timeframe of a symbol, updated together. */
+    struct SymbolBars
+    {
+        std::array<BarSeries, kTimeframeCount> series{ BarSeries{ Timeframe::M1 }, BarSeries{ Timeframe::M5 },
+                                                        BarSeries{ Timeframe::H1 }, BarSeries{ Timeframe::D1 } };
+
+        [[nodiscard]] BarSeries &operator[](Timeframe timeframe) noexcept
+        {
+            return series[static_cast<size_t>(timeframe)];
+        }
+        [[nodiscard]] BarSeries const &operator[](Timeframe timeframe) const noexcept
+        {
+            return series[static_cast<size_t>(timeframe)];
+        }
+    };
+}  // namespace pds::market
+
+// Saved inline: no class information and no tracking, as bars travel by the thousand.
+BOOST_CLASS_IMPLEMENTATION(pds::market::Bar, boost::serialization::object_serializable)
+BOOST_CLASS_TRACKING(pds::market::Bar, boost::serialization::track_never)
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../mql-cpp/common.hpp"
+#include "tick-codec.hpp"
+
+namespace pds::market
+{
+    /**
+     * @brief Interns symbol names into dense ids, so that ticks carry a small varint instead of
+     * the name and receivers index arrays with it.
+     *
+     * @details Ids are handed out in order and never reused. Not synchronized.
+     */
+    class SymbolTable
+    {
+    public:
+        /** @brief Digits of a symbol interned before anyone said how it is quoted. */
+        static constexpr int32_t kUnknownDigits = -1;
+
+        struct Symbol
+        {
+            mql::SymbolString name;
+            int32_t digits = kUnknownDigits;
+        };
+
+        /**
+         * @brief Id of name, added if it is new; nullopt once kMaxSymbols are taken. Names are
+         * truncated to a SymbolString first, so the ones that only differ past it share an id.
+         */
+        std::optional<uint32_t> intern(std::string_view name)
+        {
+            const mql::SymbolString stored{ name };
+            if (const auto it = ids_.find(stored.view()); it != ids_.end())
+            {
+                return it->second;
+            }
+            if (symbols_.size() >= kMaxSymbols)
+            {
+                return std::nullopt;
+            }
+            const auto id = static_cast<uint32_t>(symbols_.size());
+            symbols_.emplace_back(Symbol{ .name = stored });
+            ids_.emplace(std::string{ stored.view() }, id);
+            return id;
+        }
+
+        /** @brief Truncates name like intern() does. */
+        [[nodiscard]] std::optional<uint32_t> find(std::string_view name) const
+        {
+            const auto it = ids_.find(mql::SymbolString{ name }.view());
+            return it == ids_.end() ? std::nullopt : std::optional<uint32_t>{ it->second };
+        }
+
+        [[nodiscard]] Symbol &operator[](uint32_t id) noexcept { return symbols_[id]; }
+        [[nodiscard]] Symbol const &operator[](uint32_t id) const noexcept { return symbols_[id]; }
+        [[nodiscard]] uint32_t size() const noexcept { return static_cast<uint32_t>(symbols_.size()); }
+
+        /** @brief Digits are only valid in [0, kMaxDigits]. */
+        [[nodiscard]] static constexpr bool valid_digits(int32_t digits) noexcept
+        {
+            return digits >= 0 && digits <= kMaxDigits;
+        }
+
+    private:
+        struct NameHash
+        {
+            using is_transparent = void;
+            size_t operator()(std::string_view name) const noexcept { return std::hash<std::string_view>{}(name); }
+        };
+
+        std::vector<Symbol> symbols_;
+        std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> ids_;
+    };
+}  // namespace pds::market
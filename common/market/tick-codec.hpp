@@ -0,0 +1,288 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace pds::market
+{
+    /** @brief Prices carry at most this many decimals. */
+    constexpr int32_t kMaxDigits = 10;
+    /** @brief Symbol ids of a connection are below this. */
+    constexpr uint32_t kMaxSymbols = 65536;
+
+    /**
+     * @brief One change of a symbol's prices, as MqlTick carries it, with the prices in points
+     * of the symbol (price * 10^digits) so that they travel as small integers.
+     */
+    struct Tick
+    {
+        /** @brief Interned on the connection, see SymbolDefinition. */
+        uint32_t symbol = 0;
+        int64_t time_msc = 0;
+        int64_t bid = 0;
+        int64_t ask = 0;
+        int64_t last = 0;
+        uint64_t volume = 0;
+        /** @brief TICK_FLAG_* of MqlTick. */
+        uint32_t flags = 0;
+
+        friend bool operator==(Tick const &, Tick const &) = default;
+    };
+
+    namespace detail
+    {
+        inline constexpr std::array<double, kMaxDigits + 1> kPowersOf10{ 1e0, 1e1, 1e2, 1e3, 1e4, 1e5,
+                                                                          1e6, 1e7, 1e8, 1e9, 1e10 };
+
+        inline void put_varint(std::vector<uint8_t> &out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(value) | 0x80);
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+        [[nodiscard]] inline bool get_varint(std::span<const uint8_t> in, size_t &position, uint64_t &value) noexcept
+        {
+            value = 0;
+            for (unsigned shift = 0; shift < 64 && position < in.size(); shift += 7)
+            {
+                const uint8_t byte = in[position++];
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Small magnitudes of either sign become small unsigned values.
+        [[nodiscard]] constexpr uint64_t zigzag(int64_t value) noexcept
+        {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+        [[nodiscard]] constexpr int64_t unzigzag(uint64_t value) noexcept
+        {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        // Fields of a tick that differ from the previous tick of its symbol in the batch.
+        enum TickFields : uint8_t
+        {
+            kBid = 1 << 0,
+            kAsk = 1 << 1,
+            kLast = 1 << 2,
+            kVolume = 1 << 3,
+            kFlags = 1 << 4,
+        };
+
+        // What the previous tick of a symbol left, valid while batch matches the current one.
+        struct SymbolState
+        {
+            uint32_t batch = 0;
+            int64_t bid = 0;
+            int64_t ask = 0;
+            int64_t last = 0;
+            uint32_t flags = 0;
+        };
+
+        // State of symbol for the current batch, starting from zero for its first tick.
+        [[nodiscard]] inline SymbolState &state_of(std::vector<SymbolState> &states, uint32_t symbol, uint32_t batch)
+        {
+            if (symbol >= states.size())
+            {
+                states.resize(static_cast<size_t>(symbol) + 1);
+            }
+            SymbolState &state = states[symbol];
+            if (state.batch != batch)
+            {
+                state = SymbolState{ .batch = batch };
+            }
+            return state;
+        }
+    }  // namespace detail
+
+    [[nodiscard]] inline int64_t to_points(double price, int32_t digits) noexcept
+    {
+        return std::llround(price * detail::kPowersOf10[digits]);
+    }
+    [[nodiscard]] inline double from_points(int64_t points, int32_t digits) noexcept
+    {
+        return static_cast<double>(points) / detail::kPowersOf10[digits];
+    }
+    /** @brief Points of a symbol quoted with from digits, in points of to digits. */
+    [[nodiscard]] inline int64_t rescale(int64_t points, int32_t from, int32_t to) noexcept
+    {
+        return from == to ? points : to_points(from_points(points, from), to);
+    }
+
+    /**
+     * @brief Appends ticks of any symbols to one batch in a compact form: a byte telling which
+     * fields changed, the symbol id and the time as varints, then only the changed fields.
+     *
+     * @details Times are deltas from the previous tick of the batch, prices deltas in points
+     * from the previous tick of the same symbol, all zigzag varints; a symbol's first tick in
+     * the batch is relative to zero. A typical tick takes 6 to 10 bytes instead of the 52 of
+     * its fields. Batches don't depend on each other, so any of them can be dropped or expire
+     * on the way without corrupting the stream.
+     */
+    class TickWriter
+    {
+    public:
+        /** @brief Starts a new batch in out, which is cleared but keeps its capacity. */
+        void begin(std::vector<uint8_t> &out, int64_t base_time_msc)
+        {
+            out_ = &out;
+            out_->clear();
+            previous_time_ = base_time_msc;
+            count_ = 0;
+            ++batch_;
+        }
+
+        void add(Tick const &tick)
+        {
+            detail::SymbolState &state = detail::state_of(states_, tick.symbol, batch_);
+            const uint8_t fields = (tick.bid != state.bid ? detail::kBid : 0) |
+                                   (tick.ask != state.ask ? detail::kAsk : 0) |
+                                   (tick.last != state.last ? detail::kLast : 0) |
+                                   (tick.volume != 0 ? detail::kVolume : 0) |
+                                   (tick.flags != state.flags ? detail::kFlags : 0);
+            out_->push_back(fields);
+            detail::put_varint(*out_, tick.symbol);
+            detail::put_varint(*out_, detail::zigzag(tick.time_msc - previous_time_));
+            previous_time_ = tick.time_msc;
+            if (fields & detail::kBid)
+            {
+                detail::put_varint(*out_, detail::zigzag(tick.bid - state.bid));
+                state.bid = tick.bid;
+            }
+            if (fields & detail::kAsk)
+            {
+                detail::put_varint(*out_, detail::zigzag(tick.ask - state.ask));
+                state.ask = tick.ask;
+            }
+            if (fields & detail::kLast)
+            {
+                detail::put_varint(*out_, detail::zigzag(tick.last - state.last));
+                state.last = tick.last;
+            }
+            if (fields & detail::kVolume)
+            {
+                detail::put_varint(*out_, tick.volume);
+            }
+            if (fields & detail::kFlags)
+            {
+                detail::put_varint(*out_, tick.flags);
+                state.flags = tick.flags;
+            }
+            ++count_;
+        }
+
+        [[nodiscard]] uint32_t count() const noexcept { return count_; }
+        [[nodiscard]] size_t size() const noexcept { return out_ == nullptr ? 0 : out_->size(); }
+
+    private:
+        std::vector<uint8_t> *out_ = nullptr;
+        std::vector<detail::SymbolState> states_;
+        int64_t previous_time_ = 0;
+        uint32_t count_ = 0;
+        uint32_t batch_ = 0;
+    };
+
+    /**
+     * @brief Reads back what TickWriter wrote. Stops at the first malformed tick, e.g. a
+     * truncated one or a symbol id of kMaxSymbols or more.
+     */
+    class TickReader
+    {
+    public:
+        void begin(std::span<const uint8_t> in, int64_t base_time_msc) noexcept
+        {
+            in_ = in;
+            position_ = 0;
+            previous_time_ = base_time_msc;
+            malformed_ = false;
+            ++batch_;
+        }
+
+        /** @brief False at the end of the batch or on a malformed tick. */
+        [[nodiscard]] bool next(Tick &tick)
+        {
+            if (position_ >= in_.size() || malformed_)
+            {
+                return false;
+            }
+            const uint8_t fields = in_[position_++];
+            uint64_t value = 0;
+            if (!detail::get_varint(in_, position_, value) || value >= kMaxSymbols)
+            {
+                return fail();
+            }
+            tick.symbol = static_cast<uint32_t>(value);
+            if (!detail::get_varint(in_, position_, value))
+            {
+                return fail();
+            }
+            previous_time_ += detail::unzigzag(value);
+            tick.time_msc = previous_time_;
+            detail::SymbolState &state = detail::state_of(states_, tick.symbol, batch_);
+            const auto read_delta = [this, fields, &value](uint8_t field, auto &current)
+            {
+                if ((fields & field) == 0)
+                {
+                    return true;
+                }
+                if (!detail::get_varint(in_, position_, value))
+                {
+                    return false;
+                }
+                current += static_cast<std::remove_reference_t<decltype(current)>>(detail::unzigzag(value));
+                return true;
+            };
+            if (!read_delta(detail::kBid, state.bid) || !read_delta(detail::kAsk, state.ask) ||
+                !read_delta(detail::kLast, state.last))
+            {
+                return fail();
+            }
+            tick.volume = 0;
+            if ((fields & detail::kVolume) && !detail::get_varint(in_, position_, tick.volume))
+            {
+                return fail();
+            }
+            if (fields & detail::kFlags)
+            {
+                if (!detail::get_varint(in_, position_, value))
+                {
+                    return fail();
+                }
+                state.flags = static_cast<uint32_t>(value);
+            }
+            tick.bid = state.bid;
+            tick.ask = state.ask;
+            tick.last = state.last;
+            tick.flags = state.flags;
+            return true;
+        }
+
+        [[nodiscard]] bool malformed() const noexcept { return malformed_; }
+
+    private:
+        bool fail() noexcept
+        {
+            malformed_ = true;
+            return false;
+        }
+
+        std::span<const uint8_t> in_;
+        size_t position_ = 0;
+        std::vector<detail::SymbolState> states_;
+        int64_t previous_time_ = 0;
+        uint32_t batch_ = 0;
+        bool malformed_ = false;
+    };
+}  // namespace pds::market
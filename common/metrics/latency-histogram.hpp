@@ -0,0 +1,116 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace pds::metrics
+{
+    /**
+     * @brief HDR-style log-linear histogram of unsigned values, typically nanoseconds.
+     *
+     * @details Values below 2^kSubBucketBits are stored exactly; above that every power-of-two
+     * range is split into 2^(kSubBucketBits - 1) equal buckets, which bounds the relative error of
+     * any reported value by 1 / 2^(kSubBucketBits - 1). Recording is a couple of bit operations
+     * and an increment, with no allocation.
+     *
+     * Not thread-safe: record on one thread and merge() histograms of different threads.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr int kSubBucketBits = 8;
+        static constexpr uint64_t kSubBucketCount = uint64_t{ 1 } << kSubBucketBits;
+        static constexpr uint64_t kHalfCount = kSubBucketCount / 2;
+
+        LatencyHistogram() : counts_(index_of(std::numeric_limits<uint64_t>::max()) + 1, 0) {}
+
+        void record(uint64_t value) noexcept
+        {
+            ++counts_[index_of(value)];
+            ++count_;
+            sum_ += value;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+        }
+
+        void merge(LatencyHistogram const &other) noexcept
+        {
+            for (size_t i = 0; i < counts_.size(); ++i)
+            {
+                counts_[i] += other.counts_[i];
+            }
+            count_ += other.count_;
+            sum_ += other.sum_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+        }
+
+        void reset() noexcept
+        {
+            std::ranges::fill(counts_, 0);
+            count_ = 0;
+            sum_ = 0;
+            min_ = std::numeric_limits<uint64_t>::max();
+            max_ = 0;
+        }
+
+        /** @brief Value at the given percentile in [0, 100]; 0 for an empty histogram. */
+        [[nodiscard]] uint64_t percentile(double percentile) const noexcept
+        {
+            if (count_ == 0)
+            {
+                return 0;
+            }
+            const auto rank = static_cast<uint64_t>(
+                std::max(1.0, std::min(percentile, 100.0) / 100.0 * static_cast<double>(count_)));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < counts_.size(); ++i)
+            {
+                seen += counts_[i];
+                if (seen >= rank)
+                {
+                    return std::clamp(highest_value_of(i), min_, max_);
+                }
+            }
+            return max_;
+        }
+
+        [[nodiscard]] uint64_t count() const noexcept { return count_; }
+        [[nodiscard]] uint64_t min() const noexcept { return count_ ? min_ : 0; }
+        [[nodiscard]] uint64_t max() const noexcept { return max_; }
+        [[nodiscard]] double mean() const noexcept
+        {
+            return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0;
+        }
+
+    private:
+        [[nodiscard]] static constexpr size_t index_of(uint64_t value) noexcept
+        {
+            if (value < kSubBucketCount)
+            {
+                return static_cast<size_t>(value);
+            }
+            const int shift = std::bit_width(value) - kSubBucketBits;
+            return static_cast<size_t>(shift * kHalfCount + (value >> shift));
+        }
+
+        [[nodiscard]] static constexpr uint64_t highest_value_of(size_t index) noexcept
+        {
+            if (index < kSubBucketCount)
+            {
+                return index;
+            }
+            const uint64_t shift = index / kHalfCount - 1;
+            const uint64_t mantissa = index - shift * kHalfCount;
+            return ((mantissa + 1) << shift) - 1;
+        }
+
+        std::vector<uint64_t> counts_;
+        uint64_t count_ = 0;
+        uint64_t sum_ = 0;
+        uint64_t min_ = std::numeric_limits<uint64_t>::max();
+        uint64_t max_ = 0;
+    };
+}  // namespace pds::metrics
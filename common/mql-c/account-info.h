@@ -10,6 +10,8 @@ extern "C" {
 #include "common_alternate.h"
 #include "enums_alternate.h"
 
+MQL_C_PACK_BEGIN
+
     typedef struct {
         double balance;
         double credit;
@@ -22,11 +24,14 @@ extern "C" {
         double margin_so_so;
     } AccountInfoDouble;
 
+#define MQL_ACCOUNT_STRING_LENGTH 64
+
+    /* Null-terminated UTF-16, as MQL strings are, so the struct can be passed by value. */
     typedef struct {
-        char* account_name;
-        char* trade_server_name;
-        char* account_currency;
-        char* account_company;
+        MQL_ushort account_name[MQL_ACCOUNT_STRING_LENGTH];
+        MQL_ushort trade_server_name[MQL_ACCOUNT_STRING_LENGTH];
+        MQL_ushort account_currency[MQL_ACCOUNT_STRING_LENGTH];
+        MQL_ushort account_company[MQL_ACCOUNT_STRING_LENGTH];
     } AccountInfoString;
 
     typedef struct {
@@ -80,5 +85,18 @@ extern "C" {
         double liabilities;
         double commission_blocked;
     } MQL5_AccountInfoDouble;
-} 
+
+    /* Everything known about an account. */
+    typedef struct {
+        MQL5_AccountInfoInteger integer_info;
+        MQL5_AccountInfoDouble double_info;
+        AccountInfoString string_info;
+    } MQL5_AccountInfo;
+
+MQL_C_PACK_END
+
+#endif
+#ifdef __cplusplus
+}
+#endif
 #endif
\ No newline at end of file
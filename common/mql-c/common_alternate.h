@@ -0,0 +1,28 @@
+#ifndef COMMON_ALTERNATE_C_H
+#define COMMON_ALTERNATE_C_H
+
+#include <stdint.h>
+
+/*
+ * MQL5 passes structures to DLLs byte-packed unless they are declared with pack(n), so every
+ * structure of these headers is declared inside MQL_C_PACK_BEGIN/MQL_C_PACK_END.
+ */
+#define MQL_C_PACK_BEGIN _Pragma("pack(push, 1)")
+#define MQL_C_PACK_END _Pragma("pack(pop)")
+
+    typedef int8_t MQL_char;
+    typedef uint8_t MQL_uchar;
+
+    typedef int16_t MQL_short;
+    typedef uint16_t MQL_ushort;
+
+    typedef int32_t MQL_int;
+    typedef uint32_t MQL_uint;
+
+    typedef int64_t MQL_long;
+    typedef uint64_t MQL_ulong;
+
+    /* MQL datetime: seconds since 01.01.1970. */
+    typedef int64_t MQL_datetime;
+
+#endif
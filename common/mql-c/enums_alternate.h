@@ -0,0 +1,125 @@
+#ifndef ENUMS_ALTERNATE_C_H
+#define ENUMS_ALTERNATE_C_H
+
+/* Values match the MQL5 constants of the same names and mql-cpp/enums.hpp. */
+
+    typedef enum {
+        ACCOUNT_TRADE_MODE_DEMO = 0,
+        ACCOUNT_TRADE_MODE_CONTEST = 1,
+        ACCOUNT_TRADE_MODE_REAL = 2
+    } EnumAccountTradeMode;
+
+    typedef enum {
+        ACCOUNT_STOPOUT_MODE_PERCENT = 0,
+        ACCOUNT_STOPOUT_MODE_MONEY = 1
+    } EnumAccountStopOutMode;
+
+    typedef enum {
+        ACCOUNT_MARGIN_MODE_RETAIL_NETTING = 0,
+        ACCOUNT_MARGIN_MODE_EXCHANGE = 1,
+        ACCOUNT_MARGIN_MODE_RETAIL_HEDGING = 2
+    } EnumAccountMarginMode;
+
+    typedef enum {
+        ORDER_TYPE_BUY = 0,
+        ORDER_TYPE_SELL = 1,
+        ORDER_TYPE_BUY_LIMIT = 2,
+        ORDER_TYPE_SELL_LIMIT = 3,
+        ORDER_TYPE_BUY_STOP = 4,
+        ORDER_TYPE_SELL_STOP = 5,
+        ORDER_TYPE_BUY_STOP_LIMIT = 6,
+        ORDER_TYPE_SELL_STOP_LIMIT = 7,
+        ORDER_TYPE_CLOSE_BY = 8
+    } EnumOrderType;
+
+    typedef enum {
+        ORDER_STATE_STARTED = 0,
+        ORDER_STATE_PLACED = 1,
+        ORDER_STATE_CANCELED = 2,
+        ORDER_STATE_PARTIAL = 3,
+        ORDER_STATE_FILLED = 4,
+        ORDER_STATE_REJECTED = 5,
+        ORDER_STATE_EXPIRED = 6,
+        ORDER_STATE_REQUEST_ADD = 7,
+        ORDER_STATE_REQUEST_MODIFY = 8,
+        ORDER_STATE_REQUEST_CANCEL = 9
+    } EnumOrderState;
+
+    typedef enum {
+        ORDER_FILLING_FOK = 0,
+        ORDER_FILLING_IOC = 1,
+        ORDER_FILLING_BOC = 2,
+        ORDER_FILLING_RETURN = 3
+    } EnumOrderTypeFilling;
+
+    typedef enum {
+        ORDER_TIME_GTC = 0,
+        ORDER_TIME_DAY = 1,
+        ORDER_TIME_SPECIFIED = 2,
+        ORDER_TIME_SPECIFIED_DAY = 3
+    } EnumOrderTypeTime;
+
+    typedef enum {
+        ORDER_REASON_CLIENT = 0,
+        ORDER_REASON_MOBILE = 1,
+        ORDER_REASON_WEB = 2,
+        ORDER_REASON_EXPERT = 3,
+        ORDER_REASON_SL = 4,
+        ORDER_REASON_TP = 5,
+        ORDER_REASON_SO = 6
+    } EnumOrderReason;
+
+    typedef enum {
+        POSITION_TYPE_BUY = 0,
+        POSITION_TYPE_SELL = 1
+    } EnumPositionType;
+
+    typedef enum {
+        POSITION_REASON_CLIENT = 0,
+        POSITION_REASON_MOBILE = 1,
+        POSITION_REASON_WEB = 2,
+        POSITION_REASON_EXPERT = 3
+    } EnumPositionReason;
+
+    typedef enum {
+        DEAL_TYPE_BUY = 0,
+        DEAL_TYPE_SELL = 1,
+        DEAL_TYPE_BALANCE = 2,
+        DEAL_TYPE_CREDIT = 3,
+        DEAL_TYPE_CHARGE = 4,
+        DEAL_TYPE_CORRECTION = 5,
+        DEAL_TYPE_BONUS = 6,
+        DEAL_TYPE_COMMISSION = 7,
+        DEAL_TYPE_COMMISSION_DAILY = 8,
+        DEAL_TYPE_COMMISSION_MONTHLY = 9,
+        DEAL_TYPE_COMMISSION_AGENT_DAILY = 10,
+        DEAL_TYPE_COMMISSION_AGENT_MONTHLY = 11,
+        DEAL_TYPE_INTEREST = 12,
+        DEAL_TYPE_BUY_CANCELED = 13,
+        DEAL_TYPE_SELL_CANCELED = 14,
+        DEAL_DIVIDEND = 15,
+        DEAL_DIVIDEND_FRANKED = 16,
+        DEAL_TAX = 17
+    } EnumDealType;
+
+    typedef enum {
+        DEAL_ENTRY_IN = 0,
+        DEAL_ENTRY_OUT = 1,
+        DEAL_ENTRY_INOUT = 2,
+        DEAL_ENTRY_OUT_BY = 3
+    } EnumDealEntry;
+
+    typedef enum {
+        DEAL_REASON_CLIENT = 0,
+        DEAL_REASON_MOBILE = 1,
+        DEAL_REASON_WEB = 2,
+        DEAL_REASON_EXPERT = 3,
+        DEAL_REASON_SL = 4,
+        DEAL_REASON_TP = 5,
+        DEAL_REASON_SO = 6,
+        DEAL_REASON_ROLLOVER = 7,
+        DEAL_REASON_VMARGIN = 8,
+        DEAL_REASON_SPLIT = 9
+    } EnumDealReason;
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef MARKET_INFO_C_H
+#define MARKET_INFO_C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "common_alternate.h"
+
+MQL_C_PACK_BEGIN
+
+    /* Same layout as MqlTick, so an EA passes the one SymbolInfoTick filled. */
+    typedef struct {
+        MQL_datetime time;
+        double bid;
+        double ask;
+        double last;
+        MQL_ulong volume;
+        MQL_long time_msc;
+        /* TICK_FLAG_* */
+        MQL_uint flags;
+        double volume_real;
+    } MQL5_Tick;
+
+MQL_C_PACK_END
+
+#ifdef __cplusplus
+}
+#endif
+#endif
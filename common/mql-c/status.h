@@ -0,0 +1,15 @@
+#ifndef STATUS_C_H
+#define STATUS_C_H
+
+/* Status codes of the functions server_dll and client_dll export. */
+#define PDS_OK 0
+#define PDS_QUEUE_FULL 1
+#define PDS_NOT_STARTED 2
+#define PDS_INVALID_ARGUMENT 3
+#define PDS_ERROR 4
+#define PDS_NOT_SUBSCRIBED 5
+#define PDS_TOO_MANY_SUBSCRIPTIONS 6
+#define PDS_CHANNEL_NOT_OPEN 7
+#define PDS_TOO_MANY_CHANNELS 8
+
+#endif
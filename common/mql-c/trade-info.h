@@ -0,0 +1,124 @@
+#ifndef TRADE_INFO_C_H
+#define TRADE_INFO_C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "common_alternate.h"
+#include "enums_alternate.h"
+
+MQL_C_PACK_BEGIN
+
+    /* Numeric properties of mql-cpp/trade-info.hpp; strings are passed to the DLL separately. */
+
+    typedef struct {
+        MQL_long ticket;
+        MQL_datetime time_setup;
+        EnumOrderType type;
+        EnumOrderState state;
+        MQL_datetime time_expiration;
+        MQL_datetime time_done;
+        MQL_long time_setup_msc;
+        MQL_long time_done_msc;
+        EnumOrderTypeFilling type_filling;
+        EnumOrderTypeTime type_time;
+        MQL_long magic;
+        EnumOrderReason reason;
+        MQL_long position_id;
+        MQL_long position_by_id;
+    } MQL5_OrderInfoInteger;
+
+    typedef struct {
+        double volume_initial;
+        double volume_current;
+        double price_open;
+        double stop_loss;
+        double take_profit;
+        double price_current;
+        double stop_limit;
+    } MQL5_OrderInfoDouble;
+
+    typedef struct {
+        MQL_long ticket;
+        MQL_datetime open_time;
+        MQL_long open_time_msc;
+        MQL_datetime time_update;
+        MQL_long time_update_msc;
+        EnumPositionType type;
+        MQL_long magic;
+        MQL_long identifier;
+        EnumPositionReason reason;
+    } MQL5_PositionInfoInteger;
+
+    typedef struct {
+        double volume;
+        double price_open;
+        double stop_loss;
+        double take_profit;
+        double price_current;
+        double swap;
+        double profit;
+    } MQL5_PositionInfoDouble;
+
+    typedef struct {
+        MQL_long ticket;
+        MQL_long order;
+        MQL_datetime time;
+        MQL_long time_msc;
+        EnumDealType type;
+        EnumDealEntry entry;
+        MQL_long magic;
+        EnumDealReason reason;
+        MQL_long position_id;
+    } MQL5_DealInfoInteger;
+
+    typedef struct {
+        double volume;
+        double price;
+        double commission;
+        double swap;
+        double profit;
+        double fee;
+        double stop_loss;
+        double take_profit;
+    } MQL5_DealInfoDouble;
+
+    /*
+     * Complete records for arrays filled by a DLL in one call. Strings are null-terminated
+     * UTF-16, which MQL reads as ushort arrays: ShortArrayToString(position.symbol).
+     */
+#define MQL_SYMBOL_LENGTH 32
+#define MQL_COMMENT_LENGTH 64
+#define MQL_EXTERNAL_ID_LENGTH 32
+
+    typedef struct {
+        MQL5_OrderInfoInteger integer_info;
+        MQL5_OrderInfoDouble double_info;
+        MQL_ushort symbol[MQL_SYMBOL_LENGTH];
+        MQL_ushort comment[MQL_COMMENT_LENGTH];
+        MQL_ushort external_id[MQL_EXTERNAL_ID_LENGTH];
+    } MQL5_OrderInfo;
+
+    typedef struct {
+        MQL5_PositionInfoInteger integer_info;
+        MQL5_PositionInfoDouble double_info;
+        MQL_ushort symbol[MQL_SYMBOL_LENGTH];
+        MQL_ushort comment[MQL_COMMENT_LENGTH];
+        MQL_ushort external_id[MQL_EXTERNAL_ID_LENGTH];
+    } MQL5_PositionInfo;
+
+    typedef struct {
+        MQL5_DealInfoInteger integer_info;
+        MQL5_DealInfoDouble double_info;
+        MQL_ushort symbol[MQL_SYMBOL_LENGTH];
+        MQL_ushort comment[MQL_COMMENT_LENGTH];
+        MQL_ushort external_id[MQL_EXTERNAL_ID_LENGTH];
+    } MQL5_DealInfo;
+
+MQL_C_PACK_END
+
+#ifdef __cplusplus
+}
+#endif
+#endif
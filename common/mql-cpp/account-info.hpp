@@ -34,10 +34,10 @@ namespace mql::common
 
     struct AccountInfoString
     {
-        std::string account_name;
-        std::string trade_server_name;
-        std::string account_currency;
-        std::string account_company;
+        AccountString account_name;
+        AccountString trade_server_name;
+        AccountString account_currency;
+        AccountString account_company;
 
     private:
         friend class boost::serialization::access;
@@ -168,6 +168,7 @@ namespace mql::mql5
         template <class Archive>
         void serialize(Archive &ar, const unsigned int)
         {
+            ar &boost::serialization::base_object<common::AccountInfoInteger>(*this);
             ar &margin_mode;
             ar &currency_digits;
             ar &fifo_close;
@@ -188,6 +189,7 @@ namespace mql::mql5
         template <class Archive>
         void serialize(Archive &ar, const unsigned int)
         {
+            ar &boost::serialization::base_object<common::AccountInfoDouble>(*this);
             ar &margin_initial;
             ar &margin_maintenance;
             ar &assets;
@@ -197,3 +199,9 @@ namespace mql::mql5
     };
 
 }  // namespace mql::mql5
+
+// Copied between the C ABI, the caches and the wire as plain bytes.
+static_assert(std::is_trivially_copyable_v<mql::common::AccountInfoMinimal>);
+static_assert(std::is_trivially_copyable_v<mql::mql4::FullAccountInfo>);
+static_assert(std::is_trivially_copyable_v<mql::mql5::AccountInfoInteger>);
+static_assert(std::is_trivially_copyable_v<mql::mql5::AccountInfoDouble>);
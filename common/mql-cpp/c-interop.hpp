@@ -0,0 +1,246 @@
+#pragma once
+#include "../mql-c/account-info.h"
+#include "../mql-c/market-info.h"
+#include "../mql-c/trade-info.h"
+#include "mql.hpp"
+#include "wide-string.hpp"
+
+namespace mql
+{
+    /** @brief MQL datetime values are whole seconds. */
+    [[nodiscard]] inline MQL_DateTime from_c_datetime(MQL_datetime seconds)
+    {
+        return MQL_DateTime{ std::chrono::seconds{ seconds } };
+    }
+    [[nodiscard]] inline MQL_datetime to_c_datetime(MQL_DateTime time)
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+    }
+
+    inline void from_c(mql5::AccountInfoInteger &out, MQL5_AccountInfoInteger const &in)
+    {
+        out.account_login = in.base_info.account_login;
+        out.trade_mode = static_cast<common::EnumAccountTradeMode>(in.base_info.trade_mode);
+        out.account_leverage = in.base_info.account_leverage;
+        out.limit_orders = in.base_info.limit_orders;
+        out.margin_so_mode = static_cast<common::EnumAccountStopOutMode>(in.base_info.margin_so_mode);
+        out.trade_allowed = in.base_info.trade_allowed != 0;
+        out.expert_trade_allowed = in.base_info.expert_trade_allowed != 0;
+        out.margin_mode = static_cast<mql5::EnumAccountMarginMode>(in.margin_mode);
+        out.currency_digits = in.currency_digits;
+        out.fifo_close = in.fifo_close != 0;
+        out.hedge_allowed = in.hedge_allowed != 0;
+    }
+
+    inline void from_c(mql5::AccountInfoDouble &out, MQL5_AccountInfoDouble const &in)
+    {
+        out.balance = in.base_info.balance;
+        out.credit = in.base_info.credit;
+        out.profit = in.base_info.profit;
+        out.equity = in.base_info.equity;
+        out.margin = in.base_info.margin;
+        out.margin_free = in.base_info.margin_free;
+        out.margin_level = in.base_info.margin_level;
+        out.margin_so_call = in.base_info.margin_so_call;
+        out.margin_so_so = in.base_info.margin_so_so;
+        out.margin_initial = in.margin_initial;
+        out.margin_maintenance = in.margin_maintenance;
+        out.assets = in.assets;
+        out.liabilities = in.liabilities;
+        out.commission_blocked = in.commission_blocked;
+    }
+
+    inline void from_c(mql5::OrderInfoInteger &out, MQL5_OrderInfoInteger const &in)
+    {
+        out.ticket = in.ticket;
+        out.time_setup = from_c_datetime(in.time_setup);
+        out.type = static_cast<mql5::EnumOrderType>(in.type);
+        out.state = static_cast<mql5::EnumOrderState>(in.state);
+        out.time_expiration = from_c_datetime(in.time_expiration);
+        out.time_done = from_c_datetime(in.time_done);
+        out.time_setup_msc = in.time_setup_msc;
+        out.time_done_msc = in.time_done_msc;
+        out.type_filling = static_cast<mql5::EnumOrderTypeFilling>(in.type_filling);
+        out.type_time = static_cast<mql5::EnumOrderTypeTime>(in.type_time);
+        out.magic = in.magic;
+        out.reason = static_cast<mql5::EnumOrderReason>(in.reason);
+        out.position_id = in.position_id;
+        out.position_by_id = in.position_by_id;
+    }
+
+    inline void from_c(mql5::OrderInfoDouble &out, MQL5_OrderInfoDouble const &in)
+    {
+        out.volume_initial = in.volume_initial;
+        out.volume_current = in.volume_current;
+        out.price_open = in.price_open;
+        out.stop_loss = in.stop_loss;
+        out.take_profit = in.take_profit;
+        out.price_current = in.price_current;
+        out.stop_limit = in.stop_limit;
+    }
+
+    inline void from_c(mql5::PositionInfoInteger &out, MQL5_PositionInfoInteger const &in)
+    {
+        out.ticket = in.ticket;
+        out.open_time = from_c_datetime(in.open_time);
+        out.open_time_msc = in.open_time_msc;
+        out.time_update = from_c_datetime(in.time_update);
+        out.time_update_msc = in.time_update_msc;
+        out.type = static_cast<mql5::EnumPositionType>(in.type);
+        out.magic = in.magic;
+        out.identifier = in.identifier;
+        out.reason = static_cast<mql5::EnumPositionReason>(in.reason);
+    }
+
+    inline void from_c(mql5::PositionInfoDouble &out, MQL5_PositionInfoDouble const &in)
+    {
+        out.volume = in.volume;
+        out.price_open = in.price_open;
+        out.stop_loss = in.stop_loss;
+        out.take_profit = in.take_profit;
+        out.price_current = in.price_current;
+        out.swap = in.swap;
+        out.profit = in.profit;
+    }
+
+    inline void from_c(mql5::DealInfoInteger &out, MQL5_DealInfoInteger const &in)
+    {
+        out.ticket = in.ticket;
+        out.order = in.order;
+        out.time = from_c_datetime(in.time);
+        out.time_msc = in.time_msc;
+        out.type = static_cast<mql5::EnumDealType>(in.type);
+        out.entry = static_cast<mql5::EnumDealEntry>(in.entry);
+        out.magic = in.magic;
+        out.reason = static_cast<mql5::EnumDealReason>(in.reason);
+        out.position_id = in.position_id;
+    }
+
+    inline void from_c(mql5::DealInfoDouble &out, MQL5_DealInfoDouble const &in)
+    {
+        out.volume = in.volume;
+        out.price = in.price;
+        out.commission = in.commission;
+        out.swap = in.swap;
+        out.profit = in.profit;
+        out.fee = in.fee;
+        out.stop_loss = in.stop_loss;
+        out.take_profit = in.take_profit;
+    }
+
+    inline void to_c(MQL5_AccountInfoInteger &out, mql5::AccountInfoInteger const &in)
+    {
+        out.base_info.account_login = in.account_login;
+        out.base_info.trade_mode = static_cast<EnumAccountTradeMode>(in.trade_mode);
+        out.base_info.account_leverage = in.account_leverage;
+        out.base_info.limit_orders = in.limit_orders;
+        out.base_info.margin_so_mode = static_cast<EnumAccountStopOutMode>(in.margin_so_mode);
+        out.base_info.trade_allowed = in.trade_allowed;
+        out.base_info.expert_trade_allowed = in.expert_trade_allowed;
+        out.margin_mode = static_cast<EnumAccountMarginMode>(in.margin_mode);
+        out.currency_digits = in.currency_digits;
+        out.fifo_close = in.fifo_close;
+        out.hedge_allowed = in.hedge_allowed;
+    }
+
+    inline void to_c(MQL5_AccountInfoDouble &out, mql5::AccountInfoDouble const &in)
+    {
+        out.base_info.balance = in.balance;
+        out.base_info.credit = in.credit;
+        out.base_info.profit = in.profit;
+        out.base_info.equity = in.equity;
+        out.base_info.margin = in.margin;
+        out.base_info.margin_free = in.margin_free;
+        out.base_info.margin_level = in.margin_level;
+        out.base_info.margin_so_call = in.margin_so_call;
+        out.base_info.margin_so_so = in.margin_so_so;
+        out.margin_initial = in.margin_initial;
+        out.margin_maintenance = in.margin_maintenance;
+        out.assets = in.assets;
+        out.liabilities = in.liabilities;
+        out.commission_blocked = in.commission_blocked;
+    }
+
+    inline void to_c(AccountInfoString &out, common::AccountInfoString const &in)
+    {
+        to_utf16(in.account_name, out.account_name);
+        to_utf16(in.trade_server_name, out.trade_server_name);
+        to_utf16(in.account_currency, out.account_currency);
+        to_utf16(in.account_company, out.account_company);
+    }
+
+    inline void to_c(MQL5_OrderInfo &out, mql5::OrderInfo const &in)
+    {
+        out.integer_info.ticket = in.ticket;
+        out.integer_info.time_setup = to_c_datetime(in.time_setup);
+        out.integer_info.type = static_cast<EnumOrderType>(in.type);
+        out.integer_info.state = static_cast<EnumOrderState>(in.state);
+        out.integer_info.time_expiration = to_c_datetime(in.time_expiration);
+        out.integer_info.time_done = to_c_datetime(in.time_done);
+        out.integer_info.time_setup_msc = in.time_setup_msc;
+        out.integer_info.time_done_msc = in.time_done_msc;
+        out.integer_info.type_filling = static_cast<EnumOrderTypeFilling>(in.type_filling);
+        out.integer_info.type_time = static_cast<EnumOrderTypeTime>(in.type_time);
+        out.integer_info.magic = in.magic;
+        out.integer_info.reason = static_cast<EnumOrderReason>(in.reason);
+        out.integer_info.position_id = in.position_id;
+        out.integer_info.position_by_id = in.position_by_id;
+        out.double_info.volume_initial = in.volume_initial;
+        out.double_info.volume_current = in.volume_current;
+        out.double_info.price_open = in.price_open;
+        out.double_info.stop_loss = in.stop_loss;
+        out.double_info.take_profit = in.take_profit;
+        out.double_info.price_current = in.price_current;
+        out.double_info.stop_limit = in.stop_limit;
+        to_utf16(in.symbol, out.symbol);
+        to_utf16(in.comment, out.comment);
+        to_utf16(in.external_id, out.external_id);
+    }
+
+    inline void to_c(MQL5_PositionInfo &out, mql5::PositionInfo const &in)
+    {
+        out.integer_info.ticket = in.ticket;
+        out.integer_info.open_time = to_c_datetime(in.open_time);
+        out.integer_info.open_time_msc = in.open_time_msc;
+        out.integer_info.time_update = to_c_datetime(in.time_update);
+        out.integer_info.time_update_msc = in.time_update_msc;
+        out.integer_info.type = static_cast<EnumPositionType>(in.type);
+        out.integer_info.magic = in.magic;
+        out.integer_info.identifier = in.identifier;
+        out.integer_info.reason = static_cast<EnumPositionReason>(in.reason);
+        out.double_info.volume = in.volume;
+        out.double_info.price_open = in.price_open;
+        out.double_info.stop_loss = in.stop_loss;
+        out.double_info.take_profit = in.take_profit;
+        out.double_info.price_current = in.price_current;
+        out.double_info.swap = in.swap;
+        out.double_info.profit = in.profit;
+        to_utf16(in.symbol, out.symbol);
+        to_utf16(in.comment, out.comment);
+        to_utf16(in.external_id, out.external_id);
+    }
+
+    inline void to_c(MQL5_DealInfo &out, mql5::DealInfo const &in)
+    {
+        out.integer_info.ticket = in.ticket;
+        out.integer_info.order = in.order;
+        out.integer_info.time = to_c_datetime(in.time);
+        out.integer_info.time_msc = in.time_msc;
+        out.integer_info.type = static_cast<EnumDealType>(in.type);
+        out.integer_info.entry = static_cast<EnumDealEntry>(in.entry);
+        out.integer_info.magic = in.magic;
+        out.integer_info.reason = static_cast<EnumDealReason>(in.reason);
+        out.integer_info.position_id = in.position_id;
+        out.double_info.volume = in.volume;
+        out.double_info.price = in.price;
+        out.double_info.commission = in.commission;
+        out.double_info.swap = in.swap;
+        out.double_info.profit = in.profit;
+        out.double_info.fee = in.fee;
+        out.double_info.stop_loss = in.stop_loss;
+        out.double_info.take_profit = in.take_profit;
+        to_utf16(in.symbol, out.symbol);
+        to_utf16(in.comment, out.comment);
+        to_utf16(in.external_id, out.external_id);
+    }
+}  // namespace mql
@@ -1,4 +1,5 @@
 #pragma once
+#include "fixed-string.hpp"
 #include "mal-packet-weaver/packet.hpp"
 
 namespace mql
@@ -16,6 +17,13 @@ namespace mql
     using MQL_ulong = uint64_t;
 
     using MQL_DateTime = std::chrono::time_point<std::chrono::milliseconds>;
+
+    // Capacities in UTF-8 bytes of the MQL strings the structures keep. MetaTrader limits
+    // symbols to 31 characters; the others leave room for non-ASCII text.
+    using SymbolString = FixedString<32>;
+    using CommentString = FixedString<64>;
+    using ExternalIdString = FixedString<32>;
+    using AccountString = FixedString<64>;
 }  // namespace mql
 namespace boost::serialization
 {
@@ -0,0 +1,137 @@
+#pragma once
+#include <boost/serialization/array_wrapper.hpp>
+#include <boost/serialization/level.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/tracking.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace mql
+{
+    /**
+     * @brief UTF-8 string of at most N bytes stored inline, so that the structures holding MQL
+     * strings stay trivially copyable and never allocate.
+     *
+     * @details Longer text is truncated at a character boundary. In binary archives it is
+     * written exactly like std::string (size_t length, then the bytes), so peers that still use
+     * std::string read it unchanged; longer strings they send are truncated on load.
+     */
+    template <size_t N>
+    class FixedString
+    {
+    public:
+        static_assert(N > 0 && N <= UINT16_MAX);
+        using size_type = std::conditional_t<N <= UINT8_MAX, uint8_t, uint16_t>;
+
+        FixedString() = default;
+        FixedString(std::string_view text) noexcept { assign(text); }
+        FixedString &operator=(std::string_view text) noexcept
+        {
+            assign(text);
+            return *this;
+        }
+
+        void assign(std::string_view text) noexcept
+        {
+            size_ = static_cast<size_type>(utf8_prefix(text));
+            std::copy_n(text.data(), size_, data_.data());
+        }
+        void clear() noexcept { size_ = 0; }
+
+        [[nodiscard]] static constexpr size_t capacity() noexcept { return N; }
+        [[nodiscard]] size_t size() const noexcept { return size_; }
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+        [[nodiscard]] const char *data() const noexcept { return data_.data(); }
+        [[nodiscard]] std::string_view view() const noexcept { return { data_.data(), size_ }; }
+        [[nodiscard]] std::string str() const { return std::string{ view() }; }
+        operator std::string_view() const noexcept { return view(); }
+
+        /** @brief The whole storage, for writers that produce the text in place; see set_size. */
+        [[nodiscard]] std::span<char, N> buffer() noexcept { return data_; }
+        void set_size(size_t size) noexcept { size_ = static_cast<size_type>(std::min(size, N)); }
+
+        friend bool operator==(FixedString const &lhs, FixedString const &rhs) noexcept
+        {
+            return lhs.view() == rhs.view();
+        }
+        friend bool operator==(FixedString const &lhs, std::string_view rhs) noexcept { return lhs.view() == rhs; }
+
+    private:
+        // Length of the longest prefix of text that fits and doesn't split a character.
+        [[nodiscard]] static size_t utf8_prefix(std::string_view text) noexcept
+        {
+            return text.size() <= N ? text.size() : cut_at_boundary(text.data(), text[N]);
+        }
+        // Length of the first N bytes of data without the character that `next` continues, if any.
+        [[nodiscard]] static size_t cut_at_boundary(const char *data, char next) noexcept
+        {
+            const auto continuation = [](char c) { return (static_cast<uint8_t>(c) & 0xC0) == 0x80; };
+            size_t size = N;
+            while (size > 0 && continuation(size == N ? next : data[size]))
+            {
+                --size;
+            }
+            return size;
+        }
+
+        friend class boost::serialization::access;
+        template <class Archive>
+        void save(Archive &ar, const unsigned int) const
+        {
+            const std::size_t size = size_;
+            ar << size;
+            ar << boost::serialization::make_array(data_.data(), size_);
+        }
+        template <class Archive>
+        void load(Archive &ar, const unsigned int)
+        {
+            std::size_t size;
+            ar >> size;
+            const size_t kept = std::min(size, N);
+            ar >> boost::serialization::make_array(data_.data(), kept);
+            size_ = static_cast<size_type>(kept);
+            char next = 0;
+            for (size_t skipped = kept; skipped < size;)
+            {
+                std::array<char, 64> scratch;
+                const size_t chunk = std::min(scratch.size(), size - skipped);
+                ar >> boost::serialization::make_array(scratch.data(), chunk);
+                next = skipped == kept ? scratch[0] : next;
+                skipped += chunk;
+            }
+            if (kept < size)
+            {
+                size_ = static_cast<size_type>(cut_at_boundary(data_.data(), next));
+            }
+        }
+        BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+        std::array<char, N> data_;
+        size_type size_ = 0;
+    };
+}  // namespace mql
+
+namespace boost::serialization
+{
+    // Saved inline like std::string: no class information, and no tracking, which would
+    // register the type with every archive and allocate.
+    template <size_t N>
+    struct implementation_level_impl<const mql::FixedString<N>>
+    {
+        using tag = mpl::integral_c_tag;
+        using type = mpl::int_<object_serializable>;
+        BOOST_STATIC_CONSTANT(int, value = type::value);
+    };
+    template <size_t N>
+    struct tracking_level_impl<const mql::FixedString<N>>
+    {
+        using tag = mpl::integral_c_tag;
+        using type = mpl::int_<track_never>;
+        BOOST_STATIC_CONSTANT(int, value = type::value);
+    };
+}  // namespace boost::serialization
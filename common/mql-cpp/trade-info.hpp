@@ -52,10 +52,10 @@ namespace mql::mql5
             ar &time_done;
             ar &time_setup_msc;
             ar &time_done_msc;
-            ar &state;
-            ar &state;
+            ar &type_filling;
+            ar &type_time;
             ar &magic;
-            ar &state;
+            ar &reason;
             ar &position_id;
             ar &position_by_id;
         }
@@ -96,11 +96,11 @@ namespace mql::mql5
     struct OrderInfoString
     {
         /** @brief Symbol of the order */
-        std::string symbol;
+        SymbolString symbol;
         /** @brief Order comment */
-        std::string comment;
+        CommentString comment;
         /** @brief Order identifier in an external trading system (on the Exchange) */
-        std::string external_id;
+        ExternalIdString external_id;
 
     private:
         friend class boost::serialization::access;
@@ -223,15 +223,15 @@ namespace mql::mql5
         /**
          * @brief Symbol of the position
          */
-        std::string symbol;
+        SymbolString symbol;
         /**
          * @brief Position comment
          */
-        std::string comment;
+        CommentString comment;
         /**
          * @brief Position identifier in an external trading system (on the Exchange)
          */
-        std::string external_id;
+        ExternalIdString external_id;
 
     private:
         friend class boost::serialization::access;
@@ -383,13 +383,13 @@ namespace mql::mql5
     struct DealInfoString
     {
         /** @brief Deal symbol */
-        std::string symbol;
+        SymbolString symbol;
 
         /** @brief Deal comment */
-        std::string comment;
+        CommentString comment;
 
         /** @brief Deal identifier in an external trading system (on the Exchange) */
-        std::string external_id;
+        ExternalIdString external_id;
 
     private:
         friend class boost::serialization::access;
@@ -415,6 +415,12 @@ namespace mql::mql5
         }
     };
 
+    /** @brief Whether an order in this state left the terminal's pending orders for good. */
+    [[nodiscard]] constexpr bool is_final(EnumOrderState state) noexcept
+    {
+        return state == EnumOrderState::OrderStateFilled || state == EnumOrderState::OrderStateCanceled ||
+               state == EnumOrderState::OrderStateRejected || state == EnumOrderState::OrderStateExpired;
+    }
 }  // namespace mql::mql5
 
 namespace mql::mql4
@@ -423,7 +429,7 @@ namespace mql::mql4
     {
         double close_price;
         MQL_DateTime close_time;
-        std::string comment;
+        CommentString comment;
         double commission;
         MQL_DateTime expiration;
         double lots;
@@ -433,7 +439,7 @@ namespace mql::mql4
         double order_profit;
         double stop_loss;
         double swap;
-        std::string symbol;
+        SymbolString symbol;
         double take_profit;
         MQL_int ticket;
         MQL_int type;
@@ -460,4 +466,10 @@ namespace mql::mql4
             ar &type;
         }
     };
-}  // namespace mql::mql4
\ No newline at end of file
+}  // namespace mql::mql4
+
+// Copied between the C ABI, the caches and the wire as plain bytes.
+static_assert(std::is_trivially_copyable_v<mql::mql5::OrderInfo>);
+static_assert(std::is_trivially_copyable_v<mql::mql5::PositionInfo>);
+static_assert(std::is_trivially_copyable_v<mql::mql5::DealInfo>);
+static_assert(std::is_trivially_copyable_v<mql::mql4::OrderInfo>);
@@ -0,0 +1,159 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "fixed-string.hpp"
+
+namespace mql
+{
+    namespace detail
+    {
+        /** @brief Decodes the code point of MQL text at i and moves i to its last unit. */
+        inline uint32_t next_code_point(std::wstring_view text, size_t &i) noexcept
+        {
+            auto code_point = static_cast<uint32_t>(text[i]);
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (code_point >= 0xD800 && code_point <= 0xDBFF && i + 1 < text.size() &&
+                    static_cast<uint32_t>(text[i + 1]) >= 0xDC00 && static_cast<uint32_t>(text[i + 1]) <= 0xDFFF)
+                {
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (static_cast<uint32_t>(text[++i]) - 0xDC00);
+                }
+                else if (code_point >= 0xD800 && code_point <= 0xDFFF)
+                {
+                    code_point = 0xFFFD;
+                }
+            }
+            return code_point;
+        }
+
+        /** @brief Writes the UTF-8 encoding of code_point and returns its length. */
+        inline size_t encode_utf8(uint32_t code_point, char (&out)[4]) noexcept
+        {
+            if (code_point < 0x80)
+            {
+                out[0] = static_cast<char>(code_point);
+                return 1;
+            }
+            if (code_point < 0x800)
+            {
+                out[0] = static_cast<char>(0xC0 | code_point >> 6);
+                out[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+                return 2;
+            }
+            if (code_point < 0x10000)
+            {
+                out[0] = static_cast<char>(0xE0 | code_point >> 12);
+                out[1] = static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+                out[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+                return 3;
+            }
+            out[0] = static_cast<char>(0xF0 | code_point >> 18);
+            out[1] = static_cast<char>(0x80 | (code_point >> 12 & 0x3F));
+            out[2] = static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+            out[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 4;
+        }
+    }  // namespace detail
+
+    /**
+     * @brief Converts an MQL string, which reaches a DLL as UTF-16 wchar_t text on Windows, to
+     * the UTF-8 used in packets.
+     *
+     * @details Where wchar_t holds UTF-32 the code points are taken as they are. Unpaired
+     * surrogates become U+FFFD.
+     */
+    inline std::string to_utf8(std::wstring_view text)
+    {
+        std::string result;
+        result.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            char bytes[4];
+            result.append(bytes, detail::encode_utf8(detail::next_code_point(text, i), bytes));
+        }
+        return result;
+    }
+
+    /** @brief As above, but into inline storage, truncating at a character boundary. */
+    template <size_t N>
+    void to_utf8(std::wstring_view text, FixedString<N> &out) noexcept
+    {
+        const auto buffer = out.buffer();
+        size_t size = 0;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            char bytes[4];
+            const size_t length = detail::encode_utf8(detail::next_code_point(text, i), bytes);
+            if (size + length > N)
+            {
+                break;
+            }
+            std::copy_n(bytes, length, buffer.data() + size);
+            size += length;
+        }
+        out.set_size(size);
+    }
+
+    /**
+     * @brief Writes UTF-8 text into a fixed, null-terminated UTF-16 array of an MQL structure,
+     * truncating at a character boundary if it doesn't fit.
+     *
+     * @details Invalid UTF-8 sequences become U+FFFD.
+     */
+    inline void to_utf16(std::string_view text, std::span<uint16_t> out) noexcept
+    {
+        if (out.empty())
+        {
+            return;
+        }
+        size_t written = 0;
+        const size_t limit = out.size() - 1;
+        for (size_t i = 0; i < text.size();)
+        {
+            const auto lead = static_cast<uint8_t>(text[i]);
+            const size_t length = lead < 0x80 ? 1 : lead >> 5 == 0x6 ? 2 : lead >> 4 == 0xE ? 3 : lead >> 3 == 0x1E ? 4 : 0;
+            uint32_t code_point = 0xFFFD;
+            size_t consumed = 1;
+            if (length != 0 && i + length <= text.size())
+            {
+                code_point = length == 1 ? lead : lead & (0x7F >> length);
+                bool valid = true;
+                for (size_t k = 1; k < length; ++k)
+                {
+                    const auto next = static_cast<uint8_t>(text[i + k]);
+                    valid = valid && (next & 0xC0) == 0x80;
+                    code_point = code_point << 6 | (next & 0x3F);
+                }
+                if (valid)
+                {
+                    consumed = length;
+                }
+                else
+                {
+                    code_point = 0xFFFD;
+                }
+            }
+            const size_t units = code_point >= 0x10000 ? 2 : 1;
+            if (written + units > limit)
+            {
+                break;
+            }
+            if (units == 2)
+            {
+                code_point -= 0x10000;
+                out[written++] = static_cast<uint16_t>(0xD800 + (code_point >> 10));
+                out[written++] = static_cast<uint16_t>(0xDC00 + (code_point & 0x3FF));
+            }
+            else
+            {
+                out[written++] = static_cast<uint16_t>(code_point);
+            }
+            i += consumed;
+        }
+        out[written] = 0;
+    }
+}  // namespace mql
@@ -0,0 +1,66 @@
+#pragma once
+#include <mutex>
+#include <vector>
+
+#include "mal-packet-weaver/packet.hpp"
+
+namespace pds::network
+{
+    /**
+     * @brief Recycles frame buffers so steady-state sending does not allocate.
+     *
+     * @details Buffers keep their capacity while pooled; acquire() hands out the most recently
+     * released one, which is the most likely to still be in cache. Buffers beyond max_buffers or
+     * larger than max_buffer_capacity are freed instead of pooled. Thread-safe.
+     */
+    class BufferPool
+    {
+    public:
+        explicit BufferPool(size_t max_buffers = 1024, size_t max_buffer_capacity = 256 * 1024)
+            : max_buffers_{ max_buffers }, max_buffer_capacity_{ max_buffer_capacity }
+        {
+            free_.reserve(max_buffers);
+        }
+
+        /** @brief Returns a buffer of exactly `size` bytes with unspecified contents. */
+        [[nodiscard]] mal_packet_weaver::ByteArray acquire(size_t size)
+        {
+            mal_packet_weaver::ByteArray buffer;
+            {
+                std::lock_guard lock{ mutex_ };
+                if (!free_.empty())
+                {
+                    buffer = std::move(free_.back());
+                    free_.pop_back();
+                }
+            }
+            buffer.resize(size);
+            return buffer;
+        }
+
+        void release(mal_packet_weaver::ByteArray &&buffer)
+        {
+            if (buffer.capacity() == 0 || buffer.capacity() > max_buffer_capacity_)
+            {
+                return;
+            }
+            std::lock_guard lock{ mutex_ };
+            if (free_.size() < max_buffers_)
+            {
+                free_.emplace_back(std::move(buffer));
+            }
+        }
+
+        [[nodiscard]] size_t pooled() const
+        {
+            std::lock_guard lock{ mutex_ };
+            return free_.size();
+        }
+
+    private:
+        const size_t max_buffers_;
+        const size_t max_buffer_capacity_;
+        mutable std::mutex mutex_;
+        std::vector<mal_packet_weaver::ByteArray> free_;
+    };
+}  // namespace pds::network
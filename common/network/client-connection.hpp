@@ -0,0 +1,149 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "../crypto/session-encryption.hpp"
+#include "heartbeat.hpp"
+#include "mal-packet-weaver/dispatcher-session.hpp"
+#include "outbound-session.hpp"
+#include "transport.hpp"
+
+namespace pds::network
+{
+    /**
+     * @brief Client session to central_server that is kept open: connects, performs the
+     * handshake, answers heartbeats and reconnects with exponential backoff.
+     *
+     * @details Runs on the io_context it is given; session(), outbound() and the callbacks are
+     * only to be used from that io_context. on_connected registers the packet handlers of a fresh
+     * session through its outbound session, so they also get what the server sends in batches,
+     * before anything is received on it.
+     */
+    class ClientConnection
+    {
+    public:
+        using Outbound = OutboundSession<mal_packet_weaver::DispatcherSession>;
+        using OnConnected = std::function<void(Outbound &)>;
+        using OnDisconnected = std::function<void()>;
+
+        static constexpr std::chrono::milliseconds kMinReconnectDelay{ 100 };
+        static constexpr std::chrono::milliseconds kMaxReconnectDelay{ 5000 };
+
+        /**
+         * @param trust Server key to handshake with, or nullptr for a plaintext session, which the server
+         * only serves on a local endpoint.
+         * @param outbound_config Applied to what is sent through outbound().
+         */
+        ClientConnection(boost::asio::io_context &io_context, Endpoint endpoint, crypto::ServerTrust const *trust,
+                         uint32_t key_id, OnConnected on_connected, OnDisconnected on_disconnected = {},
+                         OutboundQueueConfig outbound_config = {})
+            : io_context_{ io_context },
+              endpoint_{ std::move(endpoint) },
+              trust_{ trust },
+              key_id_{ key_id },
+              on_connected_{ std::move(on_connected) },
+              on_disconnected_{ std::move(on_disconnected) },
+              outbound_config_{ std::move(outbound_config) }
+        {
+        }
+        ~ClientConnection()
+        {
+            if (session_)
+            {
+                session_->Destroy();
+            }
+        }
+
+        ClientConnection(ClientConnection const &) = delete;
+        ClientConnection &operator=(ClientConnection const &) = delete;
+
+        void start() { co_spawn(io_context_, run(), boost::asio::detached); }
+
+        /** @brief The open session, or null between connections. */
+        [[nodiscard]] std::shared_ptr<mal_packet_weaver::DispatcherSession> const &session() const noexcept
+        {
+            return session_;
+        }
+        /** @brief Sends through the session's outbound queue; null between connections. */
+        [[nodiscard]] std::shared_ptr<Outbound> const &outbound() const noexcept
+        {
+            return outbound_;
+        }
+        /** @brief Safe from any thread. */
+        [[nodiscard]] bool connected() const noexcept { return connected_.load(std::memory_order_relaxed); }
+        /** @brief Safe from any thread. */
+        [[nodiscard]] uint64_t reconnects() const noexcept { return reconnects_.load(std::memory_order_relaxed); }
+
+    private:
+        boost::asio::awaitable<void> run()
+        {
+            auto delay = kMinReconnectDelay;
+            boost::asio::steady_timer timer{ io_context_ };
+            while (true)
+            {
+                if (co_await connect())
+                {
+                    delay = kMinReconnectDelay;
+                    connected_ = true;
+                    on_connected_(*outbound_);
+                    while (!session_->is_closed())
+                    {
+                        timer.expires_after(std::chrono::milliseconds{ 100 });
+                        co_await timer.async_wait(boost::asio::use_awaitable);
+                    }
+                    connected_ = false;
+                    outbound_.reset();
+                    session_.reset();
+                    if (on_disconnected_)
+                    {
+                        on_disconnected_();
+                    }
+                    spdlog::warn("Lost connection to {}, reconnecting", endpoint_.to_string());
+                }
+                reconnects_.fetch_add(1, std::memory_order_relaxed);
+                timer.expires_after(delay);
+                co_await timer.async_wait(boost::asio::use_awaitable);
+                delay = std::min(delay * 2, kMaxReconnectDelay);
+            }
+        }
+
+        boost::asio::awaitable<bool> connect()
+        {
+            std::shared_ptr<mal_packet_weaver::DispatcherSession> session;
+            try
+            {
+                Socket socket = co_await async_connect(endpoint_);
+                session = std::make_shared<mal_packet_weaver::DispatcherSession>(
+                    io_context_, into_session_socket(std::move(socket)));
+            }
+            catch (const std::exception &e)
+            {
+                spdlog::error("Couldn't connect to {}: {}", endpoint_.to_string(), e.what());
+                co_return false;
+            }
+            if (trust_ != nullptr && !co_await crypto::setup_encryption_for_session(*session, *trust_, key_id_))
+            {
+                co_return false;
+            }
+            session->register_default_handler<mal_packet_weaver::Session &, PingPacket>(respond_to_ping);
+            outbound_ = Outbound::create(io_context_, session, outbound_config_);
+            session_ = std::move(session);
+            co_return true;
+        }
+
+        boost::asio::io_context &io_context_;
+        const Endpoint endpoint_;
+        crypto::ServerTrust const *trust_;
+        const uint32_t key_id_;
+        const OnConnected on_connected_;
+        const OnDisconnected on_disconnected_;
+        const OutboundQueueConfig outbound_config_;
+        std::shared_ptr<mal_packet_weaver::DispatcherSession> session_;
+        std::shared_ptr<Outbound> outbound_;
+        std::atomic<bool> connected_ = false;
+        std::atomic<uint64_t> reconnects_ = 0;
+    };
+}  // namespace pds::network
@@ -0,0 +1,77 @@
+#pragma once
+#include <chrono>
+
+#include "packet-counters.hpp"
+
+namespace pds::network
+{
+    /** @brief Latest moment a packet of this type is still worth sending. */
+    template <typename PacketType>
+    [[nodiscard]] std::chrono::steady_clock::time_point deadline_for(
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now())
+    {
+        return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                         std::chrono::duration<float>(PacketType::time_to_live));
+    }
+
+    /** @brief Wall-clock time in milliseconds since epoch, as carried by send timestamps. */
+    [[nodiscard]] inline int64_t wall_clock_ms() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    /**
+     * @brief Rejects received packets that outlived their declared lifetime in transit.
+     *
+     * @details The age is measured against the sender's wall-clock timestamp, so hosts are
+     * expected to be NTP-synchronized; clock_skew is added to every lifetime to absorb the
+     * remaining difference.
+     */
+    class LateArrivalFilter
+    {
+    public:
+        explicit LateArrivalFilter(
+            std::chrono::milliseconds clock_skew = std::chrono::milliseconds{ 250 })
+            : clock_skew_ms_{ clock_skew.count() }
+        {
+        }
+
+        [[nodiscard]] bool accept(mal_packet_weaver::UniquePacketID type, float time_to_live,
+                                  int64_t sent_at_ms)
+        {
+            const int64_t lifetime_ms = static_cast<int64_t>(time_to_live * 1000.0f);
+            if (wall_clock_ms() - sent_at_ms <= lifetime_ms + clock_skew_ms_)
+            {
+                return true;
+            }
+            rejected_.add(type);
+            return false;
+        }
+
+        /**
+         * @brief Works with any packet; those without a send timestamp (see PacketTag), or whose
+         * sender didn't set it, are always accepted.
+         */
+        template <typename PacketType>
+        [[nodiscard]] bool accept(PacketType const &packet)
+        {
+            if constexpr (requires { packet.sent_at_ms(); })
+            {
+                return packet.sent_at_ms() == 0 ||
+                       accept(PacketType::static_unique_id, PacketType::time_to_live, packet.sent_at_ms());
+            }
+            else
+            {
+                return true;
+            }
+        }
+
+        [[nodiscard]] PacketCounters const &rejected() const noexcept { return rejected_; }
+
+    private:
+        const int64_t clock_skew_ms_;
+        PacketCounters rejected_;
+    };
+}  // namespace pds::network
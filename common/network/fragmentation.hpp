@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../packets/packet-network.hpp"
+
+namespace pds::network
+{
+    /**
+     * @brief Splits a serialized packet into FragmentPackets of at most chunk_size data bytes.
+     *
+     * @details Fragments of a transfer have to be sent in order on one session. Sent through the
+     * bulk lane they let urgent frames through between chunks instead of waiting behind the whole
+     * payload.
+     */
+    [[nodiscard]] inline std::vector<FragmentPacket> split_into_fragments(
+        uint32_t transfer_id, mal_packet_weaver::UniquePacketID inner_type,
+        mal_packet_weaver::ByteView payload, size_t chunk_size = 16 * 1024)
+    {
+        std::vector<FragmentPacket> fragments;
+        fragments.reserve((payload.size() + chunk_size - 1) / chunk_size);
+        for (size_t offset = 0; offset < payload.size(); offset += chunk_size)
+        {
+            const size_t size = std::min(chunk_size, payload.size() - offset);
+            FragmentPacket &fragment = fragments.emplace_back();
+            fragment.transfer_id = transfer_id;
+            fragment.inner_type = inner_type;
+            fragment.total_size = static_cast<uint32_t>(payload.size());
+            fragment.offset = static_cast<uint32_t>(offset);
+            fragment.data = mal_packet_weaver::ByteArray(payload.begin() + offset,
+                                                         payload.begin() + offset + size);
+        }
+        return fragments;
+    }
+
+    /**
+     * @brief Packet types whose payload may outgrow a single write, and are sent in fragments of
+     * chunk_size when it does (see OutboundSession). Shared between sessions, read-only.
+     */
+    class FragmentationPolicy
+    {
+    public:
+        explicit FragmentationPolicy(size_t chunk_size = 16 * 1024) : chunk_size_{ chunk_size } {}
+
+        template <typename PacketType>
+        FragmentationPolicy &allow()
+        {
+            types_.insert(PacketType::static_unique_id);
+            return *this;
+        }
+
+        [[nodiscard]] bool allows(mal_packet_weaver::UniquePacketID type) const { return types_.contains(type); }
+        [[nodiscard]] size_t chunk_size() const noexcept { return chunk_size_; }
+
+    private:
+        const size_t chunk_size_;
+        std::unordered_set<mal_packet_weaver::UniquePacketID> types_;
+    };
+
+    /** @brief Payload of a transfer whose last fragment has arrived. */
+    struct ReassembledPacket
+    {
+        mal_packet_weaver::UniquePacketID type;
+        mal_packet_weaver::ByteArray payload;
+    };
+
+    /**
+     * @brief Receiving side of split_into_fragments() for one session.
+     *
+     * @details Transfers are expected in order; a fragment that does not continue its transfer
+     * exactly, or exceeds the limits, discards the transfer. Fragments the sender dropped leave
+     * their transfer open, so once max_open_transfers are open a new one evicts the oldest.
+     * Not thread-safe.
+     */
+    class FragmentAssembler
+    {
+    public:
+        explicit FragmentAssembler(size_t max_transfer_size = 64 * 1024 * 1024,
+                                   size_t max_open_transfers = 16)
+            : max_transfer_size_{ max_transfer_size }, max_open_transfers_{ max_open_transfers }
+        {
+        }
+
+        [[nodiscard]] std::optional<ReassembledPacket> add(FragmentPacket &&fragment)
+        {
+            if (fragment.total_size > max_transfer_size_ ||
+                fragment.offset + fragment.data.size() > fragment.total_size)
+            {
+                transfers_.erase(fragment.transfer_id);
+                ++discarded_;
+                return std::nullopt;
+            }
+
+            auto it = transfers_.find(fragment.transfer_id);
+            if (it == transfers_.end())
+            {
+                if (fragment.offset != 0)
+                {
+                    ++discarded_;
+                    return std::nullopt;
+                }
+                if (transfers_.size() >= max_open_transfers_)
+                {
+                    // Transfer ids grow with every transfer of the session.
+                    transfers_.erase(std::ranges::min_element(transfers_, {}, [](auto const &transfer)
+                                                              { return transfer.first; }));
+                    ++discarded_;
+                }
+                it = transfers_.emplace(fragment.transfer_id, ReassembledPacket{}).first;
+                it->second.type = fragment.inner_type;
+                it->second.payload.reserve(fragment.total_size);
+            }
+
+            ReassembledPacket &transfer = it->second;
+            if (transfer.type != fragment.inner_type ||
+                transfer.payload.size() != fragment.offset)
+            {
+                transfers_.erase(it);
+                ++discarded_;
+                return std::nullopt;
+            }
+            transfer.payload.insert(transfer.payload.end(), fragment.data.begin(),
+                                    fragment.data.end());
+            if (transfer.payload.size() < fragment.total_size)
+            {
+                return std::nullopt;
+            }
+            ReassembledPacket rv = std::move(transfer);
+            transfers_.erase(it);
+            return rv;
+        }
+
+        /** @brief Amount of transfers thrown away because of malformed or excess fragments. */
+        [[nodiscard]] uint64_t discarded() const noexcept { return discarded_; }
+
+    private:
+        const size_t max_transfer_size_;
+        const size_t max_open_transfers_;
+        std::unordered_map<uint32_t, ReassembledPacket> transfers_;
+        uint64_t discarded_ = 0;
+    };
+}  // namespace pds::network
@@ -0,0 +1,247 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "../logging/hot-log.hpp"
+#include "../packets/packet-network.hpp"
+#include "mal-packet-weaver/session.hpp"
+#include "timer-wheel.hpp"
+
+namespace pds::network
+{
+    struct HeartbeatConfig
+    {
+        /** @brief Time between two pings to the same peer. */
+        std::chrono::milliseconds interval{ 1000 };
+        /** @brief Consecutive pings left without a pong after which the peer is dead. */
+        uint32_t miss_limit = 3;
+        /** @brief Tick of the timer wheel; deadlines are honoured up to this precision. */
+        std::chrono::milliseconds resolution{ 10 };
+    };
+
+    /** @brief Smoothed round-trip time and its mean deviation, as in RFC 6298. */
+    struct RttEstimate
+    {
+        std::chrono::nanoseconds smoothed{ 0 };
+        std::chrono::nanoseconds jitter{ 0 };
+        std::chrono::nanoseconds last{ 0 };
+        uint64_t samples = 0;
+
+        void add_sample(std::chrono::nanoseconds rtt) noexcept
+        {
+            last = rtt;
+            if (samples++ == 0)
+            {
+                smoothed = rtt;
+                jitter = rtt / 2;
+                return;
+            }
+            const auto deviation = smoothed > rtt ? smoothed - rtt : rtt - smoothed;
+            jitter = (3 * jitter + deviation) / 4;
+            smoothed = (7 * smoothed + rtt) / 8;
+        }
+    };
+
+    /** @brief Answers a heartbeat; register it on every session that may be pinged. */
+    inline void respond_to_ping(mal_packet_weaver::Session &connection,
+                                std::unique_ptr<PingPacket> &&ping)
+    {
+        PongPacket pong;
+        pong.sequence = ping->sequence;
+        pong.sent_at_ns = ping->sent_at_ns;
+        connection.send_packet(pong);
+    }
+
+    /**
+     * @brief Pings registered sessions periodically, tracks their RTT and destroys dead ones.
+     *
+     * @details All peers share one timer wheel driven by a single asio timer, so the cost of
+     * idle peers is one wheel entry each rather than one OS timer each. Pongs are matched on
+     * the echoed send timestamp, which comes from this process's steady clock.
+     *
+     * SessionType needs send_packet(), is_closed() and Destroy(). Thread-safe.
+     */
+    template <typename SessionType>
+    class HeartbeatMonitor
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using PeerId = uint64_t;
+
+        HeartbeatMonitor(boost::asio::io_context &io_context, HeartbeatConfig config = {})
+            : config_{ config }, wheel_{ config.resolution }, timer_{ io_context }
+        {
+            schedule_tick();
+        }
+        ~HeartbeatMonitor() { stop(); }
+
+        HeartbeatMonitor(HeartbeatMonitor const &) = delete;
+        HeartbeatMonitor &operator=(HeartbeatMonitor const &) = delete;
+
+        /** @brief Starts pinging the session one interval from now. */
+        PeerId add(std::shared_ptr<SessionType> const &session)
+        {
+            std::lock_guard lock{ mutex_ };
+            const PeerId id = next_id_++;
+            peers_.emplace(id, Peer{ .session = session });
+            wheel_.schedule(Clock::now() + config_.interval, id);
+            return id;
+        }
+
+        /** @brief Stops monitoring; the pending wheel entry is discarded when it fires. */
+        void remove(PeerId id)
+        {
+            std::lock_guard lock{ mutex_ };
+            peers_.erase(id);
+        }
+
+        void on_pong(PeerId id, PongPacket const &pong)
+        {
+            const auto now = now_ns();
+            std::lock_guard lock{ mutex_ };
+            const auto it = peers_.find(id);
+            if (it == peers_.end() || pong.sequence > it->second.sequence ||
+                pong.sent_at_ns > now)
+            {
+                return;
+            }
+            // A late pong still proves the peer is alive; its RTT is as valid as any other.
+            it->second.missed = 0;
+            if (pong.sequence == it->second.sequence)
+            {
+                it->second.awaiting_pong = false;
+            }
+            it->second.rtt.add_sample(std::chrono::nanoseconds{ now - pong.sent_at_ns });
+        }
+
+        /** @brief Empty until the first pong from the peer arrived. */
+        [[nodiscard]] std::optional<RttEstimate> rtt(PeerId id) const
+        {
+            std::lock_guard lock{ mutex_ };
+            const auto it = peers_.find(id);
+            if (it == peers_.end() || it->second.rtt.samples == 0)
+            {
+                return std::nullopt;
+            }
+            return it->second.rtt;
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            std::lock_guard lock{ mutex_ };
+            return peers_.size();
+        }
+        [[nodiscard]] uint64_t dead_peers() const
+        {
+            std::lock_guard lock{ mutex_ };
+            return dead_peers_;
+        }
+
+        void stop()
+        {
+            std::lock_guard lock{ mutex_ };
+            stopped_ = true;
+            timer_.cancel();
+        }
+
+    private:
+        struct Peer
+        {
+            std::weak_ptr<SessionType> session;
+            uint64_t sequence = 0;
+            uint32_t missed = 0;
+            bool awaiting_pong = false;
+            RttEstimate rtt;
+        };
+
+        static int64_t now_ns() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       Clock::now().time_since_epoch())
+                .count();
+        }
+
+        void schedule_tick()
+        {
+            timer_.expires_after(config_.resolution);
+            timer_.async_wait(
+                [this](boost::system::error_code ec)
+                {
+                    if (!ec)
+                    {
+                        tick();
+                    }
+                });
+        }
+
+        void tick()
+        {
+            std::vector<std::pair<std::shared_ptr<SessionType>, PingPacket>> pings;
+            std::vector<std::shared_ptr<SessionType>> dead;
+            {
+                std::lock_guard lock{ mutex_ };
+                if (stopped_)
+                {
+                    return;
+                }
+                const auto now = Clock::now();
+                wheel_.advance(now,
+                               [&](PeerId id)
+                               {
+                                   const auto it = peers_.find(id);
+                                   if (it == peers_.end())
+                                   {
+                                       return;
+                                   }
+                                   Peer &peer = it->second;
+                                   auto session = peer.session.lock();
+                                   if (!session || session->is_closed())
+                                   {
+                                       peers_.erase(it);
+                                       return;
+                                   }
+                                   if (peer.awaiting_pong && ++peer.missed >= config_.miss_limit)
+                                   {
+                                       ++dead_peers_;
+                                       peers_.erase(it);
+                                       dead.emplace_back(std::move(session));
+                                       return;
+                                   }
+                                   PingPacket ping;
+                                   ping.sequence = ++peer.sequence;
+                                   peer.awaiting_pong = true;
+                                   pings.emplace_back(std::move(session), std::move(ping));
+                                   wheel_.schedule(now + config_.interval, id);
+                               });
+                schedule_tick();
+            }
+
+            for (auto &[session, ping] : pings)
+            {
+                // Stamped as late as possible so time spent in this loop is not counted as RTT.
+                ping.sent_at_ns = now_ns();
+                session->send_packet(ping);
+            }
+            for (auto &session : dead)
+            {
+                PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                         "Peer missed {} heartbeats, closing the session.", config_.miss_limit);
+                session->Destroy();
+            }
+        }
+
+        const HeartbeatConfig config_;
+        mutable std::mutex mutex_;
+        TimerWheel<PeerId> wheel_;
+        boost::asio::steady_timer timer_;
+        std::unordered_map<PeerId, Peer> peers_;
+        PeerId next_id_ = 0;
+        uint64_t dead_peers_ = 0;
+        bool stopped_ = false;
+    };
+}  // namespace pds::network
@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <unordered_map>
+
+#include "mal-packet-weaver/packet.hpp"
+
+namespace pds::network
+{
+    /** @brief What a session's outbound queue does when a frame of some type does not fit. */
+    enum class OverflowPolicy
+    {
+        /** @brief The peer is considered dead and the session is closed. */
+        Disconnect,
+        /** @brief Oldest pending frames of drop-oldest types are discarded to make room. */
+        DropOldest,
+        /** @brief Only the latest pending frame per (type, key) is kept. */
+        Conflate
+    };
+
+    /** @brief Per-session limits on data that was queued but not yet written to the socket. */
+    struct OutboundLimits
+    {
+        size_t max_bytes = 4 * 1024 * 1024;
+        size_t max_packets = 16 * 1024;
+    };
+
+    /** @brief Maps packet types to their overflow policy. Shared between sessions, read-only. */
+    class OverflowPolicies
+    {
+    public:
+        explicit OverflowPolicies(OverflowPolicy default_policy = OverflowPolicy::Disconnect)
+            : default_policy_{ default_policy }
+        {
+        }
+
+        OverflowPolicies &set(mal_packet_weaver::UniquePacketID type, OverflowPolicy policy)
+        {
+            policies_[type] = policy;
+            return *this;
+        }
+        template <typename PacketType>
+        OverflowPolicies &set(OverflowPolicy policy)
+        {
+            return set(PacketType::static_unique_id, policy);
+        }
+
+        [[nodiscard]] OverflowPolicy get(mal_packet_weaver::UniquePacketID type) const
+        {
+            const auto it = policies_.find(type);
+            return it == policies_.end() ? default_policy_ : it->second;
+        }
+
+    private:
+        OverflowPolicy default_policy_;
+        std::unordered_map<mal_packet_weaver::UniquePacketID, OverflowPolicy> policies_;
+    };
+
+    /**
+     * @brief Process-wide cap on memory held by pending outbound frames of all sessions.
+     *
+     * @details Sessions acquire the size of every frame when it is enqueued and release it once
+     * the frame is written, dropped or replaced by conflation.
+     */
+    class OutboundMemoryBudget
+    {
+    public:
+        explicit OutboundMemoryBudget(size_t capacity) : capacity_{ capacity } {}
+
+        [[nodiscard]] bool try_acquire(size_t bytes) noexcept
+        {
+            size_t used = used_.load(std::memory_order_relaxed);
+            do
+            {
+                if (used + bytes > capacity_)
+                {
+                    return false;
+                }
+            } while (!used_.compare_exchange_weak(used, used + bytes, std::memory_order_relaxed));
+            return true;
+        }
+        void release(size_t bytes) noexcept { used_.fetch_sub(bytes, std::memory_order_relaxed); }
+
+        [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+        [[nodiscard]] size_t used() const noexcept { return used_.load(std::memory_order_relaxed); }
+
+    private:
+        const size_t capacity_;
+        std::atomic<size_t> used_ = 0;
+    };
+}  // namespace pds::network
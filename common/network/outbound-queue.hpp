@@ -0,0 +1,606 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/lockfree/queue.hpp>
+#include <chrono>
+#include <concepts>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer-pool.hpp"
+#include "fragmentation.hpp"
+#include "mal-packet-weaver/packet.hpp"
+#include "outbound-policy.hpp"
+#include "packet-counters.hpp"
+#include "priority.hpp"
+
+namespace pds::network
+{
+    /** @brief A ready-to-send frame together with what the queue needs to know about it. */
+    struct OutboundFrame
+    {
+        mal_packet_weaver::UniquePacketID type = 0;
+        /** @brief Pending frames of a conflated type with equal keys replace each other. */
+        uint64_t conflation_key = 0;
+        /** @brief Frames still pending at this point are dropped instead of written. */
+        std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::time_point::max();
+        mal_packet_weaver::ByteArray bytes;
+        /**
+         * @brief Optional deferred serialization and encryption producing `bytes`.
+         *
+         * @details Runs on the executor right before the frame is written, so frames that expire
+         * or are conflated away never pay for it. Until then the frame is accounted by size_hint.
+         */
+        std::function<mal_packet_weaver::ByteArray()> forge;
+        /** @brief Size forge's `bytes` will have, e.g. capture::encoded_size() of the packet. */
+        size_t size_hint = 0;
+    };
+
+    /**
+     * @brief A sink the queue hands packets to instead of a stream it writes bytes to, for
+     * sessions that own their socket (see OutboundSession).
+     *
+     * @details Every gathered batch is handed to deliver() at once, each frame's `bytes` holding
+     * an encoded packet, for the sink to send as one packet of its session. The queue gathers the
+     * next batch only when the sink is writable() again, checking after every async_wait();
+     * frames meanwhile keep waiting in the lanes, where limits, policies and deadlines apply,
+     * instead of in the session's own unbounded buffer. async_wait() must call its handler even
+     * when the sink is destroyed.
+     */
+    template <typename Sink>
+    concept PacketSink = requires(Sink &sink, std::function<void()> handler,
+                                  std::span<OutboundFrame const *const> frames) {
+        sink.get_executor();
+        { sink.writable() } -> std::convertible_to<bool>;
+        sink.async_wait(std::move(handler));
+        sink.deliver(frames);
+    };
+
+    /** @brief Counters describing coalescing and slow-consumer handling of a session. */
+    struct OutboundStats
+    {
+        std::atomic<uint64_t> frames_enqueued = 0;
+        std::atomic<uint64_t> frames_written = 0;
+        std::atomic<uint64_t> bytes_written = 0;
+        /**
+         * @brief Amount of async_write operations, each one a single gathered write; for packet
+         * sinks, the batches delivered.
+         */
+        std::atomic<uint64_t> writes_issued = 0;
+
+        /** @brief Enqueues that found the session over its byte or packet limit. */
+        std::atomic<uint64_t> overflow_events = 0;
+        std::atomic<uint64_t> frames_dropped = 0;
+        std::atomic<uint64_t> frames_conflated = 0;
+        /** @brief Frames refused because the process-wide memory budget was exhausted. */
+        std::atomic<uint64_t> budget_rejections = 0;
+        /** @brief Frames that reached their deadline before they could be written. */
+        std::atomic<uint64_t> frames_expired = 0;
+    };
+
+    struct OutboundQueueConfig
+    {
+        OutboundLimits limits;
+        /** @brief Null means every packet type disconnects on overflow. */
+        std::shared_ptr<const OverflowPolicies> policies;
+        /** @brief Null means pending memory is only limited per session. */
+        std::shared_ptr<OutboundMemoryBudget> budget;
+        /** @brief Null puts every packet type into the normal lane. */
+        std::shared_ptr<const PriorityMap> priorities;
+        /** @brief Written frame buffers are returned here, if set, for forges to reuse. */
+        std::shared_ptr<BufferPool> buffer_pool;
+        /** @brief Only looked at by OutboundSession; null sends every packet whole. */
+        std::shared_ptr<const FragmentationPolicy> fragmentation;
+        PriorityWeights weights;
+        size_t max_frames_per_write = 256;
+        /**
+         * @brief Soft cap on a single gathered write. Since only one write is in flight, this is
+         * roughly how long an urgent frame can wait behind lower lanes. Large bulk payloads are
+         * expected to be split with split_into_fragments() to stay near this size.
+         */
+        size_t max_bytes_per_write = 64 * 1024;
+    };
+
+    /**
+     * @brief Per-session queue of ready-to-send frames.
+     *
+     * @details Frames can be enqueued from any thread without taking a lock. The first enqueue
+     * after the queue has drained posts a flush to the stream's executor, so every frame enqueued
+     * during the same event-loop turn is written by one async_write over a buffer sequence, which
+     * the reactor turns into a single writev/WSASend. Only one write is in flight at a time; frames
+     * enqueued while it runs are gathered into the next one.
+     *
+     * Pending data is bounded by OutboundLimits. Enqueue only checks the limits; dropping and
+     * conflation run on the executor, which keeps processing even while a write to a peer that
+     * stopped reading never completes. A session that cannot be brought back under its limits is
+     * failed with boost::asio::error::no_buffer_space through the error handler.
+     *
+     * Frames past their deadline are dropped on the executor before they are forged or written,
+     * and counted per packet type.
+     *
+     * Every packet type is assigned to a priority lane; writes are filled from the lanes by
+     * weighted deficit round robin, and each write is capped at max_bytes_per_write.
+     *
+     * AsyncWriteStream may also be a PacketSink, which gets the frames of a write instead of
+     * their bytes.
+     *
+     * The stream must outlive the queue, and the queue must outlive any pending operation, unless
+     * it is guarded by its owner's lifetime (see guard_with()).
+     */
+    template <typename AsyncWriteStream>
+    class OutboundQueue
+    {
+    public:
+        using ErrorHandler = std::function<void(boost::system::error_code)>;
+
+        explicit OutboundQueue(AsyncWriteStream &stream, OutboundQueueConfig config = {})
+            : stream_{ stream }, config_{ std::move(config) }, incoming_{ 128 }
+        {
+            in_flight_.reserve(config_.max_frames_per_write);
+            buffers_.reserve(config_.max_frames_per_write);
+            batch_.reserve(config_.max_frames_per_write);
+        }
+        OutboundQueue(OutboundQueue const &) = delete;
+        OutboundQueue &operator=(OutboundQueue const &) = delete;
+
+        ~OutboundQueue()
+        {
+            drain_incoming();
+            for (auto const &lane : lanes_)
+            {
+                for (auto const &pending : lane)
+                {
+                    if (pending)
+                    {
+                        release_budget(pending->accounted_bytes);
+                    }
+                }
+            }
+            for (auto const &pending : in_flight_)
+            {
+                release_budget(pending->accounted_bytes);
+            }
+        }
+
+        /**
+         * @brief Queues the frame for the next gathered write. Safe to call from any thread.
+         *
+         * @return false if the frame was refused, either because the session failed or because
+         * it did not fit and its type's policy gives no way to make room.
+         */
+        bool enqueue(OutboundFrame &&frame)
+        {
+            if (failed_.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+            const size_t size = frame.forge ? frame.size_hint : frame.bytes.size();
+            const OverflowPolicy policy = policy_of(frame.type);
+
+            if (config_.budget && !config_.budget->try_acquire(size))
+            {
+                stats_.budget_rejections.fetch_add(1, std::memory_order_relaxed);
+                if (policy == OverflowPolicy::Disconnect)
+                {
+                    fail(boost::asio::error::no_buffer_space);
+                }
+                return false;
+            }
+
+            const size_t frames = pending_frames_.fetch_add(1, std::memory_order_relaxed) + 1;
+            const size_t bytes = pending_bytes_.fetch_add(size, std::memory_order_relaxed) + size;
+            if (frames > config_.limits.max_packets || bytes > config_.limits.max_bytes)
+            {
+                stats_.overflow_events.fetch_add(1, std::memory_order_relaxed);
+                if (policy == OverflowPolicy::Disconnect)
+                {
+                    forget(size);
+                    fail(boost::asio::error::no_buffer_space);
+                    return false;
+                }
+                schedule(trim_scheduled_, [this]() { trim(); });
+            }
+
+            stats_.frames_enqueued.fetch_add(1, std::memory_order_relaxed);
+            const Priority priority =
+                config_.priorities ? config_.priorities->get(frame.type) : Priority::Normal;
+            incoming_.push(new Pending{ std::move(frame), size, priority });
+            schedule(flush_scheduled_, [this]() { flush(); });
+            return true;
+        }
+
+        /** @brief Called once, from the stream's executor, when the session fails. */
+        void set_error_handler(ErrorHandler handler) { on_error_ = std::move(handler); }
+
+        /**
+         * @brief Makes what the queue posts to the executor do nothing once owner is released,
+         * for queues owned by a shared object. Call before the first enqueue.
+         */
+        void guard_with(std::weak_ptr<const void> owner)
+        {
+            owner_ = std::move(owner);
+            guarded_ = true;
+        }
+
+        [[nodiscard]] OutboundStats const &stats() const noexcept { return stats_; }
+        [[nodiscard]] bool failed() const noexcept { return failed_.load(std::memory_order_relaxed); }
+        [[nodiscard]] size_t pending_bytes() const noexcept
+        {
+            return pending_bytes_.load(std::memory_order_relaxed);
+        }
+        [[nodiscard]] size_t pending_frames() const noexcept
+        {
+            return pending_frames_.load(std::memory_order_relaxed);
+        }
+        [[nodiscard]] PacketCounters const &expired_by_type() const noexcept { return expired_; }
+
+    private:
+        struct Pending
+        {
+            OutboundFrame frame;
+            /** @brief Size this frame was added to the pending counters and budget with. */
+            size_t accounted_bytes;
+            Priority priority;
+        };
+        struct ConflationKey
+        {
+            mal_packet_weaver::UniquePacketID type;
+            uint64_t key;
+            bool operator==(ConflationKey const &) const = default;
+        };
+        struct ConflationKeyHash
+        {
+            size_t operator()(ConflationKey const &k) const noexcept
+            {
+                return std::hash<uint64_t>{}(k.key * 0x9E3779B97F4A7C15ull ^ k.type);
+            }
+        };
+
+        [[nodiscard]] OverflowPolicy policy_of(mal_packet_weaver::UniquePacketID type) const
+        {
+            return config_.policies ? config_.policies->get(type) : OverflowPolicy::Disconnect;
+        }
+
+        [[nodiscard]] bool over_limits() const noexcept
+        {
+            return pending_frames() > config_.limits.max_packets ||
+                   pending_bytes() > config_.limits.max_bytes;
+        }
+
+        template <typename Function>
+        void schedule(std::atomic<bool> &scheduled, Function &&function)
+        {
+            if (!scheduled.exchange(true, std::memory_order_acq_rel))
+            {
+                boost::asio::post(stream_.get_executor(), guarded(std::forward<Function>(function)));
+            }
+        }
+
+        // Captures the owner, not this, so the check stays valid after the queue is destroyed. Also
+        // wraps completion handlers, passing on their results.
+        template <typename Function>
+        [[nodiscard]] auto guarded(Function &&function) const
+        {
+            return [owner = owner_, guarded = guarded_,
+                    function = std::forward<Function>(function)](auto &&...results) mutable
+            {
+                const auto alive = owner.lock();
+                if (!guarded || alive)
+                {
+                    function(std::forward<decltype(results)>(results)...);
+                }
+            };
+        }
+
+        void release_budget(size_t size) noexcept
+        {
+            if (config_.budget)
+            {
+                config_.budget->release(size);
+            }
+        }
+
+        // Removes a frame that left the queue from the pending counters and the global budget.
+        void forget(size_t size) noexcept
+        {
+            pending_frames_.fetch_sub(1, std::memory_order_relaxed);
+            pending_bytes_.fetch_sub(size, std::memory_order_relaxed);
+            release_budget(size);
+        }
+
+        void fail(boost::system::error_code ec)
+        {
+            if (failed_.exchange(true, std::memory_order_acq_rel))
+            {
+                return;
+            }
+            const auto report = [this, ec]()
+            {
+                if (on_error_)
+                {
+                    on_error_(ec);
+                }
+            };
+            boost::asio::post(stream_.get_executor(), guarded(report));
+        }
+
+        // Moves frames from the lock-free queue into the executor-owned lanes, replacing
+        // pending frames of conflated types in place so they keep their position in the stream.
+        void drain_incoming()
+        {
+            Pending *raw = nullptr;
+            while (incoming_.pop(raw))
+            {
+                std::unique_ptr<Pending> pending{ raw };
+                OutboundFrame const &frame = pending->frame;
+                if (policy_of(frame.type) == OverflowPolicy::Conflate)
+                {
+                    auto [it, inserted] = conflation_index_.try_emplace(
+                        ConflationKey{ frame.type, frame.conflation_key }, pending.get());
+                    if (!inserted)
+                    {
+                        forget(it->second->accounted_bytes);
+                        *it->second = std::move(*pending);
+                        stats_.frames_conflated.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+                }
+                lanes_[static_cast<size_t>(pending->priority)].emplace_back(std::move(pending));
+            }
+        }
+
+        // Takes the frame out of the conflation index once it can no longer be replaced.
+        void unindex(Pending const &pending)
+        {
+            OutboundFrame const &frame = pending.frame;
+            if (policy_of(frame.type) != OverflowPolicy::Conflate)
+            {
+                return;
+            }
+            const auto it =
+                conflation_index_.find(ConflationKey{ frame.type, frame.conflation_key });
+            if (it != conflation_index_.end() && it->second == &pending)
+            {
+                conflation_index_.erase(it);
+            }
+        }
+
+        void trim()
+        {
+            trim_scheduled_.store(false, std::memory_order_release);
+            drain_incoming();
+            // Dropped frames are left as empty slots so the indices of conflated frames stay valid.
+            // Expired frames go first since they would be dropped anyway, then the oldest frames
+            // of the least urgent lanes.
+            const auto now = std::chrono::steady_clock::now();
+            for (auto &lane : lanes_)
+            {
+                for (auto &pending : lane)
+                {
+                    if (pending && pending->frame.deadline < now)
+                    {
+                        expire(pending);
+                    }
+                }
+            }
+            for (auto lane = lanes_.rbegin(); lane != lanes_.rend() && over_limits(); ++lane)
+            {
+                for (auto &pending : *lane)
+                {
+                    if (!over_limits())
+                    {
+                        break;
+                    }
+                    if (pending && policy_of(pending->frame.type) == OverflowPolicy::DropOldest)
+                    {
+                        unindex(*pending);
+                        forget(pending->accounted_bytes);
+                        stats_.frames_dropped.fetch_add(1, std::memory_order_relaxed);
+                        pending.reset();
+                    }
+                }
+            }
+            if (over_limits())
+            {
+                fail(boost::asio::error::no_buffer_space);
+            }
+        }
+
+        void expire(std::unique_ptr<Pending> &pending)
+        {
+            unindex(*pending);
+            forget(pending->accounted_bytes);
+            stats_.frames_expired.fetch_add(1, std::memory_order_relaxed);
+            expired_.add(pending->frame.type);
+            pending.reset();
+        }
+
+        [[nodiscard]] bool write_full(size_t bytes) const noexcept
+        {
+            return in_flight_.size() >= config_.max_frames_per_write ||
+                   bytes >= config_.max_bytes_per_write;
+        }
+
+        // Fills in_flight_ from the lanes by deficit round robin over accounted bytes.
+        void gather()
+        {
+            const auto now = std::chrono::steady_clock::now();
+            size_t bytes = 0;
+            bool lanes_pending = true;
+            while (lanes_pending && !write_full(bytes))
+            {
+                lanes_pending = false;
+                for (size_t lane = 0; lane < kPriorityCount && !write_full(bytes); ++lane)
+                {
+                    auto &queue = lanes_[lane];
+                    if (queue.empty())
+                    {
+                        deficits_[lane] = 0;
+                        continue;
+                    }
+                    lanes_pending = true;
+                    deficits_[lane] += size_t{ config_.weights.weights[lane] } *
+                                       config_.weights.quantum;
+                    while (!queue.empty() && !write_full(bytes))
+                    {
+                        // A frame larger than the lane's deficit waits for later rounds, unless
+                        // nothing was gathered yet and the write would otherwise be empty.
+                        if (queue.front() && queue.front()->accounted_bytes > deficits_[lane] &&
+                            !in_flight_.empty())
+                        {
+                            break;
+                        }
+                        std::unique_ptr<Pending> pending = std::move(queue.front());
+                        queue.pop_front();
+                        if (!pending)
+                        {
+                            continue;
+                        }
+                        if (pending->frame.deadline < now)
+                        {
+                            expire(pending);
+                            continue;
+                        }
+                        deficits_[lane] -= std::min(deficits_[lane], pending->accounted_bytes);
+                        unindex(*pending);
+                        if (pending->frame.forge)
+                        {
+                            pending->frame.bytes = pending->frame.forge();
+                            pending->frame.forge = nullptr;
+                        }
+                        bytes += pending->frame.bytes.size();
+                        in_flight_.emplace_back(std::move(pending));
+                    }
+                }
+            }
+        }
+
+        void flush()
+        {
+            if (failed())
+            {
+                return;
+            }
+            drain_incoming();
+            gather();
+
+            if (in_flight_.empty())
+            {
+                flush_scheduled_.store(false, std::memory_order_release);
+                // A producer that pushed between the drain and the store above saw the flag
+                // still raised and did not schedule a flush, so its frame has to be picked up here.
+                if (!incoming_.empty())
+                {
+                    schedule(flush_scheduled_, [this]() { flush(); });
+                }
+                return;
+            }
+            if constexpr (PacketSink<AsyncWriteStream>)
+            {
+                deliver();
+            }
+            else
+            {
+                buffers_.clear();
+                for (auto const &pending : in_flight_)
+                {
+                    buffers_.emplace_back(pending->frame.bytes.data(), pending->frame.bytes.size());
+                }
+
+                stats_.writes_issued.fetch_add(1, std::memory_order_relaxed);
+                boost::asio::async_write(
+                    stream_, buffers_,
+                    guarded(
+                        [this](boost::system::error_code ec, size_t bytes_transferred)
+                        {
+                            stats_.frames_written.fetch_add(in_flight_.size(), std::memory_order_relaxed);
+                            stats_.bytes_written.fetch_add(bytes_transferred, std::memory_order_relaxed);
+                            for (auto const &pending : in_flight_)
+                            {
+                                forget(pending->accounted_bytes);
+                                if (config_.buffer_pool)
+                                {
+                                    config_.buffer_pool->release(std::move(pending->frame.bytes));
+                                }
+                            }
+                            in_flight_.clear();
+                            if (ec)
+                            {
+                                // flush_scheduled_ stays raised so nothing else is written to the stream.
+                                fail(ec);
+                                return;
+                            }
+                            flush();
+                        }));
+            }
+        }
+
+        // Hands the gathered packets to the sink as one batch, then gathers the next batch once
+        // it can take more.
+        void deliver()
+        {
+            batch_.clear();
+            size_t bytes = 0;
+            for (auto const &pending : in_flight_)
+            {
+                batch_.emplace_back(&pending->frame);
+                bytes += pending->frame.bytes.size();
+            }
+            stream_.deliver(std::span<OutboundFrame const *const>{ batch_ });
+            for (auto const &pending : in_flight_)
+            {
+                forget(pending->accounted_bytes);
+                if (config_.buffer_pool)
+                {
+                    config_.buffer_pool->release(std::move(pending->frame.bytes));
+                }
+            }
+            stats_.writes_issued.fetch_add(1, std::memory_order_relaxed);
+            stats_.frames_written.fetch_add(in_flight_.size(), std::memory_order_relaxed);
+            stats_.bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+            in_flight_.clear();
+            wait_writable();
+        }
+
+        // flush_scheduled_ stays raised meanwhile, as it does during a write.
+        void wait_writable()
+        {
+            if (stream_.writable())
+            {
+                boost::asio::post(stream_.get_executor(), guarded([this]() { flush(); }));
+                return;
+            }
+            stream_.async_wait(guarded([this]() { wait_writable(); }));
+        }
+
+        AsyncWriteStream &stream_;
+        const OutboundQueueConfig config_;
+        std::weak_ptr<const void> owner_;
+        bool guarded_ = false;
+
+        boost::lockfree::queue<Pending *> incoming_;
+        std::atomic<size_t> pending_frames_ = 0;
+        std::atomic<size_t> pending_bytes_ = 0;
+        std::atomic<bool> flush_scheduled_ = false;
+        std::atomic<bool> trim_scheduled_ = false;
+        std::atomic<bool> failed_ = false;
+
+        // Only touched from the stream's executor.
+        std::array<std::deque<std::unique_ptr<Pending>>, kPriorityCount> lanes_;
+        std::array<size_t, kPriorityCount> deficits_{};
+        std::unordered_map<ConflationKey, Pending *, ConflationKeyHash> conflation_index_;
+        std::vector<std::unique_ptr<Pending>> in_flight_;
+        std::vector<boost::asio::const_buffer> buffers_;
+        std::vector<OutboundFrame const *> batch_;
+
+        ErrorHandler on_error_;
+        OutboundStats stats_;
+        PacketCounters expired_;
+    };
+}  // namespace pds::network
@@ -0,0 +1,273 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "../capture/captured-packets.hpp"
+#include "../logging/hot-log.hpp"
+#include "deadline.hpp"
+#include "fragmentation.hpp"
+#include "outbound-queue.hpp"
+#include "packet-batch.hpp"
+
+namespace pds::network
+{
+    /**
+     * @brief Pending packets of a conflated type replace each other when these keys match: the
+     * account they belong to (see PacketTag::owner_login) and, for positions and orders, the
+     * ticket.
+     */
+    template <typename Packet>
+    [[nodiscard]] uint64_t conflation_key_of(Packet const &packet) noexcept
+    {
+        uint64_t key = 0;
+        if constexpr (requires { packet.owner_login(); })
+        {
+            key = static_cast<uint64_t>(packet.owner_login());
+        }
+        if constexpr (requires { packet.ticket; })
+        {
+            key = key * 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(packet.ticket);
+        }
+        return key;
+    }
+
+    /**
+     * @brief The PacketSink an OutboundSession's queue delivers to.
+     *
+     * @details Sends every batch as one PacketBatch, which the session serializes, encrypts and
+     * writes at once. Runs the queue on a strand of the io_context, so several threads may run it while
+     * the queue's executor state is still only touched by one at a time. The session writes on
+     * its own and can't tell when a write completed, so the peer does: it answers every batch
+     * with a BatchAck (see receive_batches()). Once the batches not acknowledged yet hold
+     * kAckWindow bytes, the next one waits for an ack and the backlog builds up in the queue,
+     * where the limits and overflow policies apply to it. A batch is always sent when nothing
+     * is on the way, however large.
+     */
+    template <typename Session>
+    class SessionSink
+    {
+    public:
+        using executor_type = boost::asio::strand<boost::asio::io_context::executor_type>;
+
+        static constexpr uint64_t kAckWindow = 256 * 1024;
+
+        SessionSink(boost::asio::io_context &io_context, Session &session)
+            : strand_{ boost::asio::make_strand(io_context) },
+              session_{ session },
+              ack_timer_{ strand_, boost::asio::steady_timer::time_point::max() }
+        {
+        }
+
+        [[nodiscard]] executor_type get_executor() const noexcept { return strand_; }
+
+        [[nodiscard]] bool writable() const noexcept { return sent_bytes_ - acked_bytes_ < kAckWindow; }
+
+        void deliver(std::span<OutboundFrame const *const> frames)
+        {
+            fill_batch(batch_, frames);
+            session_.send_packet(batch_);
+            sent_bytes_ += batch_.payload.size();
+        }
+
+        /** @brief Calls handler on the strand once an ack arrives, or as the sink is destroyed. */
+        template <typename Handler>
+        void async_wait(Handler &&handler)
+        {
+            ack_timer_.async_wait([handler = std::forward<Handler>(handler)](boost::system::error_code) mutable
+                                  { handler(); });
+        }
+
+        /** @brief Takes a BatchAck's received_bytes; only on the strand. */
+        void acknowledge(uint64_t received_bytes)
+        {
+            // Acks may overtake each other, as the peer may handle batches on several threads.
+            acked_bytes_ = std::max(acked_bytes_, std::min(received_bytes, sent_bytes_));
+            ack_timer_.cancel();
+        }
+
+    private:
+        executor_type strand_;
+        Session &session_;
+        // Never expires; cancelled by every ack, which wakes the waiting queue.
+        boost::asio::steady_timer ack_timer_;
+        // Payload bytes of the batches sent and acknowledged so far; only touched on the strand.
+        uint64_t sent_bytes_ = 0;
+        uint64_t acked_bytes_ = 0;
+        // Reused, so its buffers keep their capacity.
+        PacketBatch batch_;
+    };
+
+    /**
+     * @brief A session whose packets are sent through an OutboundQueue.
+     *
+     * @details send_packet() only enqueues, without a lock and from any thread; the packets
+     * enqueued during one event-loop turn are encoded and handed to the session as one
+     * PacketBatch, in lane order, and those past their deadline are dropped instead (see
+     * OutboundQueue). is_closed() and Destroy() are the wrapped session's; packets its own
+     * handlers reply with, such as pongs, bypass the queue. Handlers registered through
+     * register_default_handler() get their packets both when they arrive on their own and when
+     * they arrive in a PacketBatch of a peer that is an OutboundSession as well. A session failed
+     * by its queue, i.e. a peer too slow for a packet type that may not be dropped, is destroyed.
+     *
+     * Packets of the types OutboundQueueConfig::fragmentation allows are encoded with the capture
+     * codec first, and if they outgrow a chunk they are sent as FragmentPackets instead, queued
+     * with the packet's deadline. A receiving OutboundSession reassembles them and hands the
+     * packets to the handlers registered through it, like those of a PacketBatch.
+     *
+     * Frames are encoded into buffers of OutboundQueueConfig::buffer_pool, if set, which the
+     * queue returns to it once they are written.
+     */
+    template <typename Session>
+    class OutboundSession
+    {
+    public:
+        [[nodiscard]] static std::shared_ptr<OutboundSession> create(boost::asio::io_context &io_context,
+                                                                     std::shared_ptr<Session> session,
+                                                                     OutboundQueueConfig config = {})
+        {
+            std::shared_ptr<OutboundSession> outbound{ new OutboundSession(io_context, std::move(session),
+                                                                           std::move(config)) };
+            outbound->queue_.guard_with(outbound);
+            outbound->session_->template register_default_handler<BatchAck>(
+                [weak = std::weak_ptr<OutboundSession>{ outbound }](std::unique_ptr<BatchAck> &&ack)
+                {
+                    if (auto self = weak.lock())
+                    {
+                        auto const executor = self->sink_.get_executor();
+                        boost::asio::post(executor, [self = std::move(self), received = ack->received_bytes]()
+                                          { self->sink_.acknowledge(received); });
+                    }
+                });
+            return outbound;
+        }
+
+        OutboundSession(OutboundSession const &) = delete;
+        OutboundSession &operator=(OutboundSession const &) = delete;
+
+        /** @brief Queues the packet; false if the queue refused it, or any of its fragments. */
+        template <typename Packet>
+        bool send_packet(Packet const &packet)
+        {
+            // What the packet takes in a batch, so limits and the budget count what is written.
+            const size_t size = capture::encoded_size(packet);
+            if (fragmentation_ && fragmentation_->allows(Packet::static_unique_id) &&
+                size > fragmentation_->chunk_size())
+            {
+                // Stamped now, as the receiver only sees the packet once it is reassembled.
+                thread_local std::vector<std::byte> payload;
+                encode_stamped(packet, payload);
+                return send_fragments<Packet>(mal_packet_weaver::ByteView{ payload.data(), payload.size() });
+            }
+            OutboundFrame frame;
+            frame.type = Packet::static_unique_id;
+            frame.conflation_key = conflation_key_of(packet);
+            frame.deadline = deadline_for<Packet>();
+            frame.size_hint = size;
+            frame.forge = [packet, pool = buffer_pool_]()
+            {
+                mal_packet_weaver::ByteArray bytes = acquire_buffer(pool.get());
+                encode_stamped(packet, bytes);
+                return bytes;
+            };
+            return queue_.enqueue(std::move(frame));
+        }
+
+        /** @brief Handlers that take only the packet also get it out of the peer's PacketBatches. */
+        template <typename... Args, typename Handler>
+        void register_default_handler(Handler &&handler)
+        {
+            if constexpr (sizeof...(Args) == 1)
+            {
+                batches_->template add<Args...>(handler);
+            }
+            session_->template register_default_handler<Args...>(std::forward<Handler>(handler));
+        }
+
+        [[nodiscard]] bool is_closed() const { return session_->is_closed(); }
+        void Destroy() { session_->Destroy(); }
+
+        [[nodiscard]] std::shared_ptr<Session> const &session() const noexcept { return session_; }
+        [[nodiscard]] OutboundStats const &stats() const noexcept { return queue_.stats(); }
+        [[nodiscard]] PacketCounters const &expired_by_type() const noexcept { return queue_.expired_by_type(); }
+
+    private:
+        // A packet keeps the stamp of whoever sent it first, e.g. the publisher of forwarded trade
+        // info, so the receiver's LateArrivalFilter measures its whole way; others are stamped as
+        // they are written.
+        template <typename Packet>
+        static void encode_stamped(Packet const &packet, std::vector<std::byte> &out)
+        {
+            if constexpr (requires { packet.stamp_send_time(); })
+            {
+                if (packet.sent_at_ms() == 0)
+                {
+                    Packet stamped{ packet };
+                    stamped.stamp_send_time();
+                    capture::encode_packet(stamped, out);
+                    return;
+                }
+            }
+            capture::encode_packet(packet, out);
+        }
+
+        // Encoding clears the buffer, but keeps the capacity it had from earlier packets.
+        [[nodiscard]] static mal_packet_weaver::ByteArray acquire_buffer(BufferPool *pool)
+        {
+            return pool ? pool->acquire(0) : mal_packet_weaver::ByteArray{};
+        }
+
+        template <typename Packet>
+        bool send_fragments(mal_packet_weaver::ByteView payload)
+        {
+            const uint32_t transfer_id = next_transfer_id_.fetch_add(1, std::memory_order_relaxed);
+            const auto deadline = deadline_for<Packet>();
+            bool queued = true;
+            for (FragmentPacket &fragment :
+                 split_into_fragments(transfer_id, Packet::static_unique_id, payload, fragmentation_->chunk_size()))
+            {
+                OutboundFrame frame;
+                frame.type = FragmentPacket::static_unique_id;
+                frame.deadline = deadline;
+                frame.bytes = acquire_buffer(buffer_pool_.get());
+                capture::encode_packet(fragment, frame.bytes);
+                queued &= queue_.enqueue(std::move(frame));
+            }
+            return queued;
+        }
+
+        OutboundSession(boost::asio::io_context &io_context, std::shared_ptr<Session> session,
+                        OutboundQueueConfig config)
+            : session_{ std::move(session) },
+              fragmentation_{ config.fragmentation },
+              buffer_pool_{ config.buffer_pool },
+              sink_{ io_context, *session_ },
+              queue_{ sink_, std::move(config) }
+        {
+            receive_batches(*session_, batches_);
+            queue_.set_error_handler(
+                [session = session_.get()](boost::system::error_code ec)
+                {
+                    PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                             "Closing a session that couldn't keep up with its output: {}",
+                                             ec.message());
+                    session->Destroy();
+                });
+        }
+
+        const std::shared_ptr<Session> session_;
+        const std::shared_ptr<const FragmentationPolicy> fragmentation_;
+        // Where frames are encoded into, if set; the queue returns them once written.
+        const std::shared_ptr<BufferPool> buffer_pool_;
+        std::atomic<uint32_t> next_transfer_id_ = 1;
+        const std::shared_ptr<BatchReceiver> batches_ = std::make_shared<BatchReceiver>();
+        SessionSink<Session> sink_;
+        OutboundQueue<SessionSink<Session>> queue_;
+    };
+}  // namespace pds::network
@@ -0,0 +1,175 @@
+#pragma once
+#include <boost/archive/archive_exception.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <unordered_map>
+
+#include "../capture/captured-packets.hpp"
+#include "../logging/hot-log.hpp"
+#include "../packets/packet-network.hpp"
+#include "fragmentation.hpp"
+#include "outbound-queue.hpp"
+
+namespace pds::network
+{
+    /** @brief Replaces the contents of batch with the encoded packets of frames, in order. */
+    inline void fill_batch(PacketBatch &batch, std::span<OutboundFrame const *const> frames)
+    {
+        batch.types.clear();
+        batch.sizes.clear();
+        batch.payload.clear();
+        for (OutboundFrame const *frame : frames)
+        {
+            batch.types.emplace_back(frame->type);
+            batch.sizes.emplace_back(static_cast<uint32_t>(frame->bytes.size()));
+            batch.payload.insert(batch.payload.end(), frame->bytes.begin(), frame->bytes.end());
+        }
+    }
+
+    /**
+     * @brief Receiving side of fill_batch() and of the fragments of split_into_fragments():
+     * decodes the packets of a PacketBatch, and the packets reassembled from FragmentPackets, and
+     * hands each to the handler added for its type.
+     *
+     * @details Handlers are added while the session is set up and looked up under a shared lock,
+     * so batches may be received from several threads. Packets of types without a handler, and
+     * ones that don't decode, are dropped. Fragments may arrive on their own or in batches.
+     */
+    class BatchReceiver
+    {
+    public:
+        template <typename Packet, typename Handler>
+        void add(Handler &&handler)
+        {
+            std::lock_guard lock{ mutex_ };
+            decoders_.insert_or_assign(
+                Packet::static_unique_id,
+                [handler = std::forward<Handler>(handler)](std::span<const std::byte> payload)
+                {
+                    std::unique_ptr<Packet> packet;
+                    try
+                    {
+                        packet = capture::decode_packet<Packet>(payload);
+                    }
+                    catch (const boost::archive::archive_exception &e)
+                    {
+                        PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                                 "Dropped a malformed packet {:#x}: {}", Packet::static_unique_id,
+                                                 e.what());
+                        return;
+                    }
+                    handler(std::move(packet));
+                });
+        }
+
+        void receive(PacketBatch const &batch) const
+        {
+            if (batch.types.size() != batch.sizes.size())
+            {
+                PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                         "Dropped a batch of {} types and {} sizes", batch.types.size(),
+                                         batch.sizes.size());
+                return;
+            }
+            std::shared_lock lock{ mutex_ };
+            size_t offset = 0;
+            for (size_t i = 0; i < batch.types.size(); ++i)
+            {
+                const size_t size = batch.sizes[i];
+                if (size > batch.payload.size() - offset)
+                {
+                    PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                             "Dropped the rest of a batch that is shorter than its sizes");
+                    return;
+                }
+                const std::span<const std::byte> payload{ batch.payload.data() + offset, size };
+                offset += size;
+                if (batch.types[i] != FragmentPacket::static_unique_id)
+                {
+                    decode(batch.types[i], payload);
+                    continue;
+                }
+                std::unique_ptr<FragmentPacket> fragment;
+                try
+                {
+                    fragment = capture::decode_packet<FragmentPacket>(payload);
+                }
+                catch (const boost::archive::archive_exception &e)
+                {
+                    PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                             "Dropped a malformed fragment of a batch: {}", e.what());
+                    continue;
+                }
+                reassemble(std::move(*fragment));
+            }
+        }
+
+        /** @brief For fragments that arrived on their own. */
+        void receive(FragmentPacket &&fragment) const
+        {
+            std::shared_lock lock{ mutex_ };
+            reassemble(std::move(fragment));
+        }
+
+    private:
+        // Both run under a shared lock of mutex_.
+        void reassemble(FragmentPacket &&fragment) const
+        {
+            std::optional<ReassembledPacket> reassembled;
+            {
+                std::lock_guard lock{ assembler_mutex_ };
+                reassembled = assembler_.add(std::move(fragment));
+            }
+            if (reassembled)
+            {
+                decode(reassembled->type, reassembled->payload);
+            }
+        }
+        void decode(mal_packet_weaver::UniquePacketID type, std::span<const std::byte> payload) const
+        {
+            const auto decoder = decoders_.find(type);
+            if (decoder == decoders_.end())
+            {
+                PDS_HOT_LOG_RATE_LIMITED(spdlog::level::warn, std::chrono::seconds{ 1 },
+                                         "Dropped packet {:#x}, which has no handler", type);
+                return;
+            }
+            decoder->second(payload);
+        }
+
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<mal_packet_weaver::UniquePacketID, std::function<void(std::span<const std::byte>)>>
+            decoders_;
+        mutable std::mutex assembler_mutex_;
+        mutable FragmentAssembler assembler_;
+    };
+
+    /**
+     * @brief Hands the PacketBatches and FragmentPackets session receives to batches, and
+     * acknowledges every batch with a BatchAck, which the sending OutboundSession waits for
+     * before it sends more than its window. Also for peers that send on their own but are
+     * answered by an OutboundSession, such as the server's.
+     */
+    template <typename Session>
+    void receive_batches(Session &session, std::shared_ptr<BatchReceiver> const &batches)
+    {
+        session.template register_default_handler<mal_packet_weaver::Session &, PacketBatch>(
+            [batches, received = std::make_shared<std::atomic<uint64_t>>(0)](
+                mal_packet_weaver::Session &connection, std::unique_ptr<PacketBatch> &&batch)
+            {
+                batches->receive(*batch);
+                // Past the queue, which may be waiting for this very ack.
+                BatchAck ack;
+                ack.received_bytes = received->fetch_add(batch->payload.size(), std::memory_order_relaxed) +
+                                     batch->payload.size();
+                connection.send_packet(ack);
+            });
+        session.template register_default_handler<FragmentPacket>(
+            [batches](std::unique_ptr<FragmentPacket> &&fragment) { batches->receive(std::move(*fragment)); });
+    }
+}  // namespace pds::network
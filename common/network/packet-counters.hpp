@@ -0,0 +1,61 @@
+#pragma once
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "mal-packet-weaver/packet.hpp"
+
+namespace pds::network
+{
+    /**
+     * @brief Event counters keyed by packet type.
+     *
+     * @details Meant for events that are rare compared to the packet rate (drops, rejections), so
+     * a mutex is cheaper than keeping a counter slot for every declared packet type.
+     */
+    class PacketCounters
+    {
+    public:
+        void add(mal_packet_weaver::UniquePacketID type, uint64_t amount = 1)
+        {
+            std::lock_guard lock{ mutex_ };
+            counters_[type] += amount;
+        }
+
+        [[nodiscard]] uint64_t get(mal_packet_weaver::UniquePacketID type) const
+        {
+            std::lock_guard lock{ mutex_ };
+            const auto it = counters_.find(type);
+            return it == counters_.end() ? 0 : it->second;
+        }
+
+        [[nodiscard]] uint64_t total() const
+        {
+            std::lock_guard lock{ mutex_ };
+            uint64_t rv = 0;
+            for (auto const &[type, count] : counters_)
+            {
+                rv += count;
+            }
+            return rv;
+        }
+
+        /** @brief Returns (type, count) pairs sorted by type. */
+        [[nodiscard]] std::vector<std::pair<mal_packet_weaver::UniquePacketID, uint64_t>> snapshot()
+            const
+        {
+            std::vector<std::pair<mal_packet_weaver::UniquePacketID, uint64_t>> rv;
+            {
+                std::lock_guard lock{ mutex_ };
+                rv.assign(counters_.begin(), counters_.end());
+            }
+            std::ranges::sort(rv);
+            return rv;
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::unordered_map<mal_packet_weaver::UniquePacketID, uint64_t> counters_;
+    };
+}  // namespace pds::network
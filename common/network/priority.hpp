@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+#include "mal-packet-weaver/packet.hpp"
+
+namespace pds::network
+{
+    /** @brief Outbound lanes of a session, from the most to the least latency-sensitive. */
+    enum class Priority : uint8_t
+    {
+        High = 0,
+        Normal = 1,
+        Bulk = 2
+    };
+    constexpr size_t kPriorityCount = 3;
+
+    /**
+     * @brief Share of every gathered write each lane is entitled to while all lanes have data.
+     *
+     * @details Lanes are served by deficit round robin over bytes, so with the default weights
+     * bulk traffic still gets 1/21 of the link when urgent traffic saturates it.
+     */
+    struct PriorityWeights
+    {
+        std::array<uint32_t, kPriorityCount> weights{ 16, 4, 1 };
+        /** @brief Bytes a lane of weight 1 may send per round. */
+        uint32_t quantum = 4096;
+    };
+
+    /** @brief Maps packet types to lanes. Shared between sessions, read-only. */
+    class PriorityMap
+    {
+    public:
+        explicit PriorityMap(Priority default_priority = Priority::Normal)
+            : default_priority_{ default_priority }
+        {
+        }
+
+        PriorityMap &set(mal_packet_weaver::UniquePacketID type, Priority priority)
+        {
+            priorities_[type] = priority;
+            return *this;
+        }
+        template <typename PacketType>
+        PriorityMap &set(Priority priority)
+        {
+            return set(PacketType::static_unique_id, priority);
+        }
+
+        [[nodiscard]] Priority get(mal_packet_weaver::UniquePacketID type) const
+        {
+            const auto it = priorities_.find(type);
+            return it == priorities_.end() ? default_priority_ : it->second;
+        }
+
+    private:
+        Priority default_priority_;
+        std::unordered_map<mal_packet_weaver::UniquePacketID, Priority> priorities_;
+    };
+}  // namespace pds::network
@@ -0,0 +1,138 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace pds::network
+{
+    /**
+     * @brief Hierarchical timer wheel with a fixed tick resolution.
+     *
+     * @details Four levels of 256 slots each; level N slots span 256^N ticks. Scheduling is O(1),
+     * and advancing costs O(1) per elapsed tick plus the entries that expire or cascade down a
+     * level, independent of how many timers are pending. It replaces one OS/asio timer per timer
+     * with a single periodic tick driving the whole wheel.
+     *
+     * There is no cancellation: entries are expected to carry enough to recognize stale ones
+     * (e.g. a generation counter) when they fire. Not thread-safe.
+     */
+    template <typename Entry>
+    class TimerWheel
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit TimerWheel(Clock::duration resolution, Clock::time_point start = Clock::now())
+            : resolution_{ resolution }, start_{ start }
+        {
+        }
+
+        /** @brief Fires the entry on the first advance() at or after `when`. */
+        void schedule(Clock::time_point when, Entry entry)
+        {
+            // Round up so an entry never fires early.
+            const auto offset = when - start_;
+            uint64_t tick = offset <= Clock::duration::zero()
+                                ? 0
+                                : static_cast<uint64_t>((offset + resolution_ - Clock::duration{ 1 }) /
+                                                        resolution_);
+            place(Item{ std::max(tick, current_tick_ + 1), std::move(entry) });
+            ++size_;
+        }
+
+        /** @brief Calls on_expired(entry) for every entry scheduled at or before `now`. */
+        template <typename OnExpired>
+        void advance(Clock::time_point now, OnExpired &&on_expired)
+        {
+            if (now < start_)
+            {
+                return;
+            }
+            const auto target_tick = static_cast<uint64_t>((now - start_) / resolution_);
+            while (current_tick_ < target_tick)
+            {
+                ++current_tick_;
+                cascade();
+
+                auto &slot = levels_[0][current_tick_ & kSlotMask];
+                if (slot.empty())
+                {
+                    continue;
+                }
+                // Callbacks may schedule new entries, possibly into this very slot.
+                scratch_.swap(slot);
+                size_ -= scratch_.size();
+                for (Item &item : scratch_)
+                {
+                    on_expired(item.entry);
+                }
+                scratch_.clear();
+            }
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return size_; }
+        [[nodiscard]] Clock::duration resolution() const noexcept { return resolution_; }
+
+    private:
+        static constexpr int kLevels = 4;
+        static constexpr int kSlotBits = 8;
+        static constexpr uint64_t kSlots = uint64_t{ 1 } << kSlotBits;
+        static constexpr uint64_t kSlotMask = kSlots - 1;
+
+        struct Item
+        {
+            uint64_t tick;
+            Entry entry;
+        };
+
+        void place(Item &&item)
+        {
+            const uint64_t delta = item.tick - current_tick_;
+            int level = 0;
+            while (level + 1 < kLevels && delta >= (uint64_t{ 1 } << (kSlotBits * (level + 1))))
+            {
+                ++level;
+            }
+            // Entries past the wheel's horizon wait in the top level and are re-placed as it turns.
+            const uint64_t horizon = uint64_t{ 1 } << (kSlotBits * kLevels);
+            const uint64_t tick = delta < horizon ? item.tick : current_tick_ + horizon - 1;
+            levels_[level][(tick >> (kSlotBits * level)) & kSlotMask].emplace_back(std::move(item));
+        }
+
+        // When a lower level wraps around, the slot of the next level that now comes into range
+        // is redistributed into the lower levels.
+        void cascade()
+        {
+            for (int level = 1; level < kLevels; ++level)
+            {
+                if ((current_tick_ & ((uint64_t{ 1 } << (kSlotBits * level)) - 1)) != 0)
+                {
+                    return;
+                }
+                auto &slot = levels_[level][(current_tick_ >> (kSlotBits * level)) & kSlotMask];
+                std::vector<Item> items;
+                items.swap(slot);
+                for (Item &item : items)
+                {
+                    if (item.tick <= current_tick_)
+                    {
+                        item.tick = current_tick_;
+                        levels_[0][current_tick_ & kSlotMask].emplace_back(std::move(item));
+                    }
+                    else
+                    {
+                        place(std::move(item));
+                    }
+                }
+            }
+        }
+
+        const Clock::duration resolution_;
+        const Clock::time_point start_;
+        uint64_t current_tick_ = 0;
+        size_t size_ = 0;
+        std::array<std::array<std::vector<Item>, kSlots>, kLevels> levels_;
+        std::vector<Item> scratch_;
+    };
+}  // namespace pds::network
@@ -0,0 +1,235 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <charconv>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+namespace pds::network
+{
+    enum class TransportKind
+    {
+        Tcp,
+        /** @brief AF_UNIX stream socket, for peers running on the same host. */
+        Local
+    };
+
+    /**
+     * @brief Where to listen or connect: "tcp://host:port", "unix:///path/to.sock" or a bare
+     * "host:port", which is TCP.
+     */
+    struct Endpoint
+    {
+        TransportKind kind = TransportKind::Tcp;
+        /** @brief Host for TCP, socket path for local endpoints. */
+        std::string address;
+        uint16_t port = 0;
+
+        [[nodiscard]] bool is_local() const noexcept { return kind == TransportKind::Local; }
+
+        [[nodiscard]] std::string to_string() const
+        {
+            return is_local() ? "unix://" + address
+                              : "tcp://" + address + ":" + std::to_string(port);
+        }
+    };
+
+    /** @brief Throws std::invalid_argument on malformed input. */
+    [[nodiscard]] inline Endpoint parse_endpoint(std::string_view uri)
+    {
+        constexpr std::string_view kUnixScheme = "unix://";
+        constexpr std::string_view kTcpScheme = "tcp://";
+
+        if (uri.starts_with(kUnixScheme))
+        {
+            uri.remove_prefix(kUnixScheme.size());
+            if (uri.empty())
+            {
+                throw std::invalid_argument("Local endpoint needs a socket path");
+            }
+            return Endpoint{ .kind = TransportKind::Local, .address = std::string{ uri } };
+        }
+        if (uri.starts_with(kTcpScheme))
+        {
+            uri.remove_prefix(kTcpScheme.size());
+        }
+
+        const size_t colon = uri.rfind(':');
+        if (colon == std::string_view::npos || colon == 0)
+        {
+            throw std::invalid_argument("TCP endpoint should look like host:port");
+        }
+        const std::string_view port = uri.substr(colon + 1);
+        Endpoint endpoint{ .kind = TransportKind::Tcp, .address = std::string{ uri.substr(0, colon) } };
+        const auto [end, ec] = std::from_chars(port.data(), port.data() + port.size(), endpoint.port);
+        if (ec != std::errc{} || end != port.data() + port.size())
+        {
+            throw std::invalid_argument("Invalid port in endpoint: " + std::string{ port });
+        }
+        return endpoint;
+    }
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    using LocalSocket = boost::asio::local::stream_protocol::socket;
+    /** @brief A connected socket of either transport, each with its own protocol. */
+    using Socket = std::variant<boost::asio::ip::tcp::socket, LocalSocket>;
+#else
+    using Socket = std::variant<boost::asio::ip::tcp::socket>;
+#endif
+
+    /** @brief Turns off Nagle's algorithm on TCP sockets; local ones have none. */
+    inline void set_no_delay(Socket &socket)
+    {
+        if (auto *tcp = std::get_if<boost::asio::ip::tcp::socket>(&socket))
+        {
+            tcp->set_option(boost::asio::ip::tcp::no_delay(true));
+        }
+    }
+
+    /**
+     * @brief The tcp::socket a DispatcherSession is constructed from, the only socket type it
+     * takes.
+     *
+     * @details This is the one place a local socket leaves its protocol: its descriptor is handed
+     * over as it is, and the session only reads and writes it, which behaves the same whatever
+     * the address family. Nothing may query endpoints or set TCP options on the result.
+     */
+    [[nodiscard]] inline boost::asio::ip::tcp::socket into_session_socket(Socket &&socket)
+    {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+        if (auto *local = std::get_if<LocalSocket>(&socket))
+        {
+            boost::asio::ip::tcp::socket adopted(local->get_executor());
+            adopted.assign(boost::asio::ip::tcp::v4(), local->release());
+            return adopted;
+        }
+#endif
+        return std::move(std::get<boost::asio::ip::tcp::socket>(socket));
+    }
+
+    /** @brief Accepts TCP or local connections. */
+    class Listener
+    {
+    public:
+        Listener(boost::asio::io_context &io_context, Endpoint endpoint)
+            : endpoint_{ std::move(endpoint) }
+        {
+            if (endpoint_.is_local())
+            {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+                // A previous process may have left its socket file behind; anything else at the
+                // path is most likely a mistyped endpoint, and is left alone.
+                const std::filesystem::path path{ endpoint_.address };
+                if (std::filesystem::is_socket(path))
+                {
+                    std::filesystem::remove(path);
+                }
+                else if (std::filesystem::exists(path))
+                {
+                    throw std::runtime_error("Can't listen on " + endpoint_.address + ", which isn't a socket");
+                }
+                acceptor_.emplace<LocalAcceptor>(
+                    io_context, boost::asio::local::stream_protocol::endpoint(endpoint_.address));
+#else
+                throw std::runtime_error("Local sockets are not supported on this platform");
+#endif
+            }
+            else
+            {
+                auto &acceptor = acceptor_.emplace<TcpAcceptor>(
+                    io_context,
+                    boost::asio::ip::tcp::endpoint(
+                        boost::asio::ip::make_address(endpoint_.address), endpoint_.port));
+                // Port 0 binds an ephemeral port; report the one actually in use.
+                endpoint_.port = acceptor.local_endpoint().port();
+            }
+        }
+        ~Listener()
+        {
+            if (std::error_code ec; endpoint_.is_local() && std::filesystem::is_socket(endpoint_.address, ec))
+            {
+                std::filesystem::remove(endpoint_.address, ec);
+            }
+        }
+
+        Listener(Listener const &) = delete;
+        Listener &operator=(Listener const &) = delete;
+
+        /** @brief handler(boost::system::error_code, Socket) */
+        template <typename Handler>
+        void async_accept(Handler &&handler)
+        {
+            std::visit(
+                [&handler](auto &acceptor)
+                {
+                    if constexpr (!std::is_same_v<std::decay_t<decltype(acceptor)>, std::monostate>)
+                    {
+                        acceptor.async_accept(
+                            [handler = std::forward<Handler>(handler)](boost::system::error_code ec,
+                                                                       auto socket) mutable
+                            { handler(ec, Socket{ std::move(socket) }); });
+                    }
+                },
+                acceptor_);
+        }
+
+        /** @brief The bound endpoint, with the actual port for TCP. */
+        [[nodiscard]] Endpoint const &endpoint() const noexcept { return endpoint_; }
+
+    private:
+        using TcpAcceptor = boost::asio::ip::tcp::acceptor;
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+        using LocalAcceptor = boost::asio::local::stream_protocol::acceptor;
+        std::variant<std::monostate, TcpAcceptor, LocalAcceptor> acceptor_;
+#else
+        std::variant<std::monostate, TcpAcceptor> acceptor_;
+#endif
+        Endpoint endpoint_;
+    };
+
+    /** @brief Blocking connect to either transport. Throws boost::system::system_error. */
+    [[nodiscard]] inline Socket connect(boost::asio::io_context &io_context, Endpoint const &endpoint)
+    {
+        if (endpoint.is_local())
+        {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+            LocalSocket local(io_context);
+            local.connect(boost::asio::local::stream_protocol::endpoint(endpoint.address));
+            return local;
+#else
+            throw std::runtime_error("Local sockets are not supported on this platform");
+#endif
+        }
+        boost::asio::ip::tcp::socket socket(io_context);
+        socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address(endpoint.address),
+                                                      endpoint.port));
+        return socket;
+    }
+
+    /**
+     * @brief connect() for coroutines, on their executor. Throws boost::system::system_error.
+     */
+    [[nodiscard]] inline boost::asio::awaitable<Socket> async_connect(Endpoint endpoint)
+    {
+        const auto executor = co_await boost::asio::this_coro::executor;
+        if (endpoint.is_local())
+        {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+            LocalSocket local(executor);
+            co_await local.async_connect(boost::asio::local::stream_protocol::endpoint(endpoint.address),
+                                         boost::asio::use_awaitable);
+            co_return local;
+#else
+            throw std::runtime_error("Local sockets are not supported on this platform");
+#endif
+        }
+        boost::asio::ip::tcp::socket socket(executor);
+        co_await socket.async_connect(
+            boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address(endpoint.address), endpoint.port),
+            boost::asio::use_awaitable);
+        co_return socket;
+    }
+}  // namespace pds::network
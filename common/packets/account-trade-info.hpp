@@ -1,17 +1,35 @@
 #pragma once
-#include "../mql/mql.hpp"
+#include "../copier/copy-rules.hpp"
+#include "../mql-cpp/mql.hpp"
+#include "../network/deadline.hpp"
 #include "subsystems.hpp"
 
 class PacketTag
 {
-    uint64_t uid;
+public:
+    /** @brief Records the send time checked by pds::network::LateArrivalFilter on receipt. */
+    void stamp_send_time() noexcept { send_time_ms = pds::network::wall_clock_ms(); }
+    /** @brief Records a send time taken elsewhere, e.g. the one a packet was captured with. */
+    void stamp_send_time(int64_t sent_at_ms) noexcept { send_time_ms = sent_at_ms; }
+    [[nodiscard]] int64_t sent_at_ms() const noexcept { return send_time_ms; }
+
+    /**
+     * @brief Login of the account trade info belongs to: the channel it is published on (see
+     * TradeChannelOpen) and what central_server forwards to subscribers carries. 0 when unset.
+     */
+    void set_owner_login(int64_t login) noexcept { uid = static_cast<uint64_t>(login); }
+    [[nodiscard]] int64_t owner_login() const noexcept { return static_cast<int64_t>(uid); }
 
 private:
+    uint64_t uid = 0;
+    int64_t send_time_ms = 0;
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive &ar, const unsigned int)
     {
         ar &uid;
+        ar &send_time_ms;
     }
 };
 
@@ -85,4 +103,29 @@ MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITHOUT_PAYLOAD(MQL5DealInfoResponse, (
 MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITHOUT_PAYLOAD(MQL4OrderInfoRequest, (PacketTag), PacketSubsystemTradeInfo, 44, 60)
 MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITHOUT_PAYLOAD(MQL4OrderInfoResponse, (PacketTag, mql::mql4::OrderInfo), PacketSubsystemTradeInfo, 45, 60)
 
+// A client asks for the trade info of an account: central_server answers with what it holds and
+// then forwards every update, stamped with the account's login, until the client unsubscribes.
+MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITH_PAYLOAD(TradeSubscribeRequest, (PacketTag), PacketSubsystemTradeInfo, 46, 60, (int64_t, account_login))
+MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITH_PAYLOAD(TradeUnsubscribeRequest, (PacketTag), PacketSubsystemTradeInfo, 47, 60, (int64_t, account_login))
+// What subscribers hold of the account is no longer current, e.g. its terminal disconnected;
+// positions and orders are sent again once it is back.
+MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITH_PAYLOAD(TradeInvalidation, (PacketTag), PacketSubsystemTradeInfo, 48, 60, (int64_t, account_login))
+
+// A publisher multiplexes the accounts of one terminal process over its session, one channel per
+// account: central_server routes what carries the account's login in PacketTag::owner_login as
+// if it came from a session of its own, from the open until the close or the session's end.
+MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITH_PAYLOAD(TradeChannelOpen, (PacketTag), PacketSubsystemTradeInfo, 49, 60, (int64_t, account_login))
+MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITH_PAYLOAD(TradeChannelClose, (PacketTag), PacketSubsystemTradeInfo, 50, 60, (int64_t, account_login))
+
+// A follower terminal asks central_server to copy the deals of a master account to one of its
+// accounts; following again replaces the rules. The server then sends the follower's session a
+// CopyTradeCommand, stamped with the follower's login, for every deal the master's publisher
+// sends, until the follower unfollows or its session ends.
+MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITH_PAYLOAD(CopierFollow, (PacketTag), PacketSubsystemTradeInfo, 51, 60, (int64_t, master_login), (int64_t, follower_login), (pds::copier::CopyRules, rules))
+MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITH_PAYLOAD(CopierUnfollow, (PacketTag), PacketSubsystemTradeInfo, 52, 60, (int64_t, master_login), (int64_t, follower_login))
+// A master deal mapped through the follower's rules, ready to execute: type and entry are the
+// master's, so an entry out reduces the follower's copy of master_position. master_time_msc lets
+// the follower refuse commands that arrive too late to be worth executing.
+MAL_PACKET_WEAVER_DECLARE_DERIVED_PACKET_WITH_PAYLOAD(CopyTradeCommand, (PacketTag), PacketSubsystemTradeInfo, 53, 60, (int64_t, master_login), (int64_t, follower_login), (int64_t, master_deal), (int64_t, master_position), (int64_t, master_time_msc), (mql::SymbolString, symbol), (mql::mql5::EnumDealType, type), (mql::mql5::EnumDealEntry, entry), (double, volume), (double, price), (double, stop_loss), (double, take_profit), (int64_t, magic))
+
 // clang-format on
\ No newline at end of file
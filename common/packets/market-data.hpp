@@ -0,0 +1,43 @@
+#pragma once
+#include <boost/serialization/vector.hpp>
+
+#include "../market/bars.hpp"
+#include "../mql-cpp/common.hpp"
+#include "subsystems.hpp"
+
+// Ticks refer to symbols by an id interned on the connection (see pds::market::SymbolTable); the
+// sender defines every id before its first tick and again on every new connection. digits tell
+// how prices are scaled to points.
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(SymbolDefinition, PacketSubsystemMarketData, 0, 60.0f,
+                                              (uint32_t, symbol), (mql::SymbolString, name), (int32_t, digits))
+// Ticks of any symbols encoded by pds::market::TickWriter; a tick outlives its usefulness
+// quickly, so batches that wait too long are dropped.
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(TickBatch, PacketSubsystemMarketData, 1, 2.0f,
+                                              (int64_t, base_time_msc), (uint32_t, tick_count),
+                                              (std::vector<uint8_t>, ticks))
+// A client asks central_server for the ticks of a symbol; the server defines the symbol on the
+// client's connection once it knows how it is quoted, then forwards its ticks.
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(MarketDataSubscribe, PacketSubsystemMarketData, 2, 60.0f,
+                                              (mql::SymbolString, symbol))
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(MarketDataUnsubscribe, PacketSubsystemMarketData, 3, 60.0f,
+                                              (mql::SymbolString, symbol))
+
+// Bars central_server builds from the ticks it routes (see pds::market::Timeframe). Closed bars
+// are sent as they close; partial updates of the forming bar, if asked for, at most once per
+// routed tick batch.
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(BarSubscribe, PacketSubsystemMarketData, 4, 60.0f,
+                                              (mql::SymbolString, symbol), (uint8_t, timeframe), (bool, partial))
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(BarUnsubscribe, PacketSubsystemMarketData, 5, 60.0f,
+                                              (mql::SymbolString, symbol), (uint8_t, timeframe))
+// symbol is the id the server defined on the connection.
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(BarUpdate, PacketSubsystemMarketData, 6, 10.0f,
+                                              (uint32_t, symbol), (uint8_t, timeframe), (bool, closed),
+                                              (pds::market::Bar, bar))
+// Answered with the last count bars at most, the forming one included.
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(BarHistoryRequest, PacketSubsystemMarketData, 7, 60.0f,
+                                              (mql::SymbolString, symbol), (uint8_t, timeframe), (uint32_t, count))
+// Oldest first; partial tells whether the last bar is still forming. digits is
+// pds::market::SymbolTable::kUnknownDigits, and bars empty, for symbols the server has no ticks of.
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(BarHistoryResponse, PacketSubsystemMarketData, 8, 60.0f,
+                                              (mql::SymbolString, symbol), (uint8_t, timeframe), (int32_t, digits),
+                                              (bool, partial), (std::vector<pds::market::Bar>, bars))
@@ -0,0 +1,75 @@
+#pragma once
+#include "../network/fragmentation.hpp"
+#include "../network/outbound-policy.hpp"
+#include "../network/priority.hpp"
+#include "account-trade-info.hpp"
+#include "market-data.hpp"
+#include "node-info.hpp"
+#include "packet-network.hpp"
+
+/**
+ * @brief Overflow policies for the packets sent to terminals.
+ *
+ * @details Account and position snapshots only matter in their latest state, so pending ones are
+ * conflated: per account, and positions per ticket as well (see pds::network::conflation_key_of).
+ * The double and string parts of a position carry no ticket, so updates of different positions
+ * can't be told apart and they are not conflated. Node telemetry, chat messages and tick
+ * batches, which don't depend on each other, can be lost without harm, and so can the fragments
+ * of large packets: the receiver drops what is left of their transfer. Everything else (orders, deals, handshake) must arrive in full, so a terminal
+ * that cannot keep up with it is disconnected.
+ */
+inline std::shared_ptr<const pds::network::OverflowPolicies> make_default_overflow_policies()
+{
+    using pds::network::OverflowPolicy;
+    auto policies = std::make_shared<pds::network::OverflowPolicies>(OverflowPolicy::Disconnect);
+    policies->set<AccountInfoDoubleResponse>(OverflowPolicy::Conflate)
+        .set<AccountInfoStringResponse>(OverflowPolicy::Conflate)
+        .set<AccountInfoIntegerResponse>(OverflowPolicy::Conflate)
+        .set<AccountInfoDoubleMinimalResponse>(OverflowPolicy::Conflate)
+        .set<AccountInfoIntegerMinimalResponse>(OverflowPolicy::Conflate)
+        .set<AccountInfoMinimalResponse>(OverflowPolicy::Conflate)
+        .set<MQL4FullAccountInfoResponse>(OverflowPolicy::Conflate)
+        .set<MQL5AccountInfoIntegerResponse>(OverflowPolicy::Conflate)
+        .set<MQL5AccountInfoDoubleResponse>(OverflowPolicy::Conflate)
+        .set<MQL5PositionInfoIntegerResponse>(OverflowPolicy::Conflate)
+        .set<MQL5PositionInfoResponse>(OverflowPolicy::Conflate)
+        .set<NodeInformationResponse>(OverflowPolicy::Conflate)
+        .set<MessagePacket>(OverflowPolicy::DropOldest)
+        .set<EchoPacket>(OverflowPolicy::DropOldest)
+        .set<TickBatch>(OverflowPolicy::DropOldest)
+        .set<FragmentPacket>(OverflowPolicy::DropOldest);
+    return policies;
+}
+
+/**
+ * @brief Lanes for the packets sent to terminals.
+ *
+ * @details Trade info, handshake and heartbeat traffic is latency-critical and goes first; tick
+ * batches, which can be large, come next so they never hold it up. Node telemetry, chat messages
+ * and fragments of large transfers only use what bandwidth is left.
+ */
+inline std::shared_ptr<const pds::network::PriorityMap> make_default_priorities()
+{
+    using pds::network::Priority;
+    auto priorities = std::make_shared<pds::network::PriorityMap>(Priority::High);
+    priorities->set<EchoPacket>(Priority::Normal)
+        .set<TickBatch>(Priority::Normal)
+        .set<MessagePacket>(Priority::Bulk)
+        .set<FragmentPacket>(Priority::Bulk)
+        .set<NodeInformationRequest>(Priority::Bulk)
+        .set<NodeInformationResponse>(Priority::Bulk);
+    return priorities;
+}
+
+/**
+ * @brief Tick batches and bar history can hold thousands of records; the rest always fits a chunk.
+ *
+ * @details Only for sessions whose peer reassembles fragments, i.e. receives through an
+ * OutboundSession, as central_server and ClientConnection do.
+ */
+inline std::shared_ptr<const pds::network::FragmentationPolicy> make_default_fragmentation()
+{
+    auto fragmentation = std::make_shared<pds::network::FragmentationPolicy>();
+    fragmentation->allow<TickBatch>().allow<BarHistoryResponse>();
+    return fragmentation;
+}
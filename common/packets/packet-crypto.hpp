@@ -2,18 +2,34 @@
 #include "mal-packet-weaver/crypto.hpp"
 #include "subsystems.hpp"
 
+// `ciphers` is a bitmask of pds::crypto::Cipher the client supports; the server answers with
+// the one it picked in `cipher`. The response's signature covers the whole request as well as
+// its own fields (see get_hash), so a changed offer fails verification and can't force a weaker
+// cipher; the client also rejects a cipher it didn't offer. `suite` is the
+// pds::crypto::HandshakeSuite `public_key` belongs to; zero means DhEcdsa. The server echoes it
+// in the signed response. `key_id` selects the tenant key in the server's keyring that signs the
+// response; zero means the server's default key.
 MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(DHKeyExchangeRequestPacket, PacketSubsystemCrypto, 0,
-                                              120.0f, (mal_packet_weaver::ByteArray, public_key))
+                                              120.0f, (mal_packet_weaver::ByteArray, public_key),
+                                              (uint32_t, ciphers), (uint32_t, suite), (uint32_t, key_id))
 
 MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_BODY_WITH_PAYLOAD(
     DHKeyExchangeResponsePacket, PacketSubsystemCrypto, 1, 120.0f,
-    [[nodiscard]] mal_packet_weaver::crypto::Hash get_hash() const {
+    [[nodiscard]] mal_packet_weaver::crypto::Hash get_hash(DHKeyExchangeRequestPacket const &request) const {
         mal_packet_weaver::ByteArray arr;
-        arr.append(public_key, salt,
+        arr.append(request.public_key,
+                   mal_packet_weaver::ByteArray::from_integral(boost::endian::native_to_little(request.ciphers)),
+                   mal_packet_weaver::ByteArray::from_integral(boost::endian::native_to_little(request.suite)),
+                   mal_packet_weaver::ByteArray::from_integral(boost::endian::native_to_little(request.key_id)),
+                   public_key, salt,
                    mal_packet_weaver::ByteArray::from_integral(
-                       boost::endian::little_to_native(static_unique_id)));
+                       boost::endian::little_to_native(static_unique_id)),
+                   mal_packet_weaver::ByteArray::from_integral(
+                       boost::endian::native_to_little(cipher)),
+                   mal_packet_weaver::ByteArray::from_integral(
+                       boost::endian::native_to_little(suite)));
         return mal_packet_weaver::crypto::SHA::ComputeHash(
             arr, mal_packet_weaver::crypto::Hash::HashType::SHA256);
     },
     (mal_packet_weaver::ByteArray, public_key), (mal_packet_weaver::ByteArray, salt),
-    (int, n_rounds), (mal_packet_weaver::ByteArray, signature))
+    (int, n_rounds), (uint32_t, cipher), (uint32_t, suite), (mal_packet_weaver::ByteArray, signature))
@@ -1,9 +1,28 @@
 #pragma once
+#include <boost/serialization/vector.hpp>
+
 #include "subsystems.hpp"
 
-MAL_PACKET_WEAVER_DECLARE_PACKET(PingPacket, PacketSubsystemNetwork, 0, 120.0f)
-MAL_PACKET_WEAVER_DECLARE_PACKET(PongPacket, PacketSubsystemNetwork, 1, 120.0f)
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(PingPacket, PacketSubsystemNetwork, 0, 120.0f,
+                                              (uint64_t, sequence), (int64_t, sent_at_ns))
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(PongPacket, PacketSubsystemNetwork, 1, 120.0f,
+                                              (uint64_t, sequence), (int64_t, sent_at_ns))
 MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(MessagePacket, PacketSubsystemNetwork, 2, 120.0f,
                                               (std::string, message))
 MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(EchoPacket, PacketSubsystemNetwork, 3, 120.0f,
                                               (std::string, echo_message))
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(FragmentPacket, PacketSubsystemNetwork, 4, 120.0f,
+                                              (uint32_t, transfer_id),
+                                              (mal_packet_weaver::UniquePacketID, inner_type),
+                                              (uint32_t, total_size), (uint32_t, offset),
+                                              (mal_packet_weaver::ByteArray, data))
+// Packets an OutboundSession gathered into one write: the capture encoding (see
+// pds::capture::encode_packet) of each, back to back in payload, sizes[i] bytes of types[i].
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(PacketBatch, PacketSubsystemNetwork, 5, 120.0f,
+                                              (std::vector<mal_packet_weaver::UniquePacketID>, types),
+                                              (std::vector<uint32_t>, sizes),
+                                              (mal_packet_weaver::ByteArray, payload))
+// Answers every PacketBatch: the payload bytes of all batches received on the session so far,
+// which tells the sending OutboundSession how much of its output is still on the way.
+MAL_PACKET_WEAVER_DECLARE_PACKET_WITH_PAYLOAD(BatchAck, PacketSubsystemNetwork, 6, 120.0f,
+                                              (uint64_t, received_bytes))
@@ -6,4 +6,5 @@
 constexpr mal_packet_weaver::PacketSubsystemID PacketSubsystemCrypto = 0x0001;
 constexpr mal_packet_weaver::PacketSubsystemID PacketSubsystemNetwork = 0x0002;
 constexpr mal_packet_weaver::PacketSubsystemID PacketSubsystemTradeInfo = 0x0003;
-constexpr mal_packet_weaver::PacketSubsystemID PacketSubsystemNodeInfo = 0x0004;
\ No newline at end of file
+constexpr mal_packet_weaver::PacketSubsystemID PacketSubsystemNodeInfo = 0x0004;
+constexpr mal_packet_weaver::PacketSubsystemID PacketSubsystemMarketData = 0x0005;
\ No newline at end of file
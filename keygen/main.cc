@@ -3,14 +3,167 @@
 #include <boost/program_options/parsers.hpp>
 #include <boost/program_options/value_semantic.hpp>
 #include <boost/program_options/variables_map.hpp>
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 #include "mal-packet-weaver/crypto.hpp"
+#include "crypto/curve25519.hpp"
 using namespace mal_packet_weaver::crypto;
 using namespace mal_packet_weaver;
 
 namespace po = boost::program_options;
 
+// Not an ECDSA curve: selects the Ed25519 keys of the X25519/Ed25519 handshake suite.
+constexpr std::string_view kEd25519Curve = "ed25519";
+
+enum class SelfTest
+{
+    // Sign and verify the hash of a 4 KiB random buffer, as keygen always did.
+    Full,
+    // Sign and verify a fixed digest; still catches a mismatched or broken pair.
+    Fast,
+    None
+};
+
+SelfTest ParseSelfTest(std::string const& name)
+{
+    if (name == "full")
+    {
+        return SelfTest::Full;
+    }
+    if (name == "fast")
+    {
+        return SelfTest::Fast;
+    }
+    if (name == "none")
+    {
+        return SelfTest::None;
+    }
+    throw std::invalid_argument("Unknown self-test mode: " + name);
+}
+
+// std::rand() takes a global lock, which serializes the workers; every thread gets its own engine.
+ByteArray RandomBytes(size_t size)
+{
+    thread_local std::mt19937_64 rng{ std::random_device{}() };
+    ByteArray random_bytes;
+    random_bytes.resize(size);
+    std::ranges::generate(random_bytes, []() -> std::byte { return static_cast<std::byte>(rng()); });
+    return random_bytes;
+}
+
+Hash SelfTestHash(SelfTest self_test)
+{
+    if (self_test == SelfTest::Full)
+    {
+        return SHA::ComputeHash(RandomBytes(4096), Hash::HashType::SHA256);
+    }
+    static const Hash fixed_hash = SHA::ComputeHash(ByteArray{ 32 }, Hash::HashType::SHA256);
+    return fixed_hash;
+}
+
+void RunSelfTest(std::string_view curve, KeyPair const& pair, SelfTest self_test)
+{
+    if (self_test == SelfTest::None)
+    {
+        return;
+    }
+    const Hash hash = SelfTestHash(self_test);
+    bool result;
+    if (curve == kEd25519Curve)
+    {
+        pds::crypto::Ed25519Signer signer{ pair.private_key };
+        pds::crypto::Ed25519Verifier verifier{ pair.public_key };
+        result = verifier.verify(hash.hash_value, signer.sign(hash.hash_value));
+    }
+    else
+    {
+        ECDSA::Signer signer{ pair.private_key, Hash::HashType::SHA256 };
+        ECDSA::Verifier verifier{ pair.public_key, Hash::HashType::SHA256 };
+
+        ByteArray signature = signer.sign_hash(hash);
+        result = verifier.verify_hash(hash, signature);
+
+        /* Example
+        ByteArray signature = signer.sign_data(pair.private_key, random_bytes, Hash::HashType::SHA256);
+        bool result = verifier.verify_data(pair.public_key, random_bytes, signature, Hash::HashType::SHA256);
+        */
+    }
+    AlwaysAssert(result, "Error: keypair verification has failed.");
+}
+
+// Workers claim indices from a shared counter and store each pair at its index, so the output
+// is in the same order, and the files get the same names, for any number of threads.
+std::vector<KeyPair> GenerateKeyPairs(std::string const& curve, uint32_t amount, uint32_t threads, SelfTest self_test)
+{
+    std::vector<KeyPair> key_pairs(amount);
+    std::atomic<uint32_t> next_index = 0;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto worker = [&]()
+    {
+        try
+        {
+            std::optional<ECDSA::KeyPairGenerator> generator;
+            if (curve != kEd25519Curve)
+            {
+                generator.emplace(curve);
+            }
+            for (uint32_t i = next_index++; i < amount; i = next_index++)
+            {
+                key_pairs[i] = generator ? generator->generate() : pds::crypto::generate_ed25519_key_pair();
+                RunSelfTest(curve, key_pairs[i], self_test);
+            }
+        }
+        catch (...)
+        {
+            // Stops the other workers at their next key.
+            next_index = amount;
+            std::lock_guard lock{ error_mutex };
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < std::min(threads, amount); i++)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    return key_pairs;
+}
+
+void WriteBuffered(std::filesystem::path const& path, std::string const& contents)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(contents.data(), contents.size());
+    if (!file)
+    {
+        throw std::runtime_error("Couldn't write " + path.string());
+    }
+}
+
 void WriteMergedKeys(std::string const& private_key_merged_file, std::string const& public_key_merged_file, bool force, std::vector<KeyPair> const& key_pairs)
 {
     const auto private_path = std::filesystem::path(private_key_merged_file);
@@ -26,21 +179,31 @@ void WriteMergedKeys(std::string const& private_key_merged_file, std::string con
             throw std::runtime_error("Public key file already exists");
         }
     }
-    std::ofstream private_key_file(private_path);
-    std::ofstream public_key_file(public_path);
+    // Each file is assembled in memory and written once, instead of flushing after every key.
+    size_t private_size = 0;
+    size_t public_size = 0;
+    for (auto const& pair : key_pairs)
+    {
+        private_size += pair.private_key.size() + 1;
+        public_size += pair.public_key.size() + 1;
+    }
+    std::string private_keys;
+    std::string public_keys;
+    private_keys.reserve(private_size);
+    public_keys.reserve(public_size);
     for(auto const& pair : key_pairs)
     {
-        private_key_file.write(pair.private_key.as<char>(), pair.private_key.size());
-        public_key_file.write(pair.public_key.as<char>(), pair.public_key.size());
-        private_key_file << std::endl;
-        public_key_file << std::endl;
+        private_keys.append(pair.private_key.as<char>(), pair.private_key.size()).push_back('\n');
+        public_keys.append(pair.public_key.as<char>(), pair.public_key.size()).push_back('\n');
     }
-    private_key_file.close();
-    public_key_file.close();
+    WriteBuffered(private_path, private_keys);
+    WriteBuffered(public_path, public_keys);
 }
 
 void WriteSeparateKeys(std::string const& private_key_output_folder, std::string const& public_key_output_folder, bool force, std::vector<KeyPair> const& key_pairs)
 {
+    std::filesystem::create_directories(private_key_output_folder);
+    std::filesystem::create_directories(public_key_output_folder);
     int i = 0;
     for (auto const& pair : key_pairs)
     {
@@ -58,14 +221,8 @@ void WriteSeparateKeys(std::string const& private_key_output_folder, std::string
                 throw std::runtime_error("Public key file already exists");
             }
         }
-        std::filesystem::create_directories(private_key_output_folder);
-        std::filesystem::create_directories(public_key_output_folder);
-        std::ofstream private_key_file(private_path);
-        std::ofstream public_key_file(public_path);
-        private_key_file.write(pair.private_key.as<char>(), pair.private_key.size());
-        public_key_file.write(pair.public_key.as<char>(), pair.public_key.size());
-        private_key_file.close();
-        public_key_file.close();
+        WriteBuffered(private_path, std::string{ pair.private_key.as<char>(), pair.private_key.size() });
+        WriteBuffered(public_path, std::string{ pair.public_key.as<char>(), pair.public_key.size() });
     }
 }
 
@@ -77,6 +234,8 @@ int main(int argc, char **argv)
         std::string public_key_output_folder = "public";
         std::string curve = "secp256k1";
         uint32_t amount = 1;
+        uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+        std::string self_test = "full";
         bool force = true;
         bool merge = false;
         std::string public_key_merged_file;
@@ -91,8 +250,10 @@ int main(int argc, char **argv)
             ("help,h", "print usage message")
             ("private-key-output-folder", po::value<std::string>(&private_key_output_folder), "pathname where to store generated private key")
             ("public-key-output-folder", po::value<std::string>(&public_key_output_folder), "pathname where to store generated public key")
-            ("curve", po::value<std::string>(&curve), "curve name for ECDSA. Available: secp256k1, secp384r1, secp521r1")
+            ("curve", po::value<std::string>(&curve), "curve name. Available: secp256k1, secp384r1, secp521r1 for ECDSA, ed25519 for the X25519/Ed25519 handshake")
             ("amount", po::value<uint32_t>(&amount), "Amount of keys to generate")
+            ("threads", po::value<uint32_t>(&threads), "Worker threads generating keys (default: all cores)")
+            ("self-test", po::value<std::string>(&self_test), "Check of every pair: full, fast or none (default: full)")
             ("force", po::value<bool>(&force), "force overwrite of existing files if they exist (default: true)")
             ("merge", po::value<bool>(&merge), "merge all generated keys into one file")
             ("public-key-merged-file", po::value<std::string>(&public_key_merged_file), "Output file for merged public keys")
@@ -101,6 +262,7 @@ int main(int argc, char **argv)
 
         po::variables_map vm;
         store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
 
         if (vm.contains("help"))
         {
@@ -108,69 +270,8 @@ int main(int argc, char **argv)
             return 0;
         }
 
-        if (vm.contains("private-key-output"))
-        {
-            private_key_output_folder = vm["private-key-output"].as<std::string>();
-        }
-        if (vm.contains("public-key-output"))
-        {
-            public_key_output_folder = vm["public-key-output"].as<std::string>();
-        }
-        if (vm.contains("curve"))
-        {
-            curve = vm["curve"].as<std::string>();
-        }
-        if (vm.contains("force"))
-        {
-            force = vm["force"].as<bool>();
-        }
-        if (vm.contains("amount"))
-        {
-            amount = vm["amount"].as<uint32_t>();
-        }
-        if (vm.contains("merge"))
-        {
-            merge = vm["merge"].as<bool>();
-        }
-        if (vm.contains("public-key-merged-file"))
-        {
-            public_key_merged_file = vm["public-key-merged-file"].as<std::string>();
-        }
-        if (vm.contains("private-key-merged-file"))
-        {
-            private_key_merged_file = vm["private-key-merged-file"].as<std::string>();
-        }
-
-        std::vector<KeyPair> key_pairs;
-        {
-            ECDSA::KeyPairGenerator generator(curve);
-
-            for (uint32_t i = 0; i < amount; i++)
-            {
-                KeyPair pair = generator.generate();
-                ECDSA::Signer signer{ pair.private_key, Hash::HashType::SHA256 };
-                ECDSA::Verifier verifier{ pair.public_key, Hash::HashType::SHA256 };
-
-                ByteArray random_bytes;
-                {
-                    random_bytes.resize(4096);
-                    std::ranges::generate(random_bytes, []() -> std::byte {return static_cast<std::byte>(std::rand() % 0xFF); });
-                }
-
-                Hash hash = SHA::ComputeHash(random_bytes, Hash::HashType::SHA256);
-
-                ByteArray signature = signer.sign_hash(hash);
-                bool result = verifier.verify_hash(hash, signature);
-
-                /* Example
-                ByteArray signature = signer.sign_data(pair.private_key, random_bytes, Hash::HashType::SHA256);
-                bool result = verifier.verify_data(pair.public_key, random_bytes, signature, Hash::HashType::SHA256);
-                */
-
-                AlwaysAssert(result, "Error: keypair verification has failed.");
-                key_pairs.push_back(pair);
-            }
-        }
+        const std::vector<KeyPair> key_pairs =
+            GenerateKeyPairs(curve, amount, std::max(threads, 1u), ParseSelfTest(self_test));
         if(merge)
         {
             WriteMergedKeys(private_key_merged_file, public_key_merged_file, force, key_pairs);
@@ -183,5 +284,7 @@ int main(int argc, char **argv)
     catch (std::exception &e)
     {
         std::cerr << e.what() << "\n";
+        return 1;
     }
+    return 0;
 }
\ No newline at end of file
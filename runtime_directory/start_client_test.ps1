@@ -1,6 +1,12 @@
-# Example using a for loop
-$numberOfProcesses = 250
+# One client_test process drives all sessions and prints throughput and latency percentiles
+# every second; see client_test.exe --help for the message mix and open-loop options.
+$numberOfSessions = 250
+$connectRate = 50
+$durationSeconds = 60
 
-for ($i = 1; $i -le $numberOfProcesses; $i++) {
-    Start-Process -FilePath "client_test.exe"
-}
+Start-Process -FilePath "client_test.exe" -NoNewWindow -Wait -ArgumentList @(
+    "--sessions", $numberOfSessions,
+    "--connect-rate", $connectRate,
+    "--mode", "closed",
+    "--duration", $durationSeconds
+)
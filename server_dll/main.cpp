@@ -1,9 +1,268 @@
 #include "dll_declaration.hpp"
 #include <Windows.h>
 #include <memory>
-extern "C" SERVER_DLL_API float ComputeSqrt(float x)
+#include <shared_mutex>
+
+#include "server-api.h"
+#include "trade-publisher.hpp"
+
+namespace
+{
+    // Shared by every EA of the terminal, and so is its connection; publish calls only take the
+    // lock shared.
+    std::shared_mutex publisher_access;
+    std::unique_ptr<TradePublisher> publisher;
+    uint32_t publisher_users = 0;
+
+    MQL_int to_status(PublishResult result)
+    {
+        switch (result)
+        {
+        case PublishResult::Queued:
+            return PDS_OK;
+        case PublishResult::QueueFull:
+            return PDS_QUEUE_FULL;
+        case PublishResult::ChannelNotOpen:
+            return PDS_CHANNEL_NOT_OPEN;
+        case PublishResult::UnknownSymbol:
+            return PDS_INVALID_ARGUMENT;
+        }
+        return PDS_ERROR;
+    }
+
+    MQL_int publish(TradeSnapshot &snapshot)
+    {
+        std::shared_lock lock{ publisher_access };
+        if (!publisher)
+        {
+            return PDS_NOT_STARTED;
+        }
+        try
+        {
+            return to_status(publisher->publish(snapshot));
+        }
+        catch (const std::exception &)
+        {
+            return PDS_ERROR;
+        }
+    }
+
+    template <typename Info, typename Integer, typename Double>
+    MQL_int publish_trade_info(MQL_long account_login, SnapshotKind kind, Info TradeSnapshot::*info,
+                               Integer const *integer_info, Double const *double_info, const wchar_t *symbol,
+                               const wchar_t *comment, const wchar_t *external_id)
+    {
+        if (integer_info == nullptr || double_info == nullptr)
+        {
+            return PDS_INVALID_ARGUMENT;
+        }
+        TradeSnapshot snapshot;
+        snapshot.account_login = account_login;
+        snapshot.kind = kind;
+        snapshot.*info = Info{ *integer_info, *double_info };
+        snapshot.symbol.assign(symbol);
+        snapshot.comment.assign(comment);
+        snapshot.external_id.assign(external_id);
+        return publish(snapshot);
+    }
+
+    PdsPublisherStats to_c(TradePublisherStats const &stats)
+    {
+        return PdsPublisherStats{ stats.published, stats.dropped,    stats.conflated,
+                                  stats.sent,      stats.reconnects, stats.connected ? 1 : 0 };
+    }
+}  // namespace
+
+extern "C" SERVER_DLL_API MQL_int PdsStart(const wchar_t *endpoint, const wchar_t *server_key_path, MQL_uint key_id)
+{
+    if (endpoint == nullptr)
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    std::unique_lock lock{ publisher_access };
+    if (publisher)
+    {
+        ++publisher_users;
+        return PDS_OK;
+    }
+    try
+    {
+        pds::network::Endpoint parsed = pds::network::parse_endpoint(mql::to_utf8(endpoint));
+        std::unique_ptr<pds::crypto::Keyring<pds::crypto::ServerTrust>> server_keys;
+        if (server_key_path != nullptr && *server_key_path != L'\0')
+        {
+            server_keys = std::make_unique<pds::crypto::Keyring<pds::crypto::ServerTrust>>(
+                std::filesystem::path{ server_key_path });
+        }
+        else if (!parsed.is_local())
+        {
+            spdlog::error("A server key is required on non-local endpoints.");
+            return PDS_INVALID_ARGUMENT;
+        }
+        publisher = std::make_unique<TradePublisher>(std::move(parsed), std::move(server_keys), key_id);
+        publisher_users = 1;
+        return PDS_OK;
+    }
+    catch (const std::invalid_argument &e)
+    {
+        spdlog::error("Couldn't start the trade publisher: {}", e.what());
+        return PDS_INVALID_ARGUMENT;
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::error("Couldn't start the trade publisher: {}", e.what());
+        return PDS_ERROR;
+    }
+}
+
+extern "C" SERVER_DLL_API void PdsStop(void)
+{
+    std::unique_lock lock{ publisher_access };
+    if (publisher_users != 0 && --publisher_users == 0)
+    {
+        publisher.reset();
+    }
+}
+
+extern "C" SERVER_DLL_API MQL_int PdsOpenChannel(MQL_long account_login)
+{
+    if (account_login <= 0)
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    std::shared_lock lock{ publisher_access };
+    if (!publisher)
+    {
+        return PDS_NOT_STARTED;
+    }
+    return publisher->open_channel(account_login) ? PDS_OK : PDS_TOO_MANY_CHANNELS;
+}
+
+extern "C" SERVER_DLL_API MQL_int PdsCloseChannel(MQL_long account_login)
+{
+    std::shared_lock lock{ publisher_access };
+    if (!publisher)
+    {
+        return PDS_NOT_STARTED;
+    }
+    return publisher->close_channel(account_login) ? PDS_OK : PDS_CHANNEL_NOT_OPEN;
+}
+
+extern "C" SERVER_DLL_API MQL_int PdsPublishAccount(const MQL5_AccountInfoInteger *integer_info,
+                                                    const MQL5_AccountInfoDouble *double_info)
+{
+    if (integer_info == nullptr || double_info == nullptr)
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    TradeSnapshot snapshot;
+    snapshot.account_login = integer_info->base_info.account_login;
+    snapshot.kind = SnapshotKind::Account;
+    snapshot.account = { *integer_info, *double_info };
+    return publish(snapshot);
+}
+
+extern "C" SERVER_DLL_API MQL_int PdsPublishPosition(MQL_long account_login,
+                                                     const MQL5_PositionInfoInteger *integer_info,
+                                                     const MQL5_PositionInfoDouble *double_info, const wchar_t *symbol,
+                                                     const wchar_t *comment, const wchar_t *external_id)
+{
+    return publish_trade_info(account_login, SnapshotKind::Position, &TradeSnapshot::position, integer_info,
+                              double_info, symbol, comment, external_id);
+}
+
+extern "C" SERVER_DLL_API MQL_int PdsPublishOrder(MQL_long account_login, const MQL5_OrderInfoInteger *integer_info,
+                                                  const MQL5_OrderInfoDouble *double_info, const wchar_t *symbol,
+                                                  const wchar_t *comment, const wchar_t *external_id)
+{
+    return publish_trade_info(account_login, SnapshotKind::Order, &TradeSnapshot::order, integer_info,
+                              double_info, symbol, comment, external_id);
+}
+
+extern "C" SERVER_DLL_API MQL_int PdsPublishDeal(MQL_long account_login, const MQL5_DealInfoInteger *integer_info,
+                                                 const MQL5_DealInfoDouble *double_info, const wchar_t *symbol,
+                                                 const wchar_t *comment, const wchar_t *external_id)
+{
+    return publish_trade_info(account_login, SnapshotKind::Deal, &TradeSnapshot::deal, integer_info,
+                              double_info, symbol, comment, external_id);
+}
+
+extern "C" SERVER_DLL_API MQL_int PdsDefineSymbol(const wchar_t *symbol, MQL_int digits)
+{
+    if (symbol == nullptr || *symbol == L'\0')
+    {
+        return -PDS_INVALID_ARGUMENT;
+    }
+    std::shared_lock lock{ publisher_access };
+    if (!publisher)
+    {
+        return -PDS_NOT_STARTED;
+    }
+    try
+    {
+        const std::optional<uint32_t> id = publisher->define_symbol(mql::to_utf8(symbol), digits);
+        return id ? static_cast<MQL_int>(*id) : -PDS_INVALID_ARGUMENT;
+    }
+    catch (const std::exception &)
+    {
+        return -PDS_ERROR;
+    }
+}
+
+extern "C" SERVER_DLL_API MQL_int PdsPublishTick(MQL_int symbol_id, const MQL5_Tick *tick)
+{
+    if (symbol_id < 0 || tick == nullptr)
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    std::shared_lock lock{ publisher_access };
+    if (!publisher)
+    {
+        return PDS_NOT_STARTED;
+    }
+    try
+    {
+        return to_status(publisher->publish_tick(static_cast<uint32_t>(symbol_id), *tick));
+    }
+    catch (const std::exception &)
+    {
+        return PDS_ERROR;
+    }
+}
+
+extern "C" SERVER_DLL_API MQL_int PdsGetStats(PdsPublisherStats *stats)
+{
+    if (stats == nullptr)
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    std::shared_lock lock{ publisher_access };
+    if (!publisher)
+    {
+        return PDS_NOT_STARTED;
+    }
+    *stats = to_c(publisher->stats());
+    return PDS_OK;
+}
+
+extern "C" SERVER_DLL_API MQL_int PdsGetChannelStats(MQL_long account_login, PdsPublisherStats *stats)
 {
-    return sqrtf(x);
+    if (stats == nullptr)
+    {
+        return PDS_INVALID_ARGUMENT;
+    }
+    std::shared_lock lock{ publisher_access };
+    if (!publisher)
+    {
+        return PDS_NOT_STARTED;
+    }
+    const std::optional<TradePublisherStats> current = publisher->channel_stats(account_login);
+    if (!current)
+    {
+        return PDS_CHANNEL_NOT_OPEN;
+    }
+    *stats = to_c(*current);
+    return PDS_OK;
 }
 
 BOOL APIENTRY DllMain([[maybe_unused]] HMODULE hModule,
@@ -19,7 +278,11 @@ BOOL APIENTRY DllMain([[maybe_unused]] HMODULE hModule,
     }
     case DLL_THREAD_ATTACH:
     case DLL_THREAD_DETACH:
+        break;
     case DLL_PROCESS_DETACH:
+        // An EA that never called PdsStop leaves the I/O thread running. Joining it here would
+        // deadlock on the loader lock, so the publisher is abandoned instead.
+        static_cast<void>(publisher.release());
         break;
     }
     return TRUE;
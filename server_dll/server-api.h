@@ -0,0 +1,111 @@
+#ifndef SERVER_API_C_H
+#define SERVER_API_C_H
+
+#include <wchar.h>
+
+#include "dll_declaration.hpp"
+#include "mql-c/account-info.h"
+#include "mql-c/market-info.h"
+#include "mql-c/status.h"
+#include "mql-c/trade-info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Publishing trade state from an MQL5 EA. Every Pds* call returns a status.h code; the
+ * publish calls only copy their arguments into a queue and return without touching the
+ * network, so they are safe to call from OnTick and OnTradeTransaction.
+ *
+ * Every EA of the terminal process shares one connection to central_server. An EA publishes
+ * on the channel of its account, which it opens once and closes from OnDeinit; closing the
+ * last one of an account tells its subscribers it is no longer current. Every channel may
+ * only fill a share of the queue, so a busy account can't make the others drop.
+ *
+ * The EA declares the structures of mql-c/ with the same members (int for the flags of the
+ * account structures) and imports the functions:
+ *
+ *     #import "server_dll.dll"
+ *     int PdsStart(string endpoint, string server_key_path, uint key_id);
+ *     void PdsStop();
+ *     int PdsOpenChannel(long account_login);
+ *     int PdsPublishPosition(long account_login, MQL5_PositionInfoInteger &integer_info,
+ *                            MQL5_PositionInfoDouble &double_info, string symbol, string comment,
+ *                            string external_id);
+ *     ...
+ *     #import
+ *
+ * A position is published once more with zero volume when it closes, and an order once more in
+ * its final state, so that subscribers can drop them.
+ *
+ * Ticks need no channel: an EA defines each symbol once and publishes its MqlTick under the id
+ * it got, typically from OnTick:
+ *
+ *     int PdsDefineSymbol(string symbol, int digits);
+ *     int PdsPublishTick(int symbol_id, MqlTick &tick);
+ */
+
+MQL_C_PACK_BEGIN
+
+    typedef struct {
+        MQL_ulong published;
+        /* Snapshots refused because the queue or the channel's share of it was full, or too many
+           were pending offline. */
+        MQL_ulong dropped;
+        /* Account and position snapshots replaced by a newer one before they were sent. */
+        MQL_ulong conflated;
+        MQL_ulong sent;
+        MQL_ulong reconnects;
+        MQL_int connected;
+    } PdsPublisherStats;
+
+MQL_C_PACK_END
+
+    /*
+     * Starts the publisher, or joins the running one: every EA of the terminal calls it from
+     * OnInit and the first call's arguments are used. An empty server_key_path means plaintext,
+     * which is only allowed on unix:// endpoints.
+     */
+    SERVER_DLL_API MQL_int PdsStart(const wchar_t *endpoint, const wchar_t *server_key_path, MQL_uint key_id);
+    /* Called from OnDeinit; the last EA to stop it closes the connection. */
+    SERVER_DLL_API void PdsStop(void);
+
+    /*
+     * Counted: several EAs of the account may open its channel, and it stays open until all of
+     * them closed it. Fails with PDS_TOO_MANY_CHANNELS past 32 accounts.
+     */
+    SERVER_DLL_API MQL_int PdsOpenChannel(MQL_long account_login);
+    SERVER_DLL_API MQL_int PdsCloseChannel(MQL_long account_login);
+
+    /* Published on the channel of integer_info->base_info.account_login. */
+    SERVER_DLL_API MQL_int PdsPublishAccount(const MQL5_AccountInfoInteger *integer_info,
+                                             const MQL5_AccountInfoDouble *double_info);
+    SERVER_DLL_API MQL_int PdsPublishPosition(MQL_long account_login, const MQL5_PositionInfoInteger *integer_info,
+                                              const MQL5_PositionInfoDouble *double_info, const wchar_t *symbol,
+                                              const wchar_t *comment, const wchar_t *external_id);
+    SERVER_DLL_API MQL_int PdsPublishOrder(MQL_long account_login, const MQL5_OrderInfoInteger *integer_info,
+                                           const MQL5_OrderInfoDouble *double_info, const wchar_t *symbol,
+                                           const wchar_t *comment, const wchar_t *external_id);
+    SERVER_DLL_API MQL_int PdsPublishDeal(MQL_long account_login, const MQL5_DealInfoInteger *integer_info,
+                                          const MQL5_DealInfoDouble *double_info, const wchar_t *symbol,
+                                          const wchar_t *comment, const wchar_t *external_id);
+
+    /*
+     * Returns the id of the symbol, the same for every EA of the terminal, or a negated status:
+     * -PDS_INVALID_ARGUMENT if the symbol was defined with other digits. digits is
+     * SYMBOL_DIGITS; prices travel in points of it.
+     */
+    SERVER_DLL_API MQL_int PdsDefineSymbol(const wchar_t *symbol, MQL_int digits);
+    /* Ticks are dropped while disconnected; a stale tick is of no use to subscribers. */
+    SERVER_DLL_API MQL_int PdsPublishTick(MQL_int symbol_id, const MQL5_Tick *tick);
+
+    /* Totals of every channel. */
+    SERVER_DLL_API MQL_int PdsGetStats(PdsPublisherStats *stats);
+    /* Counters of one channel since it was opened. */
+    SERVER_DLL_API MQL_int PdsGetChannelStats(MQL_long account_login, PdsPublisherStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,616 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "crypto/keyring.hpp"
+#include "ipc/mpsc-queue.hpp"
+#include "logging/hot-log.hpp"
+#include "market/symbol-table.hpp"
+#include "market/tick-codec.hpp"
+#include "mql-cpp/c-interop.hpp"
+#include "mql-cpp/wide-string.hpp"
+#include "network/client-connection.hpp"
+#include "packets/account-trade-info.hpp"
+#include "packets/market-data.hpp"
+#include "packets/outbound-policies.hpp"
+
+/** @brief Fixed-capacity copy of an MQL string, so that snapshots stay trivially copyable. */
+template <size_t N>
+struct InlineWideString
+{
+    std::array<wchar_t, N> data;
+    uint16_t size = 0;
+
+    /** @brief Copies up to N characters of a null-terminated string; null is empty. */
+    void assign(const wchar_t *text) noexcept
+    {
+        size = 0;
+        if (text == nullptr)
+        {
+            return;
+        }
+        while (size < N && text[size] != L'\0')
+        {
+            data[size] = text[size];
+            ++size;
+        }
+    }
+    [[nodiscard]] std::wstring_view view() const noexcept { return { data.data(), size }; }
+};
+
+enum class SnapshotKind : uint8_t
+{
+    Account,
+    Position,
+    Order,
+    Deal
+};
+
+template <typename Integer, typename Double>
+struct InfoPair
+{
+    Integer integer_info;
+    Double double_info;
+};
+
+/** @brief What an EA call copies into the queue; about 460 bytes with UTF-16 wchar_t. */
+struct TradeSnapshot
+{
+    /** @brief Channel the snapshot is published on. */
+    int64_t account_login;
+    /** @brief Set by TradePublisher::publish. */
+    uint8_t channel;
+    SnapshotKind kind;
+    union
+    {
+        InfoPair<MQL5_AccountInfoInteger, MQL5_AccountInfoDouble> account;
+        InfoPair<MQL5_PositionInfoInteger, MQL5_PositionInfoDouble> position;
+        InfoPair<MQL5_OrderInfoInteger, MQL5_OrderInfoDouble> order;
+        InfoPair<MQL5_DealInfoInteger, MQL5_DealInfoDouble> deal;
+    };
+    InlineWideString<32> symbol;
+    InlineWideString<64> comment;
+    InlineWideString<32> external_id;
+};
+
+struct TradePublisherStats
+{
+    uint64_t published;
+    uint64_t dropped;
+    uint64_t conflated;
+    uint64_t sent;
+    uint64_t reconnects;
+    bool connected;
+};
+
+/** @brief A tick as an EA publishes it, converted to points on the I/O thread. */
+struct QueuedTick
+{
+    uint32_t symbol;
+    MQL5_Tick tick;
+};
+
+enum class PublishResult
+{
+    Queued,
+    QueueFull,
+    ChannelNotOpen,
+    UnknownSymbol
+};
+
+/**
+ * @brief Sends the trade state EAs publish to central_server without ever blocking them.
+ *
+ * @details Every EA of the terminal process shares the publisher and its one connection, and
+ * publishes on the channel of its account (TradeChannelOpen): the server routes each channel
+ * on its own, so accounts don't need a connection and a handshake each. Channels are found by
+ * login in a fixed table with no lock; opening and closing them takes a mutex.
+ *
+ * publish() copies the snapshot into a bounded MPSC queue and, if the I/O thread isn't already
+ * scheduled to drain it, posts one drain; a full queue drops the snapshot and counts it. Every
+ * channel may hold at most kChannelQueueShare of the queue, so one busy account can't make the
+ * others drop. The I/O thread owns the connection to central_server; each drain empties the
+ * queue and sends everything in one pass through the connection's outbound queue, which hands
+ * what a drain sent to the session as one batch, and a new connection reopens the channels and
+ * starts with one.
+ *
+ * Ticks aren't tied to an account and have a queue of their own. Symbols are defined once for
+ * the whole terminal and the I/O thread defines them on the server before their first tick;
+ * every drain sends the queued ticks in batches of up to kMaxBatchTicks. Ticks are stale by
+ * the next connection, so they are dropped while disconnected.
+ *
+ * Account and position snapshots only matter in their latest state, so pending ones of a
+ * channel are conflated per account and per position ticket, in line with
+ * make_default_overflow_policies, which the connection's outbound queue also applies when the
+ * server falls behind. Orders and deals are sent in full and in order; while disconnected every
+ * channel keeps up to kMaxPendingEvents of them for the next connection.
+ */
+class TradePublisher
+{
+public:
+    static constexpr size_t kQueueCapacity = 8192;
+    static constexpr size_t kMaxChannels = 32;
+    static constexpr uint32_t kChannelQueueShare = kQueueCapacity / 4;
+    static constexpr size_t kMaxPendingEvents = 16384;
+    static constexpr size_t kTickQueueCapacity = 16384;
+    static constexpr uint32_t kMaxBatchTicks = 1024;
+
+    /** @param server_keys Keys to trust, or nullptr for a plaintext session on a local endpoint. */
+    TradePublisher(pds::network::Endpoint endpoint,
+                   std::unique_ptr<pds::crypto::Keyring<pds::crypto::ServerTrust>> server_keys, uint32_t key_id)
+        : server_keys_{ std::move(server_keys) },
+          queue_{ kQueueCapacity },
+          work_guard_{ boost::asio::make_work_guard(io_context_) },
+          connection_{ io_context_, std::move(endpoint),
+                       server_keys_ ? &server_keys_->get(key_id != 0 && server_keys_->size() > 1 ? key_id : 1)
+                                    : nullptr,
+                       key_id, [this](pds::network::ClientConnection::Outbound &) { on_connected(); }, {},
+                       pds::network::OutboundQueueConfig{ .policies = make_default_overflow_policies(),
+                                                          .priorities = make_default_priorities(),
+                                                          .buffer_pool = std::make_shared<pds::network::BufferPool>(),
+                                                          .fragmentation = make_default_fragmentation() } },
+          channels_{ std::make_unique<Channel[]>(kMaxChannels) },
+          ticks_{ kTickQueueCapacity }
+    {
+        connection_.start();
+        thread_ = std::thread([this]() { io_context_.run(); });
+    }
+    ~TradePublisher()
+    {
+        io_context_.stop();
+        thread_.join();
+    }
+
+    TradePublisher(TradePublisher const &) = delete;
+    TradePublisher &operator=(TradePublisher const &) = delete;
+
+    /**
+     * @brief Counted, as several EAs may publish for the same account; safe from any thread.
+     * False if all kMaxChannels are taken.
+     */
+    bool open_channel(int64_t login)
+    {
+        std::lock_guard lock{ channels_mutex_ };
+        if (Channel *channel = find(login); channel != nullptr)
+        {
+            // Also revives a channel whose close the I/O thread hasn't handled yet.
+            channel->users.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        Channel *channel = find(0);
+        if (channel == nullptr)
+        {
+            return false;
+        }
+        channel->stats.reset();
+        channel->users.store(1, std::memory_order_relaxed);
+        channel->login.store(login, std::memory_order_release);
+        boost::asio::post(io_context_, [this, login]() { send_channel_packet<TradeChannelOpen>(login); });
+        return true;
+    }
+    /**
+     * @brief The last close sends what the channel has pending and then closes it on the
+     * server; safe from any thread. False if the channel wasn't open.
+     */
+    bool close_channel(int64_t login)
+    {
+        std::lock_guard lock{ channels_mutex_ };
+        Channel *channel = find(login);
+        if (channel == nullptr || channel->users.load(std::memory_order_relaxed) == 0)
+        {
+            return false;
+        }
+        if (channel->users.fetch_sub(1, std::memory_order_relaxed) == 1)
+        {
+            boost::asio::post(io_context_, [this, channel]() { release(*channel); });
+        }
+        return true;
+    }
+
+    /**
+     * @brief Safe from any thread; never waits on the network. Sets snapshot.channel from
+     * snapshot.account_login.
+     */
+    PublishResult publish(TradeSnapshot &snapshot)
+    {
+        const size_t index = find_index(snapshot.account_login);
+        if (snapshot.account_login == 0 || index == kMaxChannels ||
+            channels_[index].users.load(std::memory_order_relaxed) == 0)
+        {
+            return PublishResult::ChannelNotOpen;
+        }
+        Channel &channel = channels_[index];
+        snapshot.channel = static_cast<uint8_t>(index);
+        if (channel.queued.fetch_add(1, std::memory_order_relaxed) >= kChannelQueueShare ||
+            !queue_.try_push(snapshot))
+        {
+            channel.queued.fetch_sub(1, std::memory_order_relaxed);
+            count(channel, &ChannelStats::dropped);
+            return PublishResult::QueueFull;
+        }
+        count(channel, &ChannelStats::published);
+        if (!drain_scheduled_.exchange(true, std::memory_order_acq_rel))
+        {
+            boost::asio::post(io_context_, [this]() { drain(); });
+        }
+        return PublishResult::Queued;
+    }
+
+    /**
+     * @brief Id of the symbol for publish_tick; safe from any thread. A symbol keeps the digits
+     * it was first defined with: nullopt if they differ, are invalid, or kMaxSymbols are defined.
+     */
+    std::optional<uint32_t> define_symbol(std::string_view name, int32_t digits)
+    {
+        if (!pds::market::SymbolTable::valid_digits(digits))
+        {
+            return std::nullopt;
+        }
+        std::lock_guard lock{ symbols_mutex_ };
+        const auto symbol = symbols_.intern(name);
+        if (!symbol)
+        {
+            return std::nullopt;
+        }
+        int32_t &defined_digits = symbols_[*symbol].digits;
+        if (defined_digits == pds::market::SymbolTable::kUnknownDigits)
+        {
+            defined_digits = digits;
+            symbol_count_.store(symbols_.size(), std::memory_order_release);
+        }
+        return defined_digits == digits ? symbol : std::nullopt;
+    }
+
+    /** @brief Safe from any thread; never waits on the network. */
+    PublishResult publish_tick(uint32_t symbol, MQL5_Tick const &tick)
+    {
+        if (symbol >= symbol_count_.load(std::memory_order_acquire))
+        {
+            return PublishResult::UnknownSymbol;
+        }
+        if (!ticks_.try_push(QueuedTick{ symbol, tick }))
+        {
+            return PublishResult::QueueFull;
+        }
+        if (!drain_scheduled_.exchange(true, std::memory_order_acq_rel))
+        {
+            boost::asio::post(io_context_, [this]() { drain(); });
+        }
+        return PublishResult::Queued;
+    }
+
+    [[nodiscard]] TradePublisherStats stats() const noexcept { return with_connection(stats_); }
+    /** @brief Counters of the channel since it was opened, nullopt if it isn't open. */
+    [[nodiscard]] std::optional<TradePublisherStats> channel_stats(int64_t login) const noexcept
+    {
+        const size_t index = login == 0 ? kMaxChannels : find_index(login);
+        if (index == kMaxChannels)
+        {
+            return std::nullopt;
+        }
+        return with_connection(channels_[index].stats);
+    }
+
+private:
+    struct ChannelStats
+    {
+        std::atomic<uint64_t> published = 0;
+        std::atomic<uint64_t> dropped = 0;
+        std::atomic<uint64_t> conflated = 0;
+        std::atomic<uint64_t> sent = 0;
+
+        void reset() noexcept
+        {
+            published.store(0, std::memory_order_relaxed);
+            dropped.store(0, std::memory_order_relaxed);
+            conflated.store(0, std::memory_order_relaxed);
+            sent.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    struct Channel
+    {
+        // 0 while the slot is free.
+        std::atomic<int64_t> login = 0;
+        // EAs that opened the channel; changed under channels_mutex_, 0 once closed.
+        std::atomic<uint32_t> users = 0;
+        // Snapshots of the channel in queue_.
+        alignas(64) std::atomic<uint32_t> queued = 0;
+        ChannelStats stats;
+        // Only used on the I/O thread.
+        std::vector<TradeSnapshot> pending;
+        // Position in pending of the conflated snapshots: -1 for the account, else the position ticket.
+        std::unordered_map<int64_t, size_t> latest;
+        size_t pending_events = 0;
+    };
+
+    void count(Channel &channel, std::atomic<uint64_t> ChannelStats::*counter, uint64_t amount = 1) noexcept
+    {
+        (channel.stats.*counter).fetch_add(amount, std::memory_order_relaxed);
+        (stats_.*counter).fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] TradePublisherStats with_connection(ChannelStats const &stats) const noexcept
+    {
+        return TradePublisherStats{ .published = stats.published.load(std::memory_order_relaxed),
+                                    .dropped = stats.dropped.load(std::memory_order_relaxed),
+                                    .conflated = stats.conflated.load(std::memory_order_relaxed),
+                                    .sent = stats.sent.load(std::memory_order_relaxed),
+                                    .reconnects = connection_.reconnects(),
+                                    .connected = connection_.connected() };
+    }
+
+    // Index of the channel of login, kMaxChannels if there is none.
+    [[nodiscard]] size_t find_index(int64_t login) const noexcept
+    {
+        for (size_t i = 0; i < kMaxChannels; ++i)
+        {
+            if (channels_[i].login.load(std::memory_order_acquire) == login)
+            {
+                return i;
+            }
+        }
+        return kMaxChannels;
+    }
+    [[nodiscard]] Channel *find(int64_t login) const noexcept
+    {
+        const size_t index = find_index(login);
+        return index == kMaxChannels ? nullptr : &channels_[index];
+    }
+
+    // Runs on the I/O thread.
+    void on_connected()
+    {
+        for (size_t i = 0; i < kMaxChannels; ++i)
+        {
+            if (const int64_t login = channels_[i].login.load(std::memory_order_acquire); login != 0)
+            {
+                send_channel_packet<TradeChannelOpen>(login);
+            }
+        }
+        // The server knows the symbols of a connection only.
+        defined_symbols_ = 0;
+        drain();
+    }
+
+    // Runs on the I/O thread.
+    void drain()
+    {
+        drain_scheduled_.exchange(false, std::memory_order_acq_rel);
+        TradeSnapshot snapshot;
+        while (queue_.try_pop(snapshot))
+        {
+            Channel &channel = channels_[snapshot.channel];
+            channel.queued.fetch_sub(1, std::memory_order_relaxed);
+            // The slot may have been released and handed to another account meanwhile.
+            if (channel.login.load(std::memory_order_relaxed) != snapshot.account_login)
+            {
+                stats_.dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            add_pending(channel, snapshot);
+        }
+        if (!connection_.connected())
+        {
+            QueuedTick tick;
+            while (ticks_.try_pop(tick))
+            {
+            }
+            return;
+        }
+        for (size_t i = 0; i < kMaxChannels; ++i)
+        {
+            flush(channels_[i]);
+        }
+        send_ticks();
+    }
+
+    // Runs on the I/O thread, once the last EA closed the channel.
+    void release(Channel &channel)
+    {
+        drain();
+        std::lock_guard lock{ channels_mutex_ };
+        if (channel.users.load(std::memory_order_relaxed) != 0)
+        {
+            return;
+        }
+        send_channel_packet<TradeChannelClose>(channel.login.load(std::memory_order_relaxed));
+        channel.pending.clear();
+        channel.latest.clear();
+        channel.pending_events = 0;
+        channel.login.store(0, std::memory_order_release);
+    }
+
+    void flush(Channel &channel)
+    {
+        if (channel.pending.empty())
+        {
+            return;
+        }
+        for (auto const &pending : channel.pending)
+        {
+            send(pending);
+        }
+        count(channel, &ChannelStats::sent, channel.pending.size());
+        channel.pending.clear();
+        channel.latest.clear();
+        channel.pending_events = 0;
+    }
+
+    void add_pending(Channel &channel, TradeSnapshot const &snapshot)
+    {
+        if (snapshot.kind == SnapshotKind::Account || snapshot.kind == SnapshotKind::Position)
+        {
+            const int64_t key = snapshot.kind == SnapshotKind::Account ? -1 : snapshot.position.integer_info.ticket;
+            const auto [it, inserted] = channel.latest.try_emplace(key, channel.pending.size());
+            if (!inserted)
+            {
+                channel.pending[it->second] = snapshot;
+                count(channel, &ChannelStats::conflated);
+                return;
+            }
+        }
+        else if (channel.pending_events++ >= kMaxPendingEvents)
+        {
+            count(channel, &ChannelStats::dropped);
+            return;
+        }
+        channel.pending.emplace_back(snapshot);
+    }
+
+    // Runs on the I/O thread, while connected.
+    void send_ticks()
+    {
+        define_symbols();
+        QueuedTick queued;
+        uint32_t batched = 0;
+        while (ticks_.try_pop(queued))
+        {
+            const int32_t digits = symbol_digits_[queued.symbol];
+            const pds::market::Tick tick{ .symbol = queued.symbol,
+                                          .time_msc = queued.tick.time_msc,
+                                          .bid = pds::market::to_points(queued.tick.bid, digits),
+                                          .ask = pds::market::to_points(queued.tick.ask, digits),
+                                          .last = pds::market::to_points(queued.tick.last, digits),
+                                          .volume = queued.tick.volume,
+                                          .flags = queued.tick.flags };
+            if (batched == 0)
+            {
+                tick_batch_.base_time_msc = tick.time_msc;
+                tick_writer_.begin(tick_batch_.ticks, tick.time_msc);
+            }
+            tick_writer_.add(tick);
+            if (++batched == kMaxBatchTicks)
+            {
+                send_tick_batch();
+                batched = 0;
+            }
+        }
+        if (batched != 0)
+        {
+            send_tick_batch();
+        }
+    }
+
+    void send_tick_batch()
+    {
+        tick_batch_.tick_count = tick_writer_.count();
+        connection_.outbound()->send_packet(tick_batch_);
+    }
+
+    // Sends the definitions of the symbols defined since the last call or the connection. Every
+    // queued tick refers to one of them, as its symbol was counted before it was pushed.
+    void define_symbols()
+    {
+        if (defined_symbols_ == symbol_count_.load(std::memory_order_acquire))
+        {
+            return;
+        }
+        std::lock_guard lock{ symbols_mutex_ };
+        symbol_digits_.resize(symbols_.size());
+        for (; defined_symbols_ < symbols_.size(); ++defined_symbols_)
+        {
+            SymbolDefinition definition;
+            definition.symbol = defined_symbols_;
+            definition.name = symbols_[defined_symbols_].name;
+            definition.digits = symbols_[defined_symbols_].digits;
+            symbol_digits_[defined_symbols_] = definition.digits;
+            connection_.outbound()->send_packet(definition);
+        }
+    }
+
+    // Runs on the I/O thread; while disconnected the next connection reopens the channels anyway.
+    template <typename Packet>
+    void send_channel_packet(int64_t login)
+    {
+        if (auto const &session = connection_.outbound(); session && connection_.connected())
+        {
+            Packet packet;
+            packet.account_login = login;
+            packet.set_owner_login(login);
+            packet.stamp_send_time();
+            session->send_packet(packet);
+        }
+    }
+
+    void send(TradeSnapshot const &snapshot)
+    {
+        switch (snapshot.kind)
+        {
+        case SnapshotKind::Account:
+        {
+            MQL5AccountInfoIntegerResponse integer_packet;
+            mql::from_c(integer_packet, snapshot.account.integer_info);
+            integer_packet.set_owner_login(snapshot.account_login);
+            integer_packet.stamp_send_time();
+            connection_.outbound()->send_packet(integer_packet);
+            MQL5AccountInfoDoubleResponse double_packet;
+            mql::from_c(double_packet, snapshot.account.double_info);
+            double_packet.set_owner_login(snapshot.account_login);
+            double_packet.stamp_send_time();
+            connection_.outbound()->send_packet(double_packet);
+            break;
+        }
+        case SnapshotKind::Position:
+            send_info<MQL5PositionInfoResponse>(snapshot, snapshot.position);
+            break;
+        case SnapshotKind::Order:
+            send_info<MQL5OrderInfoResponse>(snapshot, snapshot.order);
+            break;
+        case SnapshotKind::Deal:
+            send_info<MQL5DealInfoResponse>(snapshot, snapshot.deal);
+            break;
+        }
+    }
+
+    template <typename Packet, typename Info>
+    void send_info(TradeSnapshot const &snapshot, Info const &info)
+    {
+        Packet packet;
+        mql::from_c(packet, info.integer_info);
+        mql::from_c(packet, info.double_info);
+        mql::to_utf8(snapshot.symbol.view(), packet.symbol);
+        mql::to_utf8(snapshot.comment.view(), packet.comment);
+        mql::to_utf8(snapshot.external_id.view(), packet.external_id);
+        packet.set_owner_login(snapshot.account_login);
+        packet.stamp_send_time();
+        connection_.outbound()->send_packet(packet);
+    }
+
+    // The I/O thread's warnings, e.g. those of the session, go through the hot log; declared
+    // first, so it is destroyed after the thread is joined and writes the thread's last records.
+    pds::logging::HotLogBackend hot_log_;
+    const std::unique_ptr<pds::crypto::Keyring<pds::crypto::ServerTrust>> server_keys_;
+
+    pds::ipc::MpscQueue<TradeSnapshot> queue_;
+    alignas(64) std::atomic<bool> drain_scheduled_ = false;
+    // Totals of every channel.
+    alignas(64) ChannelStats stats_;
+
+    boost::asio::io_context io_context_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
+    pds::network::ClientConnection connection_;
+    const std::unique_ptr<Channel[]> channels_;
+    std::mutex channels_mutex_;
+
+    pds::ipc::MpscQueue<QueuedTick> ticks_;
+    // Symbols with their digits; only ever grows.
+    pds::market::SymbolTable symbols_;
+    std::mutex symbols_mutex_;
+    alignas(64) std::atomic<uint32_t> symbol_count_ = 0;
+    // Only used on the I/O thread.
+    uint32_t defined_symbols_ = 0;
+    std::vector<int32_t> symbol_digits_;
+    pds::market::TickWriter tick_writer_;
+    TickBatch tick_batch_;
+    std::thread thread_;
+};
@@ -1,11 +1,57 @@
+#include <chrono>
 #include <iostream>
+#include <string>
+#include <thread>
 
-extern "C" __declspec(dllimport) float ComputeSqrt(float x);
+#include "../server_dll/server-api.h"
 
-int main()
+// Publishes a few snapshots through server_dll the way an EA would and prints the counters.
+// Usage: server_test [endpoint] [server key]
+int main(int argc, char **argv)
 {
-    float x = 2.0f;
-    float y = ComputeSqrt(x);
-    std::cout << y << std::endl;
+    const std::string endpoint = argc > 1 ? argv[1] : "tcp://127.0.0.1:1234";
+    const std::string server_key = argc > 2 ? argv[2] : "public-key.pem";
+    const std::wstring wide_endpoint{ endpoint.begin(), endpoint.end() };
+    const std::wstring wide_server_key{ server_key.begin(), server_key.end() };
+
+    if (const MQL_int status = PdsStart(wide_endpoint.c_str(), wide_server_key.c_str(), 0); status != PDS_OK)
+    {
+        std::cout << "PdsStart failed: " << status << std::endl;
+        return 1;
+    }
+
+    constexpr MQL_long kLogin = 1000;
+    if (const MQL_int status = PdsOpenChannel(kLogin); status != PDS_OK)
+    {
+        std::cout << "PdsOpenChannel failed: " << status << std::endl;
+        return 1;
+    }
+
+    MQL5_AccountInfoInteger account_integer{};
+    MQL5_AccountInfoDouble account_double{};
+    account_integer.base_info.account_login = kLogin;
+    account_double.base_info.balance = 10000.0;
+    PdsPublishAccount(&account_integer, &account_double);
+
+    MQL5_PositionInfoInteger position_integer{};
+    MQL5_PositionInfoDouble position_double{};
+    const auto start = std::chrono::steady_clock::now();
+    constexpr int kUpdates = 1000;
+    for (int i = 0; i < kUpdates; ++i)
+    {
+        position_integer.ticket = 1 + i % 10;
+        position_double.profit = i;
+        PdsPublishPosition(kLogin, &position_integer, &position_double, L"EURUSD", L"server_test", nullptr);
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    PdsPublisherStats stats{};
+    PdsGetStats(&stats);
+    std::cout << elapsed.count() / kUpdates << " ns per publish; published " << stats.published << ", sent "
+              << stats.sent << ", conflated " << stats.conflated << ", dropped " << stats.dropped
+              << ", connected " << stats.connected << std::endl;
+    PdsCloseChannel(kLogin);
+    PdsStop();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include "market/bars.hpp"
+
+namespace
+{
+    using pds::market::Bar;
+    using pds::market::BarSeries;
+
+    constexpr int64_t kMinute = 60'000;
+
+    // One tick per minute, at its start, with the minute's number as price.
+    void add_minutes(BarSeries &series, int64_t first, int64_t count)
+    {
+        for (int64_t minute = first; minute < first + count; minute++)
+        {
+            series.add(minute * kMinute, minute, 1);
+        }
+    }
+}  // namespace
+
+TEST(BarSeries, ClosesBarsOnPeriodBoundaries)
+{
+    BarSeries series{ pds::market::Timeframe::M1 };
+    EXPECT_FALSE(series.add(0, 10, 1));
+    EXPECT_FALSE(series.add(kMinute - 1, 12, 2));
+    EXPECT_FALSE(series.add(kMinute / 2, 8, 0));
+    EXPECT_EQ(series.closed_count(), 0u);
+
+    // The first millisecond of the next minute closes the bar.
+    EXPECT_TRUE(series.add(kMinute, 11, 1));
+    ASSERT_EQ(series.closed_count(), 1u);
+    EXPECT_EQ(series.last_closed(), (Bar{ .time_msc = 0, .open = 10, .high = 12, .low = 8, .close = 8,
+                                          .tick_volume = 3, .volume = 3 }));
+    EXPECT_EQ(series.forming(), (Bar{ .time_msc = kMinute, .open = 11, .high = 11, .low = 11, .close = 11,
+                                      .tick_volume = 1, .volume = 1 }));
+
+    // Late ticks are counted in the forming bar; minutes without ticks have no bar.
+    EXPECT_FALSE(series.add(kMinute - 1, 9, 1));
+    EXPECT_TRUE(series.add(5 * kMinute + 30'000, 13, 1));
+    EXPECT_EQ(series.closed_count(), 2u);
+    EXPECT_EQ(series.last_closed().low, 9);
+    EXPECT_EQ(series.forming().time_msc, 5 * kMinute);
+}
+
+TEST(BarSeries, StartsBarsAtThePeriodOfTheirTimeframe)
+{
+    BarSeries series{ pds::market::Timeframe::H1 };
+    series.add(3 * 3'600'000 + 59 * kMinute, 1, 0);
+    EXPECT_EQ(series.forming().time_msc, 3 * 3'600'000);
+    EXPECT_FALSE(series.add(4 * 3'600'000 - 1, 2, 0));
+    EXPECT_TRUE(series.add(4 * 3'600'000, 3, 0));
+}
+
+TEST(BarSeries, CopiesClosedBarsAcrossTheRingWrap)
+{
+    BarSeries series;
+    // Closes kMaxBars + 10 bars, so the ring wrapped and the oldest 10 are gone.
+    const auto closed = static_cast<int64_t>(BarSeries::kMaxBars) + 10;
+    add_minutes(series, 0, closed + 1);
+    ASSERT_EQ(series.closed_count(), BarSeries::kMaxBars);
+    EXPECT_EQ(series.last_closed().time_msc, (closed - 1) * kMinute);
+
+    // The last 15 lie on both sides of the wrap.
+    std::vector<Bar> bars;
+    series.copy_closed(15, bars);
+    ASSERT_EQ(bars.size(), 15u);
+    for (size_t i = 0; i < bars.size(); i++)
+    {
+        EXPECT_EQ(bars[i].open, closed - 15 + static_cast<int64_t>(i));
+    }
+
+    // More than kept is all of them, oldest first, appended to what out held.
+    bars.assign(1, Bar{});
+    series.copy_closed(BarSeries::kMaxBars * 2, bars);
+    ASSERT_EQ(bars.size(), BarSeries::kMaxBars + 1);
+    EXPECT_EQ(bars[1].open, 10);
+    EXPECT_EQ(bars.back().open, closed - 1);
+}
+
+TEST(BarSeries, CopiesNothingBeforeABarClosed)
+{
+    BarSeries series;
+    std::vector<Bar> bars;
+    series.copy_closed(10, bars);
+    EXPECT_TRUE(bars.empty());
+
+    series.add(0, 1, 1);
+    series.copy_closed(10, bars);
+    EXPECT_TRUE(bars.empty());
+    EXPECT_TRUE(series.has_forming());
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "ipc/left-right.hpp"
+
+namespace
+{
+    // Written as a whole by every change, so a reader seeing a mix of two changes sees the halves differ.
+    struct Pair
+    {
+        uint64_t first = 0;
+        uint64_t second = 0;
+    };
+}  // namespace
+
+TEST(LeftRight, ReadsTheLatestChange)
+{
+    pds::ipc::LeftRight<std::vector<int>> value;
+    EXPECT_TRUE(value.read([](std::vector<int> const &v) { return v.empty(); }));
+
+    int applied = 0;
+    std::vector<int> expected;
+    for (int i = 1; i <= 3; i++)
+    {
+        value.modify(
+            [i, &applied](std::vector<int> &v)
+            {
+                v.push_back(i);
+                applied++;
+            });
+        expected.push_back(i);
+        EXPECT_EQ(value.read([](std::vector<int> const &v) { return v; }), expected);
+    }
+    // Once on either copy.
+    EXPECT_EQ(applied, 6);
+}
+
+TEST(LeftRight, ReadersNeverSeeAHalfDoneChange)
+{
+    constexpr uint64_t kChanges = 20'000;
+    pds::ipc::LeftRight<Pair> value;
+    std::atomic<bool> done = false;
+    std::atomic<int> started = 0;
+    std::atomic<uint64_t> torn_reads = 0;
+    std::atomic<uint64_t> backward_reads = 0;
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++)
+    {
+        readers.emplace_back(
+            [&]()
+            {
+                uint64_t last = 0;
+                started++;
+                while (!done.load(std::memory_order_relaxed))
+                {
+                    const Pair pair = value.read([](Pair const &p) { return p; });
+                    torn_reads += pair.first != pair.second;
+                    backward_reads += pair.first < last;
+                    last = pair.first;
+                }
+            });
+    }
+    // So that the changes overlap the reads.
+    while (started.load() != static_cast<int>(readers.size()))
+    {
+        std::this_thread::yield();
+    }
+    for (uint64_t i = 1; i <= kChanges; i++)
+    {
+        value.modify(
+            [i](Pair &p)
+            {
+                p.first = i;
+                p.second = i;
+            });
+    }
+    done = true;
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+
+    EXPECT_EQ(torn_reads.load(), 0u);
+    EXPECT_EQ(backward_reads.load(), 0u);
+    EXPECT_EQ(value.read([](Pair const &p) { return p.first; }), kChanges);
+}
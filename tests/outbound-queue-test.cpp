@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "network/outbound-queue.hpp"
+
+namespace
+{
+    using pds::network::OutboundFrame;
+    using pds::network::OverflowPolicy;
+
+    constexpr mal_packet_weaver::UniquePacketID kDisconnecting = 1;
+    constexpr mal_packet_weaver::UniquePacketID kDroppable = 2;
+    constexpr mal_packet_weaver::UniquePacketID kConflated = 3;
+
+    // Takes the first batch, then none until it is released, so the frames after it pile up in the queue.
+    class StalledSink
+    {
+    public:
+        explicit StalledSink(boost::asio::io_context &io_context) : io_context_{ io_context } {}
+
+        [[nodiscard]] boost::asio::io_context::executor_type get_executor() const noexcept
+        {
+            return io_context_.get_executor();
+        }
+        [[nodiscard]] bool writable() const noexcept { return writable_; }
+        void async_wait(std::function<void()> handler) { waiting_ = std::move(handler); }
+        void deliver(std::span<OutboundFrame const *const> frames)
+        {
+            for (OutboundFrame const *frame : frames)
+            {
+                delivered_.emplace_back(frame->type, std::to_integer<int>(frame->bytes.front()));
+            }
+        }
+
+        void release()
+        {
+            writable_ = true;
+            if (waiting_)
+            {
+                std::exchange(waiting_, nullptr)();
+            }
+        }
+
+        /** @brief (type, tag) of every delivered frame, in order. */
+        [[nodiscard]] std::vector<std::pair<mal_packet_weaver::UniquePacketID, int>> const &delivered() const
+        {
+            return delivered_;
+        }
+
+    private:
+        boost::asio::io_context &io_context_;
+        bool writable_ = false;
+        std::function<void()> waiting_;
+        std::vector<std::pair<mal_packet_weaver::UniquePacketID, int>> delivered_;
+    };
+
+    // A frame of 16 bytes whose first one tells it from the others of its type.
+    OutboundFrame make_frame(mal_packet_weaver::UniquePacketID type, int tag, uint64_t conflation_key = 0)
+    {
+        OutboundFrame frame;
+        frame.type = type;
+        frame.conflation_key = conflation_key;
+        frame.bytes.resize(16);
+        frame.bytes.front() = static_cast<std::byte>(tag);
+        return frame;
+    }
+
+    pds::network::OutboundQueueConfig make_config(size_t max_packets)
+    {
+        auto policies = std::make_shared<pds::network::OverflowPolicies>();
+        policies->set(kDroppable, OverflowPolicy::DropOldest).set(kConflated, OverflowPolicy::Conflate);
+        return pds::network::OutboundQueueConfig{ .limits = { .max_bytes = 1024 * 1024, .max_packets = max_packets },
+                                                  .policies = std::move(policies) };
+    }
+
+    class OutboundQueueTest : public ::testing::Test
+    {
+    protected:
+        // Lets the queue deliver its first frame to the sink, which then stalls.
+        void stall(pds::network::OutboundQueue<StalledSink> &queue)
+        {
+            ASSERT_TRUE(queue.enqueue(make_frame(kDroppable, 0)));
+            poll();
+            ASSERT_EQ(sink_.delivered().size(), 1u);
+        }
+
+        void release()
+        {
+            poll();
+            sink_.release();
+            poll();
+        }
+
+        // Runs what the queue posted; the io_context stops whenever it runs out of handlers.
+        void poll()
+        {
+            io_context_.restart();
+            io_context_.poll();
+        }
+
+        boost::asio::io_context io_context_;
+        StalledSink sink_{ io_context_ };
+    };
+}  // namespace
+
+TEST_F(OutboundQueueTest, DisconnectsWhenADisconnectingTypeOverflows)
+{
+    pds::network::OutboundQueue<StalledSink> queue{ sink_, make_config(4) };
+    boost::system::error_code error;
+    queue.set_error_handler([&error](boost::system::error_code ec) { error = ec; });
+    stall(queue);
+
+    for (int i = 1; i <= 4; i++)
+    {
+        EXPECT_TRUE(queue.enqueue(make_frame(kDisconnecting, i)));
+    }
+    EXPECT_FALSE(queue.enqueue(make_frame(kDisconnecting, 5)));
+    poll();
+    EXPECT_TRUE(queue.failed());
+    EXPECT_EQ(error, boost::asio::error::no_buffer_space);
+    EXPECT_FALSE(queue.enqueue(make_frame(kDroppable, 6)));
+}
+
+TEST_F(OutboundQueueTest, DropsTheOldestFramesOfDroppableTypes)
+{
+    pds::network::OutboundQueue<StalledSink> queue{ sink_, make_config(4) };
+    stall(queue);
+
+    for (int i = 1; i <= 6; i++)
+    {
+        EXPECT_TRUE(queue.enqueue(make_frame(kDroppable, i)));
+    }
+    release();
+
+    EXPECT_FALSE(queue.failed());
+    EXPECT_EQ(queue.stats().frames_dropped.load(), 2u);
+    const std::vector<std::pair<mal_packet_weaver::UniquePacketID, int>> expected{
+        { kDroppable, 0 }, { kDroppable, 3 }, { kDroppable, 4 }, { kDroppable, 5 }, { kDroppable, 6 }
+    };
+    EXPECT_EQ(sink_.delivered(), expected);
+    EXPECT_EQ(queue.pending_frames(), 0u);
+}
+
+TEST_F(OutboundQueueTest, FailsWhenDroppingCantMakeRoom)
+{
+    pds::network::OutboundQueue<StalledSink> queue{ sink_, make_config(2) };
+    stall(queue);
+
+    // Only the one droppable frame may go, which leaves the queue over its limit.
+    EXPECT_TRUE(queue.enqueue(make_frame(kConflated, 1, 1)));
+    EXPECT_TRUE(queue.enqueue(make_frame(kConflated, 2, 2)));
+    EXPECT_TRUE(queue.enqueue(make_frame(kDroppable, 3)));
+    EXPECT_TRUE(queue.enqueue(make_frame(kConflated, 4, 3)));
+    poll();
+    EXPECT_TRUE(queue.failed());
+}
+
+TEST_F(OutboundQueueTest, ConflatesFramesOfEqualKeysInPlace)
+{
+    pds::network::OutboundQueue<StalledSink> queue{ sink_, make_config(16) };
+    stall(queue);
+
+    EXPECT_TRUE(queue.enqueue(make_frame(kConflated, 1, 100)));
+    EXPECT_TRUE(queue.enqueue(make_frame(kConflated, 2, 200)));
+    EXPECT_TRUE(queue.enqueue(make_frame(kConflated, 3, 100)));
+    EXPECT_TRUE(queue.enqueue(make_frame(kDroppable, 4, 100)));
+    EXPECT_TRUE(queue.enqueue(make_frame(kDroppable, 5, 100)));
+    release();
+
+    EXPECT_EQ(queue.stats().frames_conflated.load(), 1u);
+    // The latest frame of key 100 takes the place of the first; other types are never conflated.
+    const std::vector<std::pair<mal_packet_weaver::UniquePacketID, int>> expected{
+        { kDroppable, 0 }, { kConflated, 3 }, { kConflated, 2 }, { kDroppable, 4 }, { kDroppable, 5 }
+    };
+    EXPECT_EQ(sink_.delivered(), expected);
+}
+
+TEST_F(OutboundQueueTest, DropsAndCountsExpiredFrames)
+{
+    pds::network::OutboundQueue<StalledSink> queue{ sink_, make_config(16) };
+    stall(queue);
+
+    OutboundFrame expired = make_frame(kDisconnecting, 1);
+    expired.deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds{ 1 };
+    EXPECT_TRUE(queue.enqueue(std::move(expired)));
+    OutboundFrame current = make_frame(kDisconnecting, 2);
+    current.deadline = std::chrono::steady_clock::now() + std::chrono::hours{ 1 };
+    EXPECT_TRUE(queue.enqueue(std::move(current)));
+    release();
+
+    const std::vector<std::pair<mal_packet_weaver::UniquePacketID, int>> expected{ { kDroppable, 0 },
+                                                                                   { kDisconnecting, 2 } };
+    EXPECT_EQ(sink_.delivered(), expected);
+    EXPECT_EQ(queue.stats().frames_expired.load(), 1u);
+    EXPECT_EQ(queue.expired_by_type().get(kDisconnecting), 1u);
+    EXPECT_EQ(queue.expired_by_type().get(kDroppable), 0u);
+    EXPECT_FALSE(queue.failed());
+}
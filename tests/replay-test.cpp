@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <random>
+#include <thread>
+
+#include "replayer.hpp"
+
+namespace
+{
+    using boost::asio::ip::tcp;
+
+    constexpr int64_t kAccount = 1234;
+    // Much longer ago than any packet's lifetime.
+    constexpr int64_t kCaptureAgeMs = 24 * 60 * 60 * 1000;
+
+    // One session that sent a TradeSubscribeRequest, captured a day ago.
+    std::filesystem::path write_old_capture(int64_t sent_at_ms)
+    {
+        std::random_device random;
+        const auto path =
+            std::filesystem::temp_directory_path() /
+            std::format("replay-test-{:016x}.capture", std::uniform_int_distribution<uint64_t>{}(random));
+        TradeSubscribeRequest request;
+        request.account_login = kAccount;
+        request.stamp_send_time(sent_at_ms);
+        std::vector<std::byte> payload;
+        pds::capture::encode_packet(request, payload);
+
+        pds::capture::CaptureWriter writer{ path };
+        writer.session_opened(1);
+        writer.packet(1, TradeSubscribeRequest::static_unique_id, payload);
+        writer.session_closed(1);
+        return path;
+    }
+}  // namespace
+
+TEST(Replay, RestampsPacketsOfAnOldCapture)
+{
+    const int64_t captured_at_ms = pds::network::wall_clock_ms() - kCaptureAgeMs;
+    const auto path = write_old_capture(captured_at_ms);
+    const ReplayCapture capture = load_capture(path);
+    std::filesystem::remove(path);
+    ASSERT_EQ(capture.sessions.size(), 1u);
+    ASSERT_EQ(capture.sessions.front().packets.size(), 1u);
+
+    pds::network::LateArrivalFilter late_arrivals;
+    // What the server would have done with the packet as it was captured.
+    ASSERT_FALSE(late_arrivals.accept(TradeSubscribeRequest::static_unique_id, TradeSubscribeRequest::time_to_live,
+                                      captured_at_ms));
+
+    boost::asio::io_context io_context;
+    auto work = boost::asio::make_work_guard(io_context);
+    tcp::acceptor acceptor{ io_context, tcp::endpoint{ boost::asio::ip::make_address("127.0.0.1"), 0 } };
+    tcp::socket client_socket{ io_context };
+    client_socket.connect(acceptor.local_endpoint());
+    tcp::socket server_socket = acceptor.accept();
+    auto replaying = std::make_shared<mal_packet_weaver::DispatcherSession>(io_context, std::move(client_socket));
+    auto server = std::make_shared<mal_packet_weaver::DispatcherSession>(io_context, std::move(server_socket));
+    std::thread thread{ [&io_context]() { io_context.run(); } };
+
+    const int64_t replayed_at_ms = pds::network::wall_clock_ms();
+    capture.sessions.front().packets.front().send(*replaying);
+    auto received = co_spawn(io_context, server->await_packet<TradeSubscribeRequest>(5.0f), boost::asio::use_future);
+    const std::unique_ptr<TradeSubscribeRequest> request = received.get();
+
+    replaying->Destroy();
+    server->Destroy();
+    work.reset();
+    io_context.stop();
+    thread.join();
+
+    ASSERT_NE(request, nullptr);
+    EXPECT_EQ(request->account_login, kAccount);
+    EXPECT_GE(request->sent_at_ms(), replayed_at_ms);
+    EXPECT_TRUE(late_arrivals.accept(*request));
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "ipc/spsc-ring.hpp"
+
+namespace
+{
+    using pds::ipc::SpscRing;
+
+    constexpr size_t kCapacity = 256;
+
+    struct alignas(64) RingMemory
+    {
+        std::array<std::byte, SpscRing::required_size(kCapacity)> bytes{};
+
+        // Where the record at offset of the ring's data begins.
+        [[nodiscard]] std::byte *data(size_t offset) { return bytes.data() + sizeof(pds::ipc::RingHeader) + offset; }
+    };
+
+    std::vector<std::byte> make_frame(size_t size, uint8_t seed)
+    {
+        std::vector<std::byte> frame(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            frame[i] = static_cast<std::byte>(seed + i);
+        }
+        return frame;
+    }
+
+    // Reads one frame, empty if there was none.
+    std::vector<std::byte> read(SpscRing &ring)
+    {
+        std::vector<std::byte> frame;
+        ring.try_read([&frame](std::span<const std::byte> bytes) { frame.assign(bytes.begin(), bytes.end()); });
+        return frame;
+    }
+
+    // A ring that had one 8-byte frame written, whose positions and records the test then corrupts.
+    SpscRing make_written_ring(RingMemory &memory)
+    {
+        SpscRing ring = SpscRing::create(memory.bytes.data(), kCapacity);
+        EXPECT_TRUE(ring.try_write(make_frame(8, 1)));
+        return ring;
+    }
+}  // namespace
+
+TEST(SpscRing, RoundTripsFramesAcrossTheWrap)
+{
+    RingMemory memory;
+    SpscRing producer = SpscRing::create(memory.bytes.data(), kCapacity);
+    SpscRing consumer = SpscRing::attach(memory.bytes.data(), kCapacity);
+
+    // 44 bytes take a 48-byte record, which doesn't divide the capacity, so records wrap at different offsets.
+    for (uint8_t i = 0; i < 40; i++)
+    {
+        const auto frame = make_frame(44, i);
+        ASSERT_TRUE(producer.try_write(frame));
+        ASSERT_EQ(read(consumer), frame) << "frame " << int{ i };
+    }
+    EXPECT_TRUE(consumer.empty());
+}
+
+TEST(SpscRing, RefusesFramesThatDontFit)
+{
+    RingMemory memory;
+    SpscRing ring = SpscRing::create(memory.bytes.data(), kCapacity);
+    EXPECT_FALSE(ring.try_write(make_frame(ring.max_frame_size() + 1, 0)));
+
+    // Two of the largest frames fill the ring.
+    ASSERT_TRUE(ring.try_write(make_frame(ring.max_frame_size(), 0)));
+    ASSERT_TRUE(ring.try_write(make_frame(ring.max_frame_size(), 1)));
+    EXPECT_FALSE(ring.try_write(make_frame(1, 2)));
+    EXPECT_EQ(read(ring), make_frame(ring.max_frame_size(), 0));
+    EXPECT_TRUE(ring.try_write(make_frame(ring.max_frame_size(), 2)));
+}
+
+TEST(SpscRing, AttachRejectsAnotherCapacity)
+{
+    RingMemory memory;
+    SpscRing::create(memory.bytes.data(), kCapacity);
+    EXPECT_THROW(SpscRing::attach(memory.bytes.data(), kCapacity * 2), std::runtime_error);
+}
+
+TEST(SpscRing, RejectsCorruptedPositions)
+{
+    RingMemory memory;
+    SpscRing ring = make_written_ring(memory);
+    ring.header().tail.store(kCapacity + 8);
+    SpscRing consumer = SpscRing::attach(memory.bytes.data(), kCapacity);
+    EXPECT_THROW(read(consumer), std::runtime_error);
+
+    // A head the consumer couldn't have left.
+    SpscRing unaligned = make_written_ring(memory);
+    unaligned.header().head.store(3);
+    EXPECT_THROW(read(unaligned), std::runtime_error);
+}
+
+TEST(SpscRing, RejectsRecordsPastTheWrittenBytes)
+{
+    RingMemory memory;
+    SpscRing ring = make_written_ring(memory);
+    const uint32_t length = 100;
+    std::memcpy(memory.data(0), &length, sizeof(length));
+    EXPECT_THROW(read(ring), std::runtime_error);
+
+    // A wrap marker, which is only written in front of a record, in front of nothing.
+    SpscRing marked = make_written_ring(memory);
+    std::memcpy(memory.data(0), &SpscRing::kWrapMarker, sizeof(SpscRing::kWrapMarker));
+    EXPECT_THROW(read(marked), std::runtime_error);
+
+    // A length past the largest frame.
+    SpscRing oversized = make_written_ring(memory);
+    const uint32_t huge = static_cast<uint32_t>(kCapacity);
+    std::memcpy(memory.data(0), &huge, sizeof(huge));
+    EXPECT_THROW(read(oversized), std::runtime_error);
+}
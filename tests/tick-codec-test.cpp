@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include "market/tick-codec.hpp"
+
+namespace
+{
+    using pds::market::Tick;
+
+    constexpr int64_t kBaseTimeMsc = 1'700'000'000'000;
+
+    // Two symbols interleaved, with prices moving both ways, a repeated price and changing flags.
+    std::vector<Tick> make_ticks()
+    {
+        return {
+            Tick{ .symbol = 0, .time_msc = kBaseTimeMsc, .bid = 108'512, .ask = 108'520, .last = 0, .volume = 0,
+                  .flags = 6 },
+            Tick{ .symbol = 7, .time_msc = kBaseTimeMsc + 3, .bid = 234'567, .ask = 234'601, .last = 234'590,
+                  .volume = 12, .flags = 30 },
+            Tick{ .symbol = 0, .time_msc = kBaseTimeMsc + 3, .bid = 108'509, .ask = 108'520, .last = 0, .volume = 0,
+                  .flags = 2 },
+            Tick{ .symbol = 7, .time_msc = kBaseTimeMsc + 250, .bid = 234'567, .ask = 234'599, .last = 234'620,
+                  .volume = 1, .flags = 30 },
+            // Out of order, as ticks of different symbols may be.
+            Tick{ .symbol = 0, .time_msc = kBaseTimeMsc + 100, .bid = 108'515, .ask = 108'523, .last = 0,
+                  .volume = 0, .flags = 6 },
+        };
+    }
+
+    std::vector<uint8_t> encode(std::vector<Tick> const &ticks)
+    {
+        std::vector<uint8_t> out;
+        pds::market::TickWriter writer;
+        writer.begin(out, kBaseTimeMsc);
+        for (Tick const &tick : ticks)
+        {
+            writer.add(tick);
+        }
+        return out;
+    }
+
+    std::vector<Tick> decode(std::vector<uint8_t> const &in, pds::market::TickReader &reader)
+    {
+        std::vector<Tick> ticks;
+        reader.begin(in, kBaseTimeMsc);
+        for (Tick tick; reader.next(tick);)
+        {
+            ticks.emplace_back(tick);
+        }
+        return ticks;
+    }
+}  // namespace
+
+TEST(TickCodec, RoundTrips)
+{
+    const std::vector<Tick> ticks = make_ticks();
+    pds::market::TickReader reader;
+    EXPECT_EQ(decode(encode(ticks), reader), ticks);
+    EXPECT_FALSE(reader.malformed());
+}
+
+TEST(TickCodec, BatchesDontDependOnEachOther)
+{
+    const std::vector<Tick> ticks = make_ticks();
+    pds::market::TickWriter writer;
+    std::vector<uint8_t> first;
+    writer.begin(first, kBaseTimeMsc);
+    writer.add(ticks[0]);
+    std::vector<uint8_t> second;
+    writer.begin(second, kBaseTimeMsc);
+    writer.add(ticks[2]);
+    EXPECT_EQ(writer.count(), 1u);
+
+    // Read without the first batch, as if it had been dropped on the way.
+    pds::market::TickReader reader;
+    EXPECT_EQ(decode(second, reader), std::vector<Tick>{ ticks[2] });
+}
+
+TEST(TickCodec, StopsAtATruncatedTick)
+{
+    const std::vector<Tick> ticks = make_ticks();
+    const std::vector<uint8_t> whole = encode(ticks);
+    const std::vector<uint8_t> first_tick = encode({ ticks[0] });
+
+    // Every cut inside the second tick leaves only the first one readable.
+    for (size_t size = first_tick.size() + 1; size < encode({ ticks[0], ticks[1] }).size(); size++)
+    {
+        pds::market::TickReader reader;
+        const std::vector<uint8_t> truncated{ whole.begin(), whole.begin() + static_cast<ptrdiff_t>(size) };
+        EXPECT_EQ(decode(truncated, reader), std::vector<Tick>{ ticks[0] }) << "cut after " << size << " bytes";
+        EXPECT_TRUE(reader.malformed());
+    }
+}
+
+TEST(TickCodec, RejectsMalformedTicks)
+{
+    pds::market::TickReader reader;
+
+    // A symbol id past kMaxSymbols.
+    std::vector<uint8_t> symbol_too_large{ 0 };
+    pds::market::detail::put_varint(symbol_too_large, pds::market::kMaxSymbols);
+    pds::market::detail::put_varint(symbol_too_large, 0);
+    EXPECT_TRUE(decode(symbol_too_large, reader).empty());
+    EXPECT_TRUE(reader.malformed());
+
+    // A varint longer than 64 bits.
+    const std::vector<uint8_t> endless_varint(12, 0xFF);
+    EXPECT_TRUE(decode(endless_varint, reader).empty());
+    EXPECT_TRUE(reader.malformed());
+
+    // A batch that begins fine is readable again after a malformed one.
+    EXPECT_EQ(decode(encode(make_ticks()), reader), make_ticks());
+    EXPECT_FALSE(reader.malformed());
+}
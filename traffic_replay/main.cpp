@@ -0,0 +1,103 @@
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <thread>
+
+#include "crypto/keyring.hpp"
+#include "replayer.hpp"
+
+int main(int argc, char **argv)
+{
+    namespace po = boost::program_options;
+
+    std::string capture_path;
+    std::string endpoint_uri = "tcp://127.0.0.1:1234";
+    std::string server_key_path = "public-key.pem";
+    uint32_t key_id = 0;
+    std::string key_fingerprint;
+    uint32_t threads = 1;
+    uint32_t drain_timeout_ms = 5000;
+    ReplayConfig config;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "print usage message")
+        ("capture", po::value<std::string>(&capture_path), "Capture file written by central_server --capture")
+        ("endpoint", po::value<std::string>(&endpoint_uri), "Server endpoint, tcp://host:port or unix:///path")
+        ("server-key", po::value<std::string>(&server_key_path), "Trusted server public key(s), one PEM or keygen's merged file")
+        ("key-id", po::value<uint32_t>(&key_id), "1-based tenant key in the server keyring; 0 for the server's default")
+        ("key-fingerprint", po::value<std::string>(&key_fingerprint), "Tenant key by the fingerprint central_server logs for it; overrides --key-id")
+        ("plaintext", "Skip the encryption handshake; only allowed on unix:// endpoints")
+        ("speed", po::value<double>(&config.speed), "1 keeps the captured timing, 2 replays twice as fast, 0 as fast as possible (default: 1)")
+        ("drain-timeout-ms", po::value<uint32_t>(&drain_timeout_ms), "Time a session waits for echo replies after its last packet (default: 5000)")
+        ("threads", po::value<uint32_t>(&threads), "io_context threads (default: 1)")
+    ;
+    po::variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    notify(vm);
+    if (vm.contains("help") || capture_path.empty())
+    {
+        std::cout << desc << "\n";
+        return vm.contains("help") ? 0 : 1;
+    }
+    const pds::network::Endpoint endpoint = pds::network::parse_endpoint(endpoint_uri);
+    const bool plaintext = vm.contains("plaintext");
+    if (plaintext && !endpoint.is_local())
+    {
+        spdlog::error("--plaintext is only allowed on local endpoints.");
+        return 1;
+    }
+    if (config.speed < 0)
+    {
+        spdlog::error("--speed can't be negative.");
+        return 1;
+    }
+    config.drain_timeout = std::chrono::milliseconds(drain_timeout_ms);
+    threads = std::max(threads, 1u);
+
+    ReplayCapture capture;
+    try
+    {
+        capture = load_capture(capture_path);
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::error("Couldn't read {}: {}", capture_path, e.what());
+        return 1;
+    }
+    spdlog::info("Loaded {} sessions with {} packets from {}", capture.sessions.size(), capture.packets, capture_path);
+
+    spdlog::set_level(spdlog::level::warn);
+    boost::asio::io_context io_context;
+
+    std::unique_ptr<pds::crypto::Keyring<pds::crypto::ServerTrust>> server_keys;
+    pds::crypto::ServerTrust const *trust = nullptr;
+    if (!plaintext)
+    {
+        server_keys = std::make_unique<pds::crypto::Keyring<pds::crypto::ServerTrust>>(server_key_path);
+        if (!key_fingerprint.empty())
+        {
+            const auto found = server_keys->find_by_fingerprint(key_fingerprint);
+            if (!found)
+            {
+                spdlog::error("No key in {} has the fingerprint {}.", server_key_path, key_fingerprint);
+                return 1;
+            }
+            key_id = *found;
+        }
+        trust = &server_keys->get(key_id != 0 && server_keys->size() > 1 ? key_id : 1);
+    }
+
+    Replayer replayer{ io_context, config, endpoint, trust, key_id, std::move(capture) };
+    replayer.start();
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < threads; ++i)
+    {
+        workers.emplace_back([&io_context]() { io_context.run(); });
+    }
+    io_context.run();
+    for (auto &thread : workers)
+    {
+        thread.join();
+    }
+    return 0;
+}
@@ -0,0 +1,359 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mal-packet-weaver/dispatcher-session.hpp"
+#include "capture/capture-file.hpp"
+#include "capture/captured-packets.hpp"
+#include "crypto/session-encryption.hpp"
+#include "metrics/latency-histogram.hpp"
+#include "network/heartbeat.hpp"
+#include "network/packet-batch.hpp"
+#include "network/transport.hpp"
+
+using PacketSender = std::function<void(mal_packet_weaver::DispatcherSession &)>;
+
+struct ReplayPacket
+{
+    // Since the start of the capture.
+    std::chrono::nanoseconds time;
+    mal_packet_weaver::UniquePacketID type;
+    PacketSender send;
+    // Reply central_server gives to a numeric echo, empty for everything else.
+    std::string echo_reply;
+};
+
+struct ReplaySession
+{
+    std::chrono::nanoseconds opened{};
+    std::optional<std::chrono::nanoseconds> closed;
+    std::vector<ReplayPacket> packets;
+};
+
+struct ReplayCapture
+{
+    std::vector<ReplaySession> sessions;
+    std::unordered_map<mal_packet_weaver::UniquePacketID, std::string_view> packet_names;
+    uint64_t packets = 0;
+    uint64_t skipped = 0;
+};
+
+/**
+ * @brief Reads a capture and decodes every packet up front, so that replaying only sends.
+ *
+ * @details Times are shifted so the first record is at zero. Packets of types this build
+ * doesn't know are skipped and counted. Packets with a send time are stamped again as they are
+ * replayed, as the server would drop them as late with the one they were captured with.
+ */
+inline ReplayCapture load_capture(std::filesystem::path const &path)
+{
+    using Decoder = PacketSender (*)(std::span<const std::byte>);
+    std::unordered_map<mal_packet_weaver::UniquePacketID, Decoder> decoders;
+    ReplayCapture capture;
+    pds::capture::for_each_captured_packet(
+        [&]<typename Packet>(std::string_view name)
+        {
+            capture.packet_names.emplace(Packet::static_unique_id, name);
+            decoders.emplace(Packet::static_unique_id,
+                             [](std::span<const std::byte> payload) -> PacketSender
+                             {
+                                 std::shared_ptr<const Packet> packet = pds::capture::decode_packet<Packet>(payload);
+                                 return [packet](mal_packet_weaver::DispatcherSession &session)
+                                 {
+                                     if constexpr (requires(Packet &stamped) { stamped.stamp_send_time(); })
+                                     {
+                                         Packet stamped{ *packet };
+                                         stamped.stamp_send_time();
+                                         session.send_packet(stamped);
+                                     }
+                                     else
+                                     {
+                                         session.send_packet(*packet);
+                                     }
+                                 };
+                             });
+        });
+
+    pds::capture::CaptureReader reader{ path };
+    std::map<pds::capture::SessionId, ReplaySession> sessions;
+    std::optional<std::chrono::nanoseconds> origin;
+    while (const auto record = reader.next())
+    {
+        origin = origin.value_or(record->time);
+        const auto time = record->time - *origin;
+        auto [it, inserted] = sessions.try_emplace(record->session);
+        ReplaySession &session = it->second;
+        if (inserted)
+        {
+            session.opened = time;
+        }
+        if (record->kind == pds::capture::RecordKind::SessionClosed)
+        {
+            session.closed = time;
+            continue;
+        }
+        if (record->kind != pds::capture::RecordKind::Packet)
+        {
+            continue;
+        }
+        const auto decoder = decoders.find(record->packet_type);
+        if (decoder == decoders.end())
+        {
+            capture.skipped++;
+            continue;
+        }
+        ReplayPacket packet{ time, record->packet_type, decoder->second(record->payload), {} };
+        if (record->packet_type == EchoPacket::static_unique_id)
+        {
+            try
+            {
+                const auto echo = pds::capture::decode_packet<EchoPacket>(record->payload);
+                packet.echo_reply = std::to_string(std::stoll(echo->echo_message) + 1);
+            }
+            catch (const std::logic_error &)
+            {
+                // Not a number: sent, but its reply can't be matched.
+            }
+        }
+        session.packets.emplace_back(std::move(packet));
+        capture.packets++;
+    }
+
+    capture.sessions.reserve(sessions.size());
+    for (auto &[id, session] : sessions)
+    {
+        capture.sessions.emplace_back(std::move(session));
+    }
+    return capture;
+}
+
+struct ReplayConfig
+{
+    // 1 replays at the captured pace, 2 twice as fast; 0 sends everything as fast as possible.
+    double speed = 1.0;
+    // How long a session waits for outstanding echo replies after its last packet.
+    std::chrono::milliseconds drain_timeout{ 5000 };
+};
+
+/**
+ * @brief Replays every captured session against a server: same sessions, same packets and,
+ * unless run as fast as possible, the same timing.
+ *
+ * @details Each session performs its own handshake at its captured open time. Send lag is
+ * how far behind schedule a packet went out, which tells whether the replayer itself kept
+ * up; echo latency is measured from the actual send.
+ */
+class Replayer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @param trust Server key to handshake with, or nullptr for plaintext sessions, only served on local endpoints. */
+    Replayer(boost::asio::io_context &io_context, ReplayConfig config, pds::network::Endpoint endpoint,
+             pds::crypto::ServerTrust const *trust, uint32_t key_id, ReplayCapture capture)
+        : io_context_{ io_context },
+          config_{ config },
+          endpoint_{ std::move(endpoint) },
+          trust_{ trust },
+          key_id_{ key_id },
+          capture_{ std::move(capture) }
+    {
+    }
+
+    void start()
+    {
+        start_ = Clock::now();
+        remaining_ = capture_.sessions.size();
+        if (remaining_ == 0)
+        {
+            report();
+            return;
+        }
+        for (auto const &session : capture_.sessions)
+        {
+            co_spawn(io_context_, replay(session), boost::asio::detached);
+        }
+    }
+
+private:
+    struct InFlight
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, Clock::time_point> sent;
+    };
+
+    Clock::time_point scheduled(std::chrono::nanoseconds time) const
+    {
+        if (config_.speed <= 0)
+        {
+            return start_;
+        }
+        return start_ + std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::duration<double, std::nano>(static_cast<double>(time.count()) / config_.speed));
+    }
+
+    boost::asio::awaitable<void> wait_until(Clock::time_point time)
+    {
+        if (Clock::now() < time)
+        {
+            boost::asio::steady_timer timer{ io_context_, time };
+            co_await timer.async_wait(boost::asio::use_awaitable);
+        }
+    }
+
+    boost::asio::awaitable<void> replay(ReplaySession const &captured)
+    {
+        co_await wait_until(scheduled(captured.opened));
+        std::shared_ptr<mal_packet_weaver::DispatcherSession> session;
+        try
+        {
+            pds::network::Socket socket = co_await pds::network::async_connect(endpoint_);
+            session = std::make_shared<mal_packet_weaver::DispatcherSession>(
+                io_context_, pds::network::into_session_socket(std::move(socket)));
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::error("Couldn't establish connection: {}", e.what());
+            failed_++;
+            finish();
+            co_return;
+        }
+        if (trust_ != nullptr && !co_await pds::crypto::setup_encryption_for_session(*session, *trust_, key_id_))
+        {
+            failed_++;
+            finish();
+            co_return;
+        }
+
+        auto in_flight = std::make_shared<InFlight>();
+        session->register_default_handler<mal_packet_weaver::Session &, PingPacket>(pds::network::respond_to_ping);
+        // The server answers through its outbound queue, in batches.
+        const auto batches = std::make_shared<pds::network::BatchReceiver>();
+        batches->add<EchoPacket>(
+            [this, in_flight](std::unique_ptr<EchoPacket> &&echo)
+            {
+                const auto now = Clock::now();
+                std::unique_lock lock{ in_flight->mutex };
+                const auto it = in_flight->sent.find(echo->echo_message);
+                if (it == in_flight->sent.end())
+                {
+                    return;
+                }
+                const auto latency = now - it->second;
+                in_flight->sent.erase(it);
+                lock.unlock();
+                std::lock_guard stats_lock{ stats_mutex_ };
+                echo_latency_.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count()));
+            });
+        pds::network::receive_batches(*session, batches);
+
+        for (auto const &packet : captured.packets)
+        {
+            const auto due = scheduled(packet.time);
+            co_await wait_until(due);
+            const auto now = Clock::now();
+            if (!packet.echo_reply.empty())
+            {
+                std::lock_guard lock{ in_flight->mutex };
+                in_flight->sent[packet.echo_reply] = now;
+            }
+            packet.send(*session);
+            std::lock_guard lock{ stats_mutex_ };
+            send_lag_.record(
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count()));
+            sent_[packet.type]++;
+        }
+
+        if (captured.closed)
+        {
+            co_await wait_until(scheduled(*captured.closed));
+        }
+        const auto drain_deadline = Clock::now() + config_.drain_timeout;
+        boost::asio::steady_timer timer{ io_context_ };
+        while (Clock::now() < drain_deadline)
+        {
+            {
+                std::lock_guard lock{ in_flight->mutex };
+                if (in_flight->sent.empty())
+                {
+                    break;
+                }
+            }
+            timer.expires_after(std::chrono::milliseconds{ 10 });
+            co_await timer.async_wait(boost::asio::use_awaitable);
+        }
+        {
+            std::scoped_lock lock{ in_flight->mutex, stats_mutex_ };
+            unanswered_ += in_flight->sent.size();
+        }
+        session->Destroy();
+        finish();
+    }
+
+    void finish()
+    {
+        if (--remaining_ == 0)
+        {
+            report();
+        }
+    }
+
+    void report()
+    {
+        std::lock_guard lock{ stats_mutex_ };
+        const double seconds = std::chrono::duration<double>(Clock::now() - start_).count();
+        uint64_t sent = 0;
+        for (auto const &[type, count] : sent_)
+        {
+            sent += count;
+        }
+        const auto us = [](pds::metrics::LatencyHistogram const &histogram, double percentile)
+        { return static_cast<double>(histogram.percentile(percentile)) / 1e3; };
+
+        std::cout << std::format("replayed {} sessions ({} failed) in {:.1f} s at speed {}\n",
+                                 capture_.sessions.size(), failed_.load(), seconds, config_.speed);
+        std::cout << std::format("sent {} packets, {:.0f}/s; {} skipped as unknown\n", sent, sent / seconds,
+                                 capture_.skipped);
+        std::cout << std::format("{:<12} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}\n", "", "count", "p50 us",
+                                 "p90 us", "p99 us", "p99.9 us", "max us");
+        for (auto const &[name, histogram] : { std::pair{ "echo rtt", &echo_latency_ }, std::pair{ "send lag", &send_lag_ } })
+        {
+            std::cout << std::format("{:<12} {:>10} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n", name,
+                                     histogram->count(), us(*histogram, 50), us(*histogram, 90), us(*histogram, 99),
+                                     us(*histogram, 99.9), static_cast<double>(histogram->max()) / 1e3);
+        }
+        std::cout << std::format("echoes without reply: {}\n", unanswered_);
+        for (auto const &[type, count] : sent_)
+        {
+            std::cout << std::format("  {:<36} {:>10}\n", capture_.packet_names.at(type), count);
+        }
+        io_context_.stop();
+    }
+
+    boost::asio::io_context &io_context_;
+    const ReplayConfig config_;
+    const pds::network::Endpoint endpoint_;
+    pds::crypto::ServerTrust const *trust_;
+    const uint32_t key_id_;
+    const ReplayCapture capture_;
+    Clock::time_point start_;
+    std::atomic<size_t> remaining_ = 0;
+    std::atomic<uint64_t> failed_ = 0;
+
+    std::mutex stats_mutex_;
+    pds::metrics::LatencyHistogram echo_latency_;
+    pds::metrics::LatencyHistogram send_lag_;
+    std::map<mal_packet_weaver::UniquePacketID, uint64_t> sent_;
+    uint64_t unanswered_ = 0;
+};